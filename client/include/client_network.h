@@ -47,7 +47,9 @@ public:
     using ConnectionCallback = std::function<void(bool connected, const std::string& error)>;
 
     // Matchmaking callbacks
-    using PlayerListCallback = std::function<void(bool success, const std::vector<PlayerInfo_Message>& players)>;
+    // next_cursor requests the following page, or is 0 on the last one
+    using PlayerListCallback = std::function<void(bool success, const std::vector<PlayerInfo_Message>& players,
+                                                  uint32_t next_cursor)>;
     using PlayerStatusCallback = std::function<void(const PlayerStatusUpdate& update)>;
     using SendChallengeCallback = std::function<void(bool success, const std::string& error)>;
     using ChallengeReceivedCallback = std::function<void(const ChallengeReceived& challenge)>;
@@ -70,6 +72,13 @@ public:
     void disconnect();
     bool isConnected() const { return status_ == CONNECTED || status_ == AUTHENTICATED; }
     ConnectionStatus getStatus() const { return status_; }
+    // Reconnect delay the server asked for when it refused us (SERVER_BUSY); 0 if it never did
+    uint32_t getRetryAfterMs() const { return retry_after_ms_; }
+    // Send v2 compact headers (the default); false speaks v1 to servers without them.
+    // Set before connect(). Frames from the server are read in either version.
+    // With v2 the client also offers the optional features it supports (CAPABILITIES).
+    void setCompactHeaders(bool enabled) { compact_headers_ = enabled; }
+    uint32_t getCapabilities() const { return capabilities_; }  // Agreed with the server
 
     // Authentication API
     void registerUser(const std::string& username,
@@ -86,7 +95,7 @@ public:
     void validateSession(const std::string& session_token, ValidateSessionCallback callback);
 
     // Matchmaking API
-    void requestPlayerList(PlayerListCallback callback);
+    void requestPlayerList(PlayerListCallback callback, uint32_t cursor = 0, uint16_t limit = 0);
     void sendChallenge(uint32_t target_user_id, uint32_t time_limit, bool random_placement, SendChallengeCallback callback);
     void respondToChallenge(uint32_t challenge_id, bool accept);
 
@@ -124,9 +133,12 @@ private:
     void closeSocket();
     bool sendMessage(const MessageHeader& header, const std::string& payload);
     bool receiveMessage(MessageHeader& header, std::string& payload);
+    bool receiveCompactHeader(MessageHeader& header, bool& compressed);  // Rest of a v2 header after its magic byte
 
     // Message handling
     void receiveLoop();
+    bool dispatchMessage(MessageType type, const std::string& payload);  // False to stop receiving
+    bool dispatchBatch(const std::string& payload);  // Each message of a BATCH frame in order
     void handleAuthResponse(const std::string& payload);
     void handlePlayerListResponse(const std::string& payload);
     void handlePlayerStatusUpdate(const std::string& payload);
@@ -143,8 +155,11 @@ private:
     // Connection state
     int socket_fd_;
     std::atomic<ConnectionStatus> status_;
+    std::atomic<uint32_t> retry_after_ms_;
     std::string host_;
     int port_;
+    bool compact_headers_;
+    std::atomic<uint32_t> capabilities_;  // WireCapability bits; set by the server's CAPABILITIES reply
 
     // Authentication state
     uint32_t user_id_;
@@ -155,6 +170,7 @@ private:
     // Async handling
     std::thread receive_thread_;
     std::atomic<bool> running_;
+    std::mutex send_mutex_;  // Keeps header + payload together; the receive thread answers heartbeats
 
     // Callbacks
     std::mutex callback_mutex_;
@@ -1,18 +1,27 @@
 #include "client_network.h"
 #include "message_serialization.h"
+#include "compact_header.h"
+#include "player_list.h"
+#include "batch_entry.h"
+#include "payload_compression.h"
+#include "config.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
+#include <algorithm>
 
 using namespace MessageSerialization;
 
 ClientNetwork::ClientNetwork()
     : socket_fd_(-1)
     , status_(DISCONNECTED)
+    , retry_after_ms_(0)
     , port_(0)
+    , compact_headers_(true)
+    , capabilities_(0)
     , user_id_(0)
     , elo_rating_(0)
     , running_(false)
@@ -55,6 +64,13 @@ bool ClientNetwork::connect(const std::string& host, int port, ConnectionCallbac
     status_ = CONNECTED;
     running_ = true;
 
+    // Offer what we can decode; from now on the server may use any of it
+    if (compact_headers_ && PayloadCompression::supported()) {
+        CapabilitiesMessage offer;
+        offer.flags = PayloadCompression::supported();
+        sendMessage(createHeader(MessageType::CAPABILITIES, sizeof(offer)), serialize(offer));
+    }
+
     // Start receive thread
     receive_thread_ = std::thread(&ClientNetwork::receiveLoop, this);
 
@@ -90,6 +106,7 @@ void ClientNetwork::disconnect() {
     session_token_.clear();
     display_name_.clear();
     elo_rating_ = 0;
+    capabilities_ = 0;
     pending_request_ = NONE;
 
     std::cout << "[CLIENT] Disconnected" << std::endl;
@@ -148,6 +165,38 @@ bool ClientNetwork::sendMessage(const MessageHeader& header, const std::string&
         return false;
     }
 
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
+    if (compact_headers_) {
+        // v2: a few header bytes, no session token (the server bound ours at login)
+        CompactHeader compact;
+        compact.type = header.type;
+        compact.length = (header.length > 0 && !payload.empty()) ? header.length : 0;
+        std::string body = payload.substr(0, compact.length);
+
+        // Large payloads go compressed once the server has agreed to it
+        std::string packed;
+        if ((capabilities_ & CAP_ZLIB) && compact.length >= COMPRESSION_THRESHOLD &&
+            PayloadCompression::compress(body.data(), body.size(), packed)) {
+            compact.flags |= CompactHeader::FLAG_COMPRESSED;
+            compact.length = static_cast<uint32_t>(packed.size());
+            body.swap(packed);
+        }
+
+        char encoded[CompactHeader::MAX_SIZE];
+        std::string frame(encoded, compact.encode(encoded));
+        frame.append(body);
+
+        ssize_t sent = send(socket_fd_, frame.data(), frame.size(), 0);
+        if (sent != (ssize_t)frame.size()) {
+            std::cerr << "[CLIENT] Failed to send message" << std::endl;
+            return false;
+        }
+        std::cout << "[CLIENT] Sent message type=" << (int)header.type
+                  << " length=" << compact.length << std::endl;
+        return true;
+    }
+
     // Send header
     ssize_t sent = send(socket_fd_, &header, sizeof(MessageHeader), 0);
     if (sent != sizeof(MessageHeader)) {
@@ -175,9 +224,10 @@ bool ClientNetwork::receiveMessage(MessageHeader& header, std::string& payload)
         return false;
     }
 
-    // Receive header
-    ssize_t received = recv(socket_fd_, &header, sizeof(MessageHeader), MSG_WAITALL);
-    if (received != sizeof(MessageHeader)) {
+    // Receive header; its first byte tells v2 from v1
+    uint8_t first = 0;
+    ssize_t received = recv(socket_fd_, &first, 1, 0);
+    if (received != 1) {
         if (received == 0) {
             std::cout << "[CLIENT] Server closed connection" << std::endl;
             return false;
@@ -193,6 +243,21 @@ bool ClientNetwork::receiveMessage(MessageHeader& header, std::string& payload)
         return false;
     }
 
+    bool compressed = false;
+    if (first == CompactHeader::MAGIC) {
+        if (!receiveCompactHeader(header, compressed)) {
+            return false;
+        }
+    } else {
+        header.type = first;
+        char* rest = reinterpret_cast<char*>(&header) + 1;
+        received = recv(socket_fd_, rest, sizeof(MessageHeader) - 1, MSG_WAITALL);
+        if (received != (ssize_t)sizeof(MessageHeader) - 1) {
+            std::cerr << "[CLIENT] Failed to receive header" << std::endl;
+            return false;
+        }
+    }
+
     // Receive payload if any
     payload.clear();
     if (header.length > 0) {
@@ -204,12 +269,49 @@ bool ClientNetwork::receiveMessage(MessageHeader& header, std::string& payload)
         }
     }
 
+    if (compressed) {
+        std::string decompressed;
+        if (!PayloadCompression::decompress(payload.data(), payload.size(), MAX_MESSAGE_SIZE, decompressed)) {
+            std::cerr << "[CLIENT] Bad compressed payload" << std::endl;
+            return false;
+        }
+        payload.swap(decompressed);
+        header.length = static_cast<uint32_t>(payload.size());
+    }
+
     std::cout << "[CLIENT] Received message type=" << (int)header.type
               << " length=" << header.length << std::endl;
 
     return true;
 }
 
+bool ClientNetwork::receiveCompactHeader(MessageHeader& header, bool& compressed) {
+    // Type, flags and the first length byte always follow; longer varints a byte at a time
+    char bytes[CompactHeader::MAX_SIZE];
+    bytes[0] = static_cast<char>(CompactHeader::MAGIC);
+    size_t size = 1;
+    size_t wanted = 3;
+    CompactHeader compact;
+    int used = 0;
+    while ((used = compact.decode(bytes, size)) == 0 && size < sizeof(bytes)) {
+        ssize_t received = recv(socket_fd_, bytes + size, wanted, MSG_WAITALL);
+        if (received != (ssize_t)wanted) {
+            std::cerr << "[CLIENT] Failed to receive header" << std::endl;
+            return false;
+        }
+        size += wanted;
+        wanted = 1;
+    }
+    if (used <= 0) {
+        std::cerr << "[CLIENT] Malformed v2 header" << std::endl;
+        return false;
+    }
+
+    header = compact.toMessageHeader();
+    compressed = (compact.flags & CompactHeader::FLAG_COMPRESSED) != 0;
+    return true;
+}
+
 // ==================== Message Handling ====================
 
 void ClientNetwork::receiveLoop() {
@@ -234,69 +336,134 @@ void ClientNetwork::receiveLoop() {
             break;
         }
 
-        // Handle message based on type
-        MessageType msg_type = static_cast<MessageType>(header.type);
+        if (!dispatchMessage(static_cast<MessageType>(header.type), payload)) {
+            status_ = ERROR_STATE;
+            break;
+        }
+    }
+
+    std::cout << "[CLIENT] Receive loop stopped" << std::endl;
+}
+
+bool ClientNetwork::dispatchMessage(MessageType msg_type, const std::string& payload) {
+    // The handlers below read the struct message_schema.h gives each type
+    if (!validatePayloadSize(msg_type, payload.size(), FROM_SERVER)) {
+        std::cerr << "[CLIENT] Ignoring message type=" << (int)msg_type
+                  << " with " << payload.size() << " byte payload" << std::endl;
+        return true;
+    }
 
-        switch (msg_type) {
-            case MessageType::AUTH_RESPONSE:
-                handleAuthResponse(payload);
-                break;
+    if (msg_type == MessageType::SERVER_BUSY) {
+        // Refused at accept; the server closes the socket after this frame
+        ServerBusyMessage busy;
+        memset(&busy, 0, sizeof(busy));
+        memcpy(&busy, payload.data(), std::min(payload.size(), sizeof(busy)));
+        retry_after_ms_ = busy.retry_after_ms;
+        std::cerr << "[CLIENT] Server busy ("
+                  << (busy.reason == BUSY_SERVER_FULL ? "full" : "too many connections from this address")
+                  << "), retry in " << busy.retry_after_ms << " ms" << std::endl;
+        return false;
+    }
 
-            case MessageType::PLAYER_LIST:
-                handlePlayerListResponse(payload);
-                break;
+    switch (msg_type) {
+        case MessageType::AUTH_RESPONSE:
+            handleAuthResponse(payload);
+            break;
 
-            case MessageType::PLAYER_STATUS_UPDATE:
-                handlePlayerStatusUpdate(payload);
-                break;
+        case MessageType::PLAYER_LIST:
+            handlePlayerListResponse(payload);
+            break;
 
-            case MessageType::CHALLENGE_RECEIVED:
-                handleChallengeReceived(payload);
-                break;
+        case MessageType::PLAYER_STATUS_UPDATE:
+            handlePlayerStatusUpdate(payload);
+            break;
 
-            case MessageType::MATCH_START:
-                handleMatchStart(payload);
-                break;
+        case MessageType::CHALLENGE_RECEIVED:
+            handleChallengeReceived(payload);
+            break;
 
-            case MessageType::SHIP_PLACEMENT:
-                handleShipPlacementAck(payload);
-                break;
+        case MessageType::MATCH_START:
+            handleMatchStart(payload);
+            break;
 
-            case MessageType::MATCH_READY:
-                handleMatchReady(payload);
-                break;
+        case MessageType::SHIP_PLACEMENT:
+            handleShipPlacementAck(payload);
+            break;
 
-            case MessageType::MOVE_RESULT:
-                handleMoveResult(payload);
-                break;
+        case MessageType::MATCH_READY:
+            handleMatchReady(payload);
+            break;
 
-            case MessageType::TURN_UPDATE:
-                handleTurnUpdate(payload);
-                break;
+        case MessageType::MOVE_RESULT:
+            handleMoveResult(payload);
+            break;
 
-            case MessageType::MATCH_END:
-                handleMatchEnd(payload);
-                break;
+        case MessageType::TURN_UPDATE:
+            handleTurnUpdate(payload);
+            break;
 
-            case MessageType::DRAW_OFFER:
-                handleDrawOffer(payload);
-                break;
+        case MessageType::MATCH_END:
+            handleMatchEnd(payload);
+            break;
 
-            case MessageType::DRAW_RESPONSE:
-                handleDrawResponse(payload);
-                break;
+        case MessageType::DRAW_OFFER:
+            handleDrawOffer(payload);
+            break;
 
-            case MessageType::PONG:
-                // Keepalive response
-                break;
+        case MessageType::DRAW_RESPONSE:
+            handleDrawResponse(payload);
+            break;
 
-            default:
-                std::cout << "[CLIENT] Unhandled message type: " << (int)msg_type << std::endl;
-                break;
+        case MessageType::PING: {
+            // Server heartbeat after a quiet spell; answer so the connection is kept
+            MessageHeader pong;
+            memset(&pong, 0, sizeof(pong));
+            pong.type = static_cast<uint8_t>(MessageType::PONG);
+            pong.timestamp = time(nullptr);
+            sendMessage(pong, "");
+            break;
         }
+
+        case MessageType::PONG:
+            // Keepalive response
+            break;
+
+        case MessageType::CAPABILITIES: {
+            // What the server agreed to out of our offer
+            CapabilitiesMessage agreed;
+            memset(&agreed, 0, sizeof(agreed));
+            memcpy(&agreed, payload.data(), std::min(payload.size(), sizeof(agreed)));
+            capabilities_ = agreed.flags & PayloadCompression::supported();
+            break;
+        }
+
+        case MessageType::BATCH:
+            return dispatchBatch(payload);
+
+        default:
+            std::cout << "[CLIENT] Unhandled message type: " << (int)msg_type << std::endl;
+            break;
     }
 
-    std::cout << "[CLIENT] Receive loop stopped" << std::endl;
+    return true;
+}
+
+bool ClientNetwork::dispatchBatch(const std::string& payload) {
+    // Each message in turn, as if it had come in its own frame
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        BatchEntry entry;
+        size_t used = entry.decode(payload.data() + offset, payload.size() - offset);
+        if (used == 0 || entry.type == MessageType::BATCH) {
+            std::cerr << "[CLIENT] Malformed batch frame" << std::endl;
+            return true;
+        }
+        offset += used;
+        if (!dispatchMessage(static_cast<MessageType>(entry.type), std::string(entry.payload, entry.length))) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void ClientNetwork::handleAuthResponse(const std::string& payload) {
@@ -577,16 +744,16 @@ void ClientNetwork::validateSession(const std::string& session_token, ValidateSe
 
 // ==================== Matchmaking API ====================
 
-void ClientNetwork::requestPlayerList(PlayerListCallback callback) {
+void ClientNetwork::requestPlayerList(PlayerListCallback callback, uint32_t cursor, uint16_t limit) {
     if (!isAuthenticated()) {
         std::cerr << "[CLIENT] Not authenticated" << std::endl;
         if (callback) {
-            callback(false, std::vector<PlayerInfo_Message>());
+            callback(false, std::vector<PlayerInfo_Message>(), 0);
         }
         return;
     }
 
-    std::cout << "[CLIENT] Requesting player list" << std::endl;
+    std::cout << "[CLIENT] Requesting player list (cursor " << cursor << ")" << std::endl;
 
     // Set callback
     {
@@ -595,18 +762,21 @@ void ClientNetwork::requestPlayerList(PlayerListCallback callback) {
         pending_request_ = PLAYER_LIST;
     }
 
-    // Send request (empty payload)
+    PlayerListRequest req;
+    req.cursor = cursor;
+    req.limit = limit;
+
     MessageHeader header;
     header.type = static_cast<uint8_t>(PLAYER_LIST_REQUEST);
-    header.length = 0;
+    header.length = sizeof(PlayerListRequest);
     header.timestamp = time(nullptr);
     safeStrCopy(header.session_token, session_token_, sizeof(header.session_token));
 
-    if (!sendMessage(header, "")) {
+    if (!sendMessage(header, serialize(req))) {
         std::lock_guard<std::mutex> lock(callback_mutex_);
         pending_request_ = NONE;
         if (callback) {
-            callback(false, std::vector<PlayerInfo_Message>());
+            callback(false, std::vector<PlayerInfo_Message>(), 0);
         }
     }
 }
@@ -872,25 +1042,20 @@ void ClientNetwork::handlePlayerListResponse(const std::string& payload) {
 
     pending_request_ = NONE;
 
-    PlayerListResponse resp;
-    if (!deserialize(payload, resp)) {
-        std::cerr << "[CLIENT] Failed to deserialize PlayerListResponse" << std::endl;
+    PlayerListPage page;
+    if (!page.decode(payload)) {
+        std::cerr << "[CLIENT] Failed to decode player list page" << std::endl;
         if (player_list_callback_) {
-            player_list_callback_(false, std::vector<PlayerInfo_Message>());
+            player_list_callback_(false, std::vector<PlayerInfo_Message>(), 0);
         }
         return;
     }
 
-    std::cout << "[CLIENT] Received player list with " << resp.count << " players" << std::endl;
-
-    // Convert to vector
-    std::vector<PlayerInfo_Message> players;
-    for (uint32_t i = 0; i < resp.count; i++) {
-        players.push_back(resp.players[i]);
-    }
+    std::cout << "[CLIENT] Received player list with " << page.players.size()
+              << " of " << page.total << " players" << std::endl;
 
     if (player_list_callback_) {
-        player_list_callback_(true, players);
+        player_list_callback_(true, page.players, page.next_cursor);
     }
 }
 
@@ -11,8 +11,13 @@ struct LobbyData {
     GtkWidget* challenge_btn;
     GtkWidget* refresh_btn;
     uint32_t selected_user_id;
+    uint32_t next_cursor;       // Next page of the player list (0 = all shown)
+    bool loading_players;
 };
 
+// Players fetched per page; more are loaded when the list is scrolled to the bottom
+static const uint16_t LOBBY_PAGE_SIZE = 50;
+
 // Columns for player list TreeView
 enum {
     COL_USER_ID,
@@ -87,24 +92,23 @@ static void on_challenge_clicked(GtkButton* button, gpointer data) {
         });
 }
 
-// Callback when refresh button clicked
-static void on_refresh_clicked(GtkButton* button, gpointer data) {
-    LobbyData* lobby = static_cast<LobbyData*>(data);
-
-    std::cout << "[LOBBY] Refreshing player list..." << std::endl;
-
+// Fetch a page of the player list; cursor 0 replaces the list, any other appends to it
+static void requestPlayerPage(LobbyData* lobby, uint32_t cursor) {
     // Disable button while refreshing
-    gtk_widget_set_sensitive(GTK_WIDGET(button), FALSE);
+    gtk_widget_set_sensitive(lobby->refresh_btn, FALSE);
+    lobby->loading_players = true;
 
     lobby->ui->network->requestPlayerList(
-        [lobby, button](bool success, const std::vector<PlayerInfo_Message>& players) {
+        [lobby, cursor](bool success, const std::vector<PlayerInfo_Message>& players, uint32_t next_cursor) {
             // Re-enable button
-            gtk_widget_set_sensitive(GTK_WIDGET(button), TRUE);
+            gtk_widget_set_sensitive(lobby->refresh_btn, TRUE);
+            lobby->loading_players = false;
 
             if (!success) {
                 std::cerr << "[LOBBY] ❌ Failed to get player list" << std::endl;
                 return;
             }
+            lobby->next_cursor = next_cursor;
 
             std::cout << "[LOBBY] ✅ Received " << players.size() << " players" << std::endl;
             
@@ -117,8 +121,10 @@ static void on_refresh_clicked(GtkButton* button, gpointer data) {
                           << ", Status: " << (int)player.status << ")" << std::endl;
             }
 
-            // Clear existing list
-            gtk_list_store_clear(lobby->player_list_store);
+            // Clear existing list, unless this is a further page
+            if (cursor == 0) {
+                gtk_list_store_clear(lobby->player_list_store);
+            }
 
             // Add players to tree view (including self - no filtering)
             for (const auto& player : players) {
@@ -132,7 +138,29 @@ static void on_refresh_clicked(GtkButton* button, gpointer data) {
                                   COL_STATUS_TEXT, getStatusText(player.status),
                                   -1);
             }
-        });
+        }, cursor, LOBBY_PAGE_SIZE);
+}
+
+// Callback when refresh button clicked
+static void on_refresh_clicked(GtkButton* button, gpointer data) {
+    (void)button;
+    LobbyData* lobby = static_cast<LobbyData*>(data);
+
+    std::cout << "[LOBBY] Refreshing player list..." << std::endl;
+    requestPlayerPage(lobby, 0);
+}
+
+// Callback when the player list is scrolled to an edge: load the next page at the bottom
+static void on_player_list_edge_reached(GtkScrolledWindow* scroll, GtkPositionType pos, gpointer data) {
+    (void)scroll;
+    LobbyData* lobby = static_cast<LobbyData*>(data);
+
+    if (pos != GTK_POS_BOTTOM || lobby->next_cursor == 0 || lobby->loading_players) {
+        return;
+    }
+
+    std::cout << "[LOBBY] Loading more players..." << std::endl;
+    requestPlayerPage(lobby, lobby->next_cursor);
 }
 
 // Update player status in tree view
@@ -200,6 +228,8 @@ GtkWidget* UIManager::createLobbyScreen() {
     LobbyData* lobby = new LobbyData();
     lobby->ui = this;
     lobby->selected_user_id = 0;
+    lobby->next_cursor = 0;
+    lobby->loading_players = false;
 
     GtkWidget* main_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
     g_object_set_data_full(G_OBJECT(main_box), "lobby_data", lobby, lobby_data_destroy);
@@ -324,6 +354,7 @@ GtkWidget* UIManager::createLobbyScreen() {
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(scroll),
                                    GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
     gtk_container_add(GTK_CONTAINER(scroll), GTK_WIDGET(lobby->player_tree_view));
+    g_signal_connect(scroll, "edge-reached", G_CALLBACK(on_player_list_edge_reached), lobby);
 
     gtk_box_pack_start(GTK_BOX(content), list_header, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(content), scroll, TRUE, TRUE, 0);
@@ -0,0 +1,38 @@
+#ifndef BATCH_ENTRY_H
+#define BATCH_ENTRY_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * BatchEntry - One message inside a BATCH frame
+ *
+ * When a server step sends a client several messages (MOVE_RESULT and
+ * TURN_UPDATE after a shot, MATCH_END and the status updates at the end of a
+ * match), they can go out as one BATCH frame whose payload is the messages
+ * back to back:
+ *
+ *   type (u8) | length (u16) | payload    ... repeated to the end of the frame
+ *
+ * The receiver handles them in order, as if each had come in its own frame.
+ * Entries carry no session token or timestamp, and a BATCH never nests.
+ */
+struct BatchEntry {
+    static const size_t HEADER_SIZE = 3;
+    static const size_t MAX_LENGTH = 0xFFFF;
+
+    uint8_t type;           // MessageType
+    uint16_t length;        // Payload length
+    const char* payload;    // Points into the frame the entry was decoded from
+
+    BatchEntry() : type(0), length(0), payload(nullptr) {}
+
+    // Writes the entry header (HEADER_SIZE bytes) for a payload of length bytes
+    static void encodeHeader(char* out, uint8_t type, uint16_t length);
+
+    // Reads the entry at the start of data. Returns its total size, or 0 if
+    // data is too short to hold it.
+    size_t decode(const char* data, size_t size);
+};
+
+#endif // BATCH_ENTRY_H
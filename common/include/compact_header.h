@@ -0,0 +1,57 @@
+#ifndef COMPACT_HEADER_H
+#define COMPACT_HEADER_H
+
+#include <cstdint>
+#include <cstddef>
+#include "protocol.h"
+
+/**
+ * CompactHeader - Frame header of protocol v2
+ *
+ * A v1 frame starts with the 77-byte MessageHeader, session token and all.
+ * A v2 frame starts with
+ *
+ *   0xB2 | type | flags | length (varint) | sequence (varint, FLAG_SEQUENCE only)
+ *
+ * which is 4 bytes for any payload under 128 bytes. Varints are LEB128:
+ * seven bits a byte, low bits first, high bit set on every byte but the last.
+ *
+ * No v1 message type is 0xB2, so the first byte of a connection's first frame
+ * says which version the client speaks, and the server answers in the same.
+ * v2 frames carry no session token or timestamp: the server binds the session
+ * to the connection at login (or VALIDATE_SESSION) and uses that one.
+ *
+ * FLAG_COMPRESSED marks a payload compressed by PayloadCompression; length
+ * is then its compressed size. Peers only send it once CAP_ZLIB is agreed.
+ */
+struct CompactHeader {
+    static const uint8_t MAGIC = 0xB2;
+    static const uint8_t FLAG_SEQUENCE = 0x01;  // A sequence number follows the length
+    static const uint8_t FLAG_COMPRESSED = 0x02;  // The payload is compressed
+    static const uint8_t KNOWN_FLAGS = FLAG_SEQUENCE | FLAG_COMPRESSED;
+    static const size_t MAX_SIZE = 13;          // Magic, type, flags and two 5-byte varints
+
+    uint8_t type;       // MessageType
+    uint8_t flags;
+    uint32_t length;    // Payload length
+    uint32_t sequence;  // Chosen by the sender; only sent with FLAG_SEQUENCE
+
+    CompactHeader() : type(0), flags(0), length(0), sequence(0) {}
+
+    // Writes the header to out, which has room for MAX_SIZE bytes; returns its size
+    size_t encode(char* out) const;
+
+    // Reads a header from the start of data. Returns its size, 0 if more bytes
+    // are needed, or -1 if it is not a valid v2 header (wrong magic, unknown
+    // flags, a varint longer than 32 bits).
+    int decode(const char* data, size_t size);
+
+    // The equivalent v1 header, with no timestamp or session token
+    MessageHeader toMessageHeader() const;
+
+    static bool isCompactFrame(const char* data, size_t size) {
+        return size > 0 && static_cast<uint8_t>(data[0]) == MAGIC;
+    }
+};
+
+#endif // COMPACT_HEADER_H
@@ -11,8 +11,25 @@
 // ===========================================
 #define SERVER_HOST "127.0.0.1"  // Default server host
 #define SERVER_PORT 9999         // Default server port
-#define MAX_CLIENTS 100          // Maximum concurrent connections
+#define MAX_CLIENTS 100          // Maximum concurrent connections, env MAX_CONNECTIONS
+#define MAX_CLIENTS_PER_IP 0     // Concurrent connections from one address (0 = no limit), env MAX_CONNECTIONS_PER_IP
+#define ADMISSION_RETRY_MS 1000  // Reconnect hint sent to refused clients, jittered up to twice this
+// Per-connection message budgets, TYPE=per_second/burst (* = all messages, TYPE=0 = unlimited);
+// entries in env RATE_LIMITS are applied on top of these
+#define DEFAULT_RATE_LIMITS "AUTH_REGISTER=1/5,AUTH_LOGIN=2/10,AUTH_LOGOUT=2/10,VALIDATE_SESSION=2/10," \
+                            "PLAYER_LIST_REQUEST=2/10,CHALLENGE_SEND=2/10,CHALLENGE_RESPONSE=5/20," \
+                            "SHIP_PLACEMENT=2/10,MOVE=10/20,REMATCH_REQUEST=2/10,REMATCH_RESPONSE=2/10"
 #define BUFFER_SIZE 8192         // Network buffer size
+#define COMPRESSION_THRESHOLD 256  // Smallest v2 payload sent compressed where agreed (see make compression-bench)
+#define DEFAULT_IO_REACTORS 0    // Server I/O event loops (0 = one per core), env IO_REACTORS
+#define DEFAULT_IO_BACKEND "epoll" // Server event loop: "epoll" or "io_uring" (falls back to epoll), env IO_BACKEND
+#define DEFAULT_WORKER_THREADS 0 // Message handling threads (0 = one per core), env WORKER_THREADS
+#define OUTBOUND_QUEUE_LIMIT (256 * 1024)  // Unsent bytes per client before the overflow policy applies, env OUTBOUND_QUEUE_BYTES
+#define IDLE_TIMEOUT_SECONDS 30  // Silence before the server sends a PING heartbeat (0 = off), env IDLE_TIMEOUT
+#define HEARTBEAT_GRACE_SECONDS 10  // Further silence before the connection is closed, env HEARTBEAT_GRACE
+#define UNIX_SOCKET_PATH "data/battleship.sock"  // Stream socket for clients on this host (bots, load tools), env UNIX_SOCKET
+#define HANDOFF_SOCKET_PATH "data/handoff.sock"  // Where a new server binary takes over a running one, env HANDOFF_SOCKET
+#define HANDOFF_READY_TIMEOUT_MS 10000  // How long the old process waits for its successor to report ready
 
 // ===========================================
 // Database Settings
@@ -0,0 +1,141 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <string>
+
+/**
+ * Logger - Asynchronous leveled logging
+ *
+ *   LOG_INFO("SERVER", "Listening on port " << port);
+ *
+ * A statement below the current level costs one relaxed load. One that is
+ * logged is formatted into a stack buffer without iostreams, stamped, and
+ * copied into a lock-free ring; a background thread turns the ring into
+ * lines on stdout (DEBUG/INFO) and stderr (WARN/ERROR):
+ *
+ *   2025-01-31 14:02:07.183415 INFO  [SERVER] Listening on port 9999
+ *
+ * Nothing on the logging side blocks or allocates. Lines longer than
+ * LINE_BYTES are truncated, and when the ring is full lines are dropped and
+ * counted rather than stalling the caller. Before start() and after stop()
+ * each line is written synchronously instead.
+ *
+ * LOG_DEBUG statements are compiled in only for debug builds (make debug, or
+ * make LOG_DEBUG=1); otherwise the level is set at run time (setLevel(),
+ * LOG_LEVEL environment variable).
+ */
+enum LogLevel {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO = 1,
+    LOG_LEVEL_WARN = 2,
+    LOG_LEVEL_ERROR = 3,
+    LOG_LEVEL_OFF = 4
+};
+
+class Logger {
+public:
+    struct Stats {
+        uint64_t lines;     // Accepted into the ring or written directly
+        uint64_t dropped;   // Ring full
+    };
+
+    static const size_t LINE_BYTES = 240;   // Text of one line, after the tag
+
+    static bool enabled(LogLevel level) {
+        return level >= min_level_.load(std::memory_order_relaxed);
+    }
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+
+    // "DEBUG", "INFO", "WARN"/"WARNING", "ERROR", "OFF" (any case); false if unknown
+    static bool parseLevel(const char* name, LogLevel& level);
+
+    // Where lines go (default stdout/stderr). Set before start().
+    static void setOutput(int out_fd, int err_fd);
+
+    // Background writer. stop() writes out everything logged before it.
+    static void start();
+    static void stop();
+
+    // Waits until every line logged before the call has been written
+    static void flush();
+
+    static Stats getStats();
+
+    // Used by the LOG_* macros
+    static void submit(LogLevel level, const char* tag, const char* text, size_t length);
+
+private:
+    static std::atomic<int> min_level_;
+};
+
+/**
+ * One log statement being formatted; submits itself when it goes out of scope
+ */
+class LogLine {
+public:
+    LogLine(LogLevel level, const char* tag) : level_(level), tag_(tag), length_(0), truncated_(false) {}
+    ~LogLine();
+
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(const std::string& text) { return append(text.data(), text.size()); }
+    LogLine& operator<<(char value) { return append(&value, 1); }
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+    LogLine& operator<<(int value) { return appendSigned(value); }
+    LogLine& operator<<(long value) { return appendSigned(value); }
+    LogLine& operator<<(long long value) { return appendSigned(value); }
+    LogLine& operator<<(unsigned char value) { return appendUnsigned(value); }
+    LogLine& operator<<(unsigned short value) { return appendUnsigned(value); }
+    LogLine& operator<<(short value) { return appendSigned(value); }
+    LogLine& operator<<(unsigned int value) { return appendUnsigned(value); }
+    LogLine& operator<<(unsigned long value) { return appendUnsigned(value); }
+    LogLine& operator<<(unsigned long long value) { return appendUnsigned(value); }
+    LogLine& operator<<(double value);
+    LogLine& operator<<(const void* pointer);
+    template<typename T>
+    LogLine& operator<<(const std::atomic<T>& value) { return *this << value.load(); }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+private:
+    LogLine& append(const char* text, size_t length);
+    LogLine& appendSigned(long long value);
+    LogLine& appendUnsigned(unsigned long long value);
+
+    LogLevel level_;
+    const char* tag_;
+    size_t length_;
+    bool truncated_;
+    char text_[Logger::LINE_BYTES];
+};
+
+#define LOG_AT(level, tag, message) \
+    do { \
+        if (Logger::enabled(level)) { \
+            LogLine log_line_(level, tag); \
+            log_line_ << message; \
+        } \
+    } while (0)
+
+#if defined(DEBUG) || defined(LOG_DEBUG_ENABLED)
+#define LOG_DEBUG(tag, message) LOG_AT(LOG_LEVEL_DEBUG, tag, message)
+#else
+// Still type-checked, never run
+#define LOG_DEBUG(tag, message) \
+    do { \
+        if (false) { \
+            LogLine log_line_(LOG_LEVEL_DEBUG, tag); \
+            log_line_ << message; \
+        } \
+    } while (0)
+#endif
+
+#define LOG_INFO(tag, message) LOG_AT(LOG_LEVEL_INFO, tag, message)
+#define LOG_WARN(tag, message) LOG_AT(LOG_LEVEL_WARN, tag, message)
+#define LOG_ERROR(tag, message) LOG_AT(LOG_LEVEL_ERROR, tag, message)
+
+#endif // LOGGER_H
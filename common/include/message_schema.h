@@ -0,0 +1,298 @@
+#ifndef MESSAGE_SCHEMA_H
+#define MESSAGE_SCHEMA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "protocol.h"
+#include "messages/authentication_messages.h"
+#include "messages/matchmaking_messages.h"
+#include "messages/gameplay_messages.h"
+
+/**
+ * Message Schema
+ * The payload each message type carries, in each direction
+ *
+ * Every list below has one X(TYPE, Payload) line per message. Payload is a
+ * packed struct from messages/, or one of
+ *
+ *   NoPayload            header only
+ *   OptionalPayload<T>   nothing or a T (older clients send nothing)
+ *   VariablePayload      encoded by hand, up to MAX_MESSAGE_SIZE
+ *
+ * The rest is generated from the lists:
+ * - the payload rules both ends check incoming messages against
+ *   (MessageSerialization::validatePayloadSize),
+ * - the type to struct mapping (ClientPayload, ServerPayload),
+ * - for each server handler, which types it serves and the switch that
+ *   decodes them (e.g. MessageSchema::dispatchGameplay).
+ *
+ * A message is added here once and client and server agree on it. Within one
+ * handler group every struct is used by one type only.
+ */
+
+struct NoPayload {};
+struct VariablePayload {};
+template <typename T> struct OptionalPayload {};
+
+// ============== CLIENT -> SERVER ==============
+
+#define AUTH_CLIENT_MESSAGES(X) \
+    X(AUTH_REGISTER, RegisterRequest) \
+    X(AUTH_LOGIN, LoginRequest) \
+    X(AUTH_LOGOUT, LogoutRequest) \
+    X(VALIDATE_SESSION, SessionValidateRequest)
+
+#define PLAYER_CLIENT_MESSAGES(X) \
+    X(PLAYER_LIST_REQUEST, OptionalPayload<PlayerListRequest>)
+
+#define CHALLENGE_CLIENT_MESSAGES(X) \
+    X(CHALLENGE_SEND, ChallengeRequest) \
+    X(CHALLENGE_RESPONSE, ChallengeResponse)
+
+#define GAMEPLAY_CLIENT_MESSAGES(X) \
+    X(SHIP_PLACEMENT, ShipPlacementMessage) \
+    X(MOVE, MoveMessage) \
+    X(RESIGN, ResignMessage) \
+    X(DRAW_OFFER, DrawOfferMessage) \
+    X(DRAW_RESPONSE, DrawResponseMessage) \
+    X(REMATCH_REQUEST, RematchRequestMessage) \
+    X(REMATCH_RESPONSE, RematchResponseMessage)
+
+// Answered by the server itself (Server::routeMessage)
+#define SYSTEM_CLIENT_MESSAGES(X) \
+    X(PING, NoPayload) \
+    X(PONG, NoPayload) \
+    X(CAPABILITIES, CapabilitiesMessage)
+
+#define CLIENT_MESSAGES(X) \
+    AUTH_CLIENT_MESSAGES(X) \
+    PLAYER_CLIENT_MESSAGES(X) \
+    CHALLENGE_CLIENT_MESSAGES(X) \
+    GAMEPLAY_CLIENT_MESSAGES(X) \
+    SYSTEM_CLIENT_MESSAGES(X)
+
+// ============== SERVER -> CLIENT ==============
+
+#define SERVER_MESSAGES(X) \
+    X(AUTH_RESPONSE, VariablePayload)        /* Response struct of the request it answers */ \
+    X(PLAYER_LIST, VariablePayload)          /* PlayerListPage */ \
+    X(PLAYER_STATUS_UPDATE, PlayerStatusUpdate) \
+    X(CHALLENGE_RECEIVED, ChallengeReceived) \
+    X(CHALLENGE_RESPONSE, ChallengeResult) \
+    X(MATCH_START, MatchStartMessage) \
+    X(MATCH_READY, MatchStateMessage) \
+    X(SHIP_PLACEMENT, ShipPlacementAck) \
+    X(MOVE_RESULT, MoveResultMessage) \
+    X(TURN_UPDATE, TurnUpdateMessage) \
+    X(MATCH_END, MatchEndMessage) \
+    X(DRAW_OFFER, DrawOfferMessage) \
+    X(DRAW_RESPONSE, DrawResponseMessage) \
+    X(PING, NoPayload) \
+    X(PONG, NoPayload) \
+    X(SERVER_BUSY, ServerBusyMessage) \
+    X(BATCH, VariablePayload)                /* BatchEntry after BatchEntry */ \
+    X(CAPABILITIES, CapabilitiesMessage)
+
+namespace MessageSchema {
+
+// ============== PAYLOAD RULES ==============
+
+enum PayloadKind : uint8_t {
+    PAYLOAD_UNKNOWN = 0,    // Not sent in this direction
+    PAYLOAD_NONE,
+    PAYLOAD_FIXED,
+    PAYLOAD_OPTIONAL,       // Empty or size bytes
+    PAYLOAD_VARIABLE
+};
+
+struct PayloadRule {
+    uint8_t kind;
+    uint16_t size;          // Struct size for FIXED and OPTIONAL
+
+    constexpr bool accepts(size_t actual) const {
+        return kind == PAYLOAD_NONE ? actual == 0 :
+               kind == PAYLOAD_FIXED ? actual == size :
+               kind == PAYLOAD_OPTIONAL ? actual == 0 || actual == size :
+               kind == PAYLOAD_VARIABLE ? actual <= MAX_MESSAGE_SIZE :
+               false;
+    }
+};
+
+template <typename T>
+struct PayloadTraits {
+    static_assert(std::is_trivially_copyable<T>::value, "payloads must be plain structs");
+    static_assert(sizeof(T) <= MAX_MESSAGE_SIZE, "payload larger than MAX_MESSAGE_SIZE");
+    using Struct = T;
+
+    static constexpr PayloadRule rule() { return PayloadRule{PAYLOAD_FIXED, sizeof(T)}; }
+    static bool decode(const char* data, size_t size, T& out) {
+        if (size != sizeof(T)) {
+            return false;
+        }
+        memcpy(&out, data, sizeof(T));
+        return true;
+    }
+};
+
+template <typename T>
+struct PayloadTraits<OptionalPayload<T>> {
+    using Struct = T;
+
+    static constexpr PayloadRule rule() { return PayloadRule{PAYLOAD_OPTIONAL, PayloadTraits<T>::rule().size}; }
+    static bool decode(const char* data, size_t size, T& out) {
+        return size == 0 || PayloadTraits<T>::decode(data, size, out);
+    }
+};
+
+template <>
+struct PayloadTraits<NoPayload> {
+    using Struct = NoPayload;
+
+    static constexpr PayloadRule rule() { return PayloadRule{PAYLOAD_NONE, 0}; }
+    static bool decode(const char*, size_t size, NoPayload&) { return size == 0; }
+};
+
+// Not decodable as a struct: a handler for one reads the payload itself
+template <>
+struct PayloadTraits<VariablePayload> {
+    using Struct = VariablePayload;
+
+    static constexpr PayloadRule rule() { return PayloadRule{PAYLOAD_VARIABLE, 0}; }
+};
+
+// Rule for every message type, indexed by type
+struct RuleTable {
+    PayloadRule rules[256];
+
+    constexpr const PayloadRule& operator[](uint8_t type) const { return rules[type]; }
+};
+
+#define MESSAGE_SCHEMA_RULE(TYPE, PAYLOAD) table.rules[TYPE] = PayloadTraits<PAYLOAD>::rule();
+
+constexpr RuleTable clientRules() {
+    RuleTable table{};
+    CLIENT_MESSAGES(MESSAGE_SCHEMA_RULE)
+    return table;
+}
+
+constexpr RuleTable serverRules() {
+    RuleTable table{};
+    SERVER_MESSAGES(MESSAGE_SCHEMA_RULE)
+    return table;
+}
+
+#undef MESSAGE_SCHEMA_RULE
+
+constexpr RuleTable CLIENT_RULES = clientRules();  // What the server accepts
+constexpr RuleTable SERVER_RULES = serverRules();  // What the client accepts
+
+// Each type is listed once per direction
+#define MESSAGE_SCHEMA_TYPE(TYPE, PAYLOAD) TYPE,
+
+constexpr MessageType CLIENT_TYPES[] = { CLIENT_MESSAGES(MESSAGE_SCHEMA_TYPE) };
+constexpr MessageType SERVER_TYPES[] = { SERVER_MESSAGES(MESSAGE_SCHEMA_TYPE) };
+
+#undef MESSAGE_SCHEMA_TYPE
+
+template <size_t N>
+constexpr bool listedOnce(const MessageType (&types)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (types[i] == types[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(listedOnce(CLIENT_TYPES), "a type is listed twice in CLIENT_MESSAGES");
+static_assert(listedOnce(SERVER_TYPES), "a type is listed twice in SERVER_MESSAGES");
+
+// ============== TYPE -> STRUCT ==============
+
+// Undefined for types that are not sent in that direction
+template <MessageType Type> struct ClientPayload;
+template <MessageType Type> struct ServerPayload;
+
+#define MESSAGE_SCHEMA_CLIENT_PAYLOAD(TYPE, PAYLOAD) \
+    template <> struct ClientPayload<TYPE> { using type = PayloadTraits<PAYLOAD>::Struct; };
+#define MESSAGE_SCHEMA_SERVER_PAYLOAD(TYPE, PAYLOAD) \
+    template <> struct ServerPayload<TYPE> { using type = PayloadTraits<PAYLOAD>::Struct; };
+
+CLIENT_MESSAGES(MESSAGE_SCHEMA_CLIENT_PAYLOAD)
+SERVER_MESSAGES(MESSAGE_SCHEMA_SERVER_PAYLOAD)
+
+#undef MESSAGE_SCHEMA_CLIENT_PAYLOAD
+#undef MESSAGE_SCHEMA_SERVER_PAYLOAD
+
+// ============== HANDLER DISPATCH ==============
+
+template <typename T, typename... Rest>
+struct Contains : std::false_type {};
+template <typename T, typename First, typename... Rest>
+struct Contains<T, First, Rest...>
+    : std::integral_constant<bool, std::is_same<T, First>::value || Contains<T, Rest...>::value> {};
+
+template <typename... Ts>
+struct Distinct : std::true_type {};
+template <typename T, typename... Rest>
+struct Distinct<T, Rest...>
+    : std::integral_constant<bool, !Contains<T, Rest...>::value && Distinct<Rest...>::value> {};
+
+// Decodes payload as the struct of PAYLOAD and hands it to handler
+template <typename PAYLOAD, typename Payload, typename Handler>
+bool decodeAndCall(const Payload& payload, Handler& handler) {
+    typename PayloadTraits<PAYLOAD>::Struct message;
+    if (!PayloadTraits<PAYLOAD>::decode(payload.data(), payload.size(), message)) {
+        return false;
+    }
+    handler(static_cast<const typename PayloadTraits<PAYLOAD>::Struct&>(message));
+    return true;
+}
+
+#define MESSAGE_SCHEMA_STRUCT(TYPE, PAYLOAD) PayloadTraits<PAYLOAD>::Struct,
+#define MESSAGE_SCHEMA_CASE(TYPE, PAYLOAD) case TYPE:
+#define MESSAGE_SCHEMA_DECODE(TYPE, PAYLOAD) case TYPE: return decodeAndCall<PAYLOAD>(payload, handler);
+
+/*
+ * For a handler group: handlesXxx(type), whether the group serves type, and
+ * dispatchXxx(type, payload, handler), which decodes the payload and calls
+ * handler(message) with the group's struct for type. False if type is not
+ * in the group or the payload does not decode.
+ */
+#define MESSAGE_SCHEMA_HANDLER(NAME, LIST) \
+    static_assert(Distinct<LIST(MESSAGE_SCHEMA_STRUCT) void>::value, \
+                  #LIST " uses a struct for two types"); \
+    inline bool handles##NAME(uint8_t type) { \
+        switch (type) { \
+            LIST(MESSAGE_SCHEMA_CASE) \
+                return true; \
+            default: \
+                return false; \
+        } \
+    } \
+    template <typename Payload, typename Handler> \
+    bool dispatch##NAME(uint8_t type, const Payload& payload, Handler handler) { \
+        switch (type) { \
+            LIST(MESSAGE_SCHEMA_DECODE) \
+            default: \
+                return false; \
+        } \
+    }
+
+MESSAGE_SCHEMA_HANDLER(Auth, AUTH_CLIENT_MESSAGES)
+MESSAGE_SCHEMA_HANDLER(Player, PLAYER_CLIENT_MESSAGES)
+MESSAGE_SCHEMA_HANDLER(Challenge, CHALLENGE_CLIENT_MESSAGES)
+MESSAGE_SCHEMA_HANDLER(Gameplay, GAMEPLAY_CLIENT_MESSAGES)
+
+#undef MESSAGE_SCHEMA_HANDLER
+#undef MESSAGE_SCHEMA_DECODE
+#undef MESSAGE_SCHEMA_CASE
+#undef MESSAGE_SCHEMA_STRUCT
+
+} // namespace MessageSchema
+
+#endif // MESSAGE_SCHEMA_H
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <cstdint>
 #include "protocol.h"
+#include "message_schema.h"
 
 /**
  * Message Serialization Helpers
@@ -25,11 +26,11 @@ std::string serialize(const T& data) {
 }
 
 /**
- * Deserialize binary string to struct
+ * Deserialize binary string (or any contiguous byte view) to struct
  * Returns false if payload size doesn't match
  */
-template<typename T>
-bool deserialize(const std::string& payload, T& data) {
+template<typename Payload, typename T>
+bool deserialize(const Payload& payload, T& data) {
     if (payload.size() != sizeof(T)) {
         return false;
     }
@@ -66,35 +67,30 @@ inline MessageHeader createAuthenticatedHeader(MessageType type,
 
 // ============== SIZE VALIDATION ==============
 
+// Which end sent a message; some types carry a different struct each way
+enum MessageDirection {
+    FROM_CLIENT,
+    FROM_SERVER
+};
+
+inline const MessageSchema::PayloadRule& payloadRule(MessageType type, MessageDirection direction) {
+    return direction == FROM_CLIENT ? MessageSchema::CLIENT_RULES[type] : MessageSchema::SERVER_RULES[type];
+}
+
 /**
- * Get expected payload size for a message type
- * Returns 0 if variable size or unknown type
+ * Get expected payload size for a message type (see message_schema.h)
+ * Returns 0 if no payload, variable size or unknown type
  */
-inline size_t getExpectedPayloadSize(MessageType type) {
-    // These sizes will be updated when we include message headers
-    switch (type) {
-        case PING:
-        case PONG:
-            return 0;  // No payload
-
-        // Will be filled in as we implement each message type
-        default:
-            return 0;  // Unknown or variable size
-    }
+inline size_t getExpectedPayloadSize(MessageType type, MessageDirection direction = FROM_CLIENT) {
+    return payloadRule(type, direction).size;
 }
 
 /**
- * Validate that payload size matches expected size for message type
+ * Validate that payload size matches the schema for message type
+ * Types not sent in that direction are never valid
  */
-inline bool validatePayloadSize(MessageType type, size_t actual_size) {
-    size_t expected = getExpectedPayloadSize(type);
-
-    // If expected is 0, it's either no payload or variable size
-    if (expected == 0) {
-        return actual_size <= MAX_MESSAGE_SIZE;
-    }
-
-    return actual_size == expected;
+inline bool validatePayloadSize(MessageType type, size_t actual_size, MessageDirection direction = FROM_CLIENT) {
+    return payloadRule(type, direction).accepts(actual_size);
 }
 
 // ============== HELPER FUNCTIONS ==============
@@ -28,19 +28,15 @@ struct PlayerInfo_Message {
     }
 } __attribute__((packed));
 
+// An empty payload asks for the first page with no limit.
+// The reply (PLAYER_LIST) is variable-length: see PlayerListPage in player_list.h
 struct PlayerListRequest {
-    // No payload needed, just request
-    PlayerListRequest() {}
-} __attribute__((packed));
-
-struct PlayerListResponse {
-    uint32_t count;         // Number of players
-    PlayerInfo_Message players[100];  // Max 100 players in one message
+    uint32_t cursor;        // 0 = first page, else next_cursor of the previous page
+    uint16_t limit;         // Most players wanted (0 = as many as fit in one message)
 
-    PlayerListResponse()
-        : count(0) {
-        // Array elements are already default-initialized by PlayerInfo_Message constructor
-        // No need to memset - this would override the constructor behavior
+    PlayerListRequest()
+        : cursor(0),
+          limit(0) {
     }
 } __attribute__((packed));
 
@@ -0,0 +1,38 @@
+#ifndef PAYLOAD_COMPRESSION_H
+#define PAYLOAD_COMPRESSION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/**
+ * PayloadCompression - zlib for large v2 payloads
+ *
+ * A frame with CompactHeader::FLAG_COMPRESSED carries
+ *
+ *   original length (u32) | zlib stream
+ *
+ * Only payloads of COMPRESSION_THRESHOLD bytes or more are worth the CPU
+ * (see compression_bench), and a payload is only sent compressed if that
+ * makes it smaller. The fixed-width message structs are mostly zero padding,
+ * so those that pass the threshold shrink a lot.
+ *
+ * zlib is used when it is there at build time (HAVE_ZLIB). Without it
+ * supported() is 0: CAP_ZLIB is never agreed, so no peer sends this build a
+ * compressed frame.
+ */
+struct PayloadCompression {
+    static const size_t PREFIX_SIZE = 4;
+
+    // WireCapability bits this build can handle
+    static uint32_t supported();
+
+    // Sets out to the compressed form of data. False if it would not be smaller.
+    static bool compress(const char* data, size_t size, std::string& out);
+
+    // Sets out to the payload data was compressed from. False if data is
+    // malformed or would expand past max_size.
+    static bool decompress(const char* data, size_t size, size_t max_size, std::string& out);
+};
+
+#endif // PAYLOAD_COMPRESSION_H
@@ -0,0 +1,52 @@
+#ifndef PLAYER_LIST_H
+#define PLAYER_LIST_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "messages/matchmaking_messages.h"
+
+/**
+ * PlayerListPage - One page of the PLAYER_LIST reply
+ *
+ * The reply is variable-length, so it is encoded here rather than sent as a
+ * packed struct:
+ *
+ *   total (u32) | next_cursor (u32) | count (u16) | count entries
+ *
+ *   entry: user_id (u32) | elo_rating (i32) | status (u8)
+ *          | username length (u8) | username | display name length (u8) | display name
+ *
+ * Integers are in host byte order, like the fixed message structs. Names are
+ * sent without padding or terminator, so an entry costs 11 bytes plus its
+ * names instead of the 105 of a PlayerInfo_Message.
+ *
+ * Players are listed in user_id order. next_cursor is the cursor for the
+ * following page (see PlayerListRequest), or 0 on the last one.
+ */
+struct PlayerListPage {
+    static const size_t HEADER_SIZE = 10;
+    static const size_t MIN_ENTRY_SIZE = 11;
+
+    uint32_t total;         // Online players across all pages
+    uint32_t next_cursor;
+    std::vector<PlayerInfo_Message> players;
+
+    PlayerListPage() : total(0), next_cursor(0) {}
+
+    // Encoded size of one entry
+    static size_t entrySize(const PlayerInfo_Message& player);
+
+    std::string encode() const;
+
+    // False if data is not exactly one well-formed page
+    bool decode(const char* data, size_t size);
+
+    template<typename Payload>
+    bool decode(const Payload& payload) {
+        return decode(payload.data(), payload.size());
+    }
+};
+
+#endif // PLAYER_LIST_H
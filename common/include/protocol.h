@@ -62,7 +62,18 @@ enum MessageType {
     ERROR = 99,
     NOTIFICATION = 100,
     PING = 101,
-    PONG = 102
+    PONG = 102,
+    SERVER_BUSY = 103,      // Connection refused by admission control, see ServerBusyMessage
+    BATCH = 104,            // Several server messages in one frame, see BatchEntry
+    CAPABILITIES = 105      // Optional v2 features both sides support, see CapabilitiesMessage
+};
+
+// Outbound priority class; a connection sends queued frames of a lower class first
+enum MessagePriority {
+    PRIORITY_GAMEPLAY = 0,     // In-match traffic (incl. match start) and keepalives
+    PRIORITY_MATCHMAKING = 1,  // Auth, player list, challenges and everything else
+    PRIORITY_PRESENCE = 2,     // Lobby presence and chat
+    PRIORITY_CLASSES = 3
 };
 
 // Player status
@@ -120,6 +131,31 @@ struct MessageHeader {
     char session_token[64]; // Session token for authentication
 } __attribute__((packed));
 
+// Why a connection was refused
+enum BusyReason {
+    BUSY_SERVER_FULL = 0,        // Server-wide connection cap reached
+    BUSY_ADDRESS_LIMIT = 1       // Too many connections from this address
+};
+
+// SERVER_BUSY payload. The server sends it right after accept and then closes the
+// connection; clients should wait retry_after_ms (jittered per client) before reconnecting.
+struct ServerBusyMessage {
+    uint8_t reason;             // BusyReason
+    uint32_t retry_after_ms;
+} __attribute__((packed));
+
+// Optional features of the v2 wire format
+enum WireCapability {
+    CAP_ZLIB = 0x01              // Frames with CompactHeader::FLAG_COMPRESSED, see PayloadCompression
+};
+
+// CAPABILITIES payload. A v2 client sends the WireCapability bits it supports;
+// the server answers with those it supports too, and uses them from then on.
+// A client must accept what it offered as soon as it has sent the offer.
+struct CapabilitiesMessage {
+    uint32_t flags;
+} __attribute__((packed));
+
 // Coordinate structure
 struct Coordinate {
     int8_t row;  // 0-9
@@ -138,6 +174,7 @@ struct Ship {
 
 // Function declarations
 std::string messageTypeToString(MessageType type);
+MessagePriority getMessagePriority(MessageType type);
 const char* shipTypeToName(ShipType type);
 int getShipLength(ShipType type);
 
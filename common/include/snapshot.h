@@ -0,0 +1,75 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Snapshot Helpers
+ * Flat binary encoding for state handed from one server process to the next
+ * (hot restart). Both sides are the same build on the same host, so values
+ * are copied in native layout; only strings carry a length prefix.
+ */
+
+class SnapshotWriter {
+public:
+    template<typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be plain data");
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        data_.append(value);
+    }
+
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+};
+
+/**
+ * Reads what a SnapshotWriter wrote. A read past the end (a truncated or
+ * mismatched snapshot) fails that read and every one after it.
+ */
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::string& data) : data_(data), offset_(0), ok_(true) {}
+
+    template<typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be plain data");
+        if (!ok_ || data_.size() - offset_ < sizeof(T)) {
+            ok_ = false;
+            return false;
+        }
+        memcpy(&value, data_.data() + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value) {
+        uint32_t size = 0;
+        if (!get(size) || data_.size() - offset_ < size) {
+            ok_ = false;
+            return false;
+        }
+        value.assign(data_, offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return offset_ == data_.size(); }
+
+private:
+    const std::string& data_;
+    size_t offset_;
+    bool ok_;
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,23 @@
+#include "batch_entry.h"
+#include <cstring>
+
+const size_t BatchEntry::HEADER_SIZE;
+const size_t BatchEntry::MAX_LENGTH;
+
+void BatchEntry::encodeHeader(char* out, uint8_t type, uint16_t length) {
+    out[0] = static_cast<char>(type);
+    memcpy(out + 1, &length, sizeof(length));
+}
+
+size_t BatchEntry::decode(const char* data, size_t size) {
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    type = static_cast<uint8_t>(data[0]);
+    memcpy(&length, data + 1, sizeof(length));
+    if (size - HEADER_SIZE < length) {
+        return 0;
+    }
+    payload = data + HEADER_SIZE;
+    return HEADER_SIZE + length;
+}
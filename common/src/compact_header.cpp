@@ -0,0 +1,87 @@
+#include "compact_header.h"
+#include <cstring>
+
+const uint8_t CompactHeader::MAGIC;
+const uint8_t CompactHeader::FLAG_SEQUENCE;
+const uint8_t CompactHeader::FLAG_COMPRESSED;
+const uint8_t CompactHeader::KNOWN_FLAGS;
+const size_t CompactHeader::MAX_SIZE;
+
+namespace {
+const size_t MAX_VARINT_SIZE = 5;
+
+size_t putVarint(char* out, uint32_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out[size++] = static_cast<char>(value);
+    return size;
+}
+
+// Bytes read, 0 if data ends inside the varint, -1 if it runs past 32 bits
+int getVarint(const char* data, size_t size, uint32_t& value) {
+    value = 0;
+    for (size_t i = 0; i < MAX_VARINT_SIZE; i++) {
+        if (i == size) {
+            return 0;
+        }
+        uint8_t byte = static_cast<uint8_t>(data[i]);
+        if (i == MAX_VARINT_SIZE - 1 && byte > 0x0F) {
+            return -1;  // Only four bits of a 32-bit value are left for the fifth byte
+        }
+        value |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80)) {
+            return static_cast<int>(i + 1);
+        }
+    }
+    return -1;
+}
+}
+
+size_t CompactHeader::encode(char* out) const {
+    out[0] = static_cast<char>(MAGIC);
+    out[1] = static_cast<char>(type);
+    out[2] = static_cast<char>(flags);
+    size_t size = 3 + putVarint(out + 3, length);
+    if (flags & FLAG_SEQUENCE) {
+        size += putVarint(out + size, sequence);
+    }
+    return size;
+}
+
+int CompactHeader::decode(const char* data, size_t size) {
+    if (size < 3) {
+        return (size > 0 && static_cast<uint8_t>(data[0]) != MAGIC) ? -1 : 0;
+    }
+    if (static_cast<uint8_t>(data[0]) != MAGIC || (static_cast<uint8_t>(data[2]) & ~KNOWN_FLAGS)) {
+        return -1;
+    }
+    type = static_cast<uint8_t>(data[1]);
+    flags = static_cast<uint8_t>(data[2]);
+
+    int used = getVarint(data + 3, size - 3, length);
+    if (used <= 0) {
+        return used;
+    }
+    size_t total = 3 + used;
+
+    sequence = 0;
+    if (flags & FLAG_SEQUENCE) {
+        used = getVarint(data + total, size - total, sequence);
+        if (used <= 0) {
+            return used;
+        }
+        total += used;
+    }
+    return static_cast<int>(total);
+}
+
+MessageHeader CompactHeader::toMessageHeader() const {
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = type;
+    header.length = length;
+    return header;
+}
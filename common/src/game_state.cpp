@@ -1,4 +1,5 @@
 #include "game_state.h"
+#include "snapshot.h"
 #include <cstring>
 #include <cstdlib>
 #include <ctime>
@@ -185,6 +186,30 @@ void Board::randomPlacement() {
     }
 }
 
+// Native layout, for handing a live board to the next server process (see snapshot.h)
+std::string Board::serialize() const {
+    SnapshotWriter writer;
+    writer.put(grid);
+    writer.put(ships);
+    writer.put(ships_count);
+    writer.put(ships_remaining);
+    return writer.data();
+}
+
+bool Board::deserialize(const std::string& data) {
+    SnapshotReader reader(data);
+    Board board;
+    reader.get(board.grid);
+    reader.get(board.ships);
+    reader.get(board.ships_count);
+    reader.get(board.ships_remaining);
+    if (!reader.ok() || !reader.atEnd() || board.ships_count < 0 || board.ships_count > NUM_SHIPS) {
+        return false;
+    }
+    *this = board;
+    return true;
+}
+
 // MatchState implementation
 MatchState::MatchState()
     : current_turn_player_id(0), turn_number(0), turn_time_limit(60),
@@ -289,3 +314,75 @@ uint32_t MatchState::getTurnTimeRemaining() const {
 
     return turn_time_limit - elapsed;
 }
+
+std::string MatchState::serialize() const {
+    SnapshotWriter writer;
+    writer.putString(match_id);
+    writer.put(player1_id);
+    writer.put(player2_id);
+    writer.putString(player1_name);
+    writer.putString(player2_name);
+    writer.put(player1_elo_before);
+    writer.put(player1_elo_after);
+    writer.put(player2_elo_before);
+    writer.put(player2_elo_after);
+    writer.putString(player1_board.serialize());
+    writer.putString(player2_board.serialize());
+    writer.put(current_turn_player_id);
+    writer.put(turn_number);
+    writer.put(turn_time_limit);
+    writer.put(turn_start_time);
+    writer.put(static_cast<uint32_t>(move_history.size()));
+    for (const Move& move : move_history) {
+        writer.put(move);
+    }
+    writer.put(start_time);
+    writer.put(end_time);
+    writer.put(result);
+    writer.put(winner_id);
+    writer.put(is_active);
+    writer.put(is_paused);
+    return writer.data();
+}
+
+bool MatchState::deserialize(const std::string& data) {
+    SnapshotReader reader(data);
+    MatchState match;
+    std::string board1, board2;
+    uint32_t moves = 0;
+
+    reader.getString(match.match_id);
+    reader.get(match.player1_id);
+    reader.get(match.player2_id);
+    reader.getString(match.player1_name);
+    reader.getString(match.player2_name);
+    reader.get(match.player1_elo_before);
+    reader.get(match.player1_elo_after);
+    reader.get(match.player2_elo_before);
+    reader.get(match.player2_elo_after);
+    reader.getString(board1);
+    reader.getString(board2);
+    reader.get(match.current_turn_player_id);
+    reader.get(match.turn_number);
+    reader.get(match.turn_time_limit);
+    reader.get(match.turn_start_time);
+    reader.get(moves);
+    for (uint32_t i = 0; i < moves && reader.ok(); i++) {
+        Move move;
+        reader.get(move);
+        match.move_history.push_back(move);
+    }
+    reader.get(match.start_time);
+    reader.get(match.end_time);
+    reader.get(match.result);
+    reader.get(match.winner_id);
+    reader.get(match.is_active);
+    reader.get(match.is_paused);
+
+    if (!reader.ok() || !reader.atEnd() ||
+        !match.player1_board.deserialize(board1) || !match.player2_board.deserialize(board2)) {
+        return false;
+    }
+    *this = match;
+    return true;
+}
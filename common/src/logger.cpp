@@ -0,0 +1,350 @@
+#include "logger.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <strings.h>
+#include <unistd.h>
+
+const size_t Logger::LINE_BYTES;
+std::atomic<int> Logger::min_level_(LOG_LEVEL_INFO);
+
+namespace {
+
+const size_t RING_CELLS = 4096;   // Power of two
+const size_t RING_MASK = RING_CELLS - 1;
+const size_t OUTPUT_BYTES = 64 * 1024;
+const size_t PREFIX_BYTES = 48;   // Timestamp, level and "[]" around the tag
+
+// Bounded multi-producer queue (Vyukov): a cell is free for the producer
+// whose position equals its sequence, and full for the consumer at sequence - 1
+struct alignas(64) Cell {
+    std::atomic<size_t> sequence;
+    LogLevel level;
+    const char* tag;
+    uint64_t time_us;
+    size_t length;
+    char text[Logger::LINE_BYTES];
+};
+
+// Producer and consumer counters on separate cache lines
+Cell ring[RING_CELLS];
+alignas(64) std::atomic<size_t> enqueue_pos(0);
+alignas(64) std::atomic<size_t> written_pos(0);   // Every line before this one is out
+bool ring_ready = false;
+
+std::atomic<bool> running(false);
+std::thread writer_thread;
+std::mutex lifecycle_mutex;
+
+int out_fd = STDOUT_FILENO;
+int err_fd = STDERR_FILENO;
+
+alignas(64) std::atomic<uint64_t> lines_logged(0);
+std::atomic<uint64_t> lines_dropped(0);
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_INFO:  return "INFO ";
+        case LOG_LEVEL_WARN:  return "WARN ";
+        case LOG_LEVEL_ERROR: return "ERROR";
+        default:              return "     ";
+    }
+}
+
+uint64_t nowMicros() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// "YYYY-MM-DD HH:MM:SS.uuuuuu LEVEL [TAG] text\n" into out; returns its length
+size_t formatLine(char* out, LogLevel level, const char* tag, uint64_t time_us,
+                  const char* text, size_t length) {
+    // The date part only changes once a second
+    static thread_local time_t cached_second = -1;
+    static thread_local char cached_date[24];
+    time_t second = static_cast<time_t>(time_us / 1000000);
+    if (second != cached_second) {
+        struct tm parts;
+        localtime_r(&second, &parts);
+        strftime(cached_date, sizeof(cached_date), "%Y-%m-%d %H:%M:%S", &parts);
+        cached_second = second;
+    }
+
+    int prefix = snprintf(out, PREFIX_BYTES + Logger::LINE_BYTES, "%s.%06u %s [%s] ",
+                          cached_date, static_cast<unsigned>(time_us % 1000000), levelName(level), tag);
+    size_t used = prefix > 0 ? static_cast<size_t>(prefix) : 0;
+    memcpy(out + used, text, length);
+    used += length;
+    out[used++] = '\n';
+    return used;
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // Nowhere left to report it
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+// Lines for one stream, written out when full or when the ring runs dry
+struct OutputBuffer {
+    int fd;
+    size_t used;
+    char bytes[OUTPUT_BYTES];
+
+    void add(const char* line, size_t length) {
+        if (used + length > sizeof(bytes)) {
+            drain();
+        }
+        memcpy(bytes + used, line, length);
+        used += length;
+    }
+
+    void drain() {
+        writeAll(fd, bytes, used);
+        used = 0;
+    }
+};
+
+OutputBuffer out_buffer;
+OutputBuffer err_buffer;
+
+// Consumer side. Returns the number of lines taken from the ring.
+size_t drainRing(size_t& position) {
+    char line[PREFIX_BYTES + Logger::LINE_BYTES + 1];
+    size_t taken = 0;
+    while (true) {
+        Cell& cell = ring[position & RING_MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+            break;
+        }
+        size_t length = formatLine(line, cell.level, cell.tag, cell.time_us, cell.text, cell.length);
+        (cell.level >= LOG_LEVEL_WARN ? err_buffer : out_buffer).add(line, length);
+        cell.sequence.store(position + RING_CELLS, std::memory_order_release);
+        position++;
+        taken++;
+    }
+    return taken;
+}
+
+void writerLoop() {
+    size_t position = written_pos.load();
+    uint64_t reported_drops = lines_dropped.load();
+
+    while (true) {
+        bool stopping = !running.load();
+        size_t taken = drainRing(position);
+
+        uint64_t drops = lines_dropped.load();
+        if (drops != reported_drops) {
+            char note[64];
+            int length = snprintf(note, sizeof(note), "%llu line(s) dropped, log ring full",
+                                  static_cast<unsigned long long>(drops - reported_drops));
+            char line[PREFIX_BYTES + Logger::LINE_BYTES + 1];
+            err_buffer.add(line, formatLine(line, LOG_LEVEL_WARN, "LOG", nowMicros(), note, length));
+            reported_drops = drops;
+        }
+
+        if (taken == 0) {
+            out_buffer.drain();
+            err_buffer.drain();
+            written_pos.store(position, std::memory_order_release);
+            if (stopping) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void initRing() {
+    if (!ring_ready) {
+        for (size_t i = 0; i < RING_CELLS; i++) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        out_buffer.used = 0;
+        err_buffer.used = 0;
+        ring_ready = true;
+    }
+}
+
+}  // namespace
+
+void Logger::setLevel(LogLevel level) {
+    min_level_.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() {
+    return static_cast<LogLevel>(min_level_.load(std::memory_order_relaxed));
+}
+
+bool Logger::parseLevel(const char* name, LogLevel& level) {
+    if (!name) {
+        return false;
+    }
+    if (strcasecmp(name, "DEBUG") == 0) {
+        level = LOG_LEVEL_DEBUG;
+    } else if (strcasecmp(name, "INFO") == 0) {
+        level = LOG_LEVEL_INFO;
+    } else if (strcasecmp(name, "WARN") == 0 || strcasecmp(name, "WARNING") == 0) {
+        level = LOG_LEVEL_WARN;
+    } else if (strcasecmp(name, "ERROR") == 0) {
+        level = LOG_LEVEL_ERROR;
+    } else if (strcasecmp(name, "OFF") == 0) {
+        level = LOG_LEVEL_OFF;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Logger::setOutput(int new_out_fd, int new_err_fd) {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex);
+    out_fd = new_out_fd;
+    err_fd = new_err_fd;
+}
+
+void Logger::start() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex);
+    if (running) {
+        return;
+    }
+    initRing();
+    out_buffer.fd = out_fd;
+    err_buffer.fd = err_fd;
+    running = true;
+    writer_thread = std::thread(writerLoop);
+}
+
+void Logger::stop() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex);
+    if (!running) {
+        return;
+    }
+    running = false;
+    writer_thread.join();
+}
+
+void Logger::flush() {
+    size_t target = enqueue_pos.load();
+    while (running.load() && written_pos.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+Logger::Stats Logger::getStats() {
+    Stats stats;
+    stats.lines = lines_logged.load();
+    stats.dropped = lines_dropped.load();
+    return stats;
+}
+
+void Logger::submit(LogLevel level, const char* tag, const char* text, size_t length) {
+    uint64_t time_us = nowMicros();
+
+    if (!running.load(std::memory_order_acquire)) {
+        // No writer: one write() per line keeps concurrent lines whole
+        char line[PREFIX_BYTES + LINE_BYTES + 1];
+        size_t line_length = formatLine(line, level, tag, time_us, text, length);
+        writeAll(level >= LOG_LEVEL_WARN ? err_fd : out_fd, line, line_length);
+        lines_logged.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    size_t position = enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &ring[position & RING_MASK];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (lag == 0) {
+            if (enqueue_pos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            lines_dropped.fetch_add(1, std::memory_order_relaxed);  // Writer is a full ring behind
+            return;
+        } else {
+            position = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->level = level;
+    cell->tag = tag;
+    cell->time_us = time_us;
+    cell->length = length;
+    memcpy(cell->text, text, length);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    lines_logged.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ============== LogLine ==============
+
+LogLine::~LogLine() {
+    if (truncated_ && length_ >= 3) {
+        memcpy(text_ + length_ - 3, "...", 3);
+    }
+    Logger::submit(level_, tag_, text_, length_);
+}
+
+LogLine& LogLine::append(const char* text, size_t length) {
+    size_t room = sizeof(text_) - length_;
+    if (length > room) {
+        length = room;
+        truncated_ = true;
+    }
+    memcpy(text_ + length_, text, length);
+    length_ += length;
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const char* text) {
+    if (!text) {
+        return append("(null)", 6);
+    }
+    return append(text, strlen(text));
+}
+
+LogLine& LogLine::appendSigned(long long value) {
+    if (value < 0) {
+        append("-", 1);
+        // Negate in unsigned arithmetic so LLONG_MIN works too
+        return appendUnsigned(0ULL - static_cast<unsigned long long>(value));
+    }
+    return appendUnsigned(static_cast<unsigned long long>(value));
+}
+
+LogLine& LogLine::appendUnsigned(unsigned long long value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    return append(digits + sizeof(digits) - count, count);
+}
+
+LogLine& LogLine::operator<<(double value) {
+    char formatted[32];
+    int length = snprintf(formatted, sizeof(formatted), "%g", value);
+    return append(formatted, length > 0 ? static_cast<size_t>(length) : 0);
+}
+
+LogLine& LogLine::operator<<(const void* pointer) {
+    char formatted[24];
+    int length = snprintf(formatted, sizeof(formatted), "%p", pointer);
+    return append(formatted, length > 0 ? static_cast<size_t>(length) : 0);
+}
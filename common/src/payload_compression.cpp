@@ -0,0 +1,121 @@
+#include "payload_compression.h"
+#include "protocol.h"
+#include <cstring>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+const size_t PayloadCompression::PREFIX_SIZE;
+
+#ifdef HAVE_ZLIB
+
+namespace {
+// Speed over ratio: the payloads are small and mostly zeros
+const int COMPRESSION_LEVEL = 1;
+const int WINDOW_BITS = 12;  // 4 KB, a whole MAX_MESSAGE_SIZE payload
+const int MEMORY_LEVEL = 8;
+
+// compress2() and uncompress() set up a fresh zlib state on every call,
+// which costs more than a small payload takes to compress. Each thread
+// keeps one of each and resets it instead.
+struct Deflater {
+    z_stream stream;
+    bool ready;
+
+    Deflater() {
+        memset(&stream, 0, sizeof(stream));
+        ready = deflateInit2(&stream, COMPRESSION_LEVEL, Z_DEFLATED, WINDOW_BITS,
+                             MEMORY_LEVEL, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+    ~Deflater() {
+        if (ready) {
+            deflateEnd(&stream);
+        }
+    }
+};
+
+struct Inflater {
+    z_stream stream;
+    bool ready;
+
+    Inflater() {
+        memset(&stream, 0, sizeof(stream));
+        ready = inflateInit(&stream) == Z_OK;
+    }
+    ~Inflater() {
+        if (ready) {
+            inflateEnd(&stream);
+        }
+    }
+};
+
+thread_local Deflater deflater;
+thread_local Inflater inflater;
+}
+
+uint32_t PayloadCompression::supported() {
+    return CAP_ZLIB;
+}
+
+bool PayloadCompression::compress(const char* data, size_t size, std::string& out) {
+    z_stream& stream = deflater.stream;
+    if (!deflater.ready || deflateReset(&stream) != Z_OK) {
+        return false;
+    }
+    uLong bound = deflateBound(&stream, size);
+    out.resize(PREFIX_SIZE + bound);
+
+    uint32_t original = static_cast<uint32_t>(size);
+    memcpy(&out[0], &original, sizeof(original));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef*>(&out[PREFIX_SIZE]);
+    stream.avail_out = static_cast<uInt>(bound);
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return false;
+    }
+
+    out.resize(PREFIX_SIZE + stream.total_out);
+    return out.size() < size;
+}
+
+bool PayloadCompression::decompress(const char* data, size_t size, size_t max_size, std::string& out) {
+    uint32_t original = 0;
+    if (size < PREFIX_SIZE) {
+        return false;
+    }
+    memcpy(&original, data, sizeof(original));
+    if (original > max_size) {
+        return false;
+    }
+
+    z_stream& stream = inflater.stream;
+    if (!inflater.ready || inflateReset(&stream) != Z_OK) {
+        return false;
+    }
+    out.resize(original);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + PREFIX_SIZE));
+    stream.avail_in = static_cast<uInt>(size - PREFIX_SIZE);
+    stream.next_out = reinterpret_cast<Bytef*>(original > 0 ? &out[0] : nullptr);
+    stream.avail_out = original;
+
+    // The stream must end exactly at the length it was sent with
+    return inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out == original &&
+           stream.avail_in == 0;
+}
+
+#else
+
+uint32_t PayloadCompression::supported() {
+    return 0;
+}
+
+bool PayloadCompression::compress(const char*, size_t, std::string&) {
+    return false;
+}
+
+bool PayloadCompression::decompress(const char*, size_t, size_t, std::string&) {
+    return false;
+}
+
+#endif
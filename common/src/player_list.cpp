@@ -0,0 +1,115 @@
+#include "player_list.h"
+#include <cstring>
+
+const size_t PlayerListPage::HEADER_SIZE;
+const size_t PlayerListPage::MIN_ENTRY_SIZE;
+
+namespace {
+
+template<typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// A name up to its terminator, cut to fit a field of field_size
+size_t nameLength(const char* name, size_t field_size) {
+    const void* end = memchr(name, '\0', field_size - 1);
+    return end ? static_cast<const char*>(end) - name : field_size - 1;
+}
+
+void putName(std::string& out, const char* name, size_t field_size) {
+    uint8_t length = static_cast<uint8_t>(nameLength(name, field_size));
+    put(out, length);
+    out.append(name, length);
+}
+
+class Reader {
+public:
+    Reader(const char* data, size_t size) : data_(data), left_(size) {}
+
+    template<typename T>
+    bool get(T& value) {
+        if (left_ < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, data_, sizeof(T));
+        data_ += sizeof(T);
+        left_ -= sizeof(T);
+        return true;
+    }
+
+    // A length-prefixed name into a zero-filled field of field_size
+    bool getName(char* field, size_t field_size) {
+        uint8_t length = 0;
+        if (!get(length) || length >= field_size || left_ < length) {
+            return false;
+        }
+        memcpy(field, data_, length);
+        data_ += length;
+        left_ -= length;
+        return true;
+    }
+
+    bool atEnd() const { return left_ == 0; }
+
+private:
+    const char* data_;
+    size_t left_;
+};
+
+} // namespace
+
+size_t PlayerListPage::entrySize(const PlayerInfo_Message& player) {
+    return MIN_ENTRY_SIZE
+         + nameLength(player.username, sizeof(player.username))
+         + nameLength(player.display_name, sizeof(player.display_name));
+}
+
+std::string PlayerListPage::encode() const {
+    size_t size = HEADER_SIZE;
+    for (const auto& player : players) {
+        size += entrySize(player);
+    }
+
+    std::string out;
+    out.reserve(size);
+    put(out, total);
+    put(out, next_cursor);
+    put(out, static_cast<uint16_t>(players.size()));
+    for (const auto& player : players) {
+        put(out, player.user_id);
+        put(out, player.elo_rating);
+        put(out, static_cast<uint8_t>(player.status));
+        putName(out, player.username, sizeof(player.username));
+        putName(out, player.display_name, sizeof(player.display_name));
+    }
+    return out;
+}
+
+bool PlayerListPage::decode(const char* data, size_t size) {
+    Reader reader(data, size);
+    uint16_t count = 0;
+    if (!reader.get(total) || !reader.get(next_cursor) || !reader.get(count)) {
+        return false;
+    }
+    if (count > (size - HEADER_SIZE) / MIN_ENTRY_SIZE) {
+        return false;
+    }
+
+    players.assign(count, PlayerInfo_Message());
+    for (auto& player : players) {
+        // Fields of the packed struct cannot be read into by reference
+        uint32_t user_id = 0;
+        int32_t elo_rating = 0;
+        uint8_t status = 0;
+        if (!reader.get(user_id) || !reader.get(elo_rating) || !reader.get(status) ||
+            !reader.getName(player.username, sizeof(player.username)) ||
+            !reader.getName(player.display_name, sizeof(player.display_name))) {
+            return false;
+        }
+        player.user_id = user_id;
+        player.elo_rating = elo_rating;
+        player.status = static_cast<PlayerStatus>(status);
+    }
+    return reader.atEnd();
+}
@@ -18,10 +18,41 @@ std::string messageTypeToString(MessageType type) {
         case CHAT_MESSAGE: return "CHAT_MESSAGE";
         case ERROR: return "ERROR";
         case NOTIFICATION: return "NOTIFICATION";
+        case SERVER_BUSY: return "SERVER_BUSY";
+        case BATCH: return "BATCH";
+        case CAPABILITIES: return "CAPABILITIES";
         default: return "UNKNOWN";
     }
 }
 
+MessagePriority getMessagePriority(MessageType type) {
+    switch (type) {
+        case MATCH_START:
+        case MATCH_READY:
+        case SHIP_PLACEMENT:
+        case MOVE:
+        case MOVE_RESULT:
+        case TURN_UPDATE:
+        case MATCH_STATE:
+        case MATCH_END:
+        case PAUSE_REQUEST:
+        case PAUSE_RESPONSE:
+        case DRAW_OFFER:
+        case DRAW_RESPONSE:
+        case RESIGN:
+        case REMATCH_REQUEST:
+        case REMATCH_RESPONSE:
+        case PING:
+        case PONG:
+            return PRIORITY_GAMEPLAY;
+        case PLAYER_STATUS_UPDATE:
+        case CHAT_MESSAGE:
+            return PRIORITY_PRESENCE;
+        default:
+            return PRIORITY_MATCHMAKING;
+    }
+}
+
 const char* shipTypeToName(ShipType type) {
     switch (type) {
         case SHIP_CARRIER: return "Aircraft Carrier";
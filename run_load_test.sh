@@ -0,0 +1,84 @@
+#!/bin/bash
+# Script to run the load test against the server with different reactor counts,
+# side by side for each I/O backend (epoll and io_uring)
+
+set -e
+
+SERVER_BIN="./bin/battleship_server"
+LOAD_BIN="./bin/load_test"
+SERVER_PORT=9998
+SERVER_PID=""
+REACTOR_COUNTS="1 2 4"
+BACKENDS="epoll io_uring"
+LOAD_ARGS="--connections 1000 --threads 4 --rounds 200 --pipeline 8"
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+CYAN='\033[0;36m'
+NC='\033[0m' # No Color
+
+# Parse arguments
+while [[ $# -gt 0 ]]; do
+    case $1 in
+        --reactors)
+            REACTOR_COUNTS="$2"
+            shift 2
+            ;;
+        --backends)
+            BACKENDS="$2"
+            shift 2
+            ;;
+        *)
+            LOAD_ARGS="$LOAD_ARGS $1"
+            shift
+            ;;
+    esac
+done
+
+echo -e "${CYAN}========================================${NC}"
+echo -e "${CYAN}  Load Test Runner${NC}"
+echo -e "${CYAN}========================================${NC}"
+echo ""
+
+cleanup() {
+    if [ ! -z "$SERVER_PID" ]; then
+        kill $SERVER_PID 2>/dev/null || true
+        wait $SERVER_PID 2>/dev/null || true
+        SERVER_PID=""
+    fi
+}
+trap cleanup EXIT INT TERM
+
+make server bin/load_test > /dev/null 2>&1 || {
+    echo -e "${RED}Error: Failed to build server or load test${NC}"
+    exit 1
+}
+
+ulimit -n "$(ulimit -Hn)" 2>/dev/null || true
+
+for reactors in $REACTOR_COUNTS; do
+    for backend in $BACKENDS; do
+        echo -e "${YELLOW}IO_REACTORS=$reactors IO_BACKEND=$backend${NC}"
+        MAX_CONNECTIONS=0 IO_BACKEND=$backend IO_REACTORS=$reactors $SERVER_BIN $SERVER_PORT > /tmp/battleship_load_server.log 2>&1 &
+        SERVER_PID=$!
+        sleep 2
+
+        if ! kill -0 $SERVER_PID 2>/dev/null; then
+            echo -e "${RED}Error: Server failed to start${NC}"
+            cat /tmp/battleship_load_server.log
+            exit 1
+        fi
+
+        grep -q "falling back to epoll" /tmp/battleship_load_server.log && \
+            echo -e "${RED}io_uring unavailable, server fell back to epoll${NC}"
+
+        $LOAD_BIN --port $SERVER_PORT $LOAD_ARGS || true
+        cleanup
+        echo ""
+        sleep 1
+    done
+done
+
+echo -e "${GREEN}Load test complete (server log: /tmp/battleship_load_server.log)${NC}"
@@ -0,0 +1,63 @@
+#ifndef ADMISSION_CONTROL_H
+#define ADMISSION_CONTROL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+/**
+ * AdmissionControl - Connection cap, per-address limit and retry hints
+ *
+ * Every accepted socket asks admit() for a slot before the server builds a
+ * connection for it, and gives the slot back with release() when the
+ * connection is removed. A refused socket gets a SERVER_BUSY frame carrying
+ * retryAfterMs(): the base delay plus up to the same again at random, so a
+ * crowd refused together does not reconnect together.
+ *
+ * Thread-safe: reactors admit from their loop threads, workers release.
+ */
+class AdmissionControl {
+public:
+    enum Verdict {
+        ADMIT,
+        REJECT_FULL,     // Server-wide cap reached
+        REJECT_ADDRESS   // Per-address cap reached
+    };
+
+    struct Stats {
+        size_t active;             // Connections holding a slot
+        uint64_t admitted;
+        uint64_t rejected_full;
+        uint64_t rejected_address;
+    };
+
+    // 0 for either limit means no limit
+    AdmissionControl(size_t max_connections, size_t max_per_address, uint32_t retry_base_ms);
+
+    // address is sin_addr.s_addr of the peer, or LOCAL_ADDRESS for a peer on
+    // the Unix socket; local peers count toward the cap but not a per-address limit
+    Verdict admit(uint32_t address);
+    void release(uint32_t address);
+
+    uint32_t retryAfterMs();
+    Stats getStats() const;
+
+    static const uint32_t LOCAL_ADDRESS = 0;  // INADDR_ANY is never a TCP peer
+
+private:
+    size_t max_connections_;
+    size_t max_per_address_;
+    uint32_t retry_base_ms_;
+
+    mutable std::mutex mutex_;
+    size_t active_;
+    std::unordered_map<uint32_t, size_t> per_address_;  // Only addresses with live connections
+    std::mt19937 rng_;
+    uint64_t admitted_;
+    uint64_t rejected_full_;
+    uint64_t rejected_address_;
+};
+
+#endif // ADMISSION_CONTROL_H
@@ -0,0 +1,191 @@
+#ifndef ASYNC_RUNTIME_H
+#define ASYNC_RUNTIME_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <map>
+#include <chrono>
+#include <utility>
+#include "worker_pool.h"
+#include "client_connection.h"
+
+/**
+ * AsyncRuntime - Handler steps that wait without holding a worker thread
+ *
+ * A handler that needs the database hands the blocking part to query() and
+ * writes the rest of itself as the continuation:
+ *
+ *   async_->query(conn, [db, name]() { return db->getUserByUsername(name); },
+ *                 [this, conn](const User& user) { ... });
+ *
+ * The work runs on a small pool of blocking threads (query() on a single
+ * database strand, since SQLite serializes it anyway; run() on any of
+ * them), and the continuation is posted back to the connection's strand in
+ * the worker pool. Meanwhile the worker is free for other connections.
+ * after() does the same for a delay.
+ *
+ * A connection with a step outstanding is suspended: messages that arrive
+ * for it are deferred by dispatch() and handled, still in order, after the
+ * last continuation has run. Continuations for a connection that has been
+ * disconnected in the meantime are dropped.
+ *
+ * A continuation runs inside a ClientConnection::SendBatch, like a handler,
+ * so what it sends one client goes out together.
+ *
+ * A step that others depend on, and so must finish even if the client that
+ * started it disconnects, uses query() without a connection: it suspends
+ * nobody and its continuation runs on a strand of its own.
+ *
+ * query(), run() and after() must be called on the connection's strand,
+ * i.e. from a handler or a continuation. Until start() (and after stop())
+ * each step runs inline and after() does not wait.
+ */
+class AsyncRuntime {
+public:
+    AsyncRuntime();
+    ~AsyncRuntime();
+
+    AsyncRuntime(const AsyncRuntime&) = delete;
+    AsyncRuntime& operator=(const AsyncRuntime&) = delete;
+
+    // Continuations go to workers; blocking_threads == 0 uses two.
+    // stop() finishes outstanding steps and fires pending timers early.
+    bool start(WorkerPool* workers, size_t blocking_threads);
+    void stop();
+    bool isRunning() const { return workers_.load() != nullptr; }
+
+    // A runtime that is never started, for handlers used without a server
+    static AsyncRuntime* inlineRuntime();
+
+    // work() on the database strand, then then(result) on conn's strand
+    template <typename Work, typename Then>
+    void query(const std::shared_ptr<ClientConnection>& conn, Work work, Then then) {
+        submit(db_strand_, conn, std::move(work), std::move(then));
+    }
+
+    // work() on the database strand, then then(result) on a worker, whoever disconnects
+    template <typename Work, typename Then>
+    void query(Work work, Then then);
+
+    // work() on any blocking thread, then then(result) on conn's strand
+    template <typename Work, typename Then>
+    void run(const std::shared_ptr<ClientConnection>& conn, Work work, Then then) {
+        submit(std::make_shared<Strand>(), conn, std::move(work), std::move(then));
+    }
+
+    // then() on conn's strand once delay_ms have passed
+    template <typename Then>
+    void after(const std::shared_ptr<ClientConnection>& conn, uint32_t delay_ms, Then then);
+
+    // Runs a message task now, or defers it if conn is suspended. On conn's strand.
+    template <typename Task>
+    void dispatch(const std::shared_ptr<ClientConnection>& conn, Task&& task) {
+        if (conn->isSuspended()) {
+            conn->defer(std::function<void()>(std::forward<Task>(task)));
+            return;
+        }
+        task();
+    }
+
+private:
+    template <typename Work, typename Then>
+    void submit(const std::shared_ptr<Strand>& strand, const std::shared_ptr<ClientConnection>& conn,
+                Work work, Then then);
+
+    // After a continuation: resumes deferred messages once nothing is outstanding
+    static void finish(const std::shared_ptr<ClientConnection>& conn);
+
+    void timerLoop();
+
+    std::atomic<WorkerPool*> workers_;     // Null while stopped
+    std::unique_ptr<WorkerPool> blocking_; // Kept after stop() for steps still posting to it
+    std::shared_ptr<Strand> db_strand_;
+
+    // Pending after() calls by deadline; each posts its continuation
+    std::mutex timer_mutex_;
+    std::condition_variable timer_cv_;
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> timers_;
+    bool timers_running_;
+    std::thread timer_thread_;
+};
+
+template <typename Work, typename Then>
+void AsyncRuntime::submit(const std::shared_ptr<Strand>& strand, const std::shared_ptr<ClientConnection>& conn,
+                          Work work, Then then) {
+    conn->beginAsync();
+    WorkerPool* workers = workers_.load();
+    auto step = [workers, conn, work, then]() mutable {
+        auto result = work();
+        auto resume = [conn, then, result]() mutable {
+            ClientConnection::SendBatch batch;
+            if (conn->isConnected()) {
+                then(std::move(result));
+            }
+            finish(conn);
+        };
+        if (workers) {
+            workers->post(conn->getStrand(), std::move(resume));
+        } else {
+            resume();
+        }
+    };
+
+    if (workers) {
+        blocking_->post(strand, std::move(step));
+    } else {
+        step();
+    }
+}
+
+template <typename Work, typename Then>
+void AsyncRuntime::query(Work work, Then then) {
+    WorkerPool* workers = workers_.load();
+    auto step = [workers, work, then]() mutable {
+        auto result = work();
+        auto resume = [then, result]() mutable {
+            ClientConnection::SendBatch batch;
+            then(std::move(result));
+        };
+        if (workers) {
+            workers->post(std::make_shared<Strand>(), std::move(resume));
+        } else {
+            resume();
+        }
+    };
+
+    if (workers) {
+        blocking_->post(db_strand_, std::move(step));
+    } else {
+        step();
+    }
+}
+
+template <typename Then>
+void AsyncRuntime::after(const std::shared_ptr<ClientConnection>& conn, uint32_t delay_ms, Then then) {
+    conn->beginAsync();
+    WorkerPool* workers = workers_.load();
+    auto resume = [conn, then]() mutable {
+        ClientConnection::SendBatch batch;
+        if (conn->isConnected()) {
+            then();
+        }
+        finish(conn);
+    };
+    if (!workers) {
+        resume();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    timers_.emplace(std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms),
+                    [workers, conn, resume]() { workers->post(conn->getStrand(), resume); });
+    timer_cv_.notify_one();
+}
+
+#endif // ASYNC_RUNTIME_H
@@ -29,16 +29,16 @@ public:
 
     bool handleMessage(ClientConnection* client,
                       const MessageHeader& header,
-                      const std::string& payload) override;
+                      const PayloadView& payload) override;
 
     bool canHandle(MessageType type) const override;
 
 private:
     // Message handlers for each type
-    bool handleLogin(ClientConnection* client, const std::string& payload);
-    bool handleRegister(ClientConnection* client, const std::string& payload);
-    bool handleLogout(ClientConnection* client, const std::string& payload);
-    bool handleValidateSession(ClientConnection* client, const std::string& payload);
+    bool handleLogin(ClientConnection* client, const PayloadView& payload);
+    bool handleRegister(ClientConnection* client, const PayloadView& payload);
+    bool handleLogout(ClientConnection* client, const PayloadView& payload);
+    bool handleValidateSession(ClientConnection* client, const PayloadView& payload);
 
     // Helper functions
     std::string generateSessionToken(uint32_t user_id);
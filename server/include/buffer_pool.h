@@ -0,0 +1,98 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include "protocol.h"
+
+/**
+ * BufferPool - Size-class slab allocator for message buffers
+ *
+ * Requests are rounded up to a power-of-two class between MIN_BLOCK and
+ * MAX_BLOCK. Each class carves its blocks out of 64 KiB slabs and keeps the
+ * returned ones on a free list, so once traffic has warmed the pool up a
+ * message travels from the socket, through a worker and back out without
+ * touching the heap. Larger requests go to operator new.
+ *
+ * Covers frame storage (MessageBuffer), connection read blocks and the small
+ * objects that carry a message through the server (worker tasks, shared_ptr
+ * control blocks via PoolAllocator). Slabs are kept for the life of the
+ * process: memory is sized by the peak, not returned after it.
+ *
+ * Thread-safe: frames are built on workers and released by the reactors.
+ */
+class BufferPool {
+public:
+    struct Stats {
+        uint64_t blocks_in_use;   // Handed out and not yet returned
+        uint64_t slab_bytes;      // Carved from the heap so far
+        uint64_t oversize;        // Requests larger than MAX_BLOCK (served by operator new)
+    };
+
+    static void* allocate(size_t size);
+    static void deallocate(void* block, size_t size);  // size as passed to allocate()
+
+    // Usable bytes of the block allocate(size) returns
+    static size_t blockSize(size_t size);
+
+    static Stats getStats();
+
+    // Construct and destroy single objects in pooled storage
+    template <typename T, typename... Args>
+    static T* make(Args&&... args) {
+        void* block = allocate(sizeof(T));
+        try {
+            return new (block) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(block, sizeof(T));
+            throw;
+        }
+    }
+
+    template <typename T>
+    static void destroy(T* object) {
+        if (object) {
+            object->~T();
+            deallocate(object, sizeof(T));
+        }
+    }
+
+    static const size_t MIN_BLOCK = 64;
+    static const size_t MAX_BLOCK = 16384;
+};
+
+// The largest frame, and a read block grown once, stay in the pool
+static_assert(sizeof(MessageHeader) + MAX_MESSAGE_SIZE <= BufferPool::MAX_BLOCK, "pool too small for a frame");
+static_assert(2 * BUFFER_SIZE <= BufferPool::MAX_BLOCK, "pool too small for a grown read block");
+
+/**
+ * STL allocator over BufferPool, e.g. for std::allocate_shared so the
+ * control block and the object share one pooled block
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(BufferPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        BufferPool::deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+#endif // BUFFER_POOL_H
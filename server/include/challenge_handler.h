@@ -22,11 +22,11 @@ public:
     bool canHandle(MessageType type) const override;
     bool handleMessage(ClientConnection* client,
                       const MessageHeader& header,
-                      const std::string& payload) override;
+                      const PayloadView& payload) override;
 
 private:
-    bool handleChallengeSend(ClientConnection* client, const std::string& payload);
-    bool handleChallengeResponse(ClientConnection* client, const std::string& payload);
+    bool handleChallengeSend(ClientConnection* client, const PayloadView& payload);
+    bool handleChallengeResponse(ClientConnection* client, const PayloadView& payload);
 
     Server* server_;
     ChallengeManager* challenge_manager_;
@@ -5,45 +5,259 @@
 #include <cstdint>
 #include <memory>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <sys/uio.h>
 #include "protocol.h"
+#include "payload_view.h"
+#include "message_buffer.h"
+#include "rate_limiter.h"
+
+class Strand;
+
+/**
+ * Names one connection in the server's ConnectionTable: its fd plus the
+ * generation of the slot, so a handle kept past the connection's life (or past
+ * the fd being reused) resolves to nothing instead of to someone else.
+ */
+struct ConnectionHandle {
+    int fd;
+    uint32_t generation;  // 0 = not in a table
+
+    ConnectionHandle() : fd(-1), generation(0) {}
+    ConnectionHandle(int fd_, uint32_t generation_) : fd(fd_), generation(generation_) {}
+
+    bool valid() const { return fd >= 0 && generation != 0; }
+    bool operator==(const ConnectionHandle& other) const {
+        return fd == other.fd && generation == other.generation;
+    }
+    bool operator!=(const ConnectionHandle& other) const { return !(*this == other); }
+};
 
 /**
  * Represents a single client connection
  * Handles reading/writing messages for one client
+ *
+ * Inbound bytes are accumulated in a per-connection buffer so that a
+ * non-blocking socket can be drained by the reactor and framed incrementally.
+ * Each recv pulls as much as fits; every complete frame in the buffer is
+ * handed out as a PayloadView into it, without copying the payload.
+ * Handling of those messages runs on the connection's strand in the worker pool.
+ *
+ * Outbound frames go through a bounded per-connection queue. Senders write
+ * what the socket accepts without blocking; the rest stays queued and the
+ * reactor drains it when the socket becomes writable again. A client that
+ * stops reading hits the queue limit and the overflow policy applies.
+ * Queued frames are shared MessageBuffers, so a broadcast is serialized once
+ * and referenced from every recipient's queue.
+ *
+ * The queue is split by MessagePriority: queued gameplay frames go out before
+ * matchmaking, and both before presence/chat, so turn updates do not wait
+ * behind lobby churn. Only a frame the socket cut short is finished first.
+ * A queued PLAYER_STATUS_UPDATE is replaced by a newer one for the same user.
+ *
+ * The client's first frame sets the header version of the connection: v1
+ * MessageHeader or v2 CompactHeader. Frames going out use the same version.
+ * v2 clients also take BATCH frames: messages sent to one inside a SendBatch
+ * are held and go out together as one frame when the batch ends.
  */
-class ClientConnection {
+class ClientConnection : public std::enable_shared_from_this<ClientConnection> {
 public:
+    // What to do when a frame would push the outbound queue past its limit
+    enum OverflowPolicy {
+        OVERFLOW_DROP_LOBBY,   // Drop lobby updates (new, then queued) first; disconnect if still full
+        OVERFLOW_DISCONNECT    // Disconnect straight away
+    };
+
+    // Frame header the client speaks, from its first frame
+    enum WireVersion {
+        WIRE_UNKNOWN = 0,   // Nothing received yet; frames go out as v1
+        WIRE_V1 = 1,        // MessageHeader
+        WIRE_V2 = 2         // CompactHeader
+    };
+
+    // Process-wide outbound counters
+    struct OutboundStats {
+        uint64_t queued_bytes;    // Bytes waiting in outbound queues right now
+        uint64_t frames_dropped;  // Lobby updates dropped by the overflow policy
+        uint64_t frames_coalesced;  // Queued presence updates replaced by newer ones
+        uint64_t evictions;       // Connections closed for overflowing their queue
+    };
+
+    /**
+     * Coalesces sends made on this thread while the batch is alive
+     *
+     * Frames sent to a connection are queued and written with one syscall per
+     * connection when the outermost batch goes out of scope (or a connection's
+     * queue reaches BUFFER_SIZE). Connections must be owned by a shared_ptr.
+     *
+     * Several messages for one v2 connection become a single BATCH frame (a
+     * new one whenever MAX_MESSAGE_SIZE would be passed). Connections that got
+     * the same messages, e.g. the lobby after two status broadcasts, share
+     * one BATCH frame.
+     */
+    class SendBatch {
+    public:
+        SendBatch();
+        ~SendBatch();
+
+        SendBatch(const SendBatch&) = delete;
+        SendBatch& operator=(const SendBatch&) = delete;
+
+        void flush();
+        static SendBatch* current();
+
+        size_t pending() const { return clients_.size(); }  // Connections waiting for flush()
+
+    private:
+        friend class ClientConnection;
+        void add(std::shared_ptr<ClientConnection> client);
+
+        // The BATCH frame for parts, built on first request. The key holds raw
+        // pointers; the parts are kept with the frame so none can be reused.
+        SharedMessage batchFrame(const std::vector<SharedMessage>& parts);
+
+        bool owner_;  // False for a batch nested inside another one
+        std::vector<std::shared_ptr<ClientConnection>> clients_;  // Each once, in order added
+        std::map<std::vector<const MessageBuffer*>, std::pair<std::vector<SharedMessage>, SharedMessage>> frames_;
+    };
+
     ClientConnection(int socket_fd);
     ~ClientConnection();
 
-    // Message I/O
+    // Outbound queue limit and overflow policy for all connections
+    static void setOutboundLimit(size_t max_bytes, OverflowPolicy policy);
+    static OutboundStats getOutboundStats();
+
+    // Message I/O. sendMessage returns true once the frame is written or queued.
     bool sendMessage(const MessageHeader& header, const std::string& payload);
+    bool sendMessage(const SharedMessage& message);
     bool receiveMessage(MessageHeader& header, std::string& payload);
+    bool flushOutbound();   // Write as much of the outbound queue as the socket takes
+
+    // Non-blocking I/O (used by the reactor)
+    bool setNonBlocking();
+    bool readAvailable();   // Drain socket into read buffer; false if peer closed or error
+    void appendReceived(const char* data, size_t size);  // Bytes a completion-based backend already read
+    bool nextMessage(MessageHeader& header, PayloadView& payload);  // Pop one complete frame
 
     // Connection info
     int getSocketFd() const { return socket_fd_; }
+    ConnectionHandle getHandle() const { return handle_; }
+    void setHandle(const ConnectionHandle& handle) { handle_ = handle; }  // By ConnectionTable
     uint32_t getUserId() const { return user_id_; }
     std::string getSessionToken() const { return session_token_; }
     bool isAuthenticated() const { return authenticated_; }
+    void setPeerAddress(uint32_t address) { peer_address_ = address; }
+    uint32_t getPeerAddress() const { return peer_address_; }  // sin_addr.s_addr, for admission control
 
     // State management
     void setAuthenticated(uint32_t user_id, const std::string& token);
+    // v2 frames carry no session token: writes the one bound by setAuthenticated()
+    // into header. Same thread rules as setAuthenticated() (the strand).
+    void bindSession(MessageHeader& header) const;
+    WireVersion getWireVersion() const { return static_cast<WireVersion>(wire_version_.load()); }
+    void setWireVersion(WireVersion version) { wire_version_ = static_cast<uint8_t>(version); }  // Hot restart
+    // WireCapability bits agreed with a v2 client (CAPABILITIES); none until then
+    uint32_t getCapabilities() const { return capabilities_; }
+    void setCapabilities(uint32_t capabilities) { capabilities_ = capabilities; }
     void disconnect();
     bool isConnected() const { return connected_; }
 
+    // Hot restart, with the reactor stopped. getBufferedInput() is the start of
+    // a frame still arriving; takeOutbound() empties the outbound queue into
+    // raw bytes, which restoreOutbound() queues ahead of anything else.
+    // release() closes the descriptor without shutting the socket down, for a
+    // connection another process serves now; detach() only stops serving it and
+    // leaves the descriptor to the destructor, for one still in clients_.
+    std::string getBufferedInput() const;
+    std::string takeOutbound();
+    void restoreOutbound(const std::string& bytes);
+    void release();
+    void detach() { connected_ = false; }
+
+    // Worker pool strand that serializes this connection's message handling
+    void setStrand(std::shared_ptr<Strand> strand) { strand_ = strand; }
+    const std::shared_ptr<Strand>& getStrand() const { return strand_; }
+
+    // Handler steps in flight (see AsyncRuntime). Messages that arrive meanwhile
+    // are deferred until the last one finishes. Only used on the strand.
+    bool isSuspended() const { return async_steps_ > 0; }
+    void beginAsync() { async_steps_++; }
+    bool endAsync() { return --async_steps_ == 0; }
+    void defer(std::function<void()> task) { deferred_.push_back(std::move(task)); }
+    bool takeDeferred(std::function<void()>& task);
+
+    // Message budgets left; only the reactor that owns the connection uses them
+    RateLimiter::Buckets& getRateBuckets() { return rate_buckets_; }
+
     // Statistics
     uint64_t getBytesSent() const { return bytes_sent_; }
     uint64_t getBytesReceived() const { return bytes_received_; }
+    uint64_t getSendCalls() const { return send_calls_; }
+    size_t getQueuedBytes() const { return queued_bytes_; }
+    uint64_t getFramesDropped() const { return frames_dropped_; }
+    uint64_t getFramesCoalesced() const { return frames_coalesced_; }
+    uint64_t getLastActivityMs() const { return last_activity_ms_; }  // steadyMillis() of the last inbound bytes
 
 private:
-    // Socket operations
-    bool sendData(const void* data, size_t size);
-    bool receiveData(void* data, size_t size);
+    // Frames of one priority class. Frames before head are written; the
+    // vector is cleared (keeping its capacity) once it drains.
+    struct ClassQueue {
+        ClassQueue() : head(0) {}
+        std::vector<SharedMessage> frames;  // Header + payload, possibly shared with other queues
+        size_t head;
+    };
+
+    // Socket operations (Locked = caller holds send_mutex_)
+    bool enqueueLocked(const SharedMessage& message, MessagePriority priority);
+    bool releaseHeldLocked();  // Queue held_ as one frame
+    SharedMessage wireFrame(const SharedMessage& message) const;  // message as this client reads it
+    bool coalesceLocked(const SharedMessage& message);
+    bool flushLocked();
+    bool flushFromBatch(const SendBatch* batch);  // flushOutbound(), leaving batch
+    SharedMessage popFrontLocked(ClassQueue& queue);
+    bool fillReadBuffer();  // Single recv into read buffer (waits if socket is empty)
+    void prepareReadSpace();  // Make room at the end of the read buffer
 
     // Connection details
     int socket_fd_;
     std::atomic<bool> connected_;
     std::atomic<bool> authenticated_;
+    std::atomic<uint8_t> wire_version_;  // WireVersion; set by the reactor, read by senders
+    std::atomic<uint32_t> capabilities_;
+
+    // Outbound queue, guarded by send_mutex_. partial_ is a frame the socket
+    // took only partly (partial_offset_ bytes); it goes before any class queue.
+    std::mutex send_mutex_;
+    ClassQueue out_queues_[PRIORITY_CLASSES];
+    SharedMessage partial_;
+    size_t partial_offset_;
+    std::atomic<size_t> queued_bytes_;
+
+    // Messages held for a BATCH frame while a SendBatch is open (v2 only),
+    // also under send_mutex_. held_size_ is the BATCH payload they make.
+    std::vector<SharedMessage> held_;
+    size_t held_size_;
+    const SendBatch* batch_;  // The batch this connection is in, if any; under send_mutex_
+
+    // Incremental framing state. [read_start_, read_end_) is unparsed; bytes
+    // before read_start_ may still be referenced by PayloadViews. Blocks come
+    // from BufferPool, so replacing one that is still viewed is allocation-free.
+    using ReadBlock = std::vector<char, PoolAllocator<char>>;
+    static std::shared_ptr<ReadBlock> newReadBlock(size_t size);
+    std::shared_ptr<ReadBlock> read_buffer_;
+    size_t read_start_;
+    size_t read_end_;
+
+    std::shared_ptr<Strand> strand_;
+    RateLimiter::Buckets rate_buckets_;
+
+    uint32_t peer_address_;
+    ConnectionHandle handle_;
 
     // User info
     uint32_t user_id_;
@@ -52,6 +266,14 @@ private:
     // Statistics
     std::atomic<uint64_t> bytes_sent_;
     std::atomic<uint64_t> bytes_received_;
+    std::atomic<uint64_t> send_calls_;
+    std::atomic<uint64_t> frames_dropped_;
+    std::atomic<uint64_t> frames_coalesced_;
+    std::atomic<uint64_t> last_activity_ms_;
+
+    // AsyncRuntime state, strand only
+    size_t async_steps_;
+    std::deque<std::function<void()>> deferred_;
 };
 
 #endif // CLIENT_CONNECTION_H
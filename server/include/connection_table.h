@@ -0,0 +1,129 @@
+#ifndef CONNECTION_TABLE_H
+#define CONNECTION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "client_connection.h"
+#include "read_epoch.h"
+
+/**
+ * ConnectionTable - Live connections indexed by socket fd
+ *
+ * A flat array of slots, one per fd, allocated in chunks as fds appear and
+ * kept until the table goes away. Lookups and iteration take no lock and
+ * touch no reference counts: readers hold a ReadEpoch guard, and a writer
+ * that removes a connection waits out the readers that might have seen it
+ * before giving it back, so a pointer a reader found stays valid for as long
+ * as it looks at it.
+ *
+ * Each insert bumps the slot's generation and stamps the connection with its
+ * ConnectionHandle, so a removal or a send meant for an old connection cannot
+ * reach a newer one that got the same fd.
+ *
+ * Writers (insert/remove) are serialized and may wait for readers; never
+ * call them from inside with() or forEach().
+ */
+class ConnectionTable {
+public:
+    // max_fds = 0: the process's RLIMIT_NOFILE hard limit
+    explicit ConnectionTable(size_t max_fds = 0);
+    ~ConnectionTable();
+
+    // Adds the connection under its socket fd and sets its handle. Returns its
+    // generation, or 0 if the fd is out of range or the slot is taken.
+    uint32_t insert(const std::shared_ptr<ClientConnection>& connection);
+
+    // Takes the connection out of its slot if it is still the given generation
+    // (ANY_GENERATION: whatever is there). Readers are done with it on return.
+    std::shared_ptr<ClientConnection> remove(int fd, uint32_t generation = ANY_GENERATION);
+
+    // Empties the table, e.g. on shutdown or after a handoff
+    std::vector<std::shared_ptr<ClientConnection>> removeAll();
+
+    // Calls visit(connection, generation) if fd is live; false otherwise
+    template <typename F>
+    bool with(int fd, F&& visit) const {
+        ReadEpoch::Guard guard(epoch_);
+        const Slot* slot = findSlot(fd);
+        ClientConnection* connection = slot ? slot->connection.load(std::memory_order_acquire) : nullptr;
+        if (!connection) {
+            return false;
+        }
+        visit(*connection, slot->generation.load(std::memory_order_relaxed));
+        return true;
+    }
+
+    // Calls visit(connection) if the handle's connection is still live; false otherwise
+    template <typename F>
+    bool with(const ConnectionHandle& handle, F&& visit) const {
+        ReadEpoch::Guard guard(epoch_);
+        const Slot* slot = handle.valid() ? findSlot(handle.fd) : nullptr;
+        ClientConnection* connection = slot ? slot->connection.load(std::memory_order_acquire) : nullptr;
+        if (!connection || slot->generation.load(std::memory_order_relaxed) != handle.generation) {
+            return false;
+        }
+        visit(*connection);
+        return true;
+    }
+
+    // Calls visit(connection) for every live connection, in fd order. Returns how many.
+    template <typename F>
+    size_t forEach(F&& visit) const {
+        ReadEpoch::Guard guard(epoch_);
+        size_t end = high_water_.load(std::memory_order_acquire);
+        size_t visited = 0;
+        for (size_t chunk_index = 0; chunk_index * CHUNK_SLOTS < end; chunk_index++) {
+            const Chunk* chunk = chunks_[chunk_index].load(std::memory_order_acquire);
+            if (!chunk) {
+                continue;
+            }
+            for (size_t i = 0; i < CHUNK_SLOTS; i++) {
+                ClientConnection* connection = chunk->slots[i].connection.load(std::memory_order_acquire);
+                if (connection) {
+                    visit(*connection);
+                    visited++;
+                }
+            }
+        }
+        return visited;
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return chunk_count_ * CHUNK_SLOTS; }
+
+    static const uint32_t ANY_GENERATION = 0;
+
+    ConnectionTable(const ConnectionTable&) = delete;
+    ConnectionTable& operator=(const ConnectionTable&) = delete;
+
+private:
+    static const size_t CHUNK_SLOTS = 256;
+
+    struct Slot {
+        Slot() : connection(nullptr), generation(0) {}
+
+        std::atomic<ClientConnection*> connection;   // What readers see
+        std::atomic<uint32_t> generation;
+        std::shared_ptr<ClientConnection> owner;     // Writers only
+    };
+
+    struct Chunk {
+        Slot slots[CHUNK_SLOTS];
+    };
+
+    const Slot* findSlot(int fd) const;
+
+    size_t chunk_count_;
+    std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+    std::atomic<size_t> high_water_;   // One past the highest fd ever inserted
+    std::atomic<size_t> size_;
+
+    ReadEpoch epoch_;
+    std::mutex write_mutex_;   // Also serializes epoch_.synchronize()
+};
+
+#endif // CONNECTION_TABLE_H
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <sqlite3.h>
 #include <ctime>
 
@@ -232,6 +233,8 @@ private:
      */
     sqlite3_stmt* prepareStatement(const std::string& sql);
 
+    // Handlers for different clients run concurrently on the one sqlite handle
+    mutable std::recursive_mutex mutex_;
     sqlite3* db_;
     std::string db_path_;
     std::string last_error_;
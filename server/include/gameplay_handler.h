@@ -28,6 +28,10 @@ private:
     std::map<uint32_t, std::shared_ptr<MatchState>> active_matches_;
     std::mutex matches_mutex_;
 
+    // Per-match locks (match_id -> mutex), guarded by matches_mutex_. Messages for
+    // one match are serialized while different matches proceed in parallel.
+    std::map<uint32_t, std::shared_ptr<std::mutex>> match_locks_;
+
     // Track which players are ready (match_id -> set of ready player_ids)
     std::map<uint32_t, std::set<uint32_t>> ready_players_;
     std::mutex ready_mutex_;
@@ -36,6 +40,15 @@ private:
     std::map<uint32_t, std::pair<uint32_t, uint32_t>> pending_rematches_;
     std::mutex rematch_mutex_;
 
+    // A decoded gameplay message to its handler, by payload struct (see handleMessage)
+    void route(ClientConnection* client, const MessageHeader& header, const ShipPlacementMessage& msg);
+    void route(ClientConnection* client, const MessageHeader& header, const MoveMessage& msg);
+    void route(ClientConnection* client, const MessageHeader& header, const ResignMessage& msg);
+    void route(ClientConnection* client, const MessageHeader& header, const DrawOfferMessage& msg);
+    void route(ClientConnection* client, const MessageHeader& header, const DrawResponseMessage& msg);
+    void route(ClientConnection* client, const MessageHeader& header, const RematchRequestMessage& msg);
+    void route(ClientConnection* client, const MessageHeader& header, const RematchResponseMessage& msg);
+
 public:
     GameplayHandler(Server* server, DatabaseManager* db);
     ~GameplayHandler();
@@ -43,11 +56,11 @@ public:
     // MessageHandler interface
     bool handleMessage(ClientConnection* client,
                       const MessageHeader& header,
-                      const std::string& payload) override;
+                      const PayloadView& payload) override;
     bool canHandle(MessageType type) const override;
 
     // Specific handlers
-    void handleShipPlacement(const MessageHeader& header, const ShipPlacementMessage& msg, int client_fd);
+    void handleShipPlacement(ClientConnection* client, const MessageHeader& header, const ShipPlacementMessage& msg);
     void handleMove(const MessageHeader& header, const MoveMessage& msg, int client_fd);
     void handleResign(const MessageHeader& header, const ResignMessage& msg, int client_fd);
     void handleDrawOffer(const MessageHeader& header, const DrawOfferMessage& msg, int client_fd);
@@ -57,10 +70,15 @@ public:
 
     // Match management
     std::shared_ptr<MatchState> getMatch(uint32_t match_id);
+    std::shared_ptr<std::mutex> getMatchLock(uint32_t match_id);
     void createMatch(uint32_t match_id, uint32_t player1_id, uint32_t player2_id);
     void removeMatch(uint32_t match_id);
     void checkTurnTimeouts();  // Check all active matches for turn timeouts
 
+    // Once both boards are placed: builds the match from them and sends MATCH_READY
+    void startPlacedMatch(uint32_t match_id, uint32_t player1_id, uint32_t player2_id,
+                          const std::string& p1_ships, const std::string& p2_ships);
+
     // Validation
     bool validateShipPlacement(const Ship ships[5]);
 
@@ -76,6 +94,11 @@ public:
 
     // Handle player disconnect during match
     void handlePlayerDisconnect(uint32_t disconnected_user_id);
+
+    // Hot restart snapshot of active matches, ready players and pending rematches.
+    // Call with no messages being handled (the server has stopped its workers).
+    std::string exportState();
+    bool importState(const std::string& data);
 };
 
 #endif // GAMEPLAY_HANDLER_H
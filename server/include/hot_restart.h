@@ -0,0 +1,80 @@
+#ifndef HOT_RESTART_H
+#define HOT_RESTART_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * HotRestart - Hands a running server's sockets and sessions to a new process
+ *
+ * The running server listens on a local Unix socket. A new binary started in
+ * takeover mode connects to it; the old process stops its event loops and
+ * sends its listening sockets and every client socket as SCM_RIGHTS, with a
+ * snapshot of each connection, the online players and the active matches.
+ * The new process serves the same TCP connections, so clients stay connected
+ * and matches continue where they were.
+ *
+ * The channel is SOCK_SEQPACKET: each chunk carries part of the snapshot and
+ * up to MAX_FDS_PER_CHUNK descriptors, so any number of clients fits.
+ *
+ * The new process sets up everything that can fail, reports ready and only
+ * serves once the old one answers go. The old process gives up its sockets
+ * only after sending go; if ready never comes it serves on and closes the
+ * channel, and the new process exits without having served anything.
+ */
+
+// One client connection as it was in the old process
+struct HandoffClient {
+    int fd;                     // Descriptor in this process
+    int sender_fd;              // Descriptor in the sending process (set by receive())
+    uint32_t peer_address;
+    uint32_t user_id;
+    bool authenticated;
+    std::string session_token;
+    uint8_t wire_version;       // ClientConnection::WireVersion
+    uint32_t capabilities;      // WireCapability bits agreed with the client
+    std::string inbound;        // Received bytes of a frame not yet complete
+    std::string outbound;       // Queued frames the socket had not taken yet
+};
+
+struct HandoffState {
+    std::vector<int> listen_fds;
+    std::vector<HandoffClient> clients;
+    std::string players;        // PlayerManager::exportState()
+    std::string matches;        // GameplayHandler::exportState()
+};
+
+class HotRestart {
+public:
+    // Unix socket that a takeover connects to. Returns -1 if another live
+    // server already owns the path; a stale socket file is replaced.
+    static int listen(const std::string& path);
+    static int connect(const std::string& path);
+
+    // Sends the descriptors and snapshot. On the receiving side every fd in
+    // state has been replaced by the new process's number for it.
+    static bool send(int channel_fd, const HandoffState& state);
+    static bool receive(int channel_fd, HandoffState& state);
+
+    // The new process confirms once it can serve the connections; the old one
+    // waits up to timeout_ms for that, then answers go and gives up its copies.
+    // waitGo() is false if the old process closed the channel instead.
+    static bool sendReady(int channel_fd);
+    static bool waitReady(int channel_fd, int timeout_ms);
+    static bool sendGo(int channel_fd);
+    static bool waitGo(int channel_fd);
+
+    // Chunk I/O, exposed for tests
+    static bool sendChunk(int channel_fd, const char* data, size_t size, const int* fds, size_t fd_count);
+    static bool receiveChunk(int channel_fd, std::string& data, std::vector<int>& fds);
+
+    static const size_t MAX_FDS_PER_CHUNK = 253;      // SCM_MAX_FD
+    static const size_t MAX_BYTES_PER_CHUNK = 32768;
+
+private:
+    static bool waitFor(int channel_fd, char expected, int timeout_ms);
+};
+
+#endif // HOT_RESTART_H
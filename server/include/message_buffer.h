@@ -0,0 +1,224 @@
+#ifndef MESSAGE_BUFFER_H
+#define MESSAGE_BUFFER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+#include "protocol.h"
+#include "config.h"
+#include "compact_header.h"
+#include "batch_entry.h"
+#include "payload_compression.h"
+#include "message_schema.h"
+#include "buffer_pool.h"
+
+/**
+ * MessageBuffer - Immutable, serialized frame (header + payload)
+ *
+ * Built once and shared by reference: a broadcast serializes into one buffer
+ * and every recipient's outbound queue holds a pointer to it, so fan-out to N
+ * clients costs no per-recipient copies. Each queue keeps its own write offset.
+ *
+ * The frame bytes and the shared object itself live in BufferPool blocks.
+ * create(type, message) writes a fixed-size message struct straight into the
+ * frame, so a reply costs no intermediate std::string.
+ *
+ * Frames are built with the v1 MessageHeader. compact() gives the same
+ * message behind a v2 CompactHeader, for connections that speak v2; it is
+ * encoded on first use and then shared like the original. compressed() does
+ * the same for connections that agreed on CAP_ZLIB, compressing payloads of
+ * COMPRESSION_THRESHOLD bytes or more once for every recipient.
+ *
+ * batch() packs several frames into one BATCH frame (see BatchEntry).
+ */
+class MessageBuffer {
+public:
+    MessageBuffer(const MessageHeader& header, const void* payload, size_t payload_size)
+        : size_(sizeof(MessageHeader) + payload_size)
+        , bytes_(static_cast<char*>(BufferPool::allocate(size_)))
+        , header_size_(sizeof(MessageHeader))
+        , type_(header.type)
+        , raw_(false)
+    {
+        memcpy(bytes_, &header, sizeof(MessageHeader));
+        if (payload_size > 0) {
+            memcpy(bytes_ + sizeof(MessageHeader), payload, payload_size);
+        }
+    }
+
+    // Bytes that are already framed, e.g. output carried over a hot restart
+    explicit MessageBuffer(const std::string& frames)
+        : size_(frames.size())
+        , bytes_(static_cast<char*>(BufferPool::allocate(size_)))
+        , header_size_(sizeof(MessageHeader))
+        , type_(size_ > 0 ? static_cast<uint8_t>(frames[0]) : 0)
+        , raw_(true)
+    {
+        memcpy(bytes_, frames.data(), size_);
+    }
+
+    // payload behind an already encoded header
+    MessageBuffer(const char* header, size_t header_size, const char* payload, size_t payload_size, uint8_t type)
+        : size_(header_size + payload_size)
+        , bytes_(static_cast<char*>(BufferPool::allocate(size_)))
+        , header_size_(header_size)
+        , type_(type)
+        , raw_(false)
+    {
+        memcpy(bytes_, header, header_size);
+        if (payload_size > 0) {
+            memcpy(bytes_ + header_size, payload, payload_size);
+        }
+    }
+
+    // A BATCH frame holding the payloads of parts, which are all batchable()
+    MessageBuffer(const MessageHeader& header, const std::vector<std::shared_ptr<const MessageBuffer>>& parts)
+        : size_(sizeof(MessageHeader) + header.length)
+        , bytes_(static_cast<char*>(BufferPool::allocate(size_)))
+        , header_size_(sizeof(MessageHeader))
+        , type_(header.type)
+        , raw_(false)
+    {
+        memcpy(bytes_, &header, sizeof(MessageHeader));
+        char* out = bytes_ + sizeof(MessageHeader);
+        for (const auto& part : parts) {
+            BatchEntry::encodeHeader(out, part->type_, static_cast<uint16_t>(part->payloadSize()));
+            out += BatchEntry::HEADER_SIZE;
+            memcpy(out, part->payload(), part->payloadSize());
+            out += part->payloadSize();
+        }
+    }
+
+    ~MessageBuffer() {
+        BufferPool::deallocate(bytes_, size_);
+    }
+
+    static std::shared_ptr<const MessageBuffer> create(const MessageHeader& header,
+                                                       const void* payload, size_t payload_size) {
+        return std::allocate_shared<MessageBuffer>(PoolAllocator<MessageBuffer>(),
+                                                   header, payload, payload_size);
+    }
+
+    static std::shared_ptr<const MessageBuffer> create(const MessageHeader& header, const std::string& payload) {
+        return create(header, payload.data(), payload.size());
+    }
+
+    // Frame for a fixed-size message struct, with a fresh header (no session token)
+    template <typename T>
+    static std::shared_ptr<const MessageBuffer> create(MessageType type, const T& message) {
+        static_assert(std::is_trivially_copyable<T>::value, "messages must be plain structs");
+        MessageHeader header;
+        memset(&header, 0, sizeof(header));
+        header.type = static_cast<uint8_t>(type);
+        header.length = sizeof(T);
+        header.timestamp = time(nullptr);
+        return create(header, &message, sizeof(T));
+    }
+
+    // Frame for a server message; message must be the struct message_schema.h gives Type
+    template <MessageType Type>
+    static std::shared_ptr<const MessageBuffer> create(const typename MessageSchema::ServerPayload<Type>::type& message) {
+        return create(Type, message);
+    }
+
+    static std::shared_ptr<const MessageBuffer> fromFrames(const std::string& frames) {
+        return std::allocate_shared<MessageBuffer>(PoolAllocator<MessageBuffer>(), frames);
+    }
+
+    // message with a v2 header, shared by every caller. Raw frames are returned as they are.
+    static std::shared_ptr<const MessageBuffer> compact(const std::shared_ptr<const MessageBuffer>& message) {
+        if (message->raw_ || message->header_size_ != sizeof(MessageHeader)) {
+            return message;
+        }
+        std::call_once(message->compact_once_, [&message]() {
+            CompactHeader header;
+            header.type = message->type_;
+            header.length = static_cast<uint32_t>(message->payloadSize());
+            char encoded[CompactHeader::MAX_SIZE];
+            size_t encoded_size = header.encode(encoded);
+            message->compact_ = std::allocate_shared<MessageBuffer>(PoolAllocator<MessageBuffer>(),
+                                                                    encoded, encoded_size, message->payload(),
+                                                                    message->payloadSize(), message->type_);
+        });
+        return message->compact_;
+    }
+
+    // Like compact(), with the payload compressed if it is large enough to gain from it
+    static std::shared_ptr<const MessageBuffer> compressed(const std::shared_ptr<const MessageBuffer>& message) {
+        if (message->raw_ || message->header_size_ != sizeof(MessageHeader) ||
+            message->payloadSize() < COMPRESSION_THRESHOLD) {
+            return compact(message);
+        }
+        std::call_once(message->compressed_once_, [&message]() {
+            std::string payload;
+            if (!PayloadCompression::compress(message->payload(), message->payloadSize(), payload)) {
+                message->compressed_ = compact(message);
+                return;
+            }
+            CompactHeader header;
+            header.type = message->type_;
+            header.flags = CompactHeader::FLAG_COMPRESSED;
+            header.length = static_cast<uint32_t>(payload.size());
+            char encoded[CompactHeader::MAX_SIZE];
+            size_t encoded_size = header.encode(encoded);
+            message->compressed_ = std::allocate_shared<MessageBuffer>(PoolAllocator<MessageBuffer>(),
+                                                                       encoded, encoded_size, payload.data(),
+                                                                       payload.size(), message->type_);
+        });
+        return message->compressed_;
+    }
+
+    // One BATCH frame carrying parts in order
+    static std::shared_ptr<const MessageBuffer> batch(const std::vector<std::shared_ptr<const MessageBuffer>>& parts) {
+        MessageHeader header;
+        memset(&header, 0, sizeof(header));
+        header.type = static_cast<uint8_t>(BATCH);
+        header.timestamp = time(nullptr);
+        for (const auto& part : parts) {
+            header.length += static_cast<uint32_t>(batchedSize(*part));
+        }
+        return std::allocate_shared<MessageBuffer>(PoolAllocator<MessageBuffer>(), header, parts);
+    }
+
+    // Whether the message can go inside a BATCH frame, and what it adds to one
+    bool batchable() const {
+        return !raw_ && header_size_ == sizeof(MessageHeader) && type_ != BATCH &&
+               payloadSize() <= BatchEntry::MAX_LENGTH;
+    }
+    static size_t batchedSize(const MessageBuffer& message) {
+        return BatchEntry::HEADER_SIZE + message.payloadSize();
+    }
+
+    const char* data() const { return bytes_; }
+    size_t size() const { return size_; }
+    uint8_t type() const { return type_; }
+
+    // The message after its header (for raw frames: after the first v1 header)
+    const char* payload() const { return bytes_ + header_size_; }
+    size_t payloadSize() const { return size_ > header_size_ ? size_ - header_size_ : 0; }
+
+    MessageBuffer(const MessageBuffer&) = delete;
+    MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+private:
+    size_t size_;
+    char* bytes_;
+    size_t header_size_;
+    uint8_t type_;
+    bool raw_;  // Framed elsewhere; may hold several frames
+
+    mutable std::once_flag compact_once_;
+    mutable std::shared_ptr<const MessageBuffer> compact_;
+    mutable std::once_flag compressed_once_;
+    mutable std::shared_ptr<const MessageBuffer> compressed_;
+};
+
+using SharedMessage = std::shared_ptr<const MessageBuffer>;
+
+#endif // MESSAGE_BUFFER_H
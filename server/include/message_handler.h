@@ -5,6 +5,7 @@
 #include <cstring>
 #include "protocol.h"
 #include "client_connection.h"
+#include "async_runtime.h"
 
 /**
  * Base class for message handlers
@@ -12,15 +13,22 @@
  */
 class MessageHandler {
 public:
+    MessageHandler() : async_(AsyncRuntime::inlineRuntime()) {}
     virtual ~MessageHandler() {}
 
+    /**
+     * Runtime for handler steps that wait on the database or a timer.
+     * Set by the server when the handler is registered; until then steps run inline.
+     */
+    void setAsyncRuntime(AsyncRuntime* runtime) { async_ = runtime; }
+
     /**
      * Handle a message from a client
      * Returns true if message was handled successfully
      */
     virtual bool handleMessage(ClientConnection* client,
                               const MessageHeader& header,
-                              const std::string& payload) = 0;
+                              const PayloadView& payload) = 0;
 
     /**
      * Check if this handler can process the given message type
@@ -28,6 +36,8 @@ public:
     virtual bool canHandle(MessageType type) const = 0;
 
 protected:
+    AsyncRuntime* async_;
+
     /**
      * Send a response to the client
      */
@@ -43,6 +53,14 @@ protected:
         return client->sendMessage(header, payload);
     }
 
+    /**
+     * Send a fixed-size response struct, written straight into a pooled frame
+     */
+    template <typename T>
+    bool sendResponse(ClientConnection* client, MessageType type, const T& message) {
+        return client->sendMessage(MessageBuffer::create(type, message));
+    }
+
     /**
      * Send an error response
      */
@@ -0,0 +1,51 @@
+#ifndef PAYLOAD_VIEW_H
+#define PAYLOAD_VIEW_H
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+/**
+ * PayloadView - Read-only view of a message payload
+ *
+ * Usually points straight into a connection's read buffer. The view holds a
+ * reference on that buffer block, so the bytes stay valid after the reactor
+ * moves on (e.g. while the message waits in the worker pool); the connection
+ * switches to a fresh block instead of overwriting one that is still viewed.
+ */
+class PayloadView {
+public:
+    PayloadView() : data_(nullptr), size_(0) {}
+
+    PayloadView(std::shared_ptr<const void> owner, const char* data, size_t size)
+        : owner_(std::move(owner)), data_(data), size_(size) {}
+
+    // Owning copy, for payloads that did not come off the wire (tests, tools)
+    PayloadView(const std::string& text)
+        : data_(nullptr), size_(text.size())
+    {
+        auto copy = std::make_shared<std::string>(text);
+        data_ = copy->data();
+        owner_ = copy;
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+
+    std::string str() const { return size_ > 0 ? std::string(data_, size_) : std::string(); }
+
+    bool operator==(const std::string& other) const {
+        return other.size() == size_ && (size_ == 0 || other.compare(0, size_, data_, size_) == 0);
+    }
+
+private:
+    std::shared_ptr<const void> owner_;
+    const char* data_;
+    size_t size_;
+};
+
+#endif // PAYLOAD_VIEW_H
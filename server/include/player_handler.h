@@ -11,7 +11,7 @@ class PlayerManager;
  * PlayerHandler - Handles player list and status messages
  *
  * Handles:
- * - PLAYER_LIST_REQUEST
+ * - PLAYER_LIST_REQUEST (one page per request, see PlayerListPage)
  * - PLAYER_STATUS_UPDATE (handled by PlayerManager broadcast)
  */
 class PlayerHandler : public MessageHandler {
@@ -22,10 +22,10 @@ public:
     bool canHandle(MessageType type) const override;
     bool handleMessage(ClientConnection* client,
                       const MessageHeader& header,
-                      const std::string& payload) override;
+                      const PayloadView& payload) override;
 
 private:
-    bool handlePlayerListRequest(ClientConnection* client, const std::string& payload);
+    bool handlePlayerListRequest(ClientConnection* client, const PayloadView& payload);
 
     Server* server_;
     PlayerManager* player_manager_;
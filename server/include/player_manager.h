@@ -4,8 +4,11 @@
 #include <map>
 #include <mutex>
 #include <vector>
+#include <string>
 #include "protocol.h"
 #include "messages/matchmaking_messages.h"
+#include "message_buffer.h"
+#include "routing_table.h"
 
 // Forward declaration
 class ClientConnection;
@@ -18,6 +21,13 @@ class Server;
  * - Track online players and their status
  * - Provide player list to clients
  * - Broadcast player status updates
+ * - Route messages to a player's current connection
+ *
+ * Routing goes through a RoutingTable of generation-tagged ConnectionHandles
+ * rather than connection pointers: sendToPlayer() is one lock-free lookup
+ * here and one in the server's connection table, and a handle left over from
+ * a connection that has since closed (or been replaced by a reconnect)
+ * resolves to nothing instead of dangling.
  */
 class PlayerManager {
 public:
@@ -32,6 +42,10 @@ public:
     // Player removal (when user disconnects/logs out)
     void removePlayer(uint32_t user_id);
 
+    // Removal for one connection going away: a no-op if the player has since
+    // logged in again on another connection
+    void removePlayer(uint32_t user_id, const ConnectionHandle& connection);
+
     // Update player status
     void updatePlayerStatus(uint32_t user_id, PlayerStatus status);
 
@@ -41,14 +55,22 @@ public:
     // Get list of online players
     std::vector<PlayerInfo_Message> getOnlinePlayers() const;
 
+    // Up to limit online players with a user_id above after, in user_id order.
+    // total is set to the number of online players overall.
+    std::vector<PlayerInfo_Message> getOnlinePlayers(uint32_t after, size_t limit, uint32_t& total) const;
+
     // Get list of available players (for challenging)
     std::vector<PlayerInfo_Message> getAvailablePlayers() const;
 
     // Get player info by user_id
     PlayerInfo_Message getPlayerInfo(uint32_t user_id) const;
 
-    // Get client connection by user_id
-    ClientConnection* getClientConnection(uint32_t user_id) const;
+    // Current connection of an online player (invalid if offline). Lock-free.
+    ConnectionHandle getConnectionHandle(uint32_t user_id) const;
+
+    // Queue a frame on the player's current connection. Lock-free; false if
+    // the player is offline or the connection is gone.
+    bool sendToPlayer(uint32_t user_id, const SharedMessage& message) const;
 
     // Check if player is online
     bool isPlayerOnline(uint32_t user_id) const;
@@ -56,6 +78,12 @@ public:
     // Broadcast status update to all clients
     void broadcastPlayerStatusUpdate(uint32_t user_id, PlayerStatus status);
 
+    // Hot restart snapshot. Connections are recorded by socket fd; on import,
+    // clients maps those fds to the connections of the new process. Players
+    // whose connection did not come across are dropped. Nothing is broadcast.
+    std::string exportState() const;
+    bool importState(const std::string& data, const std::map<int, ClientConnection*>& clients);
+
 private:
     struct PlayerData {
         uint32_t user_id;
@@ -63,15 +91,18 @@ private:
         std::string display_name;
         int32_t elo_rating;
         PlayerStatus status;
-        ClientConnection* client;
+        ConnectionHandle connection;
 
         PlayerData() : user_id(0), elo_rating(1000),
-                      status(STATUS_OFFLINE), client(nullptr) {}
+                      status(STATUS_OFFLINE) {}
     };
 
     Server* server_;
     mutable std::mutex mutex_;
     std::map<uint32_t, PlayerData> players_; // user_id -> PlayerData
+
+    // user_id -> connection, kept in step with players_ (written under mutex_)
+    RoutingTable routes_;
 };
 
 #endif // PLAYER_MANAGER_H
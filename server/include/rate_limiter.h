@@ -0,0 +1,89 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+
+/**
+ * RateLimiter - Per-connection token buckets for incoming messages
+ *
+ * Each limited message type has a budget: a sustained rate and a burst.
+ * Every connection holds its own Buckets, so one client spamming MOVE or
+ * PLAYER_LIST_REQUEST only runs out its own tokens. An optional
+ * connection-wide budget applies to every message on top of that.
+ *
+ * The server checks allow() on the reactor thread, before a message is
+ * handed to a worker, so an over-limit message costs a few arithmetic
+ * operations and is then dropped and counted.
+ *
+ * Budgets are configured before the server starts and read-only after;
+ * a connection's Buckets are only touched by the reactor that owns it.
+ */
+class RateLimiter {
+public:
+    struct Budget {
+        uint32_t per_second;   // Sustained rate; 0 = unlimited
+        uint32_t burst;        // Messages allowed back to back
+    };
+
+    static const size_t MAX_LIMITED_TYPES = 15;
+    static const size_t CONNECTION_SLOT = MAX_LIMITED_TYPES;
+
+    // Per-connection state. Starts with every bucket full.
+    struct Buckets {
+        Buckets() : tokens(), refilled_ms(), primed() {}
+
+        uint32_t tokens[MAX_LIMITED_TYPES + 1];     // In thousandths of a message
+        uint32_t refilled_ms[MAX_LIMITED_TYPES + 1];
+        bool primed[MAX_LIMITED_TYPES + 1];         // Filled on first use
+    };
+
+    struct Stats {
+        uint64_t dropped;                   // All types
+        uint64_t dropped_by_type[256];
+    };
+
+    RateLimiter();
+
+    // Budget for one message type; per_second 0 removes it. False if
+    // MAX_LIMITED_TYPES other types are already limited.
+    bool setBudget(uint8_t type, const Budget& budget);
+    Budget getBudget(uint8_t type) const;
+
+    // Budget shared by all messages on a connection; per_second 0 = none
+    void setConnectionBudget(const Budget& budget);
+
+    // Applies "TYPE=per_second/burst" entries separated by commas, on top of
+    // the current budgets. TYPE is a message type name (MOVE) or number (31),
+    // or * for the connection-wide budget; "TYPE=0" removes a limit.
+    // False (after applying the entries before it) on the first bad entry.
+    bool configure(const std::string& spec);
+
+    // Takes a token for a message of this type; false if it must be dropped
+    bool allow(Buckets& buckets, uint8_t type, uint32_t now_ms);
+
+    // Milliseconds on a coarse monotonic clock, for allow()
+    static uint32_t nowMs();
+
+    // Name of a message type as used in configure(), or nullptr
+    static const char* typeName(uint8_t type);
+
+    Stats getStats() const;
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+private:
+    // Refills the bucket in slot and takes one message's worth of tokens
+    bool take(Buckets& buckets, size_t slot, const Budget& budget, uint32_t now_ms);
+
+    int8_t slot_of_type_[256];          // -1 = not limited
+    Budget budgets_[MAX_LIMITED_TYPES + 1];
+    size_t slots_used_;
+
+    std::atomic<uint64_t> dropped_[256];
+};
+
+#endif // RATE_LIMITER_H
@@ -0,0 +1,151 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+#include "protocol.h"
+#include "payload_view.h"
+#include "timer_wheel.h"
+
+class ClientConnection;
+
+// Event loop implementation behind the server's reactors
+enum IoBackend {
+    IO_BACKEND_EPOLL,   // Edge-triggered epoll (default)
+    IO_BACKEND_URING    // io_uring, see UringReactor; falls back to epoll when unsupported
+};
+
+/**
+ * Reactor - Edge-triggered epoll event loop
+ *
+ * Owns one listening socket and every client fd accepted on it. The server
+ * runs several reactors, each with its own SO_REUSEPORT listener and
+ * optionally pinned to a core, so the kernel shards accepts across them.
+ * All sockets are non-blocking; inbound bytes are framed incrementally
+ * per connection and complete messages are handed to the message callback.
+ *
+ * Other backends derive from this class and replace setup(), run(), watch()
+ * and unwatch(); lifecycle, callbacks and connection bookkeeping are shared.
+ *
+ * Liveness is tracked here too: every connection has one deadline on a
+ * TimerWheel, pushed back lazily by inbound traffic. A connection that goes
+ * quiet is sent a PING; if it stays quiet through the grace period it is
+ * closed like any other dead socket, so half-open peers stop holding a
+ * PlayerManager slot and receiving broadcasts.
+ */
+class Reactor {
+public:
+    // Called for each accepted socket; returns nullptr to reject the connection
+    using AcceptCallback = std::function<std::shared_ptr<ClientConnection>(int client_fd,
+                                                                           const sockaddr_in& addr)>;
+    // Called for every complete message read from a connection
+    using MessageCallback = std::function<void(ClientConnection* client,
+                                               const MessageHeader& header,
+                                               const PayloadView& payload)>;
+    // Called once when a connection is closed by the peer or fails
+    using CloseCallback = std::function<void(int client_fd)>;
+
+    // Liveness counters
+    struct IdleStats {
+        uint64_t heartbeats_sent;   // PINGs sent to silent connections
+        uint64_t evictions;         // Connections closed for staying silent
+        uint64_t silence_total_ms;  // Summed silence of the evicted connections
+        uint64_t silence_max_ms;
+    };
+
+    // cpu < 0 leaves the loop thread unpinned
+    explicit Reactor(int listen_fd, int cpu = -1);
+    virtual ~Reactor();
+
+    void setAcceptCallback(AcceptCallback callback) { accept_callback_ = callback; }
+    void setMessageCallback(MessageCallback callback) { message_callback_ = callback; }
+    void setCloseCallback(CloseCallback callback) { close_callback_ = callback; }
+
+    // After idle_ms without inbound bytes a connection is sent a PING; after
+    // grace_ms more it is closed. idle_ms = 0 disables both. Set before start().
+    void setIdleTimeout(uint64_t idle_ms, uint64_t grace_ms);
+
+    // Serve a connection accepted elsewhere (handed over by a hot restart).
+    // Call before start(); it is watched like a new one once the loop runs.
+    void adopt(std::shared_ptr<ClientConnection> client) { adopted_.push_back(client); }
+
+    // Lifecycle. prepare() acquires what the loop needs (and can fail on)
+    // without serving anything; start() prepares if needed and runs the loop.
+    bool prepare();
+    bool start();
+    void stop();
+    bool isRunning() const { return running_; }
+    virtual IoBackend getBackend() const { return IO_BACKEND_EPOLL; }
+
+    // Statistics
+    size_t getConnectionCount() const { return connection_count_; }
+    uint64_t getAcceptedCount() const { return accepted_count_; }
+    uint64_t getMessageCount() const { return message_count_; }
+    IdleStats getIdleStats() const;
+
+protected:
+    // Backend hooks. setup() runs in prepare() before the loop thread exists;
+    // run() is the loop; watch() starts event delivery for a connection and
+    // adds it to connections_; unwatch() stops it for a closing fd.
+    virtual bool setup();
+    virtual void run();
+    virtual bool watch(const std::shared_ptr<ClientConnection>& client);
+    virtual void unwatch(int client_fd);
+
+    void pinToCpu();
+    // Hand every complete frame buffered on a connection to the message callback
+    void dispatchMessages(ClientConnection* client);
+    void closeClient(ClientConnection* client);
+
+    // Idle tracking, loop thread only. watchIdle() starts the clock on a new
+    // connection; checkIdle() handles every deadline that has passed.
+    void watchIdle(ClientConnection* client);
+    void checkIdle();
+    int waitTimeoutMs() const;  // How long the loop may block before checkIdle() is due
+
+    int listen_fd_;
+    int cpu_;
+    int wake_fd_;   // eventfd written by stop() to interrupt the loop
+    bool prepared_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+
+    // Connections registered with this reactor (only touched by the loop thread)
+    std::unordered_map<int, std::shared_ptr<ClientConnection>> connections_;
+    std::atomic<size_t> connection_count_;
+    std::atomic<uint64_t> accepted_count_;
+    std::atomic<uint64_t> message_count_;
+    std::vector<std::shared_ptr<ClientConnection>> adopted_;  // Waiting for start()
+
+    AcceptCallback accept_callback_;
+    MessageCallback message_callback_;
+    CloseCallback close_callback_;
+
+    static const uint64_t IDLE_TICK_MS = 100;
+    static const size_t IDLE_WHEEL_SLOTS = 512;
+
+    uint64_t idle_ms_;
+    uint64_t grace_ms_;
+    TimerWheel idle_wheel_;
+    std::vector<int> idle_expired_;  // Scratch list for checkIdle()
+    std::atomic<uint64_t> heartbeats_sent_;
+    std::atomic<uint64_t> idle_evictions_;
+    std::atomic<uint64_t> idle_silence_total_ms_;
+    std::atomic<uint64_t> idle_silence_max_ms_;
+
+private:
+    void acceptPending();
+    void handleClientEvent(ClientConnection* client, uint32_t events);
+
+    static const int MAX_EVENTS = 256;
+    static const int WAIT_TIMEOUT_MS = 1000;
+
+    int epoll_fd_;
+};
+
+#endif // REACTOR_H
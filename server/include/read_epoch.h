@@ -0,0 +1,46 @@
+#ifndef READ_EPOCH_H
+#define READ_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * ReadEpoch - Grace periods for lock-free readers
+ *
+ * Readers hold a Guard while they look at shared data; it costs two atomic
+ * increments and never blocks. A writer that has unpublished something (taken
+ * a pointer out of a table, swapped in a new array) calls synchronize() before
+ * freeing it: the call flips the epoch and waits until every reader that
+ * started before the flip has left, so nothing can still be looking at it.
+ *
+ * synchronize() calls must be serialized by the caller and never made while
+ * the calling thread holds a Guard on the same epoch.
+ */
+class ReadEpoch {
+public:
+    ReadEpoch();
+
+    class Guard {
+    public:
+        explicit Guard(const ReadEpoch& epoch);
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        const ReadEpoch& epoch_;
+        uint32_t parity_;
+    };
+
+    void synchronize();
+
+    ReadEpoch(const ReadEpoch&) = delete;
+    ReadEpoch& operator=(const ReadEpoch&) = delete;
+
+private:
+    mutable std::atomic<uint32_t> epoch_;
+    mutable std::atomic<int> readers_[2];
+};
+
+#endif // READ_EPOCH_H
@@ -0,0 +1,82 @@
+#ifndef ROUTING_TABLE_H
+#define ROUTING_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "client_connection.h"
+#include "read_epoch.h"
+
+/**
+ * RoutingTable - user_id -> ConnectionHandle for online players
+ *
+ * Open addressing with linear probing over an array of buckets. find() takes
+ * no lock: each bucket is a seqlock, so a reader that overlaps a write to
+ * the bucket it is reading simply reads it again. When the table fills up
+ * (or fills with removed entries) a writer rebuilds it into a new array,
+ * publishes that, and frees the old one once ReadEpoch says no reader is
+ * still probing it.
+ *
+ * Writers are serialized by an internal mutex. User id 0 is never stored.
+ */
+class RoutingTable {
+public:
+    explicit RoutingTable(size_t initial_capacity = 256);
+    ~RoutingTable();
+
+    // Handle for the user, or an invalid handle if there is none
+    ConnectionHandle find(uint32_t user_id) const;
+
+    // Adds the route or points it at a new connection
+    void set(uint32_t user_id, const ConnectionHandle& handle);
+
+    // Removes the route; with a handle, only if it still points there, so the
+    // old connection of a user who has reconnected cannot remove the new route
+    bool erase(uint32_t user_id);
+    bool erase(uint32_t user_id, const ConnectionHandle& handle);
+
+    void clear();
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    RoutingTable(const RoutingTable&) = delete;
+    RoutingTable& operator=(const RoutingTable&) = delete;
+
+private:
+    static const uint32_t EMPTY = 0;
+    static const uint32_t REMOVED = 0xFFFFFFFF;
+
+    struct Bucket {
+        Bucket() : sequence(0), user_id(EMPTY), fd(-1), generation(0) {}
+
+        std::atomic<uint32_t> sequence;   // Odd while a writer is in the bucket
+        std::atomic<uint32_t> user_id;    // EMPTY, REMOVED or a user
+        std::atomic<int> fd;
+        std::atomic<uint32_t> generation;
+    };
+
+    struct Buckets {
+        explicit Buckets(size_t capacity_) : capacity(capacity_), slots(new Bucket[capacity_]) {}
+
+        size_t capacity;                  // Power of two
+        std::unique_ptr<Bucket[]> slots;
+    };
+
+    static size_t home(uint32_t user_id, size_t capacity);
+
+    // Writer side, with write_mutex_ held
+    Bucket* locate(Buckets& buckets, uint32_t user_id) const;
+    static void write(Bucket& bucket, uint32_t user_id, const ConnectionHandle& handle);
+    void rebuild(size_t capacity);
+
+    std::atomic<Buckets*> buckets_;
+    std::atomic<size_t> size_;
+    size_t used_;                         // Buckets not EMPTY (live + REMOVED)
+
+    ReadEpoch epoch_;
+    std::mutex write_mutex_;
+};
+
+#endif // ROUTING_TABLE_H
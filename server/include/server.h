@@ -3,15 +3,25 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <map>
 #include <mutex>
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <netinet/in.h>
 #include "protocol.h"
+#include "worker_pool.h"
+#include "reactor.h"
+#include "message_buffer.h"
+#include "admission_control.h"
+#include "rate_limiter.h"
+#include "async_runtime.h"
+#include "connection_table.h"
 
 // Forward declarations
 class ClientConnection;
+class PayloadView;
 class MessageHandler;
 class DatabaseManager;
 class PlayerManager;
@@ -21,6 +31,17 @@ class GameplayHandler;
 /**
  * Main server class for Battleship game
  * Handles socket operations, client connections, and routing
+ *
+ * Socket I/O runs on one or more epoll Reactors; complete messages are
+ * routed to the registered MessageHandlers on a WorkerPool, one strand per
+ * connection so each client's messages are still handled in order.
+ *
+ * Clients on the same host (bots, load tools) can skip TCP and connect to
+ * a Unix stream socket instead; it speaks the same protocol and gets its
+ * own reactor (see setUnixSocket()).
+ *
+ * A new server binary can take over a running one without dropping anyone:
+ * see HotRestart, setHandoffSocket() and takeOver().
  */
 class Server {
 public:
@@ -32,9 +53,62 @@ public:
     void stop();
     bool isRunning() const { return running_; }
 
+    // Additional AF_UNIX stream listener at path for co-located clients (empty
+    // disables). Must be set before start(); the socket file is removed on stop().
+    void setUnixSocket(const std::string& path) { unix_path_ = path; }
+
+    // Hot restart. While running, a new process can take over through the Unix
+    // socket at path (empty disables). Must be set before start().
+    void setHandoffSocket(const std::string& path) { handoff_path_ = path; }
+
+    // Start by taking over the server listening on the handoff socket at path:
+    // its listeners, connections, online players and matches. Replaces start().
+    bool takeOver(const std::string& path);
+
+    // A handoff pauses the server (isRunning() is false) until it completes or,
+    // if the successor fails, the server resumes
+    bool isHandingOff() const { return handing_off_; }
+    bool hasHandedOff() const { return handed_off_; }
+
+    // Number of I/O reactors (each with its own SO_REUSEPORT listener).
+    // Must be set before start(); 0 = one per available core.
+    void setReactorCount(int count) { reactor_count_ = count; }
+    int getReactorCount() const { return static_cast<int>(reactors_.size()); }
+
+    // Event loop backend. Must be set before start(); io_uring falls back to epoll
+    // when the kernel lacks support. getIoBackend() reports the one in use.
+    void setIoBackend(IoBackend backend) { io_backend_ = backend; }
+    IoBackend getIoBackend() const;
+
+    // Heartbeats: a client silent for idle_seconds gets a PING and is disconnected
+    // after grace_seconds more without traffic. 0 disables. Must be set before start().
+    void setIdleTimeout(int idle_seconds, int grace_seconds) {
+        idle_timeout_ = idle_seconds;
+        heartbeat_grace_ = grace_seconds;
+    }
+
+    // Admission control: at most max_connections clients, and max_per_address from
+    // one IP (0 = no limit). Must be set before start().
+    void setConnectionLimits(size_t max_connections, size_t max_per_address) {
+        max_connections_ = max_connections;
+        max_per_address_ = max_per_address;
+    }
+
+    // Per-connection message budgets, on top of DEFAULT_RATE_LIMITS (see
+    // RateLimiter::configure()). False if spec is malformed. Must be set before start().
+    bool setRateLimits(const std::string& spec) { return rate_limiter_.configure(spec); }
+
+    // Number of message handling threads. Must be set before start(); 0 = one per core.
+    void setWorkerCount(int count) { worker_count_ = count; }
+    int getWorkerCount() const { return worker_pool_ ? static_cast<int>(worker_pool_->getThreadCount()) : 0; }
+
     // Statistics
     int getConnectedClients() const;
     int getActiveMatches() const;
+    WorkerPool::Stats getWorkerStats() const;
+    Reactor::IdleStats getIdleStats() const;  // Summed over all reactors
+    AdmissionControl::Stats getAdmissionStats() const;
+    RateLimiter::Stats getRateLimitStats() const { return rate_limiter_.getStats(); }
 
     // Managers
     PlayerManager* getPlayerManager() { return player_manager_; }
@@ -43,36 +117,96 @@ public:
     DatabaseManager* getDatabase() { return db_; }
     DatabaseManager* getDatabaseManager() { return db_; }
 
-    // Broadcasting and messaging
+    // Broadcasting and messaging. The frame is serialized once and shared by all recipients.
     void broadcast(const MessageHeader& header, const std::string& payload);
+    void broadcast(const SharedMessage& message);
     bool sendToClient(int client_fd, const MessageHeader& header, const void* payload, size_t payload_size);
+    bool sendToClient(int client_fd, const SharedMessage& message);
+    bool sendToClient(const ConnectionHandle& connection, const SharedMessage& message);  // Lock-free
 
 private:
     // Socket operations
-    bool createSocket();
-    bool bindSocket();
-    bool listenSocket();
-    void acceptConnections(); // Main accept loop
-
-    // Client management
-    void handleClient(int client_fd);
-    void removeClient(int client_fd);
+    int createSocket();
+    bool bindSocket(int listen_fd);
+    bool listenSocket(int listen_fd);
+    int createUnixSocket();
+    void closeListeners(bool remove_socket_files);
+    std::unique_ptr<Reactor> createReactor(bool use_uring, int listen_fd, int cpu);
+
+    // start() in two steps. prepare() sets up handlers, listeners and loops,
+    // everything that can fail, without serving; serve() runs the loops and
+    // opens the handoff socket. A takeover serves only once told to go.
+    bool prepare();
+    void serve();
+    void abandonTakeover();  // After a failed takeover, leaves every socket to the old process
+
+    // Worker pool, reactors and timeout checker. startLoops() hands the
+    // connections already in clients_ (taken over, or kept through a failed
+    // handoff) to the new reactors; stopLoops() leaves every socket open.
+    // startLoops() is prepareLoops() and then runLoops().
+    bool startLoops();
+    bool prepareLoops();
+    void runLoops();
+    void stopLoops();
+
+    // Reactor callbacks
+    std::shared_ptr<ClientConnection> acceptClient(int client_fd, const struct sockaddr_in& addr);
+    void rejectClient(int client_fd, AdmissionControl::Verdict verdict, const char* client_ip);
+    void handleMessage(ClientConnection* client, const MessageHeader& header, const PayloadView& payload);
+    void handleClose(int client_fd);
+
+    // Client management. generation guards against removing a newer
+    // connection that got the same fd.
+    void removeClient(int client_fd, uint32_t generation = ConnectionTable::ANY_GENERATION);
     void broadcastToAll(const std::string& message);
 
     // Message routing
     void setupHandlers();
+    void registerHandler(MessageHandler* handler);
     bool routeMessage(ClientConnection* client,
                      const MessageHeader& header,
-                     const std::string& payload);
+                     const PayloadView& payload);
 
     // Background tasks
     void timeoutCheckerThread();  // Background thread for turn timeouts
 
+    // Hot restart (old process side)
+    void handoffThread();         // Waits for a takeover on handoff_fd_
+    bool handOff(int channel_fd);
+
     // Configuration
     int port_;
-    int server_fd_;
+    int reactor_count_;
+    int worker_count_;
+    IoBackend io_backend_;
+    int idle_timeout_;
+    int heartbeat_grace_;
+    size_t max_connections_;
+    size_t max_per_address_;
+    std::string unix_path_;
+    std::string handoff_path_;
     std::atomic<bool> running_;
 
+    // Serializes stop() with a handoff in progress
+    std::mutex lifecycle_mutex_;
+
+    // Event loops, each owning one listening socket (TCP, then the Unix socket
+    // if enabled) and the clients accepted on it
+    std::vector<int> listen_fds_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+
+    // Message handling threads fed by the reactors
+    std::unique_ptr<WorkerPool> worker_pool_;
+
+    // Database and timer waits for handlers, resumed on the worker pool
+    AsyncRuntime async_runtime_;
+
+    // Connection slots, taken in acceptClient() and returned in removeClient()
+    std::unique_ptr<AdmissionControl> admission_;
+
+    // Message budgets, checked on the reactor thread before a message reaches a worker
+    RateLimiter rate_limiter_;
+
     // Database
     DatabaseManager* db_;
 
@@ -81,20 +215,28 @@ private:
     ChallengeManager* challenge_manager_;
     GameplayHandler* gameplay_handler_;
 
-    // Client tracking
-    std::map<int, std::shared_ptr<ClientConnection>> clients_;
-    mutable std::mutex clients_mutex_;
+    // Client tracking: lock-free lookups by fd for sends and broadcasts
+    ConnectionTable clients_;
 
     // Statistics
     std::atomic<int> total_connections_;
     std::atomic<int> active_matches_;
 
-    // Message handlers
+    // Message handlers (owned; the gameplay handler is owned separately above)
     std::vector<MessageHandler*> handlers_;
-    std::mutex handlers_mutex_;
+
+    // MessageType -> handler, filled by setupHandlers() before the reactors start
+    // and read-only afterwards, so routing needs no lock
+    std::array<MessageHandler*, 256> dispatch_table_;
 
     // Background threads
     std::thread timeout_checker_thread_;
+
+    // Hot restart listener
+    int handoff_fd_;
+    std::thread handoff_thread_;
+    std::atomic<bool> handing_off_;
+    std::atomic<bool> handed_off_;
 };
 
 #endif // SERVER_H
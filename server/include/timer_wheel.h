@@ -0,0 +1,59 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+// Milliseconds on the monotonic clock; what TimerWheel deadlines are measured in
+inline uint64_t steadyMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * TimerWheel - Hashed timing wheel keyed by int (the reactors use client fds)
+ *
+ * Deadlines are rounded up to the next tick and hashed into one of a fixed
+ * number of slots; advance() only visits the slots for ticks that have
+ * passed. Each key has at most one live deadline. Rescheduling or cancelling
+ * just updates the key's entry, and stale slot entries are dropped when
+ * their slot comes round, so every operation is O(1) amortized. Deadlines
+ * further out than one revolution stay in their slot until it is their turn.
+ *
+ * Not thread-safe: each reactor owns one and only touches it on its loop thread.
+ */
+class TimerWheel {
+public:
+    TimerWheel(uint64_t tick_ms, size_t slot_count);
+
+    // Sets (or moves) key's deadline. A deadline already past fires on the next advance().
+    void schedule(int key, uint64_t deadline_ms);
+    void cancel(int key);
+    bool contains(int key) const { return deadlines_.count(key) > 0; }
+
+    // Removes every key whose deadline is <= now_ms and appends it to expired
+    void advance(uint64_t now_ms, std::vector<int>& expired);
+
+    size_t size() const { return deadlines_.size(); }
+    bool empty() const { return deadlines_.empty(); }
+    uint64_t getTickMs() const { return tick_ms_; }
+
+private:
+    struct Entry {
+        int key;
+        uint64_t deadline_ms;
+    };
+
+    void expireSlot(size_t slot, uint64_t now_ms, std::vector<int>& expired);
+
+    uint64_t tick_ms_;
+    std::vector<std::vector<Entry>> slots_;
+    std::unordered_map<int, uint64_t> deadlines_;  // Live deadline per key
+    uint64_t current_tick_;  // Last tick advance() processed
+    bool started_;
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,106 @@
+#ifndef URING_REACTOR_H
+#define URING_REACTOR_H
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <linux/time_types.h>
+#include "reactor.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+/**
+ * UringReactor - io_uring event loop
+ *
+ * Same role as the epoll Reactor, driven by completions instead of readiness:
+ * one multishot accept on the listener, one multishot recv per connection
+ * that fills kernel-picked buffers from a provided buffer ring, and a
+ * multishot edge-triggered POLLOUT that drains the outbound queue once a
+ * full socket has room again. Outbound frames still leave through the
+ * connection's gathered sendmsg, which workers call directly. A repeating
+ * timeout keeps the loop waking up to check idle deadlines.
+ *
+ * Talks to the kernel through the raw syscalls (no liburing). Needs Linux
+ * 6.0+ for multishot recv; the server checks isSupported() and uses epoll
+ * when it returns false.
+ */
+class UringReactor : public Reactor {
+public:
+    explicit UringReactor(int listen_fd, int cpu = -1);
+    ~UringReactor() override;
+
+    IoBackend getBackend() const override { return IO_BACKEND_URING; }
+
+    // Whether this kernel (and seccomp policy) allows everything the backend uses; probed once
+    static bool isSupported();
+
+protected:
+    bool setup() override;
+    void run() override;
+    bool watch(const std::shared_ptr<ClientConnection>& client) override;
+    void unwatch(int client_fd) override;
+
+private:
+    // Submission helpers; the loop thread is the only submitter
+    io_uring_sqe* nextSqe();
+    int submit(unsigned wait_for);
+    void armAccept();
+    void armWake();
+    void armTick();
+    void armRecv(int client_fd, uint32_t generation);
+    void armPollOut(int client_fd, uint32_t generation);
+    void recycleBuffer(uint16_t buffer_id);
+
+    void handleCompletion(const io_uring_cqe& cqe);
+    void acceptClient(int client_fd);
+    void quiesce();
+    ClientConnection* findClient(int client_fd, uint32_t generation);
+    void teardown();
+
+    static const unsigned RING_ENTRIES = 256;
+    static const unsigned CQ_ENTRIES = 4096;
+    static const unsigned BUFFER_COUNT = 512;   // Provided recv buffers (power of two)
+    static const unsigned BUFFER_BYTES = 4096;
+    static const uint16_t BUFFER_GROUP = 0;
+
+    int ring_fd_;
+
+    // Submission queue
+    void* sq_map_;
+    size_t sq_map_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned pending_;  // SQEs queued since the last submit
+
+    // Completion queue (shares sq_map_ on kernels with a single mmap)
+    void* cq_map_;
+    size_t cq_map_size_;
+    io_uring_cqe* cqes_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+
+    // Provided buffer ring for multishot recv
+    io_uring_buf_ring* buf_ring_;
+    size_t buf_ring_size_;
+    std::vector<char> buffers_;
+    uint16_t buf_tail_;
+    bool buf_ring_registered_;
+
+    uint64_t wake_value_;  // Target of the pending read on wake_fd_
+    __kernel_timespec tick_timeout_;  // Interval of the idle-check timeout
+
+    // Generation of each watched fd; completions tagged with an older one are stale
+    std::unordered_map<int, uint32_t> generations_;
+    uint32_t next_generation_;
+    bool quiescing_;  // Stopping: cancel everything, arm nothing new
+};
+
+#endif // URING_REACTOR_H
@@ -0,0 +1,167 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "buffer_pool.h"
+
+class WorkerPool;
+
+/**
+ * PooledTask - A posted callable, stored in a BufferPool block
+ *
+ * std::function would heap-allocate most handler closures (they capture a
+ * connection, a header and a payload view); this keeps posting free of
+ * heap allocations once the pool is warm.
+ */
+class PooledTask {
+public:
+    template <typename F>
+    static PooledTask* create(F&& fn) {
+        return BufferPool::make<Impl<typename std::decay<F>::type>>(std::forward<F>(fn));
+    }
+
+    virtual void run() = 0;
+    virtual void release() = 0;  // Destroys the task and returns its block
+
+protected:
+    virtual ~PooledTask() {}
+
+private:
+    template <typename F>
+    class Impl;
+};
+
+template <typename F>
+class PooledTask::Impl : public PooledTask {
+public:
+    explicit Impl(F&& fn) : fn_(std::move(fn)) {}
+    explicit Impl(const F& fn) : fn_(fn) {}
+    void run() override { fn_(); }
+    void release() override { BufferPool::destroy(this); }
+
+private:
+    F fn_;
+};
+
+/**
+ * Strand - Ordered task queue
+ *
+ * Tasks posted to the same strand run one at a time in posting order;
+ * different strands run in parallel. The server gives every connection
+ * its own strand so a client's messages are handled in the order sent.
+ */
+class Strand {
+public:
+    Strand() : head_(0), scheduled_(false) {}
+    ~Strand();
+
+    // Tasks waiting on this strand (not counting one that is running)
+    size_t pending() const;
+
+private:
+    friend class WorkerPool;
+
+    struct Task {
+        PooledTask* fn;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    // Tasks before head_ have run; the vector is cleared (keeping its
+    // capacity) once it drains, so a busy strand stops allocating
+    mutable std::mutex mutex_;
+    std::vector<Task> tasks_;
+    size_t head_;
+    bool scheduled_;  // True while queued on or running in a worker
+};
+
+/**
+ * WorkerPool - Fixed-size thread pool for message handling
+ *
+ * Each worker owns a run queue of strands that have work. Strands posted
+ * from outside the pool are spread round-robin; a worker that runs dry
+ * steals from the back of another worker's queue. A strand is on at most
+ * one queue at a time, which is what keeps its tasks ordered.
+ */
+class WorkerPool {
+public:
+    struct Stats {
+        size_t threads;
+        size_t queue_depth;      // Tasks posted but not yet started
+        size_t max_queue_depth;  // High-water mark of queue_depth
+        uint64_t tasks_run;
+        uint64_t steals;         // Strands taken from another worker's queue
+        double avg_wait_us;      // Post-to-start latency
+        uint64_t max_wait_us;
+    };
+
+    // thread_count == 0 uses one worker per hardware thread
+    explicit WorkerPool(size_t thread_count = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Lifecycle; stop() finishes tasks already posted before returning
+    bool start();
+    void stop();
+    bool isRunning() const { return running_; }
+
+    // Queue a task on a strand. If the pool is not running the task runs inline.
+    template <typename F>
+    void post(const std::shared_ptr<Strand>& strand, F&& task) {
+        postTask(strand, PooledTask::create(std::forward<F>(task)));
+    }
+
+    size_t getThreadCount() const { return thread_count_; }
+    Stats getStats() const;
+
+private:
+    // Strands before head are taken; cleared once drained, like Strand::tasks_
+    struct RunQueue {
+        RunQueue() : head(0) {}
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Strand>> strands;
+        size_t head;
+    };
+
+    void postTask(const std::shared_ptr<Strand>& strand, PooledTask* task);
+    static void runTask(PooledTask* task);
+    void workerLoop(size_t index);
+    void schedule(std::shared_ptr<Strand> strand);
+    std::shared_ptr<Strand> takeStrand(size_t index);
+    void runStrand(const std::shared_ptr<Strand>& strand);
+
+    // Tasks run from one strand before it yields its worker to other strands
+    static const size_t STRAND_BATCH = 16;
+
+    size_t thread_count_;
+    std::atomic<bool> running_;
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<RunQueue>> queues_;
+    std::atomic<size_t> next_queue_;
+
+    // Strands sitting in run queues; idle workers sleep until it is non-zero
+    std::atomic<size_t> ready_strands_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+
+    // Statistics
+    std::atomic<size_t> queue_depth_;
+    std::atomic<size_t> max_queue_depth_;
+    std::atomic<uint64_t> tasks_run_;
+    std::atomic<uint64_t> steals_;
+    std::atomic<uint64_t> total_wait_us_;
+    std::atomic<uint64_t> max_wait_us_;
+};
+
+#endif // WORKER_POOL_H
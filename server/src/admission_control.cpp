@@ -0,0 +1,66 @@
+#include "admission_control.h"
+
+const uint32_t AdmissionControl::LOCAL_ADDRESS;
+
+AdmissionControl::AdmissionControl(size_t max_connections, size_t max_per_address, uint32_t retry_base_ms)
+    : max_connections_(max_connections)
+    , max_per_address_(max_per_address)
+    , retry_base_ms_(retry_base_ms)
+    , active_(0)
+    , rng_(std::random_device()())
+    , admitted_(0)
+    , rejected_full_(0)
+    , rejected_address_(0)
+{
+}
+
+AdmissionControl::Verdict AdmissionControl::admit(uint32_t address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (max_connections_ > 0 && active_ >= max_connections_) {
+        rejected_full_++;
+        return REJECT_FULL;
+    }
+
+    size_t& from_address = per_address_[address];
+    if (max_per_address_ > 0 && address != LOCAL_ADDRESS && from_address >= max_per_address_) {
+        rejected_address_++;
+        return REJECT_ADDRESS;
+    }
+
+    from_address++;
+    active_++;
+    admitted_++;
+    return ADMIT;
+}
+
+void AdmissionControl::release(uint32_t address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = per_address_.find(address);
+    if (it == per_address_.end()) {
+        return;
+    }
+    if (--it->second == 0) {
+        per_address_.erase(it);
+    }
+    if (active_ > 0) {
+        active_--;
+    }
+}
+
+uint32_t AdmissionControl::retryAfterMs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uniform_int_distribution<uint32_t> jitter(0, retry_base_ms_);
+    return retry_base_ms_ + jitter(rng_);
+}
+
+AdmissionControl::Stats AdmissionControl::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.active = active_;
+    stats.admitted = admitted_;
+    stats.rejected_full = rejected_full_;
+    stats.rejected_address = rejected_address_;
+    return stats;
+}
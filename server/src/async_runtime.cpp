@@ -0,0 +1,103 @@
+#include "async_runtime.h"
+
+namespace {
+const size_t DEFAULT_BLOCKING_THREADS = 2;
+}
+
+AsyncRuntime::AsyncRuntime()
+    : workers_(nullptr)
+    , db_strand_(std::make_shared<Strand>())
+    , timers_running_(false)
+{
+}
+
+AsyncRuntime::~AsyncRuntime() {
+    stop();
+}
+
+AsyncRuntime* AsyncRuntime::inlineRuntime() {
+    static AsyncRuntime runtime;
+    return &runtime;
+}
+
+bool AsyncRuntime::start(WorkerPool* workers, size_t blocking_threads) {
+    if (workers_.load() || !workers) {
+        return false;
+    }
+
+    blocking_.reset(new WorkerPool(blocking_threads > 0 ? blocking_threads : DEFAULT_BLOCKING_THREADS));
+    if (!blocking_->start()) {
+        blocking_.reset();
+        return false;
+    }
+
+    timers_running_ = true;
+    timer_thread_ = std::thread(&AsyncRuntime::timerLoop, this);
+    workers_ = workers;
+    return true;
+}
+
+void AsyncRuntime::stop() {
+    if (!workers_.exchange(nullptr)) {
+        return;
+    }
+    // Steps started from here on run inline
+
+    // Timers fire early rather than leave their connections suspended
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        timers_running_ = false;
+    }
+    timer_cv_.notify_one();
+    timer_thread_.join();
+
+    // Outstanding steps finish and post their continuations to the workers
+    blocking_->stop();
+}
+
+void AsyncRuntime::finish(const std::shared_ptr<ClientConnection>& conn) {
+    if (!conn->endAsync()) {
+        return;
+    }
+
+    // Messages that arrived meanwhile, until one of them suspends the connection again
+    std::function<void()> task;
+    while (!conn->isSuspended() && conn->takeDeferred(task)) {
+        if (conn->isConnected()) {
+            task();
+        }
+    }
+}
+
+void AsyncRuntime::timerLoop() {
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+    while (true) {
+        if (!timers_running_) {
+            break;
+        }
+        if (timers_.empty()) {
+            timer_cv_.wait(lock);
+            continue;
+        }
+
+        auto first = timers_.begin();
+        if (first->first > std::chrono::steady_clock::now()) {
+            timer_cv_.wait_until(lock, first->first);
+            continue;
+        }
+
+        std::function<void()> fire = std::move(first->second);
+        timers_.erase(first);
+        lock.unlock();
+        fire();
+        lock.lock();
+    }
+
+    // Stopping: everything still waiting fires now
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> pending;
+    pending.swap(timers_);
+    lock.unlock();
+    for (auto& timer : pending) {
+        timer.second();
+    }
+}
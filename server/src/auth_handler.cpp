@@ -3,7 +3,7 @@
 #include "player_manager.h"
 #include "message_serialization.h"
 #include "password_hash.h"
-#include <iostream>
+#include "logger.h"
 #include <sstream>
 #include <iomanip>
 #include <random>
@@ -12,25 +12,22 @@ using namespace MessageSerialization;
 
 AuthHandler::AuthHandler(DatabaseManager* db) : db_(db), server_(nullptr) {
     if (!db_ || !db_->isOpen()) {
-        std::cerr << "[AUTH] ERROR: Invalid or closed database!" << std::endl;
+        LOG_ERROR("AUTH", "Invalid or closed database!");
     }
-    std::cout << "[AUTH] AuthHandler initialized with database" << std::endl;
+    LOG_INFO("AUTH", "AuthHandler initialized with database");
 }
 
 AuthHandler::~AuthHandler() {
 }
 
 bool AuthHandler::canHandle(MessageType type) const {
-    return type == AUTH_LOGIN ||
-           type == AUTH_REGISTER ||
-           type == AUTH_LOGOUT ||
-           type == VALIDATE_SESSION;
+    return MessageSchema::handlesAuth(type);
 }
 
 bool AuthHandler::handleMessage(ClientConnection* client,
                                 const MessageHeader& header,
-                                const std::string& payload) {
-    std::cout << "[AUTH] Handling message type=" << (int)header.type << std::endl;
+                                const PayloadView& payload) {
+    LOG_DEBUG("AUTH", "Handling message type=" << (int)header.type);
 
     switch (header.type) {
         case AUTH_LOGIN:
@@ -46,35 +43,35 @@ bool AuthHandler::handleMessage(ClientConnection* client,
             return handleValidateSession(client, payload);
 
         default:
-            std::cerr << "[AUTH] Unknown message type: " << (int)header.type << std::endl;
+            LOG_WARN("AUTH", "Unknown message type: " << (int)header.type);
             return false;
     }
 }
 
-bool AuthHandler::handleRegister(ClientConnection* client, const std::string& payload) {
+bool AuthHandler::handleRegister(ClientConnection* client, const PayloadView& payload) {
     RegisterRequest req;
     if (!deserialize(payload, req)) {
-        std::cerr << "[AUTH] Failed to deserialize RegisterRequest" << std::endl;
+        LOG_WARN("AUTH", "Failed to deserialize RegisterRequest");
         return false;
     }
 
-    std::cout << "[AUTH] Register request: username=" << req.username
-              << " display_name=" << req.display_name << std::endl;
+    LOG_DEBUG("AUTH", "Register request: username=" << req.username
+            << " display_name=" << req.display_name);
 
     RegisterResponse resp;
 
     if (!db_ || !db_->isOpen()) {
         resp.success = false;
         safeStrCopy(resp.error_message, "Database error", sizeof(resp.error_message));
-        std::cerr << "[AUTH] Database not available" << std::endl;
-        return sendResponse(client, AUTH_RESPONSE, serialize(resp));
+        LOG_ERROR("AUTH", "Database not available");
+        return sendResponse(client, AUTH_RESPONSE, resp);
     }
 
     // Check if username already exists
     if (db_->usernameExists(req.username)) {
         resp.success = false;
         safeStrCopy(resp.error_message, "Username already exists", sizeof(resp.error_message));
-        std::cout << "[AUTH] Registration failed: username exists" << std::endl;
+        LOG_INFO("AUTH", "Registration failed: username exists");
     } else {
         // Hash password before storing
         std::string password_hash = PasswordHash::hashPassword(req.password);
@@ -85,112 +82,129 @@ bool AuthHandler::handleRegister(ClientConnection* client, const std::string& pa
         if (user_id > 0) {
             resp.success = true;
             resp.user_id = user_id;
-            std::cout << "[AUTH] Registration successful: user_id=" << user_id << std::endl;
+            LOG_INFO("AUTH", "Registration successful: user_id=" << user_id);
         } else {
             resp.success = false;
             safeStrCopy(resp.error_message, "Failed to create user", sizeof(resp.error_message));
-            std::cerr << "[AUTH] Database error: " << db_->getLastError() << std::endl;
+            LOG_ERROR("AUTH", "Database error: " << db_->getLastError());
         }
     }
 
     // Send response
-    return sendResponse(client, AUTH_RESPONSE, serialize(resp));
+    return sendResponse(client, AUTH_RESPONSE, resp);
 }
 
-bool AuthHandler::handleLogin(ClientConnection* client, const std::string& payload) {
+bool AuthHandler::handleLogin(ClientConnection* client, const PayloadView& payload) {
     LoginRequest req;
     if (!deserialize(payload, req)) {
-        std::cerr << "[AUTH] Failed to deserialize LoginRequest" << std::endl;
+        LOG_WARN("AUTH", "Failed to deserialize LoginRequest");
         return false;
     }
 
-    std::cout << "[AUTH] Login request: username=" << req.username << std::endl;
-
-    LoginResponse resp;
+    LOG_DEBUG("AUTH", "Login request: username=" << req.username);
 
     if (!db_ || !db_->isOpen()) {
+        LoginResponse resp;
         resp.success = false;
         safeStrCopy(resp.error_message, "Database error", sizeof(resp.error_message));
-        std::cerr << "[AUTH] Database not available" << std::endl;
-        return sendResponse(client, AUTH_RESPONSE, serialize(resp));
+        LOG_ERROR("AUTH", "Database not available");
+        return sendResponse(client, AUTH_RESPONSE, resp);
     }
 
-    // Get user from database
-    User user = db_->getUserByUsername(req.username);
-
-    if (user.user_id == 0) {
-        // User not found
-        resp.success = false;
-        safeStrCopy(resp.error_message, "User not found", sizeof(resp.error_message));
-        std::cout << "[AUTH] Login failed: user not found" << std::endl;
-    } else if (!PasswordHash::verifyPassword(req.password, user.password_hash)) {
-        // Wrong password
-        resp.success = false;
-        safeStrCopy(resp.error_message, "Invalid password", sizeof(resp.error_message));
-        std::cout << "[AUTH] Login failed: invalid password" << std::endl;
-    } else {
-        // Success!
-        resp.success = true;
-        resp.user_id = user.user_id;
-        resp.elo_rating = user.elo_rating;
-        safeStrCopy(resp.display_name, user.display_name, sizeof(resp.display_name));
-
-        // Generate session token
-        std::string token = generateSessionToken(user.user_id);
-        safeStrCopy(resp.session_token, token, sizeof(resp.session_token));
-
-        // Create session in database (24 hour expiration)
-        uint32_t session_id = db_->createSession(user.user_id, token, 24);
+    // Each database step runs off the worker thread; the rest resumes on this client's strand
+    std::shared_ptr<ClientConnection> conn = client->shared_from_this();
+    DatabaseManager* db = db_;
+    std::string username = req.username;
+    std::string password = req.password;
 
-        if (session_id > 0) {
-            // Update last login timestamp
-            db_->updateLastLogin(user.user_id);
+    async_->query(conn, [db, username]() { return db->getUserByUsername(username); },
+                  [this, conn, db, password](const User& user) {
+        LoginResponse resp;
 
-            // Mark client as authenticated
-            client->setAuthenticated(user.user_id, token);
-
-            std::cout << "[AUTH] Login successful: user_id=" << user.user_id
-                      << " session_id=" << session_id << std::endl;
-        } else {
-            // Failed to create session
+        if (user.user_id == 0) {
+            // User not found
             resp.success = false;
-            safeStrCopy(resp.error_message, "Failed to create session", sizeof(resp.error_message));
-            std::cerr << "[AUTH] Failed to create session: " << db_->getLastError() << std::endl;
+            safeStrCopy(resp.error_message, "User not found", sizeof(resp.error_message));
+            LOG_INFO("AUTH", "Login failed: user not found");
+            sendResponse(conn.get(), AUTH_RESPONSE, resp);
+            return;
+        }
+        if (!PasswordHash::verifyPassword(password, user.password_hash)) {
+            // Wrong password
+            resp.success = false;
+            safeStrCopy(resp.error_message, "Invalid password", sizeof(resp.error_message));
+            LOG_INFO("AUTH", "Login failed: invalid password");
+            sendResponse(conn.get(), AUTH_RESPONSE, resp);
+            return;
         }
-    }
 
-    // Send response FIRST (before broadcasting)
-    bool result = sendResponse(client, AUTH_RESPONSE, serialize(resp));
+        // Create session in database (24 hour expiration) and update last login timestamp
+        std::string token = generateSessionToken(user.user_id);
+        async_->query(conn, [db, user, token]() {
+            uint32_t session_id = db->createSession(user.user_id, token, 24);
+            if (session_id > 0) {
+                db->updateLastLogin(user.user_id);
+            } else {
+                LOG_ERROR("AUTH", "Failed to create session: " << db->getLastError());
+            }
+            return session_id;
+        }, [this, conn, user, token](uint32_t session_id) {
+            LoginResponse resp;
+            if (session_id == 0) {
+                // Failed to create session
+                resp.success = false;
+                safeStrCopy(resp.error_message, "Failed to create session", sizeof(resp.error_message));
+                sendResponse(conn.get(), AUTH_RESPONSE, resp);
+                return;
+            }
 
-    // Register player with PlayerManager AFTER sending response (to avoid race condition)
-    if (resp.success && server_ && server_->getPlayerManager()) {
-        server_->getPlayerManager()->addPlayer(
-            client,
-            resp.user_id,
-            user.username,
-            user.display_name,
-            resp.elo_rating
-        );
-    }
+            // Success!
+            resp.success = true;
+            resp.user_id = user.user_id;
+            resp.elo_rating = user.elo_rating;
+            safeStrCopy(resp.display_name, user.display_name, sizeof(resp.display_name));
+            safeStrCopy(resp.session_token, token, sizeof(resp.session_token));
 
-    return result;
+            // Mark client as authenticated
+            conn->setAuthenticated(user.user_id, token);
+
+            LOG_INFO("AUTH", "Login successful: user_id=" << user.user_id
+                    << " session_id=" << session_id);
+
+            // Send response FIRST (before broadcasting)
+            sendResponse(conn.get(), AUTH_RESPONSE, resp);
+
+            // Register player with PlayerManager AFTER sending response (to avoid race condition)
+            if (server_ && server_->getPlayerManager()) {
+                server_->getPlayerManager()->addPlayer(
+                    conn.get(),
+                    resp.user_id,
+                    user.username,
+                    user.display_name,
+                    resp.elo_rating
+                );
+            }
+        });
+    });
+
+    return true;
 }
 
-bool AuthHandler::handleLogout(ClientConnection* client, const std::string& payload) {
+bool AuthHandler::handleLogout(ClientConnection* client, const PayloadView& payload) {
     LogoutRequest req;
     if (!deserialize(payload, req)) {
-        std::cerr << "[AUTH] Failed to deserialize LogoutRequest" << std::endl;
+        LOG_WARN("AUTH", "Failed to deserialize LogoutRequest");
         return false;
     }
 
-    std::cout << "[AUTH] Logout request: token=" << req.session_token << std::endl;
+    LOG_DEBUG("AUTH", "Logout request: token=" << req.session_token);
 
     LogoutResponse resp;
 
     if (!db_ || !db_->isOpen()) {
         resp.success = false;
-        std::cerr << "[AUTH] Database not available" << std::endl;
-        return sendResponse(client, AUTH_RESPONSE, serialize(resp));
+        LOG_ERROR("AUTH", "Database not available");
+        return sendResponse(client, AUTH_RESPONSE, resp);
     }
 
     // Get user_id from session token (more reliable than client object)
@@ -201,7 +215,7 @@ bool AuthHandler::handleLogout(ClientConnection* client, const std::string& payl
         user_id = client->getUserId();
     }
 
-    std::cout << "[AUTH] Logout for user_id=" << user_id << std::endl;
+    LOG_DEBUG("AUTH", "Logout for user_id=" << user_id);
 
     // Delete session from database
     bool deleted = db_->deleteSession(req.session_token);
@@ -214,7 +228,7 @@ bool AuthHandler::handleLogout(ClientConnection* client, const std::string& payl
             server_->getPlayerManager()->removePlayer(user_id);
         }
 
-        std::cout << "[AUTH] Logout successful" << std::endl;
+        LOG_INFO("AUTH", "Logout successful");
     } else {
         // Session might not exist, but that's OK for logout
         resp.success = true;
@@ -224,29 +238,29 @@ bool AuthHandler::handleLogout(ClientConnection* client, const std::string& payl
             server_->getPlayerManager()->removePlayer(user_id);
         }
 
-        std::cout << "[AUTH] Logout: session not found (already logged out?)" << std::endl;
+        LOG_INFO("AUTH", "Logout: session not found (already logged out?)");
     }
 
     // Send response
-    return sendResponse(client, AUTH_RESPONSE, serialize(resp));
+    return sendResponse(client, AUTH_RESPONSE, resp);
 }
 
-bool AuthHandler::handleValidateSession(ClientConnection* client, const std::string& payload) {
+bool AuthHandler::handleValidateSession(ClientConnection* client, const PayloadView& payload) {
     SessionValidateRequest req;
     if (!deserialize(payload, req)) {
-        std::cerr << "[AUTH] Failed to deserialize SessionValidateRequest" << std::endl;
+        LOG_WARN("AUTH", "Failed to deserialize SessionValidateRequest");
         return false;
     }
 
-    std::cout << "[AUTH] Validate session request: token=" << req.session_token << std::endl;
+    LOG_DEBUG("AUTH", "Validate session request: token=" << req.session_token);
 
     SessionValidateResponse resp;
 
     if (!db_ || !db_->isOpen()) {
         resp.valid = false;
         safeStrCopy(resp.error_message, "Database error", sizeof(resp.error_message));
-        std::cerr << "[AUTH] Database not available" << std::endl;
-        return sendResponse(client, AUTH_RESPONSE, serialize(resp));
+        LOG_ERROR("AUTH", "Database not available");
+        return sendResponse(client, AUTH_RESPONSE, resp);
     }
 
     // Validate session token
@@ -256,7 +270,7 @@ bool AuthHandler::handleValidateSession(ClientConnection* client, const std::str
         // Session invalid or expired
         resp.valid = false;
         safeStrCopy(resp.error_message, "Session expired or invalid", sizeof(resp.error_message));
-        std::cout << "[AUTH] Session validation failed: token not found or expired" << std::endl;
+        LOG_INFO("AUTH", "Session validation failed: token not found or expired");
     } else {
         // Session valid! Get user info
         User user = db_->getUserById(user_id);
@@ -265,7 +279,7 @@ bool AuthHandler::handleValidateSession(ClientConnection* client, const std::str
             // User not found (should not happen)
             resp.valid = false;
             safeStrCopy(resp.error_message, "User not found", sizeof(resp.error_message));
-            std::cerr << "[AUTH] User not found for valid session, user_id=" << user_id << std::endl;
+            LOG_ERROR("AUTH", "User not found for valid session, user_id=" << user_id);
         } else {
             // Success!
             resp.valid = true;
@@ -277,13 +291,13 @@ bool AuthHandler::handleValidateSession(ClientConnection* client, const std::str
             // Mark client as authenticated
             client->setAuthenticated(user_id, req.session_token);
 
-            std::cout << "[AUTH] Session validation successful: user_id=" << user_id
-                      << " username=" << user.username << std::endl;
+            LOG_INFO("AUTH", "Session validation successful: user_id=" << user_id
+                    << " username=" << user.username);
         }
     }
 
     // Send response FIRST (before broadcasting)
-    bool result = sendResponse(client, AUTH_RESPONSE, serialize(resp));
+    bool result = sendResponse(client, AUTH_RESPONSE, resp);
 
     // Register player with PlayerManager AFTER sending response (to avoid race condition)
     if (resp.valid && server_ && server_->getPlayerManager()) {
@@ -0,0 +1,102 @@
+#include "buffer_pool.h"
+#include <mutex>
+#include <atomic>
+
+const size_t BufferPool::MIN_BLOCK;
+const size_t BufferPool::MAX_BLOCK;
+
+namespace {
+
+const size_t SLAB_BYTES = 64 * 1024;
+const size_t CLASS_COUNT = 9;  // 64 .. 16384
+
+// Free blocks are linked through their own first bytes
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct SizeClass {
+    std::mutex mutex;
+    FreeBlock* free_list;
+};
+
+// Constant-initialized, so usable from any static constructor or destructor
+SizeClass classes[CLASS_COUNT];
+std::atomic<uint64_t> blocks_in_use(0);
+std::atomic<uint64_t> slab_bytes(0);
+std::atomic<uint64_t> oversize(0);
+
+size_t classIndex(size_t size) {
+    size_t index = 0;
+    size_t block = BufferPool::MIN_BLOCK;
+    while (block < size) {
+        block <<= 1;
+        index++;
+    }
+    return index;
+}
+
+// Carves a fresh slab into blocks; called with the class mutex held
+void refill(SizeClass& size_class, size_t block_size) {
+    char* slab = static_cast<char*>(::operator new(SLAB_BYTES));
+    slab_bytes += SLAB_BYTES;
+    for (size_t offset = 0; offset + block_size <= SLAB_BYTES; offset += block_size) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + offset);
+        block->next = size_class.free_list;
+        size_class.free_list = block;
+    }
+}
+
+}  // namespace
+
+void* BufferPool::allocate(size_t size) {
+    if (size > MAX_BLOCK) {
+        oversize++;
+        return ::operator new(size);
+    }
+
+    size_t index = classIndex(size);
+    SizeClass& size_class = classes[index];
+    FreeBlock* block;
+    {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!size_class.free_list) {
+            refill(size_class, MIN_BLOCK << index);
+        }
+        block = size_class.free_list;
+        size_class.free_list = block->next;
+    }
+    blocks_in_use++;
+    return block;
+}
+
+void BufferPool::deallocate(void* block, size_t size) {
+    if (!block) {
+        return;
+    }
+    if (size > MAX_BLOCK) {
+        ::operator delete(block);
+        return;
+    }
+
+    SizeClass& size_class = classes[classIndex(size)];
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        freed->next = size_class.free_list;
+        size_class.free_list = freed;
+    }
+    blocks_in_use--;
+}
+
+size_t BufferPool::blockSize(size_t size) {
+    return size > MAX_BLOCK ? size : MIN_BLOCK << classIndex(size);
+}
+
+BufferPool::Stats BufferPool::getStats() {
+    Stats stats;
+    stats.blocks_in_use = blocks_in_use;
+    stats.slab_bytes = slab_bytes;
+    stats.oversize = oversize;
+    return stats;
+}
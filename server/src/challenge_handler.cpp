@@ -4,23 +4,23 @@
 #include "client_connection.h"
 #include "message_serialization.h"
 #include "messages/matchmaking_messages.h"
-#include <iostream>
+#include "logger.h"
 
 using namespace MessageSerialization;
 
 ChallengeHandler::ChallengeHandler(Server* server, ChallengeManager* challenge_manager)
     : server_(server), challenge_manager_(challenge_manager) {
-    std::cout << "[CHALLENGE_HANDLER] Initialized" << std::endl;
+    LOG_INFO("CHALLENGE_HANDLER", "Initialized");
 }
 
 bool ChallengeHandler::canHandle(MessageType type) const {
-    return type == CHALLENGE_SEND || type == CHALLENGE_RESPONSE;
+    return MessageSchema::handlesChallenge(type);
 }
 
 bool ChallengeHandler::handleMessage(ClientConnection* client,
                                     const MessageHeader& header,
-                                    const std::string& payload) {
-    std::cout << "[CHALLENGE_HANDLER] Handling message type=" << static_cast<int>(header.type) << std::endl;
+                                    const PayloadView& payload) {
+    LOG_DEBUG("CHALLENGE_HANDLER", "Handling message type=" << static_cast<int>(header.type));
 
     MessageType type = static_cast<MessageType>(header.type);
 
@@ -32,15 +32,15 @@ bool ChallengeHandler::handleMessage(ClientConnection* client,
             return handleChallengeResponse(client, payload);
 
         default:
-            std::cerr << "[CHALLENGE_HANDLER] Unknown message type: " << static_cast<int>(header.type) << std::endl;
+            LOG_WARN("CHALLENGE_HANDLER", "Unknown message type: " << static_cast<int>(header.type));
             return false;
     }
 }
 
-bool ChallengeHandler::handleChallengeSend(ClientConnection* client, const std::string& payload) {
+bool ChallengeHandler::handleChallengeSend(ClientConnection* client, const PayloadView& payload) {
     // Check if client is authenticated
     if (!client->isAuthenticated()) {
-        std::cerr << "[CHALLENGE_HANDLER] Client not authenticated" << std::endl;
+        LOG_WARN("CHALLENGE_HANDLER", "Client not authenticated");
         return false;
     }
 
@@ -49,21 +49,21 @@ bool ChallengeHandler::handleChallengeSend(ClientConnection* client, const std::
     // Deserialize challenge request
     ChallengeRequest request;
     if (!deserialize(payload, request)) {
-        std::cerr << "[CHALLENGE_HANDLER] Failed to deserialize ChallengeRequest" << std::endl;
+        LOG_ERROR("CHALLENGE_HANDLER", "Failed to deserialize ChallengeRequest");
         return false;
     }
 
-    std::cout << "[CHALLENGE_HANDLER] Challenge send: user " << challenger_id
-              << " -> user " << request.target_user_id << std::endl;
+    LOG_DEBUG("CHALLENGE_HANDLER", "Challenge send: user " << challenger_id
+            << " -> user " << request.target_user_id);
 
     // Send challenge through ChallengeManager
     return challenge_manager_->sendChallenge(challenger_id, request);
 }
 
-bool ChallengeHandler::handleChallengeResponse(ClientConnection* client, const std::string& payload) {
+bool ChallengeHandler::handleChallengeResponse(ClientConnection* client, const PayloadView& payload) {
     // Check if client is authenticated
     if (!client->isAuthenticated()) {
-        std::cerr << "[CHALLENGE_HANDLER] Client not authenticated" << std::endl;
+        LOG_WARN("CHALLENGE_HANDLER", "Client not authenticated");
         return false;
     }
 
@@ -72,13 +72,13 @@ bool ChallengeHandler::handleChallengeResponse(ClientConnection* client, const s
     // Deserialize challenge response
     ChallengeResponse response;
     if (!deserialize(payload, response)) {
-        std::cerr << "[CHALLENGE_HANDLER] Failed to deserialize ChallengeResponse" << std::endl;
+        LOG_ERROR("CHALLENGE_HANDLER", "Failed to deserialize ChallengeResponse");
         return false;
     }
 
-    std::cout << "[CHALLENGE_HANDLER] Challenge response: challenge_id=" << response.challenge_id
-              << " accepted=" << response.accepted
-              << " from user " << responder_id << std::endl;
+    LOG_DEBUG("CHALLENGE_HANDLER", "Challenge response: challenge_id=" << response.challenge_id
+            << " accepted=" << response.accepted
+            << " from user " << responder_id);
 
     // Respond to challenge through ChallengeManager
     return challenge_manager_->respondToChallenge(responder_id, response);
@@ -4,14 +4,14 @@
 #include "client_connection.h"
 #include "database.h"
 #include "message_serialization.h"
-#include <iostream>
+#include "logger.h"
 #include <cstring>
 
 using namespace MessageSerialization;
 
 ChallengeManager::ChallengeManager(Server* server, PlayerManager* player_manager)
     : server_(server), player_manager_(player_manager), next_challenge_id_(1) {
-    std::cout << "[CHALLENGE_MANAGER] Initialized" << std::endl;
+    LOG_INFO("CHALLENGE_MANAGER", "Initialized");
 }
 
 ChallengeManager::~ChallengeManager() {
@@ -24,19 +24,14 @@ bool ChallengeManager::sendChallenge(uint32_t challenger_id, const ChallengeRequ
 
     // Validate challenge
     if (!validateChallenge(challenger_id, request.target_user_id, error)) {
-        std::cerr << "[CHALLENGE] Validation failed: " << error << std::endl;
+        LOG_WARN("CHALLENGE", "Validation failed: " << error);
 
         // Send error to challenger
         ChallengeResult result;
         result.success = false;
         safeStrCopy(result.error_message, error, sizeof(result.error_message));
 
-        ClientConnection* challenger = player_manager_->getClientConnection(challenger_id);
-        if (challenger) {
-            MessageHeader header;
-            header.type = CHALLENGE_RESPONSE;
-            challenger->sendMessage(header, serialize(result));
-        }
+        player_manager_->sendToPlayer(challenger_id, MessageBuffer::create<CHALLENGE_RESPONSE>(result));
 
         return false;
     }
@@ -59,9 +54,9 @@ bool ChallengeManager::sendChallenge(uint32_t challenger_id, const ChallengeRequ
         challenges_[challenge.challenge_id] = challenge;
     }
 
-    std::cout << "[CHALLENGE] Challenge #" << challenge.challenge_id
-              << " sent from user " << challenger_id
-              << " to user " << request.target_user_id << std::endl;
+    LOG_INFO("CHALLENGE", "Challenge #" << challenge.challenge_id
+            << " sent from user " << challenger_id
+            << " to user " << request.target_user_id);
 
     // Notify target player
     notifyTarget(challenge);
@@ -83,8 +78,8 @@ bool ChallengeManager::respondToChallenge(uint32_t responder_id, const Challenge
 
             // Validate responder is the target
             if (challenge.target_id != responder_id) {
-                std::cerr << "[CHALLENGE] Invalid responder: expected "
-                          << challenge.target_id << ", got " << responder_id << std::endl;
+                LOG_WARN("CHALLENGE", "Invalid responder: expected "
+                        << challenge.target_id << ", got " << responder_id);
                 return false;
             }
 
@@ -94,8 +89,8 @@ bool ChallengeManager::respondToChallenge(uint32_t responder_id, const Challenge
     }
 
     if (!found) {
-        std::cout << "[CHALLENGE] Challenge " << response.challenge_id
-                  << " not found (possibly cancelled or expired)" << std::endl;
+        LOG_INFO("CHALLENGE", "Challenge " << response.challenge_id
+                << " not found (possibly cancelled or expired)");
 
         // Notify responder
         ChallengeResult result;
@@ -103,19 +98,14 @@ bool ChallengeManager::respondToChallenge(uint32_t responder_id, const Challenge
         result.success = false;
         safeStrCopy(result.error_message, "Challenge not found or expired", sizeof(result.error_message));
 
-        ClientConnection* responder = player_manager_->getClientConnection(responder_id);
-        if (responder) {
-            MessageHeader header;
-            header.type = CHALLENGE_RESPONSE;
-            responder->sendMessage(header, serialize(result));
-        }
+        player_manager_->sendToPlayer(responder_id, MessageBuffer::create<CHALLENGE_RESPONSE>(result));
 
         return false;
     }
 
-    std::cout << "[CHALLENGE] Challenge #" << challenge.challenge_id
-              << " " << (response.accepted ? "ACCEPTED" : "DECLINED")
-              << " by user " << responder_id << std::endl;
+    LOG_INFO("CHALLENGE", "Challenge #" << challenge.challenge_id
+            << " " << (response.accepted ? "ACCEPTED" : "DECLINED")
+            << " by user " << responder_id);
 
     if (response.accepted) {
         // Create match
@@ -135,17 +125,8 @@ bool ChallengeManager::respondToChallenge(uint32_t responder_id, const Challenge
             match_msg_challenger.time_limit = challenge.time_limit;
             match_msg_challenger.you_go_first = true;  // Challenger goes first
 
-            ClientConnection* challenger = player_manager_->getClientConnection(challenge.challenger_id);
-            if (challenger) {
-                MessageHeader header;
-                memset(&header, 0, sizeof(header));
-                header.type = MATCH_START;
-                header.length = sizeof(match_msg_challenger);
-                header.timestamp = time(nullptr);
-
-                std::string payload = serialize(match_msg_challenger);
-                challenger->sendMessage(header, payload);
-                std::cout << "[CHALLENGE] Sent MATCH_START to challenger (user_id=" << challenge.challenger_id << ")" << std::endl;
+            if (player_manager_->sendToPlayer(challenge.challenger_id, MessageBuffer::create<MATCH_START>(match_msg_challenger))) {
+                LOG_DEBUG("CHALLENGE", "Sent MATCH_START to challenger (user_id=" << challenge.challenger_id << ")");
             }
 
             // Send to target
@@ -157,24 +138,15 @@ bool ChallengeManager::respondToChallenge(uint32_t responder_id, const Challenge
             match_msg_target.time_limit = challenge.time_limit;
             match_msg_target.you_go_first = false;  // Target goes second
 
-            ClientConnection* target = player_manager_->getClientConnection(challenge.target_id);
-            if (target) {
-                MessageHeader header;
-                memset(&header, 0, sizeof(header));
-                header.type = MATCH_START;
-                header.length = sizeof(match_msg_target);
-                header.timestamp = time(nullptr);
-
-                std::string payload = serialize(match_msg_target);
-                target->sendMessage(header, payload);
-                std::cout << "[CHALLENGE] Sent MATCH_START to target (user_id=" << challenge.target_id << ")" << std::endl;
+            if (player_manager_->sendToPlayer(challenge.target_id, MessageBuffer::create<MATCH_START>(match_msg_target))) {
+                LOG_DEBUG("CHALLENGE", "Sent MATCH_START to target (user_id=" << challenge.target_id << ")");
             }
 
             // Update player statuses to IN_GAME
             player_manager_->updatePlayerStatus(challenge.challenger_id, STATUS_IN_GAME);
             player_manager_->updatePlayerStatus(challenge.target_id, STATUS_IN_GAME);
 
-            std::cout << "[CHALLENGE] Match #" << match_id << " created successfully" << std::endl;
+            LOG_INFO("CHALLENGE", "Match #" << match_id << " created successfully");
         } else {
             notifyChallenger(challenge, false, "Failed to create match");
         }
@@ -189,7 +161,7 @@ bool ChallengeManager::respondToChallenge(uint32_t responder_id, const Challenge
 void ChallengeManager::cancelChallenge(uint32_t challenge_id) {
     std::lock_guard<std::mutex> lock(mutex_);
     challenges_.erase(challenge_id);
-    std::cout << "[CHALLENGE] Challenge #" << challenge_id << " cancelled" << std::endl;
+    LOG_INFO("CHALLENGE", "Challenge #" << challenge_id << " cancelled");
 }
 
 void ChallengeManager::checkExpiredChallenges() {
@@ -212,7 +184,7 @@ void ChallengeManager::checkExpiredChallenges() {
 
     // Notify players of expired challenges
     for (const auto& challenge : expired) {
-        std::cout << "[CHALLENGE] Challenge #" << challenge.challenge_id << " expired" << std::endl;
+        LOG_INFO("CHALLENGE", "Challenge #" << challenge.challenge_id << " expired");
         notifyChallenger(challenge, false, "Challenge timed out");
 
         // Notify target as well
@@ -221,12 +193,7 @@ void ChallengeManager::checkExpiredChallenges() {
         result.success = false;
         safeStrCopy(result.error_message, "Challenge timed out", sizeof(result.error_message));
 
-        ClientConnection* target = player_manager_->getClientConnection(challenge.target_id);
-        if (target) {
-            MessageHeader header;
-            header.type = CHALLENGE_RESPONSE;
-            target->sendMessage(header, serialize(result));
-        }
+        player_manager_->sendToPlayer(challenge.target_id, MessageBuffer::create<CHALLENGE_RESPONSE>(result));
     }
 }
 
@@ -248,8 +215,8 @@ void ChallengeManager::removePlayerChallenges(uint32_t user_id) {
     }
 
     if (!to_remove.empty()) {
-        std::cout << "[CHALLENGE] Removed " << to_remove.size()
-                  << " challenges for user " << user_id << std::endl;
+        LOG_INFO("CHALLENGE", "Removed " << to_remove.size()
+                << " challenges for user " << user_id);
     }
 }
 
@@ -291,7 +258,7 @@ bool ChallengeManager::validateChallenge(uint32_t challenger_id, uint32_t target
 
 uint32_t ChallengeManager::createMatch(const PendingChallenge& challenge) {
     if (!server_ || !server_->getDatabase()) {
-        std::cerr << "[CHALLENGE] No database available" << std::endl;
+        LOG_ERROR("CHALLENGE", "No database available");
         return 0;
     }
 
@@ -301,7 +268,7 @@ uint32_t ChallengeManager::createMatch(const PendingChallenge& challenge) {
     uint32_t match_id = db->createMatch(challenge.challenger_id, challenge.target_id);
 
     if (match_id == 0) {
-        std::cerr << "[CHALLENGE] Failed to create match in database: " << db->getLastError() << std::endl;
+        LOG_ERROR("CHALLENGE", "Failed to create match in database: " << db->getLastError());
         return 0;
     }
 
@@ -317,17 +284,7 @@ void ChallengeManager::notifyChallenger(const PendingChallenge& challenge, bool
         safeStrCopy(result.error_message, error, sizeof(result.error_message));
     }
 
-    ClientConnection* challenger = player_manager_->getClientConnection(challenge.challenger_id);
-    if (challenger) {
-        MessageHeader header;
-        memset(&header, 0, sizeof(header));
-        header.type = CHALLENGE_RESPONSE;
-        header.length = sizeof(result);
-        header.timestamp = time(nullptr);
-
-        std::string payload = serialize(result);
-        challenger->sendMessage(header, payload);
-    }
+    player_manager_->sendToPlayer(challenge.challenger_id, MessageBuffer::create<CHALLENGE_RESPONSE>(result));
 }
 
 void ChallengeManager::notifyTarget(const PendingChallenge& challenge) {
@@ -342,20 +299,9 @@ void ChallengeManager::notifyTarget(const PendingChallenge& challenge) {
     msg.random_placement = challenge.random_placement;
     msg.expires_at = challenge.expires_at;
 
-    ClientConnection* target = player_manager_->getClientConnection(challenge.target_id);
-    std::cout << "[CHALLENGE] notifyTarget: target_id=" << challenge.target_id
-              << ", target=" << (void*)target << std::endl;
-    if (target) {
-        MessageHeader header;
-        memset(&header, 0, sizeof(header));
-        header.type = CHALLENGE_RECEIVED;
-        header.length = sizeof(msg);
-        header.timestamp = time(nullptr);
-
-        std::string payload = serialize(msg);
-        std::cout << "[CHALLENGE] Sending CHALLENGE_RECEIVED to target (payload size=" << payload.size() << ")" << std::endl;
-        target->sendMessage(header, payload);
-    } else {
-        std::cerr << "[CHALLENGE] Target client not found: user_id=" << challenge.target_id << std::endl;
+    LOG_DEBUG("CHALLENGE", "notifyTarget: target_id=" << challenge.target_id
+            << " (payload size=" << sizeof(msg) << ")");
+    if (!player_manager_->sendToPlayer(challenge.target_id, MessageBuffer::create<CHALLENGE_RECEIVED>(msg))) {
+        LOG_WARN("CHALLENGE", "Target client not found: user_id=" << challenge.target_id);
     }
 }
@@ -1,21 +1,148 @@
 #include "client_connection.h"
-#include <iostream>
+#include "config.h"
+#include "timer_wheel.h"
+#include "logger.h"
 #include <cstring>
+#include <algorithm>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
 
+namespace {
+// Outermost SendBatch on this thread
+thread_local ClientConnection::SendBatch* current_batch = nullptr;
+
+// Client list of the last finished batch, kept so the next one reuses its capacity
+thread_local std::vector<std::shared_ptr<ClientConnection>> spare_batch_clients;
+
+// Frames handed to one sendmsg call
+const int MAX_IOVECS = 64;
+
+// Outbound queue settings shared by all connections
+std::atomic<size_t> outbound_limit(OUTBOUND_QUEUE_LIMIT);
+std::atomic<int> overflow_policy(ClientConnection::OVERFLOW_DROP_LOBBY);
+
+std::atomic<uint64_t> total_queued_bytes(0);
+std::atomic<uint64_t> total_frames_dropped(0);
+std::atomic<uint64_t> total_frames_coalesced(0);
+std::atomic<uint64_t> total_evictions(0);
+
+// Lobby presence: safe to lose under pressure, the next update supersedes it
+bool isLobbyUpdate(uint8_t type) {
+    return type == PLAYER_STATUS_UPDATE;
+}
+
+// User a presence update is about; a newer update for the same user replaces a queued one
+bool presenceKey(const MessageBuffer& message, uint32_t& user_id) {
+    if (message.type() != PLAYER_STATUS_UPDATE || message.payloadSize() < sizeof(uint32_t)) {
+        return false;
+    }
+    memcpy(&user_id, message.payload(), sizeof(user_id));
+    return true;
+}
+}
+
+ClientConnection::SendBatch::SendBatch()
+    : owner_(current_batch == nullptr)
+{
+    if (owner_) {
+        current_batch = this;
+        clients_.swap(spare_batch_clients);
+    }
+}
+
+ClientConnection::SendBatch::~SendBatch() {
+    if (owner_) {
+        flush();
+        current_batch = nullptr;
+        spare_batch_clients.swap(clients_);
+    }
+}
+
+ClientConnection::SendBatch* ClientConnection::SendBatch::current() {
+    return current_batch;
+}
+
+// Called with client's send_mutex_ held
+void ClientConnection::SendBatch::add(std::shared_ptr<ClientConnection> client) {
+    if (client->batch_ == this) {
+        return;
+    }
+    client->batch_ = this;
+    clients_.push_back(std::move(client));
+}
+
+void ClientConnection::SendBatch::flush() {
+    for (auto& client : clients_) {
+        client->flushFromBatch(this);
+    }
+    clients_.clear();
+    frames_.clear();
+}
+
+SharedMessage ClientConnection::SendBatch::batchFrame(const std::vector<SharedMessage>& parts) {
+    std::vector<const MessageBuffer*> key;
+    key.reserve(parts.size());
+    for (const auto& part : parts) {
+        key.push_back(part.get());
+    }
+
+    auto found = frames_.find(key);
+    if (found != frames_.end()) {
+        return found->second.second;
+    }
+    SharedMessage frame = MessageBuffer::batch(parts);
+    frames_.emplace(std::move(key), std::make_pair(parts, frame));
+    return frame;
+}
+
 ClientConnection::ClientConnection(int socket_fd)
     : socket_fd_(socket_fd)
     , connected_(true)
     , authenticated_(false)
+    , wire_version_(WIRE_UNKNOWN)
+    , capabilities_(0)
+    , partial_offset_(0)
+    , queued_bytes_(0)
+    , held_size_(0)
+    , batch_(nullptr)
+    , read_buffer_(newReadBlock(BUFFER_SIZE))
+    , read_start_(0)
+    , read_end_(0)
+    , peer_address_(0)
     , user_id_(0)
     , bytes_sent_(0)
     , bytes_received_(0)
+    , send_calls_(0)
+    , frames_dropped_(0)
+    , frames_coalesced_(0)
+    , last_activity_ms_(steadyMillis())
+    , async_steps_(0)
 {
 }
 
 ClientConnection::~ClientConnection() {
     disconnect();
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+    total_queued_bytes -= queued_bytes_;
+}
+
+void ClientConnection::setOutboundLimit(size_t max_bytes, OverflowPolicy policy) {
+    outbound_limit = max_bytes;
+    overflow_policy = policy;
+}
+
+ClientConnection::OutboundStats ClientConnection::getOutboundStats() {
+    OutboundStats stats;
+    stats.queued_bytes = total_queued_bytes;
+    stats.frames_dropped = total_frames_dropped;
+    stats.frames_coalesced = total_frames_coalesced;
+    stats.evictions = total_evictions;
+    return stats;
 }
 
 bool ClientConnection::sendMessage(const MessageHeader& header, const std::string& payload) {
@@ -23,107 +150,352 @@ bool ClientConnection::sendMessage(const MessageHeader& header, const std::strin
         return false;
     }
 
-    // Send header
-    if (!sendData(&header, sizeof(MessageHeader))) {
+    size_t payload_size = (header.length > 0 && !payload.empty()) ? header.length : 0;
+    if (payload_size > payload.size()) {
+        LOG_ERROR("CONNECTION", "Header length " << header.length << " exceeds payload ("
+                << payload.size() << " bytes), not sending");
         return false;
     }
+    return sendMessage(MessageBuffer::create(header, payload.data(), payload_size));
+}
+
+bool ClientConnection::sendMessage(const SharedMessage& message) {
+    if (!connected_ || !message) {
+        return false;
+    }
+
+    SendBatch* batch = SendBatch::current();
+
+    std::lock_guard<std::mutex> lock(send_mutex_);
 
-    // Send payload if present
-    if (header.length > 0 && !payload.empty()) {
-        if (!sendData(payload.data(), header.length)) {
+    // Inside a batch, a v2 client's messages are held for one BATCH frame
+    if (batch && wire_version_ == WIRE_V2 && message->batchable()) {
+        size_t batched_size = MessageBuffer::batchedSize(*message);
+        if (held_size_ + batched_size > MAX_MESSAGE_SIZE && !releaseHeldLocked()) {
             return false;
         }
+        if (held_.empty()) {
+            batch->add(shared_from_this());
+        }
+
+        // A newer presence update replaces a held one for the same user, as in the queue
+        uint32_t user_id;
+        if (presenceKey(*message, user_id)) {
+            for (auto& held : held_) {
+                uint32_t held_id;
+                if (presenceKey(*held, held_id) && held_id == user_id) {
+                    held = message;
+                    frames_coalesced_++;
+                    total_frames_coalesced++;
+                    return true;
+                }
+            }
+        }
+
+        held_.push_back(message);
+        held_size_ += batched_size;
+        return true;
     }
 
-    return true;
+    // Anything held goes first, so the client sees messages in the order they were sent
+    bool was_idle = queued_bytes_ == 0 && held_.empty();
+    if (!releaseHeldLocked()) {
+        return false;
+    }
+    if (!enqueueLocked(wireFrame(message),
+                       getMessagePriority(static_cast<MessageType>(message->type())))) {
+        return false;
+    }
+
+    // Inside a batch: leave the frame queued; the batch writes it with everything else for this client
+    if (batch && queued_bytes_ < BUFFER_SIZE) {
+        if (was_idle) {
+            batch->add(shared_from_this());
+        }
+        return true;
+    }
+
+    return flushLocked();
 }
 
-bool ClientConnection::receiveMessage(MessageHeader& header, std::string& payload) {
-    if (!connected_) {
+bool ClientConnection::flushOutbound() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (!releaseHeldLocked()) {
         return false;
     }
+    return flushLocked();
+}
 
-    // Receive header
-    if (!receiveData(&header, sizeof(MessageHeader))) {
+bool ClientConnection::flushFromBatch(const SendBatch* batch) {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (batch_ == batch) {
+        batch_ = nullptr;
+    }
+    if (!releaseHeldLocked()) {
         return false;
     }
+    return flushLocked();
+}
 
-    // Validate header
-    if (header.length > MAX_MESSAGE_SIZE) {
-        std::cerr << "[ERROR] Message too large: " << header.length << " bytes" << std::endl;
-        disconnect();
+bool ClientConnection::releaseHeldLocked() {
+    if (held_.empty()) {
+        return true;
+    }
+
+    // Alone, a message goes out as it is; the BATCH goes at the most urgent priority of its parts
+    SharedMessage frame;
+    MessagePriority priority = PRIORITY_PRESENCE;
+    for (const auto& message : held_) {
+        priority = std::min(priority, getMessagePriority(static_cast<MessageType>(message->type())));
+    }
+    SendBatch* batch = SendBatch::current();
+    if (held_.size() == 1) {
+        frame = held_[0];
+    } else if (batch) {
+        frame = batch->batchFrame(held_);
+    } else {
+        frame = MessageBuffer::batch(held_);
+    }
+
+    held_.clear();
+    held_size_ = 0;
+    return enqueueLocked(wireFrame(frame), priority);
+}
+
+SharedMessage ClientConnection::wireFrame(const SharedMessage& message) const {
+    if (wire_version_ != WIRE_V2) {
+        return message;
+    }
+    if (capabilities_ & CAP_ZLIB) {
+        return MessageBuffer::compressed(message);
+    }
+    return MessageBuffer::compact(message);
+}
+
+bool ClientConnection::coalesceLocked(const SharedMessage& message) {
+    uint32_t user_id;
+    if (!presenceKey(*message, user_id)) {
         return false;
     }
 
-    // Receive payload if present
-    payload.clear();
-    if (header.length > 0) {
-        payload.resize(header.length);
-        if (!receiveData(&payload[0], header.length)) {
+    // Frames in the class queue have not started going out; partial_ never matches here
+    ClassQueue& queue = out_queues_[PRIORITY_PRESENCE];
+    for (size_t i = queue.head; i < queue.frames.size(); i++) {
+        uint32_t queued_id;
+        if (presenceKey(*queue.frames[i], queued_id) && queued_id == user_id) {
+            size_t old_size = queue.frames[i]->size();
+            queue.frames[i] = message;  // Keeps the older frame's place in line
+
+            queued_bytes_ += message->size();
+            queued_bytes_ -= old_size;
+            total_queued_bytes += message->size();
+            total_queued_bytes -= old_size;
+            frames_coalesced_++;
+            total_frames_coalesced++;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ClientConnection::enqueueLocked(const SharedMessage& message, MessagePriority priority) {
+    if (coalesceLocked(message)) {
+        return true;
+    }
+
+    size_t frame_size = message->size();
+    size_t limit = outbound_limit;
+
+    if (queued_bytes_ + frame_size > limit) {
+        if (overflow_policy == OVERFLOW_DROP_LOBBY) {
+            if (isLobbyUpdate(message->type())) {
+                frames_dropped_++;
+                total_frames_dropped++;
+                return true;  // Dropped by policy, not a failure
+            }
+
+            // Make room by dropping queued lobby updates that have not started going out
+            std::vector<SharedMessage>& presence = out_queues_[PRIORITY_PRESENCE].frames;
+            auto it = presence.begin() + out_queues_[PRIORITY_PRESENCE].head;
+            while (it != presence.end() && queued_bytes_ + frame_size > limit) {
+                if (isLobbyUpdate((*it)->type())) {
+                    queued_bytes_ -= (*it)->size();
+                    total_queued_bytes -= (*it)->size();
+                    frames_dropped_++;
+                    total_frames_dropped++;
+                    it = presence.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        if (queued_bytes_ + frame_size > limit) {
+            LOG_WARN("CONNECTION", "Outbound queue full on fd=" << socket_fd_ << " (" << queued_bytes_
+                    << " bytes), disconnecting slow client");
+            total_evictions++;
+            disconnect();
             return false;
         }
     }
 
+    out_queues_[priority].frames.push_back(message);
+
+    queued_bytes_ += frame_size;
+    total_queued_bytes += frame_size;
     return true;
 }
 
-bool ClientConnection::sendData(const void* data, size_t size) {
-    if (!connected_ || socket_fd_ < 0) {
-        return false;
+SharedMessage ClientConnection::popFrontLocked(ClassQueue& queue) {
+    SharedMessage front = std::move(queue.frames[queue.head]);
+    queue.head++;
+
+    if (queue.head == queue.frames.size()) {
+        queue.frames.clear();  // Keeps capacity: steady-state sends do not allocate
+        queue.head = 0;
+    } else if (queue.head >= 64 && queue.head * 2 >= queue.frames.size()) {
+        // Never fully drained (slow reader): drop the written prefix now and then
+        queue.frames.erase(queue.frames.begin(), queue.frames.begin() + queue.head);
+        queue.head = 0;
     }
+    return front;
+}
+
+bool ClientConnection::flushLocked() {
+    while (queued_bytes_ > 0) {
+        if (!connected_ || socket_fd_ < 0) {
+            return false;
+        }
+
+        // Gather the partial frame, then each class in priority order, into one call
+        struct iovec iov[MAX_IOVECS];
+        int count = 0;
+        if (partial_) {
+            iov[count].iov_base = const_cast<char*>(partial_->data() + partial_offset_);
+            iov[count].iov_len = partial_->size() - partial_offset_;
+            count++;
+        }
+        for (int priority = 0; priority < PRIORITY_CLASSES; priority++) {
+            const ClassQueue& queue = out_queues_[priority];
+            for (size_t i = queue.head; i < queue.frames.size() && count < MAX_IOVECS; i++, count++) {
+                iov[count].iov_base = const_cast<char*>(queue.frames[i]->data());
+                iov[count].iov_len = queue.frames[i]->size();
+            }
+        }
 
-    size_t total_sent = 0;
-    const char* buffer = static_cast<const char*>(data);
+        // sendmsg rather than writev so MSG_NOSIGNAL applies
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
 
-    while (total_sent < size) {
-        ssize_t sent = send(socket_fd_, buffer + total_sent, size - total_sent, MSG_NOSIGNAL);
+        ssize_t sent = sendmsg(socket_fd_, &msg, MSG_NOSIGNAL);
+        send_calls_++;
 
         if (sent < 0) {
             if (errno == EINTR) {
                 continue;  // Interrupted, try again
             }
 
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Socket buffer full: the rest stays queued until the reactor sees EPOLLOUT
+                return true;
+            }
+
             // In unit tests we may use dummy file descriptors; avoid noisy errors for EBADF
             if (errno == EBADF) {
                 return false;
             }
 
-            std::cerr << "[ERROR] Send failed: " << strerror(errno) << std::endl;
+            LOG_WARN("CONNECTION", "Send failed: " << strerror(errno));
             disconnect();
             return false;
         }
 
         if (sent == 0) {
-            std::cerr << "[WARNING] Send returned 0" << std::endl;
+            LOG_WARN("CONNECTION", "Send returned 0");
             disconnect();
             return false;
         }
 
-        total_sent += sent;
         bytes_sent_ += sent;
+        queued_bytes_ -= sent;
+        total_queued_bytes -= sent;
+
+        // Retire written frames in the order they were gathered. A frame cut
+        // short becomes partial_ so it finishes before anything overtakes it.
+        size_t written = sent;
+        if (partial_) {
+            size_t remaining = partial_->size() - partial_offset_;
+            if (written < remaining) {
+                partial_offset_ += written;
+                continue;
+            }
+            written -= remaining;
+            partial_.reset();
+            partial_offset_ = 0;
+        }
+        for (int priority = 0; priority < PRIORITY_CLASSES && written > 0; priority++) {
+            ClassQueue& queue = out_queues_[priority];
+            while (written > 0 && queue.head < queue.frames.size()) {
+                size_t size = queue.frames[queue.head]->size();
+                SharedMessage front = popFrontLocked(queue);
+                if (written < size) {
+                    partial_ = std::move(front);
+                    partial_offset_ = written;
+                    written = 0;
+                    break;
+                }
+                written -= size;
+            }
+        }
     }
 
     return true;
 }
 
-bool ClientConnection::receiveData(void* data, size_t size) {
+bool ClientConnection::receiveMessage(MessageHeader& header, std::string& payload) {
+    if (!connected_) {
+        return false;
+    }
+
+    // Serve from buffered bytes first, reading more only when no full frame is available
+    PayloadView view;
+    while (!nextMessage(header, view)) {
+        if (!connected_ || !fillReadBuffer()) {
+            return false;
+        }
+    }
+
+    payload = view.str();
+    return true;
+}
+
+bool ClientConnection::setNonBlocking() {
+    int flags = fcntl(socket_fd_, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    return fcntl(socket_fd_, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool ClientConnection::readAvailable() {
     if (!connected_ || socket_fd_ < 0) {
         return false;
     }
 
-    size_t total_received = 0;
-    char* buffer = static_cast<char*>(data);
+    // Edge-triggered: keep reading until the kernel buffer is empty
+    while (true) {
+        prepareReadSpace();
 
-    while (total_received < size) {
-        ssize_t received = recv(socket_fd_, buffer + total_received, size - total_received, 0);
+        ssize_t received = recv(socket_fd_, read_buffer_->data() + read_end_,
+                                read_buffer_->size() - read_end_, 0);
 
-        if (received < 0) {
-            if (errno == EINTR) {
-                continue;  // Interrupted, try again
-            }
-            std::cerr << "[ERROR] Receive failed: " << strerror(errno) << std::endl;
-            disconnect();
-            return false;
+        if (received > 0) {
+            read_end_ += received;
+            bytes_received_ += received;
+            last_activity_ms_ = steadyMillis();
+            continue;
         }
 
         if (received == 0) {
@@ -132,25 +504,265 @@ bool ClientConnection::receiveData(void* data, size_t size) {
             return false;
         }
 
-        total_received += received;
-        bytes_received_ += received;
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;  // Drained
+        }
+
+        LOG_WARN("CONNECTION", "Receive failed: " << strerror(errno));
+        disconnect();
+        return false;
+    }
+}
+
+void ClientConnection::appendReceived(const char* data, size_t size) {
+    if (size > 0) {
+        last_activity_ms_ = steadyMillis();
     }
+    while (size > 0) {
+        prepareReadSpace();
 
+        size_t chunk = std::min(size, read_buffer_->size() - read_end_);
+        memcpy(read_buffer_->data() + read_end_, data, chunk);
+        read_end_ += chunk;
+        bytes_received_ += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+bool ClientConnection::nextMessage(MessageHeader& header, PayloadView& payload) {
+    size_t available = read_end_ - read_start_;
+    const char* frame = read_buffer_->data() + read_start_;
+    size_t header_size = sizeof(MessageHeader);
+    bool compressed = false;
+
+    if (CompactHeader::isCompactFrame(frame, available)) {
+        CompactHeader compact;
+        int used = compact.decode(frame, available);
+        if (used < 0) {
+            LOG_ERROR("CONNECTION", "Malformed v2 header on fd=" << socket_fd_);
+            disconnect();
+            return false;
+        }
+        if (used == 0) {
+            return false;  // Header not fully received yet
+        }
+        header = compact.toMessageHeader();
+        header_size = static_cast<size_t>(used);
+        compressed = (compact.flags & CompactHeader::FLAG_COMPRESSED) != 0;
+        if (wire_version_ == WIRE_UNKNOWN) {
+            wire_version_ = WIRE_V2;
+        }
+    } else {
+        if (available < sizeof(MessageHeader)) {
+            return false;
+        }
+        memcpy(&header, frame, sizeof(MessageHeader));
+        if (wire_version_ == WIRE_UNKNOWN) {
+            wire_version_ = WIRE_V1;
+        }
+    }
+
+    // Validate header
+    if (header.length > MAX_MESSAGE_SIZE) {
+        LOG_ERROR("CONNECTION", "Message too large: " << header.length << " bytes");
+        disconnect();
+        return false;
+    }
+
+    if (available < header_size + header.length) {
+        return false;  // Payload not fully received yet
+    }
+
+    size_t frame_size = header_size + header.length;
+    if (!compressed) {
+        payload = PayloadView(read_buffer_, frame + header_size, header.length);
+        read_start_ += frame_size;
+        return true;
+    }
+
+    // Only a client that offered CAP_ZLIB may compress
+    std::string decompressed;
+    if (!(capabilities_ & CAP_ZLIB) ||
+        !PayloadCompression::decompress(frame + header_size, header.length, MAX_MESSAGE_SIZE, decompressed)) {
+        LOG_ERROR("CONNECTION", "Bad compressed payload on fd=" << socket_fd_);
+        disconnect();
+        return false;
+    }
+    header.length = static_cast<uint32_t>(decompressed.size());
+    payload = PayloadView(decompressed);
+    read_start_ += frame_size;
     return true;
 }
 
+std::shared_ptr<ClientConnection::ReadBlock> ClientConnection::newReadBlock(size_t size) {
+    return std::allocate_shared<ReadBlock>(PoolAllocator<ReadBlock>(), size);
+}
+
+void ClientConnection::prepareReadSpace() {
+    // Only we hold the buffer: no payload views are outstanding, so it may be rewritten
+    bool exclusive = read_buffer_.use_count() == 1;
+
+    if (read_start_ == read_end_ && exclusive) {
+        read_start_ = 0;
+        read_end_ = 0;
+    }
+
+    size_t capacity = read_buffer_->size();
+    if (read_end_ < capacity) {
+        return;  // Room left at the end; appending never touches viewed bytes
+    }
+
+    // Out of room. Grow when one frame fills most of the buffer.
+    size_t unread = read_end_ - read_start_;
+    size_t wanted = (unread > capacity / 2) ? capacity * 2 : capacity;
+
+    if (exclusive && wanted == capacity) {
+        // Compact unread bytes to the front, ring-buffer style
+        memmove(read_buffer_->data(), read_buffer_->data() + read_start_, unread);
+    } else {
+        // Views still point into the old block (or it is too small): carry the
+        // partial frame over to a fresh one and let the views keep the old alive
+        std::shared_ptr<ReadBlock> fresh = newReadBlock(wanted);
+        memcpy(fresh->data(), read_buffer_->data() + read_start_, unread);
+        read_buffer_ = fresh;
+    }
+    read_start_ = 0;
+    read_end_ = unread;
+}
+
+bool ClientConnection::fillReadBuffer() {
+    if (!connected_ || socket_fd_ < 0) {
+        return false;
+    }
+
+    prepareReadSpace();
+
+    while (true) {
+        ssize_t received = recv(socket_fd_, read_buffer_->data() + read_end_,
+                                read_buffer_->size() - read_end_, 0);
+
+        if (received > 0) {
+            read_end_ += received;
+            bytes_received_ += received;
+            return true;
+        }
+
+        if (received == 0) {
+            // Client closed connection
+            disconnect();
+            return false;
+        }
+
+        if (errno == EINTR) {
+            continue;  // Interrupted, try again
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Non-blocking socket with nothing buffered: wait for data
+            struct pollfd pfd;
+            pfd.fd = socket_fd_;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+                disconnect();
+                return false;
+            }
+            continue;
+        }
+
+        LOG_WARN("CONNECTION", "Receive failed: " << strerror(errno));
+        disconnect();
+        return false;
+    }
+}
+
 void ClientConnection::setAuthenticated(uint32_t user_id, const std::string& token) {
     user_id_ = user_id;
     session_token_ = token;
     authenticated_ = true;
 }
 
+void ClientConnection::bindSession(MessageHeader& header) const {
+    if (wire_version_ == WIRE_V2 && authenticated_) {
+        memset(header.session_token, 0, sizeof(header.session_token));
+        memcpy(header.session_token, session_token_.data(),
+               std::min(session_token_.size(), sizeof(header.session_token) - 1));
+    }
+}
+
+std::string ClientConnection::getBufferedInput() const {
+    return std::string(read_buffer_->data() + read_start_, read_end_ - read_start_);
+}
+
+std::string ClientConnection::takeOutbound() {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
+    std::string bytes;
+    if (partial_) {
+        bytes.append(partial_->data() + partial_offset_, partial_->size() - partial_offset_);
+        partial_.reset();
+        partial_offset_ = 0;
+    }
+    for (int priority = 0; priority < PRIORITY_CLASSES; priority++) {
+        ClassQueue& queue = out_queues_[priority];
+        for (size_t i = queue.head; i < queue.frames.size(); i++) {
+            bytes.append(queue.frames[i]->data(), queue.frames[i]->size());
+        }
+        queue.frames.clear();
+        queue.head = 0;
+    }
+
+    total_queued_bytes -= queued_bytes_;
+    queued_bytes_ = 0;
+    return bytes;
+}
+
+void ClientConnection::restoreOutbound(const std::string& bytes) {
+    if (bytes.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(send_mutex_);
+
+    // Goes out first; it may begin mid-frame, exactly where the old process stopped
+    std::string carried = bytes;
+    if (partial_) {
+        carried.append(partial_->data() + partial_offset_, partial_->size() - partial_offset_);
+    }
+    partial_ = MessageBuffer::fromFrames(carried);
+    partial_offset_ = 0;
+
+    queued_bytes_ += bytes.size();
+    total_queued_bytes += bytes.size();
+}
+
+bool ClientConnection::takeDeferred(std::function<void()>& task) {
+    if (deferred_.empty()) {
+        return false;
+    }
+    task = std::move(deferred_.front());
+    deferred_.pop_front();
+    return true;
+}
+
+void ClientConnection::release() {
+    connected_ = false;
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
 void ClientConnection::disconnect() {
-    if (connected_) {
-        connected_ = false;
+    if (connected_.exchange(false)) {
+        // Shut down rather than close so the fd number cannot be reused while the
+        // reactor still has it registered; the destructor releases the descriptor.
         if (socket_fd_ >= 0) {
-            close(socket_fd_);
-            socket_fd_ = -1;
+            shutdown(socket_fd_, SHUT_RDWR);
         }
     }
 }
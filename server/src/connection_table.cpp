@@ -0,0 +1,120 @@
+#include "connection_table.h"
+#include <algorithm>
+#include <sys/resource.h>
+
+const uint32_t ConnectionTable::ANY_GENERATION;
+const size_t ConnectionTable::CHUNK_SLOTS;
+
+namespace {
+// The kernel's default fs.nr_open; no fd can be above it unless it is raised
+const size_t DEFAULT_MAX_FDS = 1 << 20;
+}
+
+ConnectionTable::ConnectionTable(size_t max_fds)
+    : high_water_(0)
+    , size_(0)
+{
+    if (max_fds == 0) {
+        struct rlimit limit;
+        max_fds = DEFAULT_MAX_FDS;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_max != RLIM_INFINITY) {
+            max_fds = std::min(static_cast<size_t>(limit.rlim_max), DEFAULT_MAX_FDS);
+        }
+    }
+
+    chunk_count_ = (max_fds + CHUNK_SLOTS - 1) / CHUNK_SLOTS;
+    chunks_.reset(new std::atomic<Chunk*>[chunk_count_]);
+    for (size_t i = 0; i < chunk_count_; i++) {
+        chunks_[i].store(nullptr);
+    }
+}
+
+ConnectionTable::~ConnectionTable() {
+    for (size_t i = 0; i < chunk_count_; i++) {
+        delete chunks_[i].load();
+    }
+}
+
+uint32_t ConnectionTable::insert(const std::shared_ptr<ClientConnection>& connection) {
+    int fd = connection ? connection->getSocketFd() : -1;
+    if (fd < 0 || static_cast<size_t>(fd) >= capacity()) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_t chunk_index = static_cast<size_t>(fd) / CHUNK_SLOTS;
+    Chunk* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new Chunk();
+        chunks_[chunk_index].store(chunk, std::memory_order_release);
+    }
+
+    Slot& slot = chunk->slots[fd % CHUNK_SLOTS];
+    if (slot.owner) {
+        return 0;
+    }
+
+    uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+    if (generation == ANY_GENERATION) {
+        generation++;
+    }
+    slot.owner = connection;
+    slot.generation.store(generation, std::memory_order_relaxed);
+    connection->setHandle(ConnectionHandle(fd, generation));
+    slot.connection.store(connection.get(), std::memory_order_release);
+
+    if (static_cast<size_t>(fd) >= high_water_.load(std::memory_order_relaxed)) {
+        high_water_.store(fd + 1, std::memory_order_release);
+    }
+    size_++;
+    return generation;
+}
+
+std::shared_ptr<ClientConnection> ConnectionTable::remove(int fd, uint32_t generation) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Slot* slot = const_cast<Slot*>(findSlot(fd));
+    if (!slot || !slot->owner ||
+        (generation != ANY_GENERATION && slot->generation.load(std::memory_order_relaxed) != generation)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<ClientConnection> connection = std::move(slot->owner);
+    slot->owner.reset();
+    slot->connection.store(nullptr, std::memory_order_seq_cst);
+    size_--;
+
+    epoch_.synchronize();
+    return connection;
+}
+
+std::vector<std::shared_ptr<ClientConnection>> ConnectionTable::removeAll() {
+    std::vector<std::shared_ptr<ClientConnection>> removed;
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    size_t end = high_water_.load(std::memory_order_relaxed);
+    for (size_t chunk_index = 0; chunk_index * CHUNK_SLOTS < end; chunk_index++) {
+        Chunk* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+        if (!chunk) {
+            continue;
+        }
+        for (Slot& slot : chunk->slots) {
+            if (slot.owner) {
+                slot.connection.store(nullptr, std::memory_order_seq_cst);
+                removed.push_back(std::move(slot.owner));
+                slot.owner.reset();
+            }
+        }
+    }
+    size_ = 0;
+
+    epoch_.synchronize();
+    return removed;
+}
+
+const ConnectionTable::Slot* ConnectionTable::findSlot(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= capacity()) {
+        return nullptr;
+    }
+    const Chunk* chunk = chunks_[fd / CHUNK_SLOTS].load(std::memory_order_acquire);
+    return chunk ? &chunk->slots[fd % CHUNK_SLOTS] : nullptr;
+}
@@ -1,5 +1,5 @@
 #include "database.h"
-#include <iostream>
+#include "logger.h"
 #include <sstream>
 #include <cstring>
 #include <sys/stat.h>
@@ -18,13 +18,13 @@ DatabaseManager::DatabaseManager(const std::string& db_path)
     int rc = sqlite3_open(db_path.c_str(), &db_);
     if (rc != SQLITE_OK) {
         last_error_ = "Failed to open database: " + std::string(sqlite3_errmsg(db_));
-        std::cerr << "[DB] " << last_error_ << std::endl;
+        LOG_ERROR("DB", last_error_);
         sqlite3_close(db_);
         db_ = nullptr;
         return;
     }
 
-    std::cout << "[DB] Database opened: " << db_path << std::endl;
+    LOG_INFO("DB", "Database opened: " << db_path);
 
     // Enable WAL mode for better concurrent access
     executeSQL("PRAGMA journal_mode=WAL;");
@@ -34,7 +34,7 @@ DatabaseManager::DatabaseManager(const std::string& db_path)
 
     // Initialize schema
     if (!initializeSchema()) {
-        std::cerr << "[DB] Failed to initialize schema" << std::endl;
+        LOG_ERROR("DB", "Failed to initialize schema");
         sqlite3_close(db_);
         db_ = nullptr;
     }
@@ -43,12 +43,12 @@ DatabaseManager::DatabaseManager(const std::string& db_path)
 DatabaseManager::~DatabaseManager() {
     if (db_) {
         sqlite3_close(db_);
-        std::cout << "[DB] Database closed" << std::endl;
+        LOG_INFO("DB", "Database closed");
     }
 }
 
 bool DatabaseManager::initializeSchema() {
-    std::cout << "[DB] Initializing database schema..." << std::endl;
+    LOG_INFO("DB", "Initializing database schema...");
 
     // Create users table
     const char* users_sql = R"(
@@ -142,7 +142,7 @@ bool DatabaseManager::executeSQL(const std::string& sql) {
 
     if (rc != SQLITE_OK) {
         last_error_ = std::string(err_msg);
-        std::cerr << "[DB] SQL error: " << last_error_ << std::endl;
+        LOG_ERROR("DB", "SQL error: " << last_error_);
         sqlite3_free(err_msg);
         return false;
     }
@@ -156,7 +156,7 @@ sqlite3_stmt* DatabaseManager::prepareStatement(const std::string& sql) {
 
     if (rc != SQLITE_OK) {
         last_error_ = sqlite3_errmsg(db_);
-        std::cerr << "[DB] Prepare error: " << last_error_ << std::endl;
+        LOG_ERROR("DB", "Prepare error: " << last_error_);
         return nullptr;
     }
 
@@ -168,6 +168,7 @@ sqlite3_stmt* DatabaseManager::prepareStatement(const std::string& sql) {
 uint32_t DatabaseManager::createUser(const std::string& username,
                                      const std::string& password_hash,
                                      const std::string& display_name) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return 0;
 
     const char* sql = "INSERT INTO users (username, password_hash, display_name, created_at) "
@@ -188,17 +189,18 @@ uint32_t DatabaseManager::createUser(const std::string& username,
 
     if (rc != SQLITE_DONE) {
         last_error_ = sqlite3_errmsg(db_);
-        std::cerr << "[DB] Create user failed: " << last_error_ << std::endl;
+        LOG_ERROR("DB", "Create user failed: " << last_error_);
         return 0;
     }
 
     uint32_t user_id = static_cast<uint32_t>(sqlite3_last_insert_rowid(db_));
-    std::cout << "[DB] Created user: " << username << " (ID: " << user_id << ")" << std::endl;
+    LOG_INFO("DB", "Created user: " << username << " (ID: " << user_id << ")");
 
     return user_id;
 }
 
 User DatabaseManager::getUserByUsername(const std::string& username) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     User user;
     if (!db_) return user;
 
@@ -225,6 +227,7 @@ User DatabaseManager::getUserByUsername(const std::string& username) {
 }
 
 User DatabaseManager::getUserById(uint32_t user_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     User user;
     if (!db_) return user;
 
@@ -251,6 +254,7 @@ User DatabaseManager::getUserById(uint32_t user_id) {
 }
 
 bool DatabaseManager::updateLastLogin(uint32_t user_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "UPDATE users SET last_login = ? WHERE user_id = ?;";
@@ -269,6 +273,7 @@ bool DatabaseManager::updateLastLogin(uint32_t user_id) {
 }
 
 bool DatabaseManager::updateEloRating(uint32_t user_id, int32_t new_elo) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "UPDATE users SET elo_rating = ? WHERE user_id = ?;";
@@ -286,6 +291,7 @@ bool DatabaseManager::updateEloRating(uint32_t user_id, int32_t new_elo) {
 }
 
 bool DatabaseManager::usernameExists(const std::string& username) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "SELECT COUNT(*) FROM users WHERE username = ?;";
@@ -309,6 +315,7 @@ bool DatabaseManager::usernameExists(const std::string& username) {
 uint32_t DatabaseManager::createSession(uint32_t user_id,
                                         const std::string& session_token,
                                         int duration_hours) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return 0;
 
     const char* sql = "INSERT INTO sessions (user_id, session_token, created_at, expires_at) "
@@ -330,18 +337,19 @@ uint32_t DatabaseManager::createSession(uint32_t user_id,
 
     if (rc != SQLITE_DONE) {
         last_error_ = sqlite3_errmsg(db_);
-        std::cerr << "[DB] Create session failed: " << last_error_ << std::endl;
+        LOG_ERROR("DB", "Create session failed: " << last_error_);
         return 0;
     }
 
     uint32_t session_id = static_cast<uint32_t>(sqlite3_last_insert_rowid(db_));
-    std::cout << "[DB] Created session for user " << user_id << " (expires in "
-              << duration_hours << "h)" << std::endl;
+    LOG_DEBUG("DB", "Created session for user " << user_id << " (expires in "
+            << duration_hours << "h)");
 
     return session_id;
 }
 
 Session DatabaseManager::getSessionByToken(const std::string& session_token) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     Session session;
     if (!db_) return session;
 
@@ -366,6 +374,7 @@ Session DatabaseManager::getSessionByToken(const std::string& session_token) {
 }
 
 uint32_t DatabaseManager::validateSession(const std::string& session_token) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     Session session = getSessionByToken(session_token);
 
     if (session.session_id == 0) {
@@ -373,7 +382,7 @@ uint32_t DatabaseManager::validateSession(const std::string& session_token) {
     }
 
     if (session.isExpired()) {
-        std::cout << "[DB] Session expired: " << session_token << std::endl;
+        LOG_DEBUG("DB", "Session expired: " << session_token);
         deleteSession(session_token); // Clean up expired session
         return 0;
     }
@@ -382,6 +391,7 @@ uint32_t DatabaseManager::validateSession(const std::string& session_token) {
 }
 
 bool DatabaseManager::deleteSession(const std::string& session_token) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "DELETE FROM sessions WHERE session_token = ?;";
@@ -395,7 +405,7 @@ bool DatabaseManager::deleteSession(const std::string& session_token) {
     sqlite3_finalize(stmt);
 
     if (rc == SQLITE_DONE) {
-        std::cout << "[DB] Deleted session: " << session_token << std::endl;
+        LOG_DEBUG("DB", "Deleted session: " << session_token);
         return true;
     }
 
@@ -403,6 +413,7 @@ bool DatabaseManager::deleteSession(const std::string& session_token) {
 }
 
 int DatabaseManager::cleanupExpiredSessions() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return 0;
 
     const char* sql = "DELETE FROM sessions WHERE expires_at < ?;";
@@ -418,13 +429,14 @@ int DatabaseManager::cleanupExpiredSessions() {
 
     int deleted = sqlite3_changes(db_);
     if (deleted > 0) {
-        std::cout << "[DB] Cleaned up " << deleted << " expired sessions" << std::endl;
+        LOG_INFO("DB", "Cleaned up " << deleted << " expired sessions");
     }
 
     return deleted;
 }
 
 bool DatabaseManager::deleteUserSessions(uint32_t user_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "DELETE FROM sessions WHERE user_id = ?;";
@@ -443,6 +455,7 @@ bool DatabaseManager::deleteUserSessions(uint32_t user_id) {
 // ===== MATCH OPERATIONS (for Phase 4-5) =====
 
 uint32_t DatabaseManager::createMatch(uint32_t player1_id, uint32_t player2_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return 0;
 
     const char* sql = "INSERT INTO matches (player1_id, player2_id, status, created_at) "
@@ -469,6 +482,7 @@ uint32_t DatabaseManager::createMatch(uint32_t player1_id, uint32_t player2_id)
 }
 
 Match DatabaseManager::getMatchById(uint32_t match_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     Match match;
     if (!db_) return match;
 
@@ -495,6 +509,7 @@ Match DatabaseManager::getMatchById(uint32_t match_id) {
 }
 
 bool DatabaseManager::updateMatchStatus(uint32_t match_id, const std::string& status) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "UPDATE matches SET status = ? WHERE match_id = ?;";
@@ -512,6 +527,7 @@ bool DatabaseManager::updateMatchStatus(uint32_t match_id, const std::string& st
 }
 
 bool DatabaseManager::endMatch(uint32_t match_id, uint32_t winner_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "UPDATE matches SET status = 'completed', winner_id = ?, ended_at = ? "
@@ -533,6 +549,7 @@ bool DatabaseManager::endMatch(uint32_t match_id, uint32_t winner_id) {
 }
 
 std::vector<Match> DatabaseManager::getUserMatches(uint32_t user_id, int limit) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     std::vector<Match> matches;
     if (!db_) return matches;
 
@@ -568,6 +585,7 @@ std::vector<Match> DatabaseManager::getUserMatches(uint32_t user_id, int limit)
 
 bool DatabaseManager::saveShipPlacement(uint32_t match_id, uint32_t user_id,
                                        const std::string& ship_data) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "INSERT INTO match_boards (match_id, user_id, ship_data) "
@@ -587,6 +605,7 @@ bool DatabaseManager::saveShipPlacement(uint32_t match_id, uint32_t user_id,
 }
 
 std::string DatabaseManager::getShipPlacement(uint32_t match_id, uint32_t user_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     std::string ship_data;
     if (!db_) return ship_data;
 
@@ -612,6 +631,7 @@ std::string DatabaseManager::getShipPlacement(uint32_t match_id, uint32_t user_i
 bool DatabaseManager::saveMove(uint32_t match_id, uint32_t player_id,
                                int move_number, int x, int y,
                                const std::string& result) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!db_) return false;
 
     const char* sql = "INSERT INTO match_moves (match_id, player_id, move_number, x, y, result, timestamp) "
@@ -637,6 +657,7 @@ bool DatabaseManager::saveMove(uint32_t match_id, uint32_t player_id,
 }
 
 std::vector<std::string> DatabaseManager::getMatchMoves(uint32_t match_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     std::vector<std::string> moves;
     if (!db_) return moves;
 
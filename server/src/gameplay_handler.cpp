@@ -1,8 +1,10 @@
 #include "gameplay_handler.h"
 #include "server.h"
 #include "player_manager.h"
+#include "snapshot.h"
+#include "message_schema.h"
 #include <cstring>
-#include <iostream>
+#include "logger.h"
 #include <sstream>
 #include <cmath>
 
@@ -14,130 +16,68 @@ GameplayHandler::~GameplayHandler() {
 }
 
 bool GameplayHandler::canHandle(MessageType type) const {
-    return (type == MessageType::SHIP_PLACEMENT ||
-            type == MessageType::MOVE ||
-            type == MessageType::RESIGN ||
-            type == MessageType::DRAW_OFFER ||
-            type == MessageType::DRAW_RESPONSE ||
-            type == MessageType::REMATCH_REQUEST ||
-            type == MessageType::REMATCH_RESPONSE);
+    return MessageSchema::handlesGameplay(type);
 }
 
 bool GameplayHandler::handleMessage(ClientConnection* client,
                                     const MessageHeader& header,
-                                    const std::string& payload) {
+                                    const PayloadView& payload) {
     if (!client) return false;
 
-    int client_fd = client->getSocketFd();
-    MessageType type = static_cast<MessageType>(header.type);
-
-    switch (type) {
-        case MessageType::SHIP_PLACEMENT: {
-            if (payload.size() >= sizeof(ShipPlacementMessage)) {
-                ShipPlacementMessage msg;
-                memcpy(&msg, payload.data(), sizeof(ShipPlacementMessage));
-                handleShipPlacement(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
-
-        case MessageType::MOVE: {
-            if (payload.size() >= sizeof(MoveMessage)) {
-                MoveMessage msg;
-                memcpy(&msg, payload.data(), sizeof(MoveMessage));
-                handleMove(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
-
-        case MessageType::RESIGN: {
-            if (payload.size() >= sizeof(ResignMessage)) {
-                ResignMessage msg;
-                memcpy(&msg, payload.data(), sizeof(ResignMessage));
-                handleResign(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
-
-        case MessageType::DRAW_OFFER: {
-            if (payload.size() >= sizeof(DrawOfferMessage)) {
-                DrawOfferMessage msg;
-                memcpy(&msg, payload.data(), sizeof(DrawOfferMessage));
-                handleDrawOffer(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
+    // Decoded as message_schema.h says; a gameplay message without a route() does not compile
+    return MessageSchema::dispatchGameplay(header.type, payload, [this, client, &header](const auto& msg) {
+        route(client, header, msg);
+    });
+}
 
-        case MessageType::DRAW_RESPONSE: {
-            if (payload.size() >= sizeof(DrawResponseMessage)) {
-                DrawResponseMessage msg;
-                memcpy(&msg, payload.data(), sizeof(DrawResponseMessage));
-                handleDrawResponse(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const ShipPlacementMessage& msg) {
+    handleShipPlacement(client, header, msg);
+}
 
-        case MessageType::REMATCH_REQUEST: {
-            if (payload.size() >= sizeof(RematchRequestMessage)) {
-                RematchRequestMessage msg;
-                memcpy(&msg, payload.data(), sizeof(RematchRequestMessage));
-                handleRematchRequest(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const MoveMessage& msg) {
+    handleMove(header, msg, client->getSocketFd());
+}
 
-        case MessageType::REMATCH_RESPONSE: {
-            if (payload.size() >= sizeof(RematchResponseMessage)) {
-                RematchResponseMessage msg;
-                memcpy(&msg, payload.data(), sizeof(RematchResponseMessage));
-                handleRematchResponse(header, msg, client_fd);
-                return true;
-            }
-            break;
-        }
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const ResignMessage& msg) {
+    handleResign(header, msg, client->getSocketFd());
+}
 
-        default:
-            return false;
-    }
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const DrawOfferMessage& msg) {
+    handleDrawOffer(header, msg, client->getSocketFd());
+}
 
-    return false;
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const DrawResponseMessage& msg) {
+    handleDrawResponse(header, msg, client->getSocketFd());
 }
 
-void GameplayHandler::handleShipPlacement(const MessageHeader& header,
-                                         const ShipPlacementMessage& msg,
-                                         int client_fd) {
-    // Validate session
-    std::string token(header.session_token);
-    uint32_t user_id = db_->validateSession(token);
-    if (user_id == 0) {
-        std::cout << "Invalid session for ship placement" << std::endl;
-        return;
-    }
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const RematchRequestMessage& msg) {
+    handleRematchRequest(header, msg, client->getSocketFd());
+}
 
-    // Validate ship placement
-    ShipPlacementAck ack;
-    ack.match_id = msg.match_id;
+void GameplayHandler::route(ClientConnection* client, const MessageHeader& header, const RematchResponseMessage& msg) {
+    handleRematchResponse(header, msg, client->getSocketFd());
+}
 
-    if (!validateShipPlacement(msg.ships)) {
-        ack.valid = false;
-        strcpy(ack.error_message, "Invalid ship placement");
+namespace {
+// Result of the database half of a ship placement
+struct PlacementRecord {
+    uint32_t user_id;
+    bool saved;
+    Match match;
 
-        // Send error response
-        MessageHeader resp_header;
-        memset(&resp_header, 0, sizeof(resp_header));
-        resp_header.type = MessageType::SHIP_PLACEMENT;
-        resp_header.length = sizeof(ack);
-        resp_header.timestamp = time(nullptr);
+    PlacementRecord() : user_id(0), saved(false) {}
+};
+}
 
-        server_->sendToClient(client_fd, resp_header, &ack, sizeof(ack));
-        return;
-    }
+void GameplayHandler::handleShipPlacement(ClientConnection* client,
+                                         const MessageHeader& header,
+                                         const ShipPlacementMessage& msg) {
+    int client_fd = client->getSocketFd();
+    std::shared_ptr<ClientConnection> conn = client->shared_from_this();
+    DatabaseManager* db = db_;
+    std::string token(header.session_token);
+    uint32_t match_id = msg.match_id;
+    bool ships_valid = validateShipPlacement(msg.ships);
 
     // Store ships in database
     std::string ship_data = ""; // TODO: Serialize ships to JSON
@@ -148,10 +88,26 @@ void GameplayHandler::handleShipPlacement(const MessageHeader& header,
                     std::to_string((int)msg.ships[i].position.col) + ";";
     }
 
-    if (!db_->saveShipPlacement(msg.match_id, user_id, ship_data)) {
-        std::cout << "Failed to save board data for user " << user_id << std::endl;
-        ack.valid = false;
-        strcpy(ack.error_message, "Failed to save board data");
+    // Validate session, save the board and look up the match in one trip off the worker
+    async_->query(conn, [db, token, match_id, ships_valid, ship_data]() {
+        PlacementRecord record;
+        record.user_id = db->validateSession(token);
+        if (record.user_id == 0 || !ships_valid) {
+            return record;
+        }
+        record.saved = db->saveShipPlacement(match_id, record.user_id, ship_data);
+        if (record.saved) {
+            record.match = db->getMatchById(match_id);
+        }
+        return record;
+    }, [this, conn, client_fd, match_id, ships_valid](const PlacementRecord& record) {
+        if (record.user_id == 0) {
+            LOG_WARN("GAMEPLAY", "Invalid session for ship placement");
+            return;
+        }
+
+        ShipPlacementAck ack;
+        ack.match_id = match_id;
 
         MessageHeader resp_header;
         memset(&resp_header, 0, sizeof(resp_header));
@@ -159,116 +115,144 @@ void GameplayHandler::handleShipPlacement(const MessageHeader& header,
         resp_header.length = sizeof(ack);
         resp_header.timestamp = time(nullptr);
 
-        server_->sendToClient(client_fd, resp_header, &ack, sizeof(ack));
-        return;
-    }
+        if (!ships_valid) {
+            ack.valid = false;
+            strcpy(ack.error_message, "Invalid ship placement");
 
-    // Success acknowledgment
-    ack.valid = true;
-    strcpy(ack.error_message, "Ship placement accepted");
+            // Send error response
+            server_->sendToClient(client_fd, resp_header, &ack, sizeof(ack));
+            return;
+        }
 
-    MessageHeader resp_header;
-    memset(&resp_header, 0, sizeof(resp_header));
-    resp_header.type = MessageType::SHIP_PLACEMENT;
-    resp_header.length = sizeof(ack);
-    resp_header.timestamp = time(nullptr);
+        if (!record.saved) {
+            LOG_ERROR("GAMEPLAY", "Failed to save board data for user " << record.user_id);
+            ack.valid = false;
+            strcpy(ack.error_message, "Failed to save board data");
 
-    server_->sendToClient(client_fd, resp_header, &ack, sizeof(ack));
+            server_->sendToClient(client_fd, resp_header, &ack, sizeof(ack));
+            return;
+        }
 
-    // Mark player as ready
-    {
-        std::lock_guard<std::mutex> lock(ready_mutex_);
-        ready_players_[msg.match_id].insert(user_id);
-    }
+        // Success acknowledgment
+        ack.valid = true;
+        strcpy(ack.error_message, "Ship placement accepted");
 
-    // Check if both players are ready
-    auto match_data = db_->getMatchById(msg.match_id);
-    if (match_data.match_id == 0) {
-        std::cout << "Match " << msg.match_id << " not found" << std::endl;
-        return;
-    }
+        server_->sendToClient(client_fd, resp_header, &ack, sizeof(ack));
 
-    uint32_t player1_id = match_data.player1_id;
-    uint32_t player2_id = match_data.player2_id;
+        // Mark player as ready
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            ready_players_[match_id].insert(record.user_id);
+        }
 
-    bool both_ready = false;
-    {
-        std::lock_guard<std::mutex> lock(ready_mutex_);
-        auto& ready_set = ready_players_[msg.match_id];
-        both_ready = (ready_set.count(player1_id) > 0 && ready_set.count(player2_id) > 0);
-    }
+        // Check if both players are ready
+        if (record.match.match_id == 0) {
+            LOG_WARN("GAMEPLAY", "Match " << match_id << " not found");
+            return;
+        }
 
-    if (both_ready) {
-        // Create match state
-        createMatch(msg.match_id, player1_id, player2_id);
+        uint32_t player1_id = record.match.player1_id;
+        uint32_t player2_id = record.match.player2_id;
+
+        bool both_ready = false;
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            auto& ready_set = ready_players_[match_id];
+            both_ready = (ready_set.count(player1_id) > 0 && ready_set.count(player2_id) > 0);
+            if (both_ready) {
+                // Claim the start so concurrent placements don't create the match twice
+                ready_players_.erase(match_id);
+            }
+        }
 
-        // Load ships from database for both players
-        auto match = getMatch(msg.match_id);
-        if (match) {
-            // Helper lambda to parse simple "type,orient,row,col;..." format
-            auto loadShips = [](Board& board, const std::string& data) {
-                if (data.empty()) {
-                    return;
-                }
-                // Start from a clean board
-                board.clearBoard();
-
-                std::stringstream ss(data);
-                std::string token;
-                while (std::getline(ss, token, ';')) {
-                    if (token.empty()) continue;
-
-                    std::stringstream ship_ss(token);
-                    std::string field;
-                    int type_i = 0, orient_i = 0, row = 0, col = 0;
-
-                    // type
-                    if (!std::getline(ship_ss, field, ',')) continue;
-                    type_i = std::stoi(field);
-                    // orientation
-                    if (!std::getline(ship_ss, field, ',')) continue;
-                    orient_i = std::stoi(field);
-                    // row
-                    if (!std::getline(ship_ss, field, ',')) continue;
-                    row = std::stoi(field);
-                    // col
-                    if (!std::getline(ship_ss, field, ',')) continue;
-                    col = std::stoi(field);
-
-                    ShipType type = static_cast<ShipType>(type_i);
-                    Orientation orient = static_cast<Orientation>(orient_i);
-                    Coordinate pos;
-                    pos.row = row;
-                    pos.col = col;
-
-                    // Place ship on board; ignore invalid placements (already validated earlier)
-                    board.placeShip(type, pos, orient);
-                }
-            };
+        if (both_ready) {
+            // Not tied to conn: the opponent waits on this even if the placer disconnects
+            DatabaseManager* db = db_;
+            async_->query([db, match_id, player1_id, player2_id]() {
+                return std::make_pair(db->getShipPlacement(match_id, player1_id),
+                                      db->getShipPlacement(match_id, player2_id));
+            }, [this, match_id, player1_id, player2_id](const std::pair<std::string, std::string>& ships) {
+                startPlacedMatch(match_id, player1_id, player2_id, ships.first, ships.second);
+            });
+        }
+    });
+}
 
-            // Parse and place ships for player 1
-            std::string p1_ships = db_->getShipPlacement(msg.match_id, player1_id);
-            loadShips(match->player1_board, p1_ships);
+void GameplayHandler::startPlacedMatch(uint32_t match_id, uint32_t player1_id, uint32_t player2_id,
+                                       const std::string& p1_ships, const std::string& p2_ships) {
+    // Create match state
+    createMatch(match_id, player1_id, player2_id);
 
-            // Parse and place ships for player 2
-            std::string p2_ships = db_->getShipPlacement(msg.match_id, player2_id);
-            loadShips(match->player2_board, p2_ships);
+    auto match_lock = getMatchLock(match_id);
+    if (!match_lock) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(*match_lock);
 
-            // Start the match
-            match->startMatch();
+    // Load ships for both players
+    auto match = getMatch(match_id);
+    if (match) {
+        // Helper lambda to parse simple "type,orient,row,col;..." format
+        auto loadShips = [](Board& board, const std::string& data) {
+            if (data.empty()) {
+                return;
+            }
+            // Start from a clean board
+            board.clearBoard();
+
+            std::stringstream ss(data);
+            std::string token;
+            while (std::getline(ss, token, ';')) {
+                if (token.empty()) continue;
+
+                std::stringstream ship_ss(token);
+                std::string field;
+                int type_i = 0, orient_i = 0, row = 0, col = 0;
+
+                // type
+                if (!std::getline(ship_ss, field, ',')) continue;
+                type_i = std::stoi(field);
+                // orientation
+                if (!std::getline(ship_ss, field, ',')) continue;
+                orient_i = std::stoi(field);
+                // row
+                if (!std::getline(ship_ss, field, ',')) continue;
+                row = std::stoi(field);
+                // col
+                if (!std::getline(ship_ss, field, ',')) continue;
+                col = std::stoi(field);
+
+                ShipType type = static_cast<ShipType>(type_i);
+                Orientation orient = static_cast<Orientation>(orient_i);
+                Coordinate pos;
+                pos.row = row;
+                pos.col = col;
+
+                // Place ship on board; ignore invalid placements (already validated earlier)
+                board.placeShip(type, pos, orient);
+            }
+        };
 
-            // Randomly select first player
-            srand(time(nullptr));
-            match->current_turn_player_id = (rand() % 2 == 0) ? player1_id : player2_id;
+        // Parse and place ships for player 1
+        loadShips(match->player1_board, p1_ships);
 
-            // Send MATCH_READY to both players
-            sendMatchReady(msg.match_id, player1_id, player2_id);
+        // Parse and place ships for player 2
+        loadShips(match->player2_board, p2_ships);
 
-            // Send initial turn update
-            sendTurnUpdate(msg.match_id, match->current_turn_player_id, 1);
+        // Start the match
+        match->startMatch();
 
-            std::cout << "Match " << msg.match_id << " is ready! First turn: " << match->current_turn_player_id << std::endl;
-        }
+        // Randomly select first player
+        srand(time(nullptr));
+        match->current_turn_player_id = (rand() % 2 == 0) ? player1_id : player2_id;
+
+        // Send MATCH_READY to both players
+        sendMatchReady(match_id, player1_id, player2_id);
+
+        // Send initial turn update
+        sendTurnUpdate(match_id, match->current_turn_player_id, 1);
+
+        LOG_INFO("GAMEPLAY", "Match " << match_id << " is ready! First turn: " << match->current_turn_player_id);
     }
 }
 
@@ -280,20 +264,28 @@ void GameplayHandler::handleMove(const MessageHeader& header,
     std::string token(header.session_token);
     uint32_t user_id = db_->validateSession(token);
     if (user_id == 0) {
-        std::cout << "Invalid session for move" << std::endl;
+        LOG_WARN("GAMEPLAY", "Invalid session for move");
         return;
     }
 
+    // Serialize with other messages for this match, then re-check it is still active
+    auto match_lock = getMatchLock(msg.match_id);
+    if (!match_lock) {
+        LOG_WARN("GAMEPLAY", "Match " << msg.match_id << " not found");
+        return;
+    }
+    std::lock_guard<std::mutex> guard(*match_lock);
+
     // Get match state
     auto match = getMatch(msg.match_id);
     if (!match) {
-        std::cout << "Match " << msg.match_id << " not found" << std::endl;
+        LOG_WARN("GAMEPLAY", "Match " << msg.match_id << " not found");
         return;
     }
 
     // Validate it's player's turn
     if (match->current_turn_player_id != user_id) {
-        std::cout << "Not player " << user_id << "'s turn" << std::endl;
+        LOG_DEBUG("GAMEPLAY", "Not player " << user_id << "'s turn");
         return;
     }
 
@@ -378,6 +370,13 @@ void GameplayHandler::handleResign(const MessageHeader& header,
         return;
     }
 
+    // Serialize with other messages for this match, then re-check it is still active
+    auto match_lock = getMatchLock(msg.match_id);
+    if (!match_lock) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(*match_lock);
+
     // Get match state
     auto match = getMatch(msg.match_id);
     if (!match) {
@@ -426,17 +425,7 @@ void GameplayHandler::handleDrawOffer(const MessageHeader& header,
 
     // Forward draw offer to opponent
     uint32_t opponent_id = (user_id == match->player1_id) ? match->player2_id : match->player1_id;
-    ClientConnection* opponent_conn = server_->getPlayerManager()->getClientConnection(opponent_id);
-
-    if (opponent_conn) {
-        MessageHeader forward_header;
-        memset(&forward_header, 0, sizeof(forward_header));
-        forward_header.type = MessageType::DRAW_OFFER;
-        forward_header.length = sizeof(msg);
-        forward_header.timestamp = time(nullptr);
-
-        server_->sendToClient(opponent_conn->getSocketFd(), forward_header, &msg, sizeof(msg));
-    }
+    server_->getPlayerManager()->sendToPlayer(opponent_id, MessageBuffer::create<MessageType::DRAW_OFFER>(msg));
 }
 
 void GameplayHandler::handleDrawResponse(const MessageHeader& header,
@@ -455,22 +444,18 @@ void GameplayHandler::handleDrawResponse(const MessageHeader& header,
         auto match = getMatch(msg.match_id);
         if (match) {
             uint32_t opponent_id = (user_id == match->player1_id) ? match->player2_id : match->player1_id;
-            ClientConnection* opponent_conn = server_->getPlayerManager()->getClientConnection(opponent_id);
-
-            if (opponent_conn) {
-                MessageHeader forward_header;
-                memset(&forward_header, 0, sizeof(forward_header));
-                forward_header.type = MessageType::DRAW_RESPONSE;
-                forward_header.length = sizeof(msg);
-                forward_header.timestamp = time(nullptr);
-
-                server_->sendToClient(opponent_conn->getSocketFd(), forward_header, &msg, sizeof(msg));
-            }
+            server_->getPlayerManager()->sendToPlayer(opponent_id, MessageBuffer::create<MessageType::DRAW_RESPONSE>(msg));
         }
         return;
     }
 
-    // Draw accepted
+    // Draw accepted: serialize with other messages for this match, then re-check it is still active
+    auto match_lock = getMatchLock(msg.match_id);
+    if (!match_lock) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(*match_lock);
+
     auto match = getMatch(msg.match_id);
     if (!match) {
         return;
@@ -505,6 +490,16 @@ std::shared_ptr<MatchState> GameplayHandler::getMatch(uint32_t match_id) {
     return nullptr;
 }
 
+std::shared_ptr<std::mutex> GameplayHandler::getMatchLock(uint32_t match_id) {
+    // Callers hold the returned pointer, so the mutex outlives removeMatch()
+    std::lock_guard<std::mutex> lock(matches_mutex_);
+    auto it = match_locks_.find(match_id);
+    if (it != match_locks_.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
 void GameplayHandler::createMatch(uint32_t match_id, uint32_t player1_id, uint32_t player2_id) {
     std::lock_guard<std::mutex> lock(matches_mutex_);
 
@@ -520,12 +515,16 @@ void GameplayHandler::createMatch(uint32_t match_id, uint32_t player1_id, uint32
     match->player2_name = p2_info.username;
 
     active_matches_[match_id] = match;
+    if (match_locks_.find(match_id) == match_locks_.end()) {
+        match_locks_[match_id] = std::make_shared<std::mutex>();
+    }
 }
 
 void GameplayHandler::removeMatch(uint32_t match_id) {
     {
         std::lock_guard<std::mutex> lock(matches_mutex_);
         active_matches_.erase(match_id);
+        match_locks_.erase(match_id);
     }
 
     {
@@ -534,6 +533,112 @@ void GameplayHandler::removeMatch(uint32_t match_id) {
     }
 }
 
+std::string GameplayHandler::exportState() {
+    SnapshotWriter writer;
+    {
+        std::lock_guard<std::mutex> lock(matches_mutex_);
+        writer.put(static_cast<uint32_t>(active_matches_.size()));
+        for (const auto& pair : active_matches_) {
+            writer.put(pair.first);
+            writer.putString(pair.second->serialize());
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        writer.put(static_cast<uint32_t>(ready_players_.size()));
+        for (const auto& pair : ready_players_) {
+            writer.put(pair.first);
+            writer.put(static_cast<uint32_t>(pair.second.size()));
+            for (uint32_t user_id : pair.second) {
+                writer.put(user_id);
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(rematch_mutex_);
+        writer.put(static_cast<uint32_t>(pending_rematches_.size()));
+        for (const auto& pair : pending_rematches_) {
+            writer.put(pair.first);
+            writer.put(pair.second.first);
+            writer.put(pair.second.second);
+        }
+    }
+    return writer.data();
+}
+
+bool GameplayHandler::importState(const std::string& data) {
+    SnapshotReader reader(data);
+    std::map<uint32_t, std::shared_ptr<MatchState>> matches;
+    std::map<uint32_t, std::set<uint32_t>> ready;
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> rematches;
+
+    uint32_t count = 0;
+    reader.get(count);
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        uint32_t match_id = 0;
+        std::string state;
+        reader.get(match_id);
+        reader.getString(state);
+        auto match = std::make_shared<MatchState>();
+        if (reader.ok() && !match->deserialize(state)) {
+            LOG_ERROR("GAMEPLAY", "Match " << match_id << " in snapshot is malformed");
+            return false;
+        }
+        matches[match_id] = match;
+    }
+
+    count = 0;
+    reader.get(count);
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        uint32_t match_id = 0;
+        uint32_t players = 0;
+        reader.get(match_id);
+        reader.get(players);
+        for (uint32_t j = 0; j < players && reader.ok(); j++) {
+            uint32_t user_id = 0;
+            reader.get(user_id);
+            ready[match_id].insert(user_id);
+        }
+    }
+
+    count = 0;
+    reader.get(count);
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        uint32_t match_id = 0;
+        std::pair<uint32_t, uint32_t> request;
+        reader.get(match_id);
+        reader.get(request.first);
+        reader.get(request.second);
+        rematches[match_id] = request;
+    }
+
+    if (!reader.ok() || !reader.atEnd()) {
+        LOG_ERROR("GAMEPLAY", "Match snapshot is malformed");
+        return false;
+    }
+
+    size_t restored = matches.size();
+    {
+        std::lock_guard<std::mutex> lock(matches_mutex_);
+        active_matches_.swap(matches);
+        match_locks_.clear();
+        for (const auto& pair : active_matches_) {
+            match_locks_[pair.first] = std::make_shared<std::mutex>();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ready_players_.swap(ready);
+    }
+    {
+        std::lock_guard<std::mutex> lock(rematch_mutex_);
+        pending_rematches_.swap(rematches);
+    }
+
+    LOG_INFO("GAMEPLAY", "Restored " << restored << " active matches");
+    return true;
+}
+
 void GameplayHandler::checkTurnTimeouts() {
     std::vector<uint32_t> timed_out_matches;
 
@@ -544,24 +649,29 @@ void GameplayHandler::checkTurnTimeouts() {
             auto match = pair.second;
             if (match && match->isTurnTimedOut()) {
                 timed_out_matches.push_back(pair.first);
-                std::cout << "[TIMEOUT] Match " << pair.first
-                          << " - Player " << match->current_turn_player_id
-                          << " timed out" << std::endl;
+                LOG_INFO("TIMEOUT", "Match " << pair.first
+                        << " - Player " << match->current_turn_player_id
+                        << " timed out");
             }
         }
     }
 
     // Process timeouts (outside of lock to avoid deadlock)
     for (uint32_t match_id : timed_out_matches) {
+        auto match_lock = getMatchLock(match_id);
+        if (!match_lock) continue;
+        std::lock_guard<std::mutex> guard(*match_lock);
+
+        // A move may have landed (or the match ended) while we were waiting
         auto match = getMatch(match_id);
-        if (!match) continue;
+        if (!match || !match->isTurnTimedOut()) continue;
 
         uint32_t timed_out_player = match->current_turn_player_id;
         uint32_t winner_id = (timed_out_player == match->player1_id) ?
                              match->player2_id : match->player1_id;
 
-        std::cout << "[TIMEOUT] Ending match " << match_id
-                  << " - Player " << timed_out_player << " loses by timeout" << std::endl;
+        LOG_INFO("TIMEOUT", "Ending match " << match_id
+                << " - Player " << timed_out_player << " loses by timeout");
 
         // End match with timeout reason
         uint64_t duration = time(nullptr) - match->start_time;
@@ -650,15 +760,10 @@ void GameplayHandler::sendMatchReady(uint32_t match_id, uint32_t player1_id, uin
     // Send to both players
     auto player_manager = server_->getPlayerManager();
     if (player_manager) {
-        ClientConnection* p1_conn = player_manager->getClientConnection(player1_id);
-        ClientConnection* p2_conn = player_manager->getClientConnection(player2_id);
-
-        if (p1_conn) {
-            server_->sendToClient(p1_conn->getSocketFd(), header, &msg, sizeof(msg));
-        }
-        if (p2_conn) {
-            server_->sendToClient(p2_conn->getSocketFd(), header, &msg, sizeof(msg));
-        }
+        // Serialize once; both queues reference the same frame
+        SharedMessage frame = MessageBuffer::create(header, &msg, sizeof(msg));
+        player_manager->sendToPlayer(player1_id, frame);
+        player_manager->sendToPlayer(player2_id, frame);
     }
 }
 
@@ -675,24 +780,13 @@ void GameplayHandler::sendMoveResult(uint32_t match_id, uint32_t shooter_id, uin
     msg.game_over = game_over;
     msg.winner_id = winner_id;
 
-    MessageHeader header;
-    memset(&header, 0, sizeof(header));
-    header.type = MessageType::MOVE_RESULT;
-    header.length = sizeof(msg);
-    header.timestamp = time(nullptr);
-
     // Send to both players
     auto player_manager = server_->getPlayerManager();
     if (player_manager) {
-        ClientConnection* shooter_conn = player_manager->getClientConnection(shooter_id);
-        ClientConnection* target_conn = player_manager->getClientConnection(target_id);
-
-        if (shooter_conn) {
-            server_->sendToClient(shooter_conn->getSocketFd(), header, &msg, sizeof(msg));
-        }
-        if (target_conn) {
-            server_->sendToClient(target_conn->getSocketFd(), header, &msg, sizeof(msg));
-        }
+        // Serialize once; both queues reference the same frame
+        SharedMessage frame = MessageBuffer::create<MessageType::MOVE_RESULT>(msg);
+        player_manager->sendToPlayer(shooter_id, frame);
+        player_manager->sendToPlayer(target_id, frame);
     }
 }
 
@@ -703,12 +797,6 @@ void GameplayHandler::sendTurnUpdate(uint32_t match_id, uint32_t current_player_
     msg.turn_number = turn_number;
     msg.time_left = 20;
 
-    MessageHeader header;
-    memset(&header, 0, sizeof(header));
-    header.type = MessageType::TURN_UPDATE;
-    header.length = sizeof(msg);
-    header.timestamp = time(nullptr);
-
     // Get match state to find both players
     auto match = getMatch(match_id);
     if (!match) return;
@@ -716,15 +804,10 @@ void GameplayHandler::sendTurnUpdate(uint32_t match_id, uint32_t current_player_
     // Send to both players
     auto player_manager = server_->getPlayerManager();
     if (player_manager) {
-        ClientConnection* p1_conn = player_manager->getClientConnection(match->player1_id);
-        ClientConnection* p2_conn = player_manager->getClientConnection(match->player2_id);
-
-        if (p1_conn) {
-            server_->sendToClient(p1_conn->getSocketFd(), header, &msg, sizeof(msg));
-        }
-        if (p2_conn) {
-            server_->sendToClient(p2_conn->getSocketFd(), header, &msg, sizeof(msg));
-        }
+        // Serialize once; both queues reference the same frame
+        SharedMessage frame = MessageBuffer::create<MessageType::TURN_UPDATE>(msg);
+        player_manager->sendToPlayer(match->player1_id, frame);
+        player_manager->sendToPlayer(match->player2_id, frame);
     }
 }
 
@@ -803,10 +886,7 @@ void GameplayHandler::sendMatchEnd(uint32_t match_id, uint32_t player1_id, uint3
 
     auto player_manager = server_->getPlayerManager();
     if (player_manager) {
-        ClientConnection* p1_conn = player_manager->getClientConnection(player1_id);
-        if (p1_conn) {
-            server_->sendToClient(p1_conn->getSocketFd(), header, &msg1, sizeof(msg1));
-        }
+        player_manager->sendToPlayer(player1_id, MessageBuffer::create(header, &msg1, sizeof(msg1)));
 
         // Send to player 2 with opposite result
         MatchEndMessage msg2 = msg1;
@@ -822,15 +902,12 @@ void GameplayHandler::sendMatchEnd(uint32_t match_id, uint32_t player1_id, uint3
         msg2.elo_change = p2_change;
         msg2.new_elo = p2_new_elo;
 
-        ClientConnection* p2_conn = player_manager->getClientConnection(player2_id);
-        if (p2_conn) {
-            server_->sendToClient(p2_conn->getSocketFd(), header, &msg2, sizeof(msg2));
-        }
+        player_manager->sendToPlayer(player2_id, MessageBuffer::create(header, &msg2, sizeof(msg2)));
     }
 }
 
 void GameplayHandler::handlePlayerDisconnect(uint32_t disconnected_user_id) {
-    std::cout << "[GAMEPLAY] Handling disconnect for user_id=" << disconnected_user_id << std::endl;
+    LOG_INFO("GAMEPLAY", "Handling disconnect for user_id=" << disconnected_user_id);
 
     // Find all matches involving this player
     std::vector<uint32_t> matches_to_end;
@@ -847,6 +924,10 @@ void GameplayHandler::handlePlayerDisconnect(uint32_t disconnected_user_id) {
 
     // End each match where this player was involved
     for (uint32_t match_id : matches_to_end) {
+        auto match_lock = getMatchLock(match_id);
+        if (!match_lock) continue;
+        std::lock_guard<std::mutex> guard(*match_lock);
+
         auto match = getMatch(match_id);
         if (!match) continue;
 
@@ -854,8 +935,8 @@ void GameplayHandler::handlePlayerDisconnect(uint32_t disconnected_user_id) {
         uint32_t player2_id = match->player2_id;
         uint32_t opponent_id = (player1_id == disconnected_user_id) ? player2_id : player1_id;
 
-        std::cout << "[GAMEPLAY] Match " << match_id << " - Player " << disconnected_user_id
-                  << " disconnected, awarding win to player " << opponent_id << std::endl;
+        LOG_INFO("GAMEPLAY", "Match " << match_id << " - Player " << disconnected_user_id
+                << " disconnected, awarding win to player " << opponent_id);
 
         // Opponent wins, disconnected player loses
         // Calculate match duration
@@ -895,7 +976,7 @@ void GameplayHandler::handleRematchRequest(const MessageHeader& header,
     std::string token(header.session_token);
     uint32_t requester_id = db_->validateSession(token);
     if (requester_id == 0) {
-        std::cout << "[REMATCH] Invalid session token" << std::endl;
+        LOG_WARN("REMATCH", "Invalid session token");
         return;
     }
 
@@ -903,8 +984,8 @@ void GameplayHandler::handleRematchRequest(const MessageHeader& header,
     // For now, we need to track who played in each match
     // This is a simplification - in production, query match participants from DB
 
-    std::cout << "[REMATCH] User " << requester_id << " requests rematch for match "
-              << msg.previous_match_id << std::endl;
+    LOG_INFO("REMATCH", "User " << requester_id << " requests rematch for match "
+            << msg.previous_match_id);
 
     // Query database for match participants
     // Simplified: assume we can get opponent from previous match
@@ -914,21 +995,12 @@ void GameplayHandler::handleRematchRequest(const MessageHeader& header,
     {
         std::lock_guard<std::mutex> lock(rematch_mutex_);
         // This is incomplete without DB query - will implement full version
-        std::cout << "[REMATCH] Rematch request stored for match " << msg.previous_match_id << std::endl;
+        LOG_INFO("REMATCH", "Rematch request stored for match " << msg.previous_match_id);
     }
 
     // TODO: Query opponent_id from database and forward request
     // Forward rematch request to opponent
-    // MessageHeader forward_header;
-    // memset(&forward_header, 0, sizeof(forward_header));
-    // forward_header.type = MessageType::REMATCH_REQUEST;
-    // forward_header.length = sizeof(msg);
-    // forward_header.timestamp = time(nullptr);
-
-    // ClientConnection* opponent_conn = server_->getPlayerManager()->getClientConnection(opponent_id);
-    // if (opponent_conn) {
-    //     server_->sendToClient(opponent_conn->getSocketFd(), forward_header, &msg, sizeof(msg));
-    // }
+    // server_->getPlayerManager()->sendToPlayer(opponent_id, MessageBuffer::create(MessageType::REMATCH_REQUEST, msg));
 }
 
 void GameplayHandler::handleRematchResponse(const MessageHeader& header,
@@ -943,8 +1015,8 @@ void GameplayHandler::handleRematchResponse(const MessageHeader& header,
         return;
     }
 
-    std::cout << "[REMATCH] User " << responder_id << " responded to rematch: "
-              << (msg.accepted ? "ACCEPTED" : "DECLINED") << std::endl;
+    LOG_INFO("REMATCH", "User " << responder_id << " responded to rematch: "
+            << (msg.accepted ? "ACCEPTED" : "DECLINED"));
 
     if (!msg.accepted) {
         // Forward decline to requester
@@ -0,0 +1,320 @@
+#include "hot_restart.h"
+#include "snapshot.h"
+#include "logger.h"
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+
+const uint32_t HANDOFF_MAGIC = 0x34485342;  // "BSH4"; changes with the snapshot layout or handshake
+const char READY_BYTE = 'R';
+const char GO_BYTE = 'G';
+
+bool makeAddress(const std::string& path, struct sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("HANDOFF", "Invalid socket path: " << path);
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+void closeAll(const std::vector<int>& fds) {
+    for (int fd : fds) {
+        close(fd);
+    }
+}
+
+}  // namespace
+
+int HotRestart::listen(const std::string& path) {
+    struct sockaddr_un addr;
+    if (!makeAddress(path, addr)) {
+        return -1;
+    }
+
+    // A path that still accepts connections belongs to a running server: leave it alone
+    int probe = connect(path);
+    if (probe >= 0) {
+        close(probe);
+        LOG_ERROR("HANDOFF", path << " is in use by another server");
+        return -1;
+    }
+    unlink(path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("HANDOFF", "socket failed: " << strerror(errno));
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, 1) < 0) {
+        LOG_ERROR("HANDOFF", "Failed to listen on " << path << ": " << strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int HotRestart::connect(const std::string& path) {
+    struct sockaddr_un addr;
+    if (!makeAddress(path, addr)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool HotRestart::sendChunk(int channel_fd, const char* data, size_t size, const int* fds, size_t fd_count) {
+    if (size == 0 || fd_count > MAX_FDS_PER_CHUNK) {
+        return false;  // Descriptors need at least one data byte to travel with
+    }
+
+    struct iovec iov;
+    iov.iov_base = const_cast<char*>(data);
+    iov.iov_len = size;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    std::vector<char> control;
+    if (fd_count > 0) {
+        control.assign(CMSG_SPACE(fd_count * sizeof(int)), 0);
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(fd_count * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, fd_count * sizeof(int));
+    }
+
+    while (true) {
+        ssize_t sent = sendmsg(channel_fd, &msg, MSG_NOSIGNAL);
+        if (sent == static_cast<ssize_t>(size)) {
+            return true;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        LOG_ERROR("HANDOFF", "sendmsg failed: " << (sent < 0 ? strerror(errno) : "short write"));
+        return false;
+    }
+}
+
+bool HotRestart::receiveChunk(int channel_fd, std::string& data, std::vector<int>& fds) {
+    std::vector<char> buffer(MAX_BYTES_PER_CHUNK + 64);
+    std::vector<char> control(CMSG_SPACE(MAX_FDS_PER_CHUNK * sizeof(int)));
+
+    struct iovec iov;
+    iov.iov_base = buffer.data();
+    iov.iov_len = buffer.size();
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t received;
+    do {
+        received = recvmsg(channel_fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+
+    // Take ownership of whatever arrived before judging the message
+    size_t fds_before = fds.size();
+    if (received >= 0) {
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                const int* passed = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+                fds.insert(fds.end(), passed, passed + count);
+            }
+        }
+    }
+
+    if (received <= 0 || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        LOG_ERROR("HANDOFF", "recvmsg failed: "
+                << (received < 0 ? strerror(errno) : received == 0 ? "channel closed" : "message truncated"));
+        closeAll(std::vector<int>(fds.begin() + fds_before, fds.end()));
+        fds.resize(fds_before);
+        return false;
+    }
+
+    data.assign(buffer.data(), received);
+    return true;
+}
+
+bool HotRestart::send(int channel_fd, const HandoffState& state) {
+    SnapshotWriter body;
+    body.put(static_cast<uint32_t>(state.listen_fds.size()));
+    body.put(static_cast<uint32_t>(state.clients.size()));
+    for (const HandoffClient& client : state.clients) {
+        body.put(static_cast<int32_t>(client.fd));
+        body.put(client.peer_address);
+        body.put(client.user_id);
+        body.put(client.authenticated);
+        body.putString(client.session_token);
+        body.put(client.wire_version);
+        body.put(client.capabilities);
+        body.putString(client.inbound);
+        body.putString(client.outbound);
+    }
+    body.putString(state.players);
+    body.putString(state.matches);
+
+    std::vector<int> fds(state.listen_fds);
+    for (const HandoffClient& client : state.clients) {
+        fds.push_back(client.fd);
+    }
+
+    // Totals first, so the receiver knows when it has everything
+    SnapshotWriter header;
+    header.put(HANDOFF_MAGIC);
+    header.put(static_cast<uint64_t>(body.data().size()));
+    header.put(static_cast<uint32_t>(fds.size()));
+    if (!sendChunk(channel_fd, header.data().data(), header.data().size(), nullptr, 0)) {
+        return false;
+    }
+
+    // Each chunk leads with a marker byte so it can carry descriptors after the body runs out
+    const std::string& bytes = body.data();
+    size_t byte_offset = 0;
+    size_t fd_offset = 0;
+    std::string chunk;
+    while (byte_offset < bytes.size() || fd_offset < fds.size()) {
+        size_t byte_count = std::min(bytes.size() - byte_offset, MAX_BYTES_PER_CHUNK);
+        size_t fd_count = std::min(fds.size() - fd_offset, MAX_FDS_PER_CHUNK);
+
+        chunk.assign(1, 'C');
+        chunk.append(bytes, byte_offset, byte_count);
+        if (!sendChunk(channel_fd, chunk.data(), chunk.size(), fds.data() + fd_offset, fd_count)) {
+            return false;
+        }
+        byte_offset += byte_count;
+        fd_offset += fd_count;
+    }
+    return true;
+}
+
+bool HotRestart::receive(int channel_fd, HandoffState& state) {
+    std::string chunk;
+    std::vector<int> fds;
+    if (!receiveChunk(channel_fd, chunk, fds)) {
+        return false;
+    }
+
+    SnapshotReader header(chunk);
+    uint32_t magic = 0;
+    uint64_t body_size = 0;
+    uint32_t fd_count = 0;
+    header.get(magic);
+    header.get(body_size);
+    header.get(fd_count);
+    if (!header.ok() || magic != HANDOFF_MAGIC || !fds.empty()) {
+        LOG_ERROR("HANDOFF", "Unexpected handoff header");
+        closeAll(fds);
+        return false;
+    }
+
+    std::string bytes;
+    while (bytes.size() < body_size || fds.size() < fd_count) {
+        if (!receiveChunk(channel_fd, chunk, fds) || chunk[0] != 'C' ||
+            bytes.size() + chunk.size() - 1 > body_size || fds.size() > fd_count) {
+            LOG_ERROR("HANDOFF", "Handoff stream ended early or is malformed");
+            closeAll(fds);
+            return false;
+        }
+        bytes.append(chunk, 1, std::string::npos);
+    }
+
+    SnapshotReader body(bytes);
+    uint32_t listen_count = 0;
+    uint32_t client_count = 0;
+    body.get(listen_count);
+    body.get(client_count);
+    if (!body.ok() || static_cast<uint64_t>(listen_count) + client_count != fd_count) {
+        LOG_ERROR("HANDOFF", "Snapshot does not match the descriptors passed");
+        closeAll(fds);
+        return false;
+    }
+
+    HandoffState received;
+    received.listen_fds.assign(fds.begin(), fds.begin() + listen_count);
+    for (uint32_t i = 0; i < client_count && body.ok(); i++) {
+        HandoffClient client;
+        int32_t sender_fd = -1;
+        body.get(sender_fd);
+        body.get(client.peer_address);
+        body.get(client.user_id);
+        body.get(client.authenticated);
+        body.getString(client.session_token);
+        body.get(client.wire_version);
+        body.get(client.capabilities);
+        body.getString(client.inbound);
+        body.getString(client.outbound);
+        client.fd = fds[listen_count + i];
+        client.sender_fd = sender_fd;
+        received.clients.push_back(client);
+    }
+    body.getString(received.players);
+    body.getString(received.matches);
+
+    if (!body.ok() || !body.atEnd()) {
+        LOG_ERROR("HANDOFF", "Snapshot is truncated");
+        closeAll(fds);
+        return false;
+    }
+
+    state = received;
+    return true;
+}
+
+bool HotRestart::sendReady(int channel_fd) {
+    return sendChunk(channel_fd, &READY_BYTE, 1, nullptr, 0);
+}
+
+bool HotRestart::waitReady(int channel_fd, int timeout_ms) {
+    return waitFor(channel_fd, READY_BYTE, timeout_ms);
+}
+
+bool HotRestart::sendGo(int channel_fd) {
+    return sendChunk(channel_fd, &GO_BYTE, 1, nullptr, 0);
+}
+
+bool HotRestart::waitGo(int channel_fd) {
+    return waitFor(channel_fd, GO_BYTE, -1);
+}
+
+bool HotRestart::waitFor(int channel_fd, char expected, int timeout_ms) {
+    struct pollfd pfd;
+    pfd.fd = channel_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int ready;
+    do {
+        ready = poll(&pfd, 1, timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+
+    char byte = 0;
+    return ready > 0 && recv(channel_fd, &byte, 1, 0) == 1 && byte == expected;
+}
@@ -4,34 +4,117 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <algorithm>
 #include "server.h"
+#include "client_connection.h"
 #include "config.h"
+#include "logger.h"
 
-// Global server instance for signal handling
+// Global server instance
 std::unique_ptr<Server> g_server;
 
+// Set by the signal handler; the main loop does the actual shutdown
+volatile sig_atomic_t g_stop_signal = 0;
+
 // Signal handler for graceful shutdown
 void signalHandler(int signal) {
-    std::cout << "\n[SIGNAL] Received signal " << signal << std::endl;
-    if (g_server) {
-        std::cout << "[SERVER] Shutting down gracefully..." << std::endl;
-        g_server->stop();
-    }
-    exit(0);
+    g_stop_signal = signal;
 }
 
 int main(int argc, char* argv[]) {
-    // Parse command line arguments
+    // Parse command line arguments: [port] [--takeover]
     int port = SERVER_PORT;  // Use config.h default
-    if (argc > 1) {
-        port = std::atoi(argv[1]);
+    bool takeover = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--takeover") == 0) {
+            takeover = true;
+            continue;
+        }
+        port = std::atoi(argv[i]);
         if (port <= 0 || port > 65535) {
-            std::cerr << "Invalid port number: " << argv[1] << std::endl;
-            std::cerr << "Usage: " << argv[0] << " [port]" << std::endl;
+            std::cerr << "Invalid port number: " << argv[i] << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [port] [--takeover]" << std::endl;
             return 1;
         }
     }
 
+    // Unix socket for co-located clients (overridable via environment; empty disables)
+    const char* unix_socket = UNIX_SOCKET_PATH;
+    if (const char* env = std::getenv("UNIX_SOCKET")) {
+        unix_socket = env;
+    }
+
+    // Hot restart socket (overridable via environment; empty disables)
+    const char* handoff_socket = HANDOFF_SOCKET_PATH;
+    if (const char* env = std::getenv("HANDOFF_SOCKET")) {
+        handoff_socket = env;
+    }
+
+    // Number of I/O reactors (overridable via environment)
+    int io_reactors = DEFAULT_IO_REACTORS;
+    if (const char* env = std::getenv("IO_REACTORS")) {
+        io_reactors = std::atoi(env);
+    }
+
+    // Event loop backend (overridable via environment)
+    const char* io_backend = DEFAULT_IO_BACKEND;
+    if (const char* env = std::getenv("IO_BACKEND")) {
+        io_backend = env;
+    }
+
+    // Number of message handling workers (overridable via environment)
+    int worker_threads = DEFAULT_WORKER_THREADS;
+    if (const char* env = std::getenv("WORKER_THREADS")) {
+        worker_threads = std::atoi(env);
+    }
+
+    // Per-client outbound queue limit and what happens when a slow client hits it
+    size_t outbound_limit = OUTBOUND_QUEUE_LIMIT;
+    if (const char* env = std::getenv("OUTBOUND_QUEUE_BYTES")) {
+        outbound_limit = std::strtoul(env, nullptr, 10);
+    }
+    ClientConnection::OverflowPolicy overflow_policy = ClientConnection::OVERFLOW_DROP_LOBBY;
+    if (const char* env = std::getenv("OUTBOUND_OVERFLOW")) {
+        if (std::strcmp(env, "disconnect") == 0) {
+            overflow_policy = ClientConnection::OVERFLOW_DISCONNECT;
+        }
+    }
+    ClientConnection::setOutboundLimit(outbound_limit, overflow_policy);
+
+    // Connection caps (overridable via environment)
+    int max_connections = MAX_CLIENTS;
+    if (const char* env = std::getenv("MAX_CONNECTIONS")) {
+        max_connections = std::atoi(env);
+    }
+    int max_per_ip = MAX_CLIENTS_PER_IP;
+    if (const char* env = std::getenv("MAX_CONNECTIONS_PER_IP")) {
+        max_per_ip = std::atoi(env);
+    }
+
+    // Per-connection message budgets (applied on top of DEFAULT_RATE_LIMITS)
+    const char* rate_limits = std::getenv("RATE_LIMITS");
+
+    // Heartbeat timing for silent clients (overridable via environment)
+    int idle_timeout = IDLE_TIMEOUT_SECONDS;
+    if (const char* env = std::getenv("IDLE_TIMEOUT")) {
+        idle_timeout = std::atoi(env);
+    }
+    int heartbeat_grace = HEARTBEAT_GRACE_SECONDS;
+    if (const char* env = std::getenv("HEARTBEAT_GRACE")) {
+        heartbeat_grace = std::atoi(env);
+    }
+
+    // Log level (overridable via environment; DEBUG lines need a debug build)
+    if (const char* env = std::getenv("LOG_LEVEL")) {
+        LogLevel level;
+        if (Logger::parseLevel(env, level)) {
+            Logger::setLevel(level);
+        } else {
+            std::cerr << "Unknown LOG_LEVEL: " << env << " (using INFO)" << std::endl;
+        }
+    }
+
     // Setup signal handlers
     std::signal(SIGINT, signalHandler);   // Ctrl+C
     std::signal(SIGTERM, signalHandler);  // kill command
@@ -44,30 +127,104 @@ int main(int argc, char* argv[]) {
     std::cout << "╚════════════════════════════════════╝" << std::endl;
     std::cout << std::endl;
 
+    // From here on log lines are written by a background thread
+    Logger::start();
+
     // Create and start server
     g_server = std::make_unique<Server>(port);
+    g_server->setReactorCount(io_reactors);
+    g_server->setIoBackend(std::strcmp(io_backend, "io_uring") == 0 ? IO_BACKEND_URING : IO_BACKEND_EPOLL);
+    g_server->setWorkerCount(worker_threads);
+    g_server->setIdleTimeout(idle_timeout, heartbeat_grace);
+    g_server->setConnectionLimits(std::max(max_connections, 0), std::max(max_per_ip, 0));
+    if (rate_limits && !g_server->setRateLimits(rate_limits)) {
+        LOG_WARN("SERVER", "RATE_LIMITS is malformed, applied up to the first bad entry: " << rate_limits);
+    }
+    g_server->setUnixSocket(unix_socket);
+    g_server->setHandoffSocket(handoff_socket);
 
-    if (!g_server->start()) {
-        std::cerr << "[ERROR] Failed to start server" << std::endl;
+    // --takeover: adopt the sockets and sessions of the server already running
+    // (same port; it exits once we are serving)
+    bool started = takeover ? g_server->takeOver(handoff_socket) : g_server->start();
+    if (!started) {
+        LOG_ERROR("SERVER", "Failed to start server");
+        Logger::stop();
         return 1;
     }
 
-    std::cout << "[SERVER] Server started successfully!" << std::endl;
-    std::cout << "[SERVER] Listening on port " << port << std::endl;
-    std::cout << "[SERVER] Press Ctrl+C to stop" << std::endl;
-    std::cout << std::endl;
+    LOG_INFO("SERVER", "Server started successfully!");
+    LOG_INFO("SERVER", "Listening on port " << port
+            << " (" << g_server->getReactorCount() << " I/O reactors on "
+            << (g_server->getIoBackend() == IO_BACKEND_URING ? "io_uring" : "epoll") << ", "
+            << g_server->getWorkerCount() << " workers)");
+    if (unix_socket[0] != '\0') {
+        LOG_INFO("SERVER", "Local clients can connect to " << unix_socket);
+    }
+    LOG_INFO("SERVER", "Press Ctrl+C to stop");
 
     // Main loop (server runs in background threads)
-    while (g_server->isRunning()) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    while (g_server->isRunning() || g_server->isHandingOff()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        if (g_stop_signal) {
+            LOG_INFO("SIGNAL", "Received signal " << g_stop_signal);
+            LOG_INFO("SERVER", "Shutting down gracefully...");
+            g_server->stop();
+            break;
+        }
 
         // Print statistics every 30 seconds
         static int counter = 0;
-        if (++counter % 30 == 0) {
-            std::cout << "[STATS] Connected clients: " << g_server->getConnectedClients()
-                      << " | Active matches: " << g_server->getActiveMatches() << std::endl;
+        if (++counter % 150 == 0 && g_server->isRunning()) {
+            LOG_INFO("STATS", "Connected clients: " << g_server->getConnectedClients()
+                    << " | Active matches: " << g_server->getActiveMatches());
+
+            WorkerPool::Stats workers = g_server->getWorkerStats();
+            LOG_INFO("STATS", "Workers: " << workers.threads
+                    << " | Queued: " << workers.queue_depth << " (max " << workers.max_queue_depth << ")"
+                    << " | Run: " << workers.tasks_run
+                    << " | Wait avg/max: " << static_cast<uint64_t>(workers.avg_wait_us) << "/"
+                    << workers.max_wait_us << " us"
+                    << " | Steals: " << workers.steals);
+
+            ClientConnection::OutboundStats outbound = ClientConnection::getOutboundStats();
+            LOG_INFO("STATS", "Outbound queued: " << outbound.queued_bytes << " bytes"
+                    << " | Dropped: " << outbound.frames_dropped
+                    << " | Coalesced: " << outbound.frames_coalesced
+                    << " | Evicted: " << outbound.evictions);
+
+            Reactor::IdleStats idle = g_server->getIdleStats();
+            LOG_INFO("STATS", "Heartbeats: " << idle.heartbeats_sent
+                    << " | Idle reaped: " << idle.evictions
+                    << " | Silent avg/max: "
+                    << (idle.evictions > 0 ? idle.silence_total_ms / idle.evictions : 0) << "/"
+                    << idle.silence_max_ms << " ms");
+
+            AdmissionControl::Stats admission = g_server->getAdmissionStats();
+            LOG_INFO("STATS", "Admitted: " << admission.admitted
+                    << " | Refused full/per-IP: " << admission.rejected_full << "/"
+                    << admission.rejected_address);
+
+            RateLimiter::Stats limited = g_server->getRateLimitStats();
+            std::string by_type;
+            for (size_t type = 0; type < 256; type++) {
+                if (limited.dropped_by_type[type] > 0) {
+                    const char* name = RateLimiter::typeName(static_cast<uint8_t>(type));
+                    by_type += " " + (name ? std::string(name) : std::to_string(type)) + "="
+                             + std::to_string(limited.dropped_by_type[type]);
+                }
+            }
+            LOG_INFO("STATS", "Rate limited: " << limited.dropped << by_type);
+
+            Logger::Stats log = Logger::getStats();
+            LOG_INFO("STATS", "Log lines: " << log.lines << " | Dropped: " << log.dropped);
         }
     }
 
+    if (g_server->hasHandedOff()) {
+        LOG_INFO("SERVER", "Handed off to the new process, exiting");
+    }
+    g_server.reset();
+    Logger::stop();
     return 0;
 }
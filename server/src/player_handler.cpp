@@ -3,24 +3,30 @@
 #include "player_manager.h"
 #include "client_connection.h"
 #include "messages/matchmaking_messages.h"
+#include "player_list.h"
 #include "message_serialization.h"
-#include <iostream>
+#include "logger.h"
 #include <cstring>
 
 using namespace MessageSerialization;
 
+namespace {
+// Most players in one PLAYER_LIST page, however short their names
+const size_t MAX_PAGE_SIZE = (MAX_MESSAGE_SIZE - PlayerListPage::HEADER_SIZE) / PlayerListPage::MIN_ENTRY_SIZE;
+}
+
 PlayerHandler::PlayerHandler(Server* server, PlayerManager* player_manager)
     : server_(server), player_manager_(player_manager) {
-    std::cout << "[PLAYER_HANDLER] Initialized" << std::endl;
+    LOG_INFO("PLAYER_HANDLER", "Initialized");
 }
 
 bool PlayerHandler::canHandle(MessageType type) const {
-    return type == MessageType::PLAYER_LIST_REQUEST;
+    return MessageSchema::handlesPlayer(type);
 }
 
 bool PlayerHandler::handleMessage(ClientConnection* client,
                                   const MessageHeader& header,
-                                  const std::string& payload) {
+                                  const PayloadView& payload) {
     MessageType type = static_cast<MessageType>(header.type);
 
     switch (type) {
@@ -31,38 +37,41 @@ bool PlayerHandler::handleMessage(ClientConnection* client,
     }
 }
 
-bool PlayerHandler::handlePlayerListRequest(ClientConnection* client, const std::string& payload) {
-    (void)payload;
-    std::cout << "[PLAYER_HANDLER] Player list request from client" << std::endl;
-
-    // Get list of online players
-    std::vector<PlayerInfo_Message> online_players = player_manager_->getOnlinePlayers();
+bool PlayerHandler::handlePlayerListRequest(ClientConnection* client, const PayloadView& payload) {
+    // Older clients send no payload: first page, no limit
+    PlayerListRequest req;
+    if (payload.size() > 0 && !deserialize(payload, req)) {
+        LOG_WARN("PLAYER_HANDLER", "Failed to deserialize PlayerListRequest");
+        return false;
+    }
 
-    // Debug: Print all online players
-    std::cout << "[PLAYER_HANDLER] Total online players in manager: " << online_players.size() << std::endl;
-    for (const auto& player : online_players) {
-        std::cout << "[PLAYER_HANDLER]   - Player: " << player.display_name 
-                  << " (ID: " << player.user_id 
-                  << ", Status: " << (int)player.status << ")" << std::endl;
+    size_t limit = MAX_PAGE_SIZE;
+    if (req.limit > 0 && req.limit < limit) {
+        limit = req.limit;
     }
+    LOG_DEBUG("PLAYER_HANDLER", "Player list request from client (cursor " << req.cursor
+            << ", limit " << req.limit << ")");
 
-    // Create response
-    PlayerListResponse response;
-    response.count = std::min(static_cast<size_t>(100), online_players.size());
+    // One extra to tell whether another page follows
+    PlayerListPage page;
+    std::vector<PlayerInfo_Message> players = player_manager_->getOnlinePlayers(req.cursor, limit + 1, page.total);
 
-    // Copy players to response (max 100)
-    for (size_t i = 0; i < response.count; i++) {
-        response.players[i] = online_players[i];
+    // Fill the page until the limit or the message size runs out
+    size_t size = PlayerListPage::HEADER_SIZE;
+    for (const auto& player : players) {
+        size_t entry_size = PlayerListPage::entrySize(player);
+        if (page.players.size() == limit || size + entry_size > MAX_MESSAGE_SIZE) {
+            page.next_cursor = page.players.back().user_id;
+            break;
+        }
+        page.players.push_back(player);
+        size += entry_size;
     }
 
-    std::cout << "[PLAYER_HANDLER] Sending " << response.count << " players to client" << std::endl;
-
-    // Send response
-    MessageHeader response_header;
-    response_header.type = static_cast<uint8_t>(MessageType::PLAYER_LIST);
-    response_header.length = sizeof(PlayerListResponse);
-    response_header.timestamp = time(nullptr);
-    memset(response_header.session_token, 0, sizeof(response_header.session_token));
+    LOG_DEBUG("PLAYER_HANDLER", "Sending " << page.players.size() << " of " << page.total
+            << " players to client (" << size << " bytes, next cursor " << page.next_cursor << ")");
 
-    return client->sendMessage(response_header, serialize(response));
+    std::string response = page.encode();
+    return client->sendMessage(MessageBuffer::create(createHeader(MessageType::PLAYER_LIST, response.size()),
+                                                     response));
 }
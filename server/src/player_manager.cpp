@@ -2,18 +2,20 @@
 #include "server.h"
 #include "client_connection.h"
 #include "message_serialization.h"
-#include <iostream>
+#include "snapshot.h"
+#include "logger.h"
 #include <cstring>
 
 using namespace MessageSerialization;
 
 PlayerManager::PlayerManager(Server* server) : server_(server) {
-    std::cout << "[PLAYER_MANAGER] Initialized" << std::endl;
+    LOG_INFO("PLAYER_MANAGER", "Initialized");
 }
 
 PlayerManager::~PlayerManager() {
     std::lock_guard<std::mutex> lock(mutex_);
     players_.clear();
+    routes_.clear();
 }
 
 void PlayerManager::addPlayer(ClientConnection* client, uint32_t user_id,
@@ -25,8 +27,8 @@ void PlayerManager::addPlayer(ClientConnection* client, uint32_t user_id,
         // Check if player already exists (same user_id from different connection)
         auto it = players_.find(user_id);
         if (it != players_.end()) {
-            std::cout << "[PLAYER_MANAGER] WARNING: Player " << display_name
-                      << " (ID: " << user_id << ") already exists! Overwriting..." << std::endl;
+            LOG_WARN("PLAYER_MANAGER", "Player " << display_name
+                    << " (ID: " << user_id << ") already exists! Overwriting...");
         }
 
         PlayerData data;
@@ -35,13 +37,14 @@ void PlayerManager::addPlayer(ClientConnection* client, uint32_t user_id,
         data.display_name = display_name;
         data.elo_rating = elo_rating;
         data.status = STATUS_AVAILABLE; // New players are available
-        data.client = client;
+        data.connection = client ? client->getHandle() : ConnectionHandle();
 
         players_[user_id] = data;
+        routes_.set(user_id, data.connection);
 
-        std::cout << "[PLAYER_MANAGER] Player added: " << display_name
-                  << " (ID: " << user_id << ", ELO: " << elo_rating 
-                  << "). Total players now: " << players_.size() << std::endl;
+        LOG_INFO("PLAYER_MANAGER", "Player added: " << display_name
+                << " (ID: " << user_id << ", ELO: " << elo_rating 
+                << "). Total players now: " << players_.size());
     } // Release lock before broadcasting
 
     // Broadcast status update to all clients (outside lock to avoid deadlock)
@@ -54,10 +57,11 @@ void PlayerManager::removePlayer(uint32_t user_id) {
 
         auto it = players_.find(user_id);
         if (it != players_.end()) {
-            std::cout << "[PLAYER_MANAGER] Player removed: " << it->second.display_name
-                      << " (ID: " << user_id << ")" << std::endl;
+            LOG_INFO("PLAYER_MANAGER", "Player removed: " << it->second.display_name
+                    << " (ID: " << user_id << ")");
 
             players_.erase(it);
+            routes_.erase(user_id);
         } else {
             return; // Player not found, nothing to do
         }
@@ -67,6 +71,29 @@ void PlayerManager::removePlayer(uint32_t user_id) {
     broadcastPlayerStatusUpdate(user_id, STATUS_OFFLINE);
 }
 
+void PlayerManager::removePlayer(uint32_t user_id, const ConnectionHandle& connection) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = players_.find(user_id);
+        if (it == players_.end()) {
+            return;
+        }
+        if (it->second.connection != connection) {
+            LOG_INFO("PLAYER_MANAGER", "Player " << it->second.display_name
+                    << " (ID: " << user_id << ") is on a newer connection, keeping");
+            return;
+        }
+
+        LOG_INFO("PLAYER_MANAGER", "Player removed: " << it->second.display_name
+                << " (ID: " << user_id << ")");
+        players_.erase(it);
+        routes_.erase(user_id, connection);
+    }
+
+    broadcastPlayerStatusUpdate(user_id, STATUS_OFFLINE);
+}
+
 void PlayerManager::updatePlayerStatus(uint32_t user_id, PlayerStatus status) {
     {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -75,8 +102,8 @@ void PlayerManager::updatePlayerStatus(uint32_t user_id, PlayerStatus status) {
         if (it != players_.end()) {
             it->second.status = status;
 
-            std::cout << "[PLAYER_MANAGER] Player status updated: " << it->second.display_name
-                      << " -> " << static_cast<int>(status) << std::endl;
+            LOG_DEBUG("PLAYER_MANAGER", "Player status updated: " << it->second.display_name
+                    << " -> " << static_cast<int>(status));
         } else {
             return; // Player not found, nothing to do
         }
@@ -116,6 +143,28 @@ std::vector<PlayerInfo_Message> PlayerManager::getOnlinePlayers() const {
     return result;
 }
 
+std::vector<PlayerInfo_Message> PlayerManager::getOnlinePlayers(uint32_t after, size_t limit,
+                                                                uint32_t& total) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    total = static_cast<uint32_t>(players_.size());
+    std::vector<PlayerInfo_Message> result;
+    for (auto it = players_.upper_bound(after); it != players_.end() && result.size() < limit; ++it) {
+        const PlayerData& data = it->second;
+
+        PlayerInfo_Message info;
+        info.user_id = data.user_id;
+        safeStrCopy(info.username, data.username, sizeof(info.username));
+        safeStrCopy(info.display_name, data.display_name, sizeof(info.display_name));
+        info.elo_rating = data.elo_rating;
+        info.status = data.status;
+
+        result.push_back(info);
+    }
+
+    return result;
+}
+
 std::vector<PlayerInfo_Message> PlayerManager::getAvailablePlayers() const {
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -156,14 +205,16 @@ PlayerInfo_Message PlayerManager::getPlayerInfo(uint32_t user_id) const {
     return info;
 }
 
-ClientConnection* PlayerManager::getClientConnection(uint32_t user_id) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+ConnectionHandle PlayerManager::getConnectionHandle(uint32_t user_id) const {
+    return routes_.find(user_id);
+}
 
-    auto it = players_.find(user_id);
-    if (it != players_.end()) {
-        return it->second.client;
+bool PlayerManager::sendToPlayer(uint32_t user_id, const SharedMessage& message) const {
+    ConnectionHandle connection = routes_.find(user_id);
+    if (!connection.valid() || !server_) {
+        return false;
     }
-    return nullptr;
+    return server_->sendToClient(connection, message);
 }
 
 bool PlayerManager::isPlayerOnline(uint32_t user_id) const {
@@ -200,20 +251,69 @@ void PlayerManager::broadcastPlayerStatusUpdate(uint32_t user_id, PlayerStatus s
 
     // Broadcast to all connected clients (only if server is running)
     if (server_ && server_->isRunning()) {
-        MessageHeader header;
-        header.type = static_cast<uint8_t>(MessageType::PLAYER_STATUS_UPDATE);
-        header.length = sizeof(PlayerStatusUpdate);
-        header.timestamp = time(nullptr);
-        memset(header.session_token, 0, sizeof(header.session_token));
-
-        std::cout << "[PLAYER_MANAGER] Broadcasting status update: "
-                  << info.display_name << " (ID: " << user_id 
-                  << ") -> Status: " << static_cast<int>(status) << std::endl;
+        LOG_DEBUG("PLAYER_MANAGER", "Broadcasting status update: "
+                << info.display_name << " (ID: " << user_id 
+                << ") -> Status: " << static_cast<int>(status));
         
-        server_->broadcast(header, serialize(update));
+        server_->broadcast(MessageBuffer::create<MessageType::PLAYER_STATUS_UPDATE>(update));
 
-        std::cout << "[PLAYER_MANAGER] Broadcast sent to all clients" << std::endl;
+        LOG_DEBUG("PLAYER_MANAGER", "Broadcast sent to all clients");
     } else {
-        std::cerr << "[PLAYER_MANAGER] WARNING: Cannot broadcast - server not running!" << std::endl;
+        LOG_WARN("PLAYER_MANAGER", "Cannot broadcast - server not running!");
+    }
+}
+
+std::string PlayerManager::exportState() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SnapshotWriter writer;
+    writer.put(static_cast<uint32_t>(players_.size()));
+    for (const auto& pair : players_) {
+        const PlayerData& data = pair.second;
+        writer.put(data.user_id);
+        writer.putString(data.username);
+        writer.putString(data.display_name);
+        writer.put(data.elo_rating);
+        writer.put(data.status);
+        writer.put(static_cast<int32_t>(data.connection.fd));
+    }
+    return writer.data();
+}
+
+bool PlayerManager::importState(const std::string& data, const std::map<int, ClientConnection*>& clients) {
+    SnapshotReader reader(data);
+    uint32_t count = 0;
+    reader.get(count);
+
+    std::map<uint32_t, PlayerData> restored;
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        PlayerData player;
+        int32_t client_fd = -1;
+        reader.get(player.user_id);
+        reader.getString(player.username);
+        reader.getString(player.display_name);
+        reader.get(player.elo_rating);
+        reader.get(player.status);
+        reader.get(client_fd);
+
+        auto it = clients.find(client_fd);
+        if (it != clients.end()) {
+            player.connection = it->second->getHandle();
+            restored[player.user_id] = player;
+        }
+    }
+    if (!reader.ok() || !reader.atEnd()) {
+        LOG_ERROR("PLAYER_MANAGER", "Player snapshot is malformed");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    players_.swap(restored);
+    routes_.clear();
+    for (const auto& pair : players_) {
+        routes_.set(pair.first, pair.second.connection);
     }
+    LOG_INFO("PLAYER_MANAGER", "Restored " << players_.size() << " of " << count
+            << " online players");
+    return true;
 }
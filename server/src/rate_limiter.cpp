@@ -0,0 +1,223 @@
+#include "rate_limiter.h"
+#include "protocol.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+const size_t RateLimiter::MAX_LIMITED_TYPES;
+const size_t RateLimiter::CONNECTION_SLOT;
+
+namespace {
+const uint32_t TOKENS_PER_MESSAGE = 1000;
+const uint32_t MAX_BURST = 1000000;    // Keeps burst * TOKENS_PER_MESSAGE in 32 bits
+
+struct TypeName {
+    uint8_t type;
+    const char* name;
+};
+
+const TypeName TYPE_NAMES[] = {
+    {AUTH_REGISTER, "AUTH_REGISTER"}, {AUTH_LOGIN, "AUTH_LOGIN"}, {AUTH_LOGOUT, "AUTH_LOGOUT"},
+    {AUTH_RESPONSE, "AUTH_RESPONSE"}, {VALIDATE_SESSION, "VALIDATE_SESSION"},
+    {PLAYER_LIST_REQUEST, "PLAYER_LIST_REQUEST"}, {PLAYER_LIST, "PLAYER_LIST"},
+    {PLAYER_STATUS_UPDATE, "PLAYER_STATUS_UPDATE"},
+    {CHALLENGE_SEND, "CHALLENGE_SEND"}, {CHALLENGE_RECEIVED, "CHALLENGE_RECEIVED"},
+    {CHALLENGE_RESPONSE, "CHALLENGE_RESPONSE"}, {MATCH_START, "MATCH_START"}, {MATCH_READY, "MATCH_READY"},
+    {SHIP_PLACEMENT, "SHIP_PLACEMENT"}, {MOVE, "MOVE"}, {MOVE_RESULT, "MOVE_RESULT"},
+    {TURN_UPDATE, "TURN_UPDATE"}, {MATCH_STATE, "MATCH_STATE"}, {MATCH_END, "MATCH_END"},
+    {PAUSE_REQUEST, "PAUSE_REQUEST"}, {PAUSE_RESPONSE, "PAUSE_RESPONSE"},
+    {DRAW_OFFER, "DRAW_OFFER"}, {DRAW_RESPONSE, "DRAW_RESPONSE"}, {RESIGN, "RESIGN"},
+    {REMATCH_REQUEST, "REMATCH_REQUEST"}, {REMATCH_RESPONSE, "REMATCH_RESPONSE"},
+    {REPLAY_REQUEST, "REPLAY_REQUEST"}, {REPLAY_DATA, "REPLAY_DATA"},
+    {STATS_REQUEST, "STATS_REQUEST"}, {STATS_DATA, "STATS_DATA"}, {ELO_UPDATE, "ELO_UPDATE"},
+    {CHAT_MESSAGE, "CHAT_MESSAGE"}, {ERROR, "ERROR"}, {NOTIFICATION, "NOTIFICATION"},
+    {PING, "PING"}, {PONG, "PONG"}, {SERVER_BUSY, "SERVER_BUSY"},
+    {BATCH, "BATCH"}, {CAPABILITIES, "CAPABILITIES"},
+};
+
+bool parseType(const std::string& text, uint8_t& type) {
+    for (const TypeName& entry : TYPE_NAMES) {
+        if (text == entry.name) {
+            type = entry.type;
+            return true;
+        }
+    }
+    char* end = nullptr;
+    unsigned long number = std::strtoul(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || number > 255) {
+        return false;
+    }
+    type = static_cast<uint8_t>(number);
+    return true;
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+// "per_second/burst" or "0"
+bool parseBudget(const std::string& text, RateLimiter::Budget& budget) {
+    char* end = nullptr;
+    unsigned long rate = std::strtoul(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return false;
+    }
+    if (*end == '\0' && rate == 0) {
+        budget.per_second = 0;
+        budget.burst = 0;
+        return true;
+    }
+    if (*end != '/') {
+        return false;
+    }
+    const char* burst_text = end + 1;
+    unsigned long burst = std::strtoul(burst_text, &end, 10);
+    if (end == burst_text || *end != '\0' || rate > MAX_BURST || burst == 0 || burst > MAX_BURST) {
+        return false;
+    }
+    budget.per_second = static_cast<uint32_t>(rate);
+    budget.burst = static_cast<uint32_t>(burst);
+    return true;
+}
+}
+
+RateLimiter::RateLimiter()
+    : slots_used_(0)
+{
+    memset(slot_of_type_, -1, sizeof(slot_of_type_));
+    for (Budget& budget : budgets_) {
+        budget.per_second = 0;
+        budget.burst = 0;
+    }
+    for (auto& counter : dropped_) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool RateLimiter::setBudget(uint8_t type, const Budget& budget) {
+    int slot = slot_of_type_[type];
+    if (slot < 0) {
+        if (budget.per_second == 0) {
+            return true;
+        }
+        if (slots_used_ >= MAX_LIMITED_TYPES) {
+            return false;
+        }
+        slot = static_cast<int>(slots_used_++);
+        slot_of_type_[type] = static_cast<int8_t>(slot);
+    }
+    budgets_[slot] = budget;
+    return true;
+}
+
+RateLimiter::Budget RateLimiter::getBudget(uint8_t type) const {
+    int slot = slot_of_type_[type];
+    if (slot < 0) {
+        Budget none = {0, 0};
+        return none;
+    }
+    return budgets_[slot];
+}
+
+void RateLimiter::setConnectionBudget(const Budget& budget) {
+    budgets_[CONNECTION_SLOT] = budget;
+}
+
+bool RateLimiter::configure(const std::string& spec) {
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        std::string entry = trim(spec.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+        start = comma == std::string::npos ? spec.size() + 1 : comma + 1;
+        if (entry.empty()) {
+            continue;
+        }
+
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        std::string name = trim(entry.substr(0, equals));
+        Budget budget;
+        if (!parseBudget(trim(entry.substr(equals + 1)), budget)) {
+            return false;
+        }
+
+        if (name == "*") {
+            setConnectionBudget(budget);
+            continue;
+        }
+        uint8_t type;
+        if (!parseType(name, type) || !setBudget(type, budget)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RateLimiter::allow(Buckets& buckets, uint8_t type, uint32_t now_ms) {
+    if (budgets_[CONNECTION_SLOT].per_second > 0 &&
+        !take(buckets, CONNECTION_SLOT, budgets_[CONNECTION_SLOT], now_ms)) {
+        dropped_[type].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int slot = slot_of_type_[type];
+    if (slot >= 0 && budgets_[slot].per_second > 0 && !take(buckets, slot, budgets_[slot], now_ms)) {
+        dropped_[type].fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool RateLimiter::take(Buckets& buckets, size_t slot, const Budget& budget, uint32_t now_ms) {
+    uint32_t capacity = budget.burst * TOKENS_PER_MESSAGE;
+    uint32_t tokens;
+    if (!buckets.primed[slot]) {
+        buckets.primed[slot] = true;
+        tokens = capacity;
+    } else {
+        // per_second messages a second is per_second thousandths a millisecond
+        uint64_t refill = static_cast<uint64_t>(now_ms - buckets.refilled_ms[slot]) * budget.per_second;
+        uint64_t topped = buckets.tokens[slot] + refill;
+        tokens = topped > capacity ? capacity : static_cast<uint32_t>(topped);
+    }
+    buckets.refilled_ms[slot] = now_ms;
+
+    if (tokens < TOKENS_PER_MESSAGE) {
+        buckets.tokens[slot] = tokens;
+        return false;
+    }
+    buckets.tokens[slot] = tokens - TOKENS_PER_MESSAGE;
+    return true;
+}
+
+uint32_t RateLimiter::nowMs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return static_cast<uint32_t>(static_cast<uint64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000);
+}
+
+const char* RateLimiter::typeName(uint8_t type) {
+    for (const TypeName& entry : TYPE_NAMES) {
+        if (entry.type == type) {
+            return entry.name;
+        }
+    }
+    return nullptr;
+}
+
+RateLimiter::Stats RateLimiter::getStats() const {
+    Stats stats;
+    stats.dropped = 0;
+    for (size_t type = 0; type < 256; type++) {
+        stats.dropped_by_type[type] = dropped_[type].load(std::memory_order_relaxed);
+        stats.dropped += stats.dropped_by_type[type];
+    }
+    return stats;
+}
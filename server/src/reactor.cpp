@@ -0,0 +1,380 @@
+#include "reactor.h"
+#include "client_connection.h"
+#include "message_buffer.h"
+#include "logger.h"
+#include <ctime>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+Reactor::Reactor(int listen_fd, int cpu)
+    : listen_fd_(listen_fd)
+    , cpu_(cpu)
+    , wake_fd_(-1)
+    , prepared_(false)
+    , running_(false)
+    , connection_count_(0)
+    , accepted_count_(0)
+    , message_count_(0)
+    , idle_ms_(0)
+    , grace_ms_(0)
+    , idle_wheel_(IDLE_TICK_MS, IDLE_WHEEL_SLOTS)
+    , heartbeats_sent_(0)
+    , idle_evictions_(0)
+    , idle_silence_total_ms_(0)
+    , idle_silence_max_ms_(0)
+    , epoll_fd_(-1)
+{
+}
+
+Reactor::~Reactor() {
+    stop();
+
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+bool Reactor::prepare() {
+    if (prepared_) {
+        return true;
+    }
+
+    if (wake_fd_ < 0) {
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) {
+            LOG_ERROR("REACTOR", "eventfd failed: " << strerror(errno));
+            return false;
+        }
+    }
+
+    prepared_ = setup();
+    return prepared_;
+}
+
+bool Reactor::start() {
+    if (running_ || !prepare()) {
+        return false;
+    }
+
+    // Connections handed over by a previous process; the loop is not running yet.
+    // One we cannot watch is let go without a shutdown, which would also end it
+    // for the other process holding the socket.
+    for (auto& client : adopted_) {
+        if (!watch(client)) {
+            client->detach();
+            if (close_callback_) {
+                close_callback_(client->getSocketFd());
+            }
+        }
+    }
+    adopted_.clear();
+
+    running_ = true;
+    thread_ = std::thread(&Reactor::run, this);
+    return true;
+}
+
+void Reactor::setIdleTimeout(uint64_t idle_ms, uint64_t grace_ms) {
+    idle_ms_ = idle_ms;
+    grace_ms_ = grace_ms;
+}
+
+Reactor::IdleStats Reactor::getIdleStats() const {
+    IdleStats stats;
+    stats.heartbeats_sent = heartbeats_sent_;
+    stats.evictions = idle_evictions_;
+    stats.silence_total_ms = idle_silence_total_ms_;
+    stats.silence_max_ms = idle_silence_max_ms_;
+    return stats;
+}
+
+bool Reactor::setup() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        LOG_ERROR("REACTOR", "epoll_create1 failed: " << strerror(errno));
+        return false;
+    }
+
+    // Listening socket must be non-blocking so accept() can be drained on each edge
+    int flags = fcntl(listen_fd_, F_GETFL, 0);
+    fcntl(listen_fd_, F_SETFL, flags | O_NONBLOCK);
+
+    // data.ptr == nullptr marks the listener, data.ptr == this marks the wake fd
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev) < 0) {
+        LOG_ERROR("REACTOR", "Failed to watch listener: " << strerror(errno));
+        return false;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = this;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+        LOG_ERROR("REACTOR", "Failed to watch wake fd: " << strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void Reactor::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written;
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // Release remaining connections (server disconnects them separately)
+    connections_.clear();
+    connection_count_ = 0;
+}
+
+void Reactor::pinToCpu() {
+    if (cpu_ < 0) {
+        return;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu_, &cpus);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (rc != 0) {
+        LOG_ERROR("REACTOR", "Failed to pin to cpu " << cpu_ << ": " << strerror(rc));
+    }
+}
+
+void Reactor::run() {
+    pinToCpu();
+
+    LOG_INFO("REACTOR", "Event loop started (listen fd=" << listen_fd_
+            << ", cpu=" << cpu_ << ")");
+
+    struct epoll_event events[MAX_EVENTS];
+
+    while (running_) {
+        int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, waitTimeoutMs());
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("REACTOR", "epoll_wait failed: " << strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count && running_; i++) {
+            void* tag = events[i].data.ptr;
+
+            if (tag == nullptr) {
+                acceptPending();
+            } else if (tag == this) {
+                uint64_t value;
+                ssize_t drained = read(wake_fd_, &value, sizeof(value));
+                (void)drained;
+            } else {
+                handleClientEvent(static_cast<ClientConnection*>(tag), events[i].events);
+            }
+        }
+
+        checkIdle();
+    }
+
+    LOG_INFO("REACTOR", "Event loop stopped");
+}
+
+void Reactor::acceptPending() {
+    // Edge-triggered: accept until the backlog is empty
+    while (running_) {
+        // A Unix peer fills in only sun_family (AF_UNIX); the rest stays zero
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+        memset(&client_addr, 0, sizeof(client_addr));
+
+        int client_fd = accept4(listen_fd_, (struct sockaddr*)&client_addr, &addr_len,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("REACTOR", "Accept failed: " << strerror(errno));
+            }
+            return;
+        }
+
+        std::shared_ptr<ClientConnection> client;
+        if (accept_callback_) {
+            client = accept_callback_(client_fd, client_addr);
+        }
+        if (!client) {
+            close(client_fd);
+            continue;
+        }
+
+        if (!watch(client)) {
+            client->disconnect();
+            if (close_callback_) {
+                close_callback_(client_fd);
+            }
+            continue;
+        }
+        accepted_count_++;
+    }
+}
+
+bool Reactor::watch(const std::shared_ptr<ClientConnection>& client) {
+    int client_fd = client->getSocketFd();
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    // EPOLLOUT is edge-triggered too: it only fires once a full socket drains
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = client.get();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+        LOG_ERROR("REACTOR", "Failed to watch fd=" << client_fd << ": " << strerror(errno));
+        return false;
+    }
+
+    connections_[client_fd] = client;
+    connection_count_ = connections_.size();
+    watchIdle(client.get());
+    return true;
+}
+
+void Reactor::handleClientEvent(ClientConnection* client, uint32_t events) {
+    bool open = true;
+
+    // Socket writable again: push out whatever senders left queued
+    if (events & EPOLLOUT) {
+        client->flushOutbound();
+    }
+
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        open = client->readAvailable();
+
+        // Dispatch every complete frame, including ones that arrived just before a close
+        dispatchMessages(client);
+    }
+
+    if (!open || !client->isConnected()) {
+        closeClient(client);
+    }
+}
+
+void Reactor::dispatchMessages(ClientConnection* client) {
+    MessageHeader header;
+    PayloadView payload;
+    while (client->nextMessage(header, payload)) {
+        message_count_++;
+        if (message_callback_) {
+            message_callback_(client, header, payload);
+        }
+    }
+}
+
+void Reactor::unwatch(int client_fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client_fd, nullptr);
+}
+
+void Reactor::closeClient(ClientConnection* client) {
+    int client_fd = client->getSocketFd();
+
+    auto it = connections_.find(client_fd);
+    if (it == connections_.end()) {
+        return;
+    }
+
+    // Keep the connection alive until the close callback has finished with it
+    std::shared_ptr<ClientConnection> keep_alive = it->second;
+    unwatch(client_fd);
+    idle_wheel_.cancel(client_fd);
+    connections_.erase(it);
+    connection_count_ = connections_.size();
+
+    LOG_DEBUG("DISCONNECT", "Client fd=" << client_fd << " disconnected");
+
+    if (close_callback_) {
+        close_callback_(client_fd);
+    }
+}
+
+void Reactor::watchIdle(ClientConnection* client) {
+    if (idle_ms_ > 0) {
+        idle_wheel_.schedule(client->getSocketFd(), client->getLastActivityMs() + idle_ms_);
+    }
+}
+
+int Reactor::waitTimeoutMs() const {
+    return (idle_ms_ > 0 && !idle_wheel_.empty()) ? static_cast<int>(IDLE_TICK_MS) : WAIT_TIMEOUT_MS;
+}
+
+void Reactor::checkIdle() {
+    if (idle_ms_ == 0 || idle_wheel_.empty()) {
+        return;
+    }
+
+    uint64_t now = steadyMillis();
+    idle_expired_.clear();
+    idle_wheel_.advance(now, idle_expired_);
+
+    for (int client_fd : idle_expired_) {
+        auto it = connections_.find(client_fd);
+        if (it == connections_.end()) {
+            continue;
+        }
+        ClientConnection* client = it->second.get();
+
+        // Traffic only moves the deadline when it comes due, not on every read
+        uint64_t last = client->getLastActivityMs();
+        uint64_t silent = now > last ? now - last : 0;
+
+        if (silent < idle_ms_) {
+            idle_wheel_.schedule(client_fd, last + idle_ms_);
+            continue;
+        }
+
+        if (silent < idle_ms_ + grace_ms_) {
+            // Any reply (or other traffic) before the grace period ends keeps it open
+            MessageHeader ping;
+            memset(&ping, 0, sizeof(ping));
+            ping.type = static_cast<uint8_t>(PING);
+            ping.timestamp = time(nullptr);
+            client->sendMessage(MessageBuffer::create(ping, nullptr, 0));
+            heartbeats_sent_++;
+
+            if (client->isConnected()) {
+                idle_wheel_.schedule(client_fd, last + idle_ms_ + grace_ms_);
+                continue;
+            }
+        } else {
+            idle_evictions_++;
+            idle_silence_total_ms_ += silent;
+            if (silent > idle_silence_max_ms_) {
+                idle_silence_max_ms_ = silent;
+            }
+            LOG_INFO("IDLE", "Closing fd=" << client_fd << " after " << silent
+                    << " ms without traffic");
+            client->disconnect();
+        }
+
+        closeClient(client);
+    }
+}
@@ -0,0 +1,36 @@
+#include "read_epoch.h"
+#include <thread>
+
+ReadEpoch::ReadEpoch()
+    : epoch_(0)
+{
+    readers_[0] = 0;
+    readers_[1] = 0;
+}
+
+void ReadEpoch::synchronize() {
+    // New readers count in the other epoch and can no longer find what was removed;
+    // the ones still counted in the old epoch may hold it, so wait them out
+    uint32_t old_parity = epoch_.fetch_add(1) & 1;
+    while (readers_[old_parity].load() != 0) {
+        std::this_thread::yield();
+    }
+}
+
+ReadEpoch::Guard::Guard(const ReadEpoch& epoch)
+    : epoch_(epoch)
+{
+    while (true) {
+        parity_ = epoch_.epoch_.load() & 1;
+        epoch_.readers_[parity_]++;
+        // A writer may have flipped in between and not be waiting on this counter
+        if ((epoch_.epoch_.load() & 1) == parity_) {
+            break;
+        }
+        epoch_.readers_[parity_]--;
+    }
+}
+
+ReadEpoch::Guard::~Guard() {
+    epoch_.readers_[parity_]--;
+}
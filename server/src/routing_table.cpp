@@ -0,0 +1,197 @@
+#include "routing_table.h"
+
+const uint32_t RoutingTable::EMPTY;
+const uint32_t RoutingTable::REMOVED;
+
+namespace {
+const size_t MIN_CAPACITY = 16;
+
+size_t roundUpCapacity(size_t capacity) {
+    size_t rounded = MIN_CAPACITY;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+}
+
+RoutingTable::RoutingTable(size_t initial_capacity)
+    : buckets_(new Buckets(roundUpCapacity(initial_capacity)))
+    , size_(0)
+    , used_(0)
+{
+}
+
+RoutingTable::~RoutingTable() {
+    delete buckets_.load();
+}
+
+size_t RoutingTable::home(uint32_t user_id, size_t capacity) {
+    // Fibonacci hashing; ids are sequential, so spread them before taking the top bits
+    uint32_t mixed = user_id * 2654435769u;
+    return static_cast<size_t>((static_cast<uint64_t>(mixed) * capacity) >> 32);
+}
+
+ConnectionHandle RoutingTable::find(uint32_t user_id) const {
+    if (user_id == EMPTY || user_id == REMOVED) {
+        return ConnectionHandle();
+    }
+
+    ReadEpoch::Guard guard(epoch_);
+    const Buckets* buckets = buckets_.load(std::memory_order_acquire);
+    size_t mask = buckets->capacity - 1;
+    size_t index = home(user_id, buckets->capacity);
+
+    for (size_t probes = 0; probes < buckets->capacity; probes++, index = (index + 1) & mask) {
+        const Bucket& bucket = buckets->slots[index];
+        uint32_t key;
+        int fd;
+        uint32_t generation;
+        while (true) {
+            uint32_t before = bucket.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;  // Writer inside; it only stores three words
+            }
+            key = bucket.user_id.load(std::memory_order_relaxed);
+            fd = bucket.fd.load(std::memory_order_relaxed);
+            generation = bucket.generation.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (bucket.sequence.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        if (key == EMPTY) {
+            break;
+        }
+        if (key == user_id) {
+            return ConnectionHandle(fd, generation);
+        }
+    }
+    return ConnectionHandle();
+}
+
+void RoutingTable::set(uint32_t user_id, const ConnectionHandle& handle) {
+    if (user_id == EMPTY || user_id == REMOVED) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Buckets* buckets = buckets_.load(std::memory_order_relaxed);
+    Bucket* existing = locate(*buckets, user_id);
+    if (existing) {
+        write(*existing, user_id, handle);
+        return;
+    }
+
+    // Keep a quarter of the buckets empty so probes stay short and always end
+    if ((used_ + 1) * 4 > buckets->capacity * 3) {
+        size_t live = size_.load(std::memory_order_relaxed) + 1;
+        rebuild(live * 2 > buckets->capacity ? buckets->capacity * 2 : buckets->capacity);
+        buckets = buckets_.load(std::memory_order_relaxed);
+    }
+
+    size_t mask = buckets->capacity - 1;
+    for (size_t index = home(user_id, buckets->capacity); ; index = (index + 1) & mask) {
+        Bucket& bucket = buckets->slots[index];
+        uint32_t key = bucket.user_id.load(std::memory_order_relaxed);
+        if (key == EMPTY || key == REMOVED) {
+            if (key == EMPTY) {
+                used_++;
+            }
+            write(bucket, user_id, handle);
+            size_++;
+            return;
+        }
+    }
+}
+
+bool RoutingTable::erase(uint32_t user_id) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Bucket* bucket = locate(*buckets_.load(std::memory_order_relaxed), user_id);
+    if (!bucket) {
+        return false;
+    }
+    write(*bucket, REMOVED, ConnectionHandle());
+    size_--;
+    return true;
+}
+
+bool RoutingTable::erase(uint32_t user_id, const ConnectionHandle& handle) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Bucket* bucket = locate(*buckets_.load(std::memory_order_relaxed), user_id);
+    if (!bucket ||
+        bucket->fd.load(std::memory_order_relaxed) != handle.fd ||
+        bucket->generation.load(std::memory_order_relaxed) != handle.generation) {
+        return false;
+    }
+    write(*bucket, REMOVED, ConnectionHandle());
+    size_--;
+    return true;
+}
+
+void RoutingTable::clear() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Buckets* old_buckets = buckets_.load(std::memory_order_relaxed);
+    buckets_.store(new Buckets(old_buckets->capacity), std::memory_order_release);
+    size_ = 0;
+    used_ = 0;
+
+    epoch_.synchronize();
+    delete old_buckets;
+}
+
+RoutingTable::Bucket* RoutingTable::locate(Buckets& buckets, uint32_t user_id) const {
+    if (user_id == EMPTY || user_id == REMOVED) {
+        return nullptr;
+    }
+    size_t mask = buckets.capacity - 1;
+    size_t index = home(user_id, buckets.capacity);
+    for (size_t probes = 0; probes < buckets.capacity; probes++, index = (index + 1) & mask) {
+        uint32_t key = buckets.slots[index].user_id.load(std::memory_order_relaxed);
+        if (key == EMPTY) {
+            return nullptr;
+        }
+        if (key == user_id) {
+            return &buckets.slots[index];
+        }
+    }
+    return nullptr;
+}
+
+void RoutingTable::write(Bucket& bucket, uint32_t user_id, const ConnectionHandle& handle) {
+    uint32_t sequence = bucket.sequence.load(std::memory_order_relaxed);
+    bucket.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bucket.user_id.store(user_id, std::memory_order_relaxed);
+    bucket.fd.store(handle.fd, std::memory_order_relaxed);
+    bucket.generation.store(handle.generation, std::memory_order_relaxed);
+    bucket.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void RoutingTable::rebuild(size_t capacity) {
+    Buckets* old_buckets = buckets_.load(std::memory_order_relaxed);
+    Buckets* new_buckets = new Buckets(capacity);
+    size_t mask = capacity - 1;
+
+    for (size_t i = 0; i < old_buckets->capacity; i++) {
+        const Bucket& old_bucket = old_buckets->slots[i];
+        uint32_t key = old_bucket.user_id.load(std::memory_order_relaxed);
+        if (key == EMPTY || key == REMOVED) {
+            continue;
+        }
+        size_t index = home(key, capacity);
+        while (new_buckets->slots[index].user_id.load(std::memory_order_relaxed) != EMPTY) {
+            index = (index + 1) & mask;
+        }
+        write(new_buckets->slots[index], key,
+              ConnectionHandle(old_bucket.fd.load(std::memory_order_relaxed),
+                               old_bucket.generation.load(std::memory_order_relaxed)));
+    }
+    used_ = size_.load(std::memory_order_relaxed);
+
+    // Readers already probing the old array finish there; then it can go
+    buckets_.store(new_buckets, std::memory_order_release);
+    epoch_.synchronize();
+    delete old_buckets;
+}
@@ -8,17 +8,33 @@
 #include "database.h"
 #include "player_manager.h"
 #include "challenge_manager.h"
-#include <iostream>
+#include "reactor.h"
+#include "uring_reactor.h"
+#include "hot_restart.h"
+#include "payload_compression.h"
+#include "message_serialization.h"
+#include "config.h"
+#include "logger.h"
 #include <cstring>
+#include <algorithm>
 #include <thread>
 #include <unistd.h>
+#include <sched.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 Server::Server(int port)
     : port_(port)
-    , server_fd_(-1)
+    , reactor_count_(0)
+    , worker_count_(0)
+    , io_backend_(IO_BACKEND_EPOLL)
+    , idle_timeout_(IDLE_TIMEOUT_SECONDS)
+    , heartbeat_grace_(HEARTBEAT_GRACE_SECONDS)
+    , max_connections_(MAX_CLIENTS)
+    , max_per_address_(MAX_CLIENTS_PER_IP)
     , running_(false)
     , db_(nullptr)
     , player_manager_(nullptr)
@@ -26,15 +42,21 @@ Server::Server(int port)
     , gameplay_handler_(nullptr)
     , total_connections_(0)
     , active_matches_(0)
+    , handoff_fd_(-1)
+    , handing_off_(false)
+    , handed_off_(false)
 {
+    dispatch_table_.fill(nullptr);
+    rate_limiter_.configure(DEFAULT_RATE_LIMITS);
+
     // Initialize database
     db_ = new DatabaseManager("data/battleship.db");
     if (!db_->isOpen()) {
-        std::cerr << "[SERVER] Failed to open database!" << std::endl;
+        LOG_ERROR("SERVER", "Failed to open database!");
         delete db_;
         db_ = nullptr;
     } else {
-        std::cout << "[SERVER] Database initialized successfully" << std::endl;
+        LOG_INFO("SERVER", "Database initialized successfully");
     }
 
     // Initialize player manager
@@ -46,12 +68,15 @@ Server::Server(int port)
     // Initialize gameplay handler
     if (db_ && db_->isOpen()) {
         gameplay_handler_ = new GameplayHandler(this, db_);
-        std::cout << "[SERVER] Gameplay handler initialized successfully" << std::endl;
+        LOG_INFO("SERVER", "Gameplay handler initialized successfully");
     }
 }
 
 Server::~Server() {
     stop();
+    if (handoff_thread_.joinable()) {
+        handoff_thread_.join();  // Still finishing a handoff that ended the run
+    }
 
     // Cleanup handlers
     for (auto handler : handlers_) {
@@ -86,46 +111,230 @@ Server::~Server() {
 
 bool Server::start() {
     if (running_) {
-        std::cerr << "[SERVER] Already running" << std::endl;
+        LOG_ERROR("SERVER", "Already running");
+        return false;
+    }
+    if (!prepare()) {
         return false;
     }
+    serve();
+    return true;
+}
 
+bool Server::prepare() {
     // Setup message handlers
     setupHandlers();
 
-    // Create socket
-    if (!createSocket()) {
-        return false;
+    // Socket files of listeners taken over still belong to the previous
+    // process until we are serving, so a failed start leaves them in place
+    bool taken_over = !listen_fds_.empty();
+
+    // One SO_REUSEPORT listener per reactor lets the kernel spread accepts across cores.
+    // Listeners taken over from a previous process are already bound and listening.
+    if (listen_fds_.empty()) {
+        int reactor_count = reactor_count_;
+        if (reactor_count <= 0) {
+            // One per core this process may run on (respects taskset / container cpusets)
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            reactor_count = sched_getaffinity(0, sizeof(allowed), &allowed) == 0 ? CPU_COUNT(&allowed) : 1;
+        }
+
+        for (int i = 0; i < reactor_count; i++) {
+            int listen_fd = createSocket();
+            if (listen_fd < 0 || !bindSocket(listen_fd) || !listenSocket(listen_fd)) {
+                if (listen_fd >= 0) {
+                    close(listen_fd);
+                }
+                closeListeners(true);
+                return false;
+            }
+            listen_fds_.push_back(listen_fd);
+        }
+
+        if (!unix_path_.empty()) {
+            int unix_fd = createUnixSocket();
+            if (unix_fd < 0 || !listenSocket(unix_fd)) {
+                if (unix_fd >= 0) {
+                    close(unix_fd);
+                    unlink(unix_path_.c_str());
+                }
+                closeListeners(true);
+                return false;
+            }
+            listen_fds_.push_back(unix_fd);
+        }
     }
 
-    // Bind to port
-    if (!bindSocket()) {
-        close(server_fd_);
+    running_ = true;
+
+    // Fresh slot counts; only connections taken over are still in clients_
+    admission_.reset(new AdmissionControl(max_connections_, max_per_address_, ADMISSION_RETRY_MS));
+    clients_.forEach([this](ClientConnection& client) {
+        admission_->admit(client.getPeerAddress());
+    });
+
+    if (!prepareLoops()) {
+        running_ = false;
+        closeListeners(!taken_over);
         return false;
     }
+    return true;
+}
+
+void Server::serve() {
+    runLoops();
+
+    // Waits for a successor; the path is free again once a previous owner handed off
+    if (!handoff_path_.empty()) {
+        handoff_fd_ = HotRestart::listen(handoff_path_);
+        if (handoff_fd_ >= 0) {
+            handoff_thread_ = std::thread(&Server::handoffThread, this);
+            LOG_INFO("SERVER", "Hot restart socket: " << handoff_path_);
+        }
+    }
+}
 
-    // Listen for connections
-    if (!listenSocket()) {
-        close(server_fd_);
+bool Server::startLoops() {
+    if (!prepareLoops()) {
         return false;
     }
+    runLoops();
+    return true;
+}
 
-    running_ = true;
+bool Server::prepareLoops() {
+    // CPUs this process may run on (respects taskset / container cpusets)
+    std::vector<int> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+
+    // Handlers run on the worker pool, so it must be up before the first message
+    worker_pool_.reset(new WorkerPool(worker_count_ > 0 ? static_cast<size_t>(worker_count_) : 0));
+    worker_pool_->start();
+    async_runtime_.start(worker_pool_.get(), 0);
+
+    bool use_uring = io_backend_ == IO_BACKEND_URING;
+    if (use_uring && !UringReactor::isSupported()) {
+        LOG_INFO("SERVER", "io_uring not supported here, falling back to epoll");
+        use_uring = false;
+    }
+
+    // Connections that outlived a previous set of reactors, dealt out round-robin
+    std::vector<std::shared_ptr<ClientConnection>> carried;
+    clients_.forEach([&carried](ClientConnection& client) {
+        carried.push_back(client.shared_from_this());
+    });
+
+    // One event loop per listener, pinned round-robin to the allowed cores
+    int reactor_count = static_cast<int>(listen_fds_.size());
+    for (int i = 0; i < reactor_count; i++) {
+        int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        std::unique_ptr<Reactor> reactor = createReactor(use_uring, listen_fds_[i], cpu);
+        for (size_t c = i; c < carried.size(); c += reactor_count) {
+            reactor->adopt(carried[c]);
+        }
+
+        bool prepared = reactor->prepare();
+        if (!prepared && use_uring) {
+            // Probe passed but setup did not (e.g. locked-memory limits): epoll from here on
+            LOG_INFO("SERVER", "io_uring setup failed, falling back to epoll");
+            use_uring = false;
+            reactor = createReactor(false, listen_fds_[i], cpu);
+            for (size_t c = i; c < carried.size(); c += reactor_count) {
+                reactor->adopt(carried[c]);
+            }
+            prepared = reactor->prepare();
+        }
+        if (!prepared) {
+            reactors_.clear();
+            async_runtime_.stop();
+            worker_pool_->stop();
+            return false;
+        }
+        reactors_.push_back(std::move(reactor));
+    }
+    return true;
+}
+
+void Server::runLoops() {
+    for (auto& reactor : reactors_) {
+        if (!reactor->start()) {
+            LOG_ERROR("SERVER", "I/O reactor failed to start");
+        }
+    }
 
-    // Start accept thread
-    std::thread accept_thread(&Server::acceptConnections, this);
-    accept_thread.detach();
+    LOG_INFO("SERVER", reactors_.size() << " I/O reactor(s) ("
+            << (getIoBackend() == IO_BACKEND_URING ? "io_uring" : "epoll") << "), "
+            << worker_pool_->getThreadCount() << " worker(s) running");
 
     // Start timeout checker thread
     timeout_checker_thread_ = std::thread(&Server::timeoutCheckerThread, this);
+}
 
-    return true;
+void Server::stopLoops() {
+    // Stop event loops before tearing down connections
+    for (auto& reactor : reactors_) {
+        reactor->stop();
+    }
+    reactors_.clear();
+
+    // Finish messages already queued (including disconnect cleanup), and the
+    // continuations of handlers still waiting on the database
+    async_runtime_.stop();
+    if (worker_pool_) {
+        worker_pool_->stop();
+    }
+
+    // Wait for timeout checker thread to finish
+    if (timeout_checker_thread_.joinable()) {
+        timeout_checker_thread_.join();
+    }
+}
+
+std::unique_ptr<Reactor> Server::createReactor(bool use_uring, int listen_fd, int cpu) {
+    std::unique_ptr<Reactor> reactor;
+    if (use_uring) {
+        reactor.reset(new UringReactor(listen_fd, cpu));
+    } else {
+        reactor.reset(new Reactor(listen_fd, cpu));
+    }
+
+    reactor->setAcceptCallback([this](int client_fd, const struct sockaddr_in& addr) {
+        return acceptClient(client_fd, addr);
+    });
+    reactor->setMessageCallback([this](ClientConnection* client, const MessageHeader& header,
+                                       const PayloadView& payload) {
+        handleMessage(client, header, payload);
+    });
+    reactor->setCloseCallback([this](int client_fd) {
+        handleClose(client_fd);
+    });
+    if (idle_timeout_ > 0) {
+        reactor->setIdleTimeout(static_cast<uint64_t>(idle_timeout_) * 1000,
+                                static_cast<uint64_t>(std::max(heartbeat_grace_, 0)) * 1000);
+    }
+    return reactor;
+}
+
+IoBackend Server::getIoBackend() const {
+    return reactors_.empty() ? io_backend_ : reactors_.front()->getBackend();
 }
 
 void Server::setupHandlers() {
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    // Handlers and the dispatch table survive stop(); a restart reuses them
+    if (!handlers_.empty()) {
+        return;
+    }
 
-    std::cout << "[SERVER] Setting up message handlers..." << std::endl;
+    LOG_INFO("SERVER", "Setting up message handlers...");
 
     // Add handlers for different message types
     if (db_ && db_->isOpen()) {
@@ -133,7 +342,7 @@ void Server::setupHandlers() {
         auth_handler->setServer(this); // Set server reference for PlayerManager access
         handlers_.push_back(auth_handler);
     } else {
-        std::cerr << "[SERVER] Cannot create AuthHandler: database not available" << std::endl;
+        LOG_ERROR("SERVER", "Cannot create AuthHandler: database not available");
     }
 
     // Add player handler
@@ -146,67 +355,89 @@ void Server::setupHandlers() {
         handlers_.push_back(new ChallengeHandler(this, challenge_manager_));
     }
 
-    // Add gameplay handler
+    // Build the dispatch table; the gameplay handler goes last, as before
+    dispatch_table_.fill(nullptr);
+    for (auto handler : handlers_) {
+        registerHandler(handler);
+    }
     if (gameplay_handler_) {
-        handlers_.push_back(gameplay_handler_);
+        registerHandler(gameplay_handler_);
     }
 
-    std::cout << "[SERVER] " << handlers_.size() << " handlers registered" << std::endl;
-}
-
-void Server::stop() {
-    if (!running_) {
-        return;
+    size_t routed = 0;
+    for (auto handler : dispatch_table_) {
+        if (handler) {
+            routed++;
+        }
     }
+    LOG_INFO("SERVER", handlers_.size() + (gameplay_handler_ ? 1 : 0)
+            << " handlers registered for " << routed << " message types");
+}
 
-    std::cout << "[SERVER] Stopping server..." << std::endl;
-    running_ = false;
+void Server::registerHandler(MessageHandler* handler) {
+    handler->setAsyncRuntime(&async_runtime_);
 
-    // Wait for timeout checker thread to finish
-    if (timeout_checker_thread_.joinable()) {
-        timeout_checker_thread_.join();
+    // The first handler to claim a type keeps it, matching the old in-order scan
+    for (size_t type = 0; type < dispatch_table_.size(); type++) {
+        if (!dispatch_table_[type] && handler->canHandle(static_cast<MessageType>(type))) {
+            dispatch_table_[type] = handler;
+        }
     }
+}
 
-    // Close all client connections
+void Server::stop() {
     {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        for (auto& pair : clients_) {
-            pair.second->disconnect();
+        std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+        if (!running_) {
+            return;
         }
-        clients_.clear();
+
+        LOG_INFO("SERVER", "Stopping server...");
+        running_ = false;
+    }
+
+    // The handoff thread notices running_ within one poll interval
+    if (handoff_thread_.joinable()) {
+        handoff_thread_.join();
     }
 
-    // Close server socket
-    if (server_fd_ >= 0) {
-        close(server_fd_);
-        server_fd_ = -1;
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    stopLoops();
+
+    // Close all client connections
+    for (auto& client : clients_.removeAll()) {
+        client->disconnect();
     }
 
-    std::cout << "[SERVER] Server stopped" << std::endl;
+    // Close listening sockets
+    closeListeners(true);
+
+    LOG_INFO("SERVER", "Server stopped");
 }
 
-bool Server::createSocket() {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0) {
-        std::cerr << "[ERROR] Failed to create socket: " << strerror(errno) << std::endl;
-        return false;
+int Server::createSocket() {
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        LOG_ERROR("SERVER", "Failed to create socket: " << strerror(errno));
+        return -1;
     }
 
     // Set socket options
     int opt = 1;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        std::cerr << "[WARNING] setsockopt SO_REUSEADDR failed: " << strerror(errno) << std::endl;
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        LOG_WARN("SERVER", "setsockopt SO_REUSEADDR failed: " << strerror(errno));
     }
 
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
-        std::cerr << "[WARNING] setsockopt SO_REUSEPORT failed: " << strerror(errno) << std::endl;
+    // Required for every reactor to bind its own listener to the same port
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        LOG_WARN("SERVER", "setsockopt SO_REUSEPORT failed: " << strerror(errno));
     }
 
-    std::cout << "[SERVER] Socket created (fd=" << server_fd_ << ")" << std::endl;
-    return true;
+    LOG_INFO("SERVER", "Socket created (fd=" << listen_fd << ")");
+    return listen_fd;
 }
 
-bool Server::bindSocket() {
+bool Server::bindSocket(int listen_fd) {
     struct sockaddr_in address;
     memset(&address, 0, sizeof(address));
 
@@ -214,138 +445,224 @@ bool Server::bindSocket() {
     address.sin_addr.s_addr = INADDR_ANY;  // Listen on all interfaces
     address.sin_port = htons(port_);
 
-    if (bind(server_fd_, (struct sockaddr*)&address, sizeof(address)) < 0) {
-        std::cerr << "[ERROR] Failed to bind to port " << port_
-                  << ": " << strerror(errno) << std::endl;
+    if (bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        LOG_ERROR("SERVER", "Failed to bind to port " << port_
+                << ": " << strerror(errno));
         return false;
     }
 
-    std::cout << "[SERVER] Bound to port " << port_ << std::endl;
+    LOG_INFO("SERVER", "Bound to port " << port_);
     return true;
 }
 
-bool Server::listenSocket() {
-    const int BACKLOG = 128;  // Max pending connections
+bool Server::listenSocket(int listen_fd) {
+    // Room for a reconnect storm to queue while the reactors accept and admit;
+    // the kernel caps it at net.core.somaxconn
+    const int BACKLOG = SOMAXCONN;
 
-    if (listen(server_fd_, BACKLOG) < 0) {
-        std::cerr << "[ERROR] Failed to listen: " << strerror(errno) << std::endl;
+    if (listen(listen_fd, BACKLOG) < 0) {
+        LOG_ERROR("SERVER", "Failed to listen: " << strerror(errno));
         return false;
     }
 
-    std::cout << "[SERVER] Listening for connections (backlog=" << BACKLOG << ")" << std::endl;
+    LOG_INFO("SERVER", "Listening for connections (backlog=" << BACKLOG << ")");
     return true;
 }
 
-void Server::acceptConnections() {
-    struct sockaddr_in client_addr;
-    socklen_t addr_len = sizeof(client_addr);
+int Server::createUnixSocket() {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (unix_path_.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("SERVER", "Unix socket path too long: " << unix_path_);
+        return -1;
+    }
+    memcpy(address.sun_path, unix_path_.c_str(), unix_path_.size());
 
-    std::cout << "[SERVER] Accept thread started" << std::endl;
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        LOG_ERROR("SERVER", "Failed to create Unix socket: " << strerror(errno));
+        return -1;
+    }
 
-    while (running_) {
-        // Accept new connection
-        int client_fd = accept(server_fd_, (struct sockaddr*)&client_addr, &addr_len);
+    // A file nobody answers on is left over from a crash; a live one is another server's
+    if (connect(listen_fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+        LOG_ERROR("SERVER", unix_path_ << " is in use by another server");
+        close(listen_fd);
+        return -1;
+    }
+    close(listen_fd);
+    unlink(unix_path_.c_str());
 
-        if (!running_) {
-            break;  // Server stopped
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        LOG_ERROR("SERVER", "Failed to bind " << unix_path_ << ": " << strerror(errno));
+        if (listen_fd >= 0) {
+            close(listen_fd);
         }
+        return -1;
+    }
 
-        if (client_fd < 0) {
-            if (errno == EINTR) {
-                continue;  // Interrupted, try again
-            }
-            std::cerr << "[ERROR] Accept failed: " << strerror(errno) << std::endl;
-            continue;
+    LOG_INFO("SERVER", "Bound to " << unix_path_ << " (fd=" << listen_fd << ")");
+    return listen_fd;
+}
+
+void Server::closeListeners(bool remove_socket_files) {
+    for (int listen_fd : listen_fds_) {
+        // Unix listeners may have been taken over, so ask the socket for its path
+        struct sockaddr_un address;
+        socklen_t length = sizeof(address);
+        memset(&address, 0, sizeof(address));
+        if (remove_socket_files &&
+            getsockname(listen_fd, (struct sockaddr*)&address, &length) == 0 &&
+            address.sun_family == AF_UNIX && address.sun_path[0] != '\0') {
+            unlink(address.sun_path);
         }
+        close(listen_fd);
+    }
+    listen_fds_.clear();
+}
 
-        // Get client info
-        char client_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
-        int client_port = ntohs(client_addr.sin_port);
+std::shared_ptr<ClientConnection> Server::acceptClient(int client_fd, const struct sockaddr_in& addr) {
+    // Get client info; peers on the Unix socket have no IP or port
+    bool local = addr.sin_family == AF_UNIX;
+    uint32_t peer_address = local ? AdmissionControl::LOCAL_ADDRESS : addr.sin_addr.s_addr;
+    char client_ip[INET_ADDRSTRLEN] = "local";
+    int client_port = 0;
+    if (!local) {
+        inet_ntop(AF_INET, &addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+        client_port = ntohs(addr.sin_port);
+    }
 
-        std::cout << "[CONNECTION] New client connected: " << client_ip
-                  << ":" << client_port << " (fd=" << client_fd << ")" << std::endl;
+    // Refuse before allocating anything for the connection; the reactor closes the fd.
+    // An fd past the connection table (limit raised after startup) counts as full.
+    AdmissionControl::Verdict verdict = static_cast<size_t>(client_fd) < clients_.capacity()
+                                            ? admission_->admit(peer_address)
+                                            : AdmissionControl::REJECT_FULL;
+    if (verdict != AdmissionControl::ADMIT) {
+        rejectClient(client_fd, verdict, client_ip);
+        return nullptr;
+    }
 
-        total_connections_++;
+    LOG_DEBUG("CONNECTION", "New client connected: " << client_ip
+            << ":" << client_port << " (fd=" << client_fd << ")");
 
-        // Create client connection object
-        auto client = std::make_shared<ClientConnection>(client_fd);
+    total_connections_++;
 
-        // Add to clients map
-        {
-            std::lock_guard<std::mutex> lock(clients_mutex_);
-            clients_[client_fd] = client;
-        }
+    // Create client connection object (socket is already non-blocking from accept4)
+    auto client = std::make_shared<ClientConnection>(client_fd);
+    client->setStrand(std::make_shared<Strand>());
+    client->setPeerAddress(peer_address);
 
-        // Handle client in separate thread
-        std::thread client_thread(&Server::handleClient, this, client_fd);
-        client_thread.detach();
-    }
+    clients_.insert(client);
 
-    std::cout << "[SERVER] Accept thread stopped" << std::endl;
+    return client;
 }
 
-void Server::handleClient(int client_fd) {
-    std::cout << "[THREAD] Handler thread started for client fd=" << client_fd << std::endl;
+void Server::rejectClient(int client_fd, AdmissionControl::Verdict verdict, const char* client_ip) {
+    ServerBusyMessage busy;
+    busy.reason = verdict == AdmissionControl::REJECT_FULL ? BUSY_SERVER_FULL : BUSY_ADDRESS_LIMIT;
+    busy.retry_after_ms = admission_->retryAfterMs();
 
-    std::shared_ptr<ClientConnection> client;
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = static_cast<uint8_t>(SERVER_BUSY);
+    header.length = sizeof(busy);
+    header.timestamp = time(nullptr);
 
-    // Get client connection
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_fd);
-        if (it == clients_.end()) {
-            std::cerr << "[ERROR] Client fd=" << client_fd << " not found!" << std::endl;
-            return;
-        }
-        client = it->second;
+    char frame[sizeof(header) + sizeof(busy)];
+    memcpy(frame, &header, sizeof(header));
+    memcpy(frame + sizeof(header), &busy, sizeof(busy));
+
+    // A just-accepted socket has an empty send buffer, so this neither blocks nor comes up short
+    ssize_t sent = send(client_fd, frame, sizeof(frame), MSG_NOSIGNAL | MSG_DONTWAIT);
+    (void)sent;
+
+    // Read what the client already sent so close() ends with FIN; an RST could discard the frame
+    char discard[512];
+    while (recv(client_fd, discard, sizeof(discard), MSG_DONTWAIT) > 0) {
     }
 
-    // Main message loop
-    while (running_ && client->isConnected()) {
-        MessageHeader header;
-        std::string payload;
+    LOG_WARN("ADMISSION", "Refused " << client_ip << " (fd=" << client_fd << "): "
+            << (verdict == AdmissionControl::REJECT_FULL ? "server full" : "too many connections from address")
+            << ", retry after " << busy.retry_after_ms << " ms");
+}
 
-        // Receive message
-        if (!client->receiveMessage(header, payload)) {
-            std::cout << "[DISCONNECT] Client fd=" << client_fd << " disconnected" << std::endl;
-            break;
-        }
+void Server::handleMessage(ClientConnection* client, const MessageHeader& header, const PayloadView& payload) {
+    LOG_DEBUG("MESSAGE", "Received from fd=" << client->getSocketFd()
+            << " type=" << (int)header.type
+            << " length=" << header.length);
 
-        std::cout << "[MESSAGE] Received from fd=" << client_fd
-                  << " type=" << (int)header.type
-                  << " length=" << header.length << std::endl;
+    // Over budget: dropped here, before any worker, handler or database time is spent
+    if (!rate_limiter_.allow(client->getRateBuckets(), header.type, RateLimiter::nowMs())) {
+        LOG_DEBUG("RATE", "Dropped type=" << (int)header.type << " from fd=" << client->getSocketFd());
+        return;
+    }
 
-        // Route message to appropriate handler
-        if (!routeMessage(client.get(), header, payload)) {
-            std::cerr << "[ERROR] Failed to route message type=" << (int)header.type << std::endl;
-        }
+    // Unknown types and payloads that do not match the message schema are dropped too
+    if (!MessageSerialization::validatePayloadSize(static_cast<MessageType>(header.type), payload.size())) {
+        LOG_WARN("MESSAGE", "Dropped type=" << (int)header.type << " with " << payload.size()
+                << " byte payload from fd=" << client->getSocketFd());
+        return;
     }
 
-    // Cleanup
-    removeClient(client_fd);
+    // Hand off to the worker pool; the strand keeps this client's messages in order.
+    // Capturing the view only takes a reference on the read buffer, not a copy.
+    std::shared_ptr<ClientConnection> conn = client->shared_from_this();
+    auto task = [this, conn, header, payload]() {
+        // While a handler waits on the database, later messages from this client
+        // are held back and routed once it has finished
+        async_runtime_.dispatch(conn, [this, conn, header, payload]() {
+            // Replies (e.g. MOVE_RESULT + TURN_UPDATE) go out as one write per client,
+            // and to a v2 client as one BATCH frame
+            ClientConnection::SendBatch batch;
+            MessageHeader bound = header;
+            conn->bindSession(bound);
+            if (!routeMessage(conn.get(), bound, payload)) {
+                LOG_WARN("SERVER", "Failed to route message type=" << (int)header.type);
+            }
+        });
+    };
 
-    std::cout << "[THREAD] Handler thread stopped for client fd=" << client_fd << std::endl;
+    if (worker_pool_) {
+        worker_pool_->post(conn->getStrand(), task);
+    } else {
+        task();
+    }
 }
 
-void Server::removeClient(int client_fd) {
-    std::shared_ptr<ClientConnection> client;
+void Server::handleClose(int client_fd) {
+    std::shared_ptr<Strand> strand;
+    uint32_t generation = ConnectionTable::ANY_GENERATION;
+    clients_.with(client_fd, [&strand, &generation](ClientConnection& client, uint32_t slot_generation) {
+        strand = client.getStrand();
+        generation = slot_generation;
+    });
+
+    // Clean up after any messages from this client that are still queued.
+    // clients_ keeps the fd open until then, so the number cannot be reused.
+    if (strand && worker_pool_) {
+        worker_pool_->post(strand, [this, client_fd, generation]() {
+            ClientConnection::SendBatch batch;
+            removeClient(client_fd, generation);
+        });
+    } else {
+        removeClient(client_fd, generation);
+    }
+}
 
-    // Get client before removing (need to access outside lock)
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_fd);
-        if (it != clients_.end()) {
-            client = it->second;
-            clients_.erase(it);
-            std::cout << "[CLEANUP] Removed client fd=" << client_fd << std::endl;
-        }
+void Server::removeClient(int client_fd, uint32_t generation) {
+    // Once this returns no sender or broadcast still holds the connection
+    std::shared_ptr<ClientConnection> client = clients_.remove(client_fd, generation);
+    if (client) {
+        admission_->release(client->getPeerAddress());
+        LOG_DEBUG("CLEANUP", "Removed client fd=" << client_fd);
     }
 
     // If client was authenticated, handle disconnect properly
     if (client && client->isAuthenticated()) {
         uint32_t user_id = client->getUserId();
-        std::cout << "[CLEANUP] Client was authenticated as user_id=" << user_id << std::endl;
+        LOG_DEBUG("CLEANUP", "Client was authenticated as user_id=" << user_id);
 
         // End any active matches involving this player
         if (gameplay_handler_) {
@@ -353,8 +670,8 @@ void Server::removeClient(int client_fd) {
         }
 
         // Remove from player manager and broadcast offline status
-        std::cout << "[CLEANUP] Broadcasting offline status for user_id=" << user_id << std::endl;
-        player_manager_->removePlayer(user_id);
+        LOG_DEBUG("CLEANUP", "Broadcasting offline status for user_id=" << user_id);
+        player_manager_->removePlayer(user_id, client->getHandle());
     }
 
     // Disconnect the client
@@ -368,64 +685,87 @@ void Server::broadcastToAll(const std::string& /*message*/) {
 }
 
 void Server::broadcast(const MessageHeader& header, const std::string& payload) {
-    // Copy client list to avoid holding lock during I/O
-    std::vector<std::shared_ptr<ClientConnection>> clients_copy;
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        clients_copy.reserve(clients_.size());
-        for (auto& pair : clients_) {
-            if (pair.second) {
-                clients_copy.push_back(pair.second);
-            }
-        }
-    } // Release lock before sending
-
-    std::cout << "[SERVER] Broadcasting message type=" << (int)header.type 
-              << " to " << clients_copy.size() << " clients" << std::endl;
+    size_t payload_size = (header.length > 0 && !payload.empty()) ? header.length : 0;
+    if (payload_size > payload.size()) {
+        LOG_ERROR("SERVER", "Broadcast header length " << header.length << " exceeds payload");
+        return;
+    }
+    broadcast(MessageBuffer::create(header, payload.data(), payload_size));
+}
 
-    // Send to all clients without holding lock (avoid blocking)
+void Server::broadcast(const SharedMessage& message) {
+    // Walks the table in place: no lock, no copy of the client list
     int sent_count = 0;
-    for (auto& client : clients_copy) {
-        if (client && client->sendMessage(header, payload)) {
+    size_t client_count = clients_.forEach([&message, &sent_count](ClientConnection& client) {
+        if (client.sendMessage(message)) {
             sent_count++;
         }
-    }
-    
-    std::cout << "[SERVER] Broadcast sent to " << sent_count << "/" << clients_copy.size() << " clients" << std::endl;
+    });
+
+    LOG_DEBUG("SERVER", "Broadcast type=" << (int)message->type()
+            << " sent to " << sent_count << "/" << client_count << " clients");
 }
 
 bool Server::sendToClient(int client_fd, const MessageHeader& header, const void* payload, size_t payload_size) {
-    std::shared_ptr<ClientConnection> client;
-    {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_fd);
-        if (it != clients_.end()) {
-            client = it->second;
-        }
-    }
+    return sendToClient(client_fd, MessageBuffer::create(header, payload, payload_size));
+}
 
-    if (client) {
-        std::string payload_str(reinterpret_cast<const char*>(payload), payload_size);
-        return client->sendMessage(header, payload_str);
-    }
+bool Server::sendToClient(int client_fd, const SharedMessage& message) {
+    bool sent = false;
+    clients_.with(client_fd, [&message, &sent](ClientConnection& client, uint32_t) {
+        sent = client.sendMessage(message);
+    });
+    return sent;
+}
 
-    return false;
+bool Server::sendToClient(const ConnectionHandle& connection, const SharedMessage& message) {
+    bool sent = false;
+    clients_.with(connection, [&message, &sent](ClientConnection& client) {
+        sent = client.sendMessage(message);
+    });
+    return sent;
 }
 
 int Server::getConnectedClients() const {
-    std::lock_guard<std::mutex> lock(clients_mutex_);
-    return clients_.size();
+    return static_cast<int>(clients_.size());
 }
 
 int Server::getActiveMatches() const {
     return active_matches_;
 }
 
+WorkerPool::Stats Server::getWorkerStats() const {
+    if (worker_pool_) {
+        return worker_pool_->getStats();
+    }
+    return WorkerPool::Stats();
+}
+
+AdmissionControl::Stats Server::getAdmissionStats() const {
+    if (admission_) {
+        return admission_->getStats();
+    }
+    AdmissionControl::Stats stats;
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+}
+
+Reactor::IdleStats Server::getIdleStats() const {
+    Reactor::IdleStats total;
+    memset(&total, 0, sizeof(total));
+    for (const auto& reactor : reactors_) {
+        Reactor::IdleStats stats = reactor->getIdleStats();
+        total.heartbeats_sent += stats.heartbeats_sent;
+        total.evictions += stats.evictions;
+        total.silence_total_ms += stats.silence_total_ms;
+        total.silence_max_ms = std::max(total.silence_max_ms, stats.silence_max_ms);
+    }
+    return total;
+}
+
 bool Server::routeMessage(ClientConnection* client,
                          const MessageHeader& header,
-                         const std::string& payload) {
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
-
+                         const PayloadView& payload) {
     // Try PING/PONG first (keep for backwards compatibility)
     if (header.type == static_cast<uint8_t>(PING)) {
         MessageHeader pong_header;
@@ -437,32 +777,232 @@ bool Server::routeMessage(ClientConnection* client,
         return client->sendMessage(pong_header, "");
     }
 
-    // Route to registered handlers
-    for (auto handler : handlers_) {
-        if (handler->canHandle(static_cast<MessageType>(header.type))) {
-            return handler->handleMessage(client, header, payload);
+    // v2 feature offer: agree on what both sides support, then tell the client
+    if (header.type == static_cast<uint8_t>(CAPABILITIES)) {
+        CapabilitiesMessage offer;
+        if (payload.size() < sizeof(offer)) {
+            return false;
         }
+        memcpy(&offer, payload.data(), sizeof(offer));
+
+        CapabilitiesMessage agreed;
+        agreed.flags = client->getWireVersion() == ClientConnection::WIRE_V2
+                     ? offer.flags & PayloadCompression::supported() : 0;
+        client->setCapabilities(agreed.flags);
+        return client->sendMessage(MessageBuffer::create<CAPABILITIES>(agreed));
+    }
+
+    // Reply to a server heartbeat; the reactor already counted the traffic
+    if (header.type == static_cast<uint8_t>(PONG)) {
+        return true;
+    }
+
+    // Route to the registered handler (table is immutable while running)
+    MessageHandler* handler = dispatch_table_[header.type];
+    if (handler) {
+        return handler->handleMessage(client, header, payload);
     }
 
     // No handler found
-    std::cerr << "[ROUTER] No handler for message type=" << (int)header.type << std::endl;
+    LOG_WARN("ROUTER", "No handler for message type=" << (int)header.type);
     return false;
 }
 
 void Server::timeoutCheckerThread() {
-    std::cout << "[TIMEOUT-CHECKER] Thread started" << std::endl;
+    LOG_INFO("TIMEOUT-CHECKER", "Thread started");
 
     while (running_) {
-        // Check turn timeouts every 2 seconds
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+        // Check turn timeouts every 2 seconds, in short steps so stopping is not held up
+        for (int step = 0; step < 20 && running_; step++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
 
         if (!running_) break;
 
         // Call gameplay handler to check timeouts
         if (gameplay_handler_) {
+            ClientConnection::SendBatch batch;
             gameplay_handler_->checkTurnTimeouts();
         }
     }
 
-    std::cout << "[TIMEOUT-CHECKER] Thread stopped" << std::endl;
+    LOG_INFO("TIMEOUT-CHECKER", "Thread stopped");
+}
+
+void Server::handoffThread() {
+    while (running_) {
+        struct pollfd pfd;
+        pfd.fd = handoff_fd_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 500) <= 0) {
+            continue;
+        }
+
+        int channel_fd = accept4(handoff_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (channel_fd < 0) {
+            continue;
+        }
+
+        // Free the path for the successor, which listens there once it has taken over
+        close(handoff_fd_);
+        handoff_fd_ = -1;
+        unlink(handoff_path_.c_str());
+
+        bool handed_off = handOff(channel_fd);
+        close(channel_fd);
+        if (handed_off) {
+            return;
+        }
+
+        // Still serving: wait for the next attempt
+        handoff_fd_ = HotRestart::listen(handoff_path_);
+        if (handoff_fd_ < 0) {
+            return;
+        }
+    }
+
+    if (handoff_fd_ >= 0) {
+        close(handoff_fd_);
+        handoff_fd_ = -1;
+        unlink(handoff_path_.c_str());
+    }
+}
+
+bool Server::handOff(int channel_fd) {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    if (!running_) {
+        return true;  // Stopping anyway
+    }
+
+    // Quiesce: no reads, no handlers, no timers. Sockets and state stay as they are.
+    LOG_INFO("HANDOFF", "New process is taking over, pausing I/O...");
+    handing_off_ = true;
+    running_ = false;
+    stopLoops();
+
+    HandoffState state;
+    state.listen_fds = listen_fds_;
+    clients_.forEach([&state](ClientConnection& client) {
+        if (!client.isConnected()) {
+            return;
+        }
+        HandoffClient entry;
+        entry.fd = client.getSocketFd();
+        entry.sender_fd = entry.fd;
+        entry.peer_address = client.getPeerAddress();
+        entry.user_id = client.getUserId();
+        entry.authenticated = client.isAuthenticated();
+        entry.session_token = client.getSessionToken();
+        entry.wire_version = static_cast<uint8_t>(client.getWireVersion());
+        entry.capabilities = client.getCapabilities();
+        entry.inbound = client.getBufferedInput();
+        entry.outbound = client.takeOutbound();
+        state.clients.push_back(entry);
+    });
+    state.players = player_manager_->exportState();
+    if (gameplay_handler_) {
+        state.matches = gameplay_handler_->exportState();
+    }
+
+    // Until the successor is told to go, every socket is still ours. Without
+    // go it exits unserved once handoffThread() closes the channel.
+    bool sent = HotRestart::send(channel_fd, state);
+    bool ready = sent && HotRestart::waitReady(channel_fd, HANDOFF_READY_TIMEOUT_MS);
+    if (!ready || !HotRestart::sendGo(channel_fd)) {
+        // Nothing was taken over: put the output back and keep serving
+        LOG_ERROR("HANDOFF", (!sent ? "Handoff failed" : !ready ? "Successor did not report ready"
+                                                                : "Successor went away")
+                << ", resuming service");
+        for (const HandoffClient& entry : state.clients) {
+            clients_.with(entry.fd, [&entry](ClientConnection& client, uint32_t) {
+                client.restoreOutbound(entry.outbound);
+            });
+        }
+        running_ = true;
+        if (!startLoops()) {
+            running_ = false;
+        }
+        handing_off_ = false;
+        return false;
+    }
+
+    // The sockets live on in the new process: drop our copies without shutting them down
+    for (auto& client : clients_.removeAll()) {
+        client->release();
+    }
+    closeListeners(false);  // The socket file now belongs to the successor
+    handed_off_ = true;
+    handing_off_ = false;
+
+    LOG_INFO("HANDOFF", "Handed off " << state.listen_fds.size() << " listener(s) and "
+            << state.clients.size() << " connection(s)");
+    return true;
+}
+
+bool Server::takeOver(const std::string& path) {
+    if (running_) {
+        LOG_ERROR("SERVER", "Already running");
+        return false;
+    }
+
+    int channel_fd = HotRestart::connect(path);
+    if (channel_fd < 0) {
+        LOG_ERROR("HANDOFF", "No running server to take over at " << path);
+        return false;
+    }
+
+    HandoffState state;
+    if (!HotRestart::receive(channel_fd, state)) {
+        close(channel_fd);
+        return false;
+    }
+
+    // Rebuild the connections as they were, keyed by the old process's fds for the snapshots
+    std::map<int, ClientConnection*> by_sender_fd;
+    for (const HandoffClient& entry : state.clients) {
+        auto client = std::make_shared<ClientConnection>(entry.fd);
+        client->setStrand(std::make_shared<Strand>());
+        client->setPeerAddress(entry.peer_address);
+        client->setWireVersion(static_cast<ClientConnection::WireVersion>(entry.wire_version));
+        client->setCapabilities(entry.capabilities);
+        if (entry.authenticated) {
+            client->setAuthenticated(entry.user_id, entry.session_token);
+        }
+        client->appendReceived(entry.inbound.data(), entry.inbound.size());
+        client->restoreOutbound(entry.outbound);
+        clients_.insert(client);
+        by_sender_fd[entry.sender_fd] = client.get();
+    }
+    listen_fds_ = state.listen_fds;
+
+    player_manager_->importState(state.players, by_sender_fd);
+    if (gameplay_handler_ && !state.matches.empty()) {
+        gameplay_handler_->importState(state.matches);
+    }
+
+    LOG_INFO("HANDOFF", "Took over " << listen_fds_.size() << " listener(s) and "
+            << state.clients.size() << " connection(s)");
+
+    // Serve only once the old process has let go; until then it still does
+    bool go = prepare() && HotRestart::sendReady(channel_fd) && HotRestart::waitGo(channel_fd);
+    close(channel_fd);
+    if (!go) {
+        LOG_ERROR("HANDOFF", "Takeover abandoned, the running server keeps serving");
+        abandonTakeover();
+        return false;
+    }
+    serve();
+    return true;
+}
+
+void Server::abandonTakeover() {
+    running_ = false;
+    stopLoops();
+
+    // The sockets are still the old process's: close our copies without shutting them down
+    for (auto& client : clients_.removeAll()) {
+        client->release();
+    }
+    closeListeners(false);
 }
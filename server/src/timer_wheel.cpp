@@ -0,0 +1,65 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(uint64_t tick_ms, size_t slot_count)
+    : tick_ms_(tick_ms > 0 ? tick_ms : 1)
+    , slots_(slot_count > 0 ? slot_count : 1)
+    , current_tick_(0)
+    , started_(false)
+{
+}
+
+void TimerWheel::schedule(int key, uint64_t deadline_ms) {
+    deadlines_[key] = deadline_ms;
+
+    // Round up so the entry's slot is only visited once the deadline has passed
+    uint64_t tick = (deadline_ms + tick_ms_ - 1) / tick_ms_;
+    if (started_ && tick <= current_tick_) {
+        tick = current_tick_ + 1;
+    }
+    slots_[tick % slots_.size()].push_back(Entry{key, deadline_ms});
+}
+
+void TimerWheel::cancel(int key) {
+    // The slot entry stays behind and is discarded when its slot comes round
+    deadlines_.erase(key);
+}
+
+void TimerWheel::advance(uint64_t now_ms, std::vector<int>& expired) {
+    uint64_t target = now_ms / tick_ms_;
+
+    if (!started_ || target - current_tick_ >= slots_.size()) {
+        // First call, or a full revolution went by: every slot is due
+        for (size_t slot = 0; slot < slots_.size(); slot++) {
+            expireSlot(slot, now_ms, expired);
+        }
+    } else {
+        for (uint64_t tick = current_tick_ + 1; tick <= target; tick++) {
+            expireSlot(tick % slots_.size(), now_ms, expired);
+        }
+    }
+
+    if (!started_ || target > current_tick_) {
+        current_tick_ = target;
+    }
+    started_ = true;
+}
+
+void TimerWheel::expireSlot(size_t slot, uint64_t now_ms, std::vector<int>& expired) {
+    std::vector<Entry>& entries = slots_[slot];
+
+    size_t kept = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry& entry = entries[i];
+        auto it = deadlines_.find(entry.key);
+        if (it == deadlines_.end() || it->second != entry.deadline_ms) {
+            continue;  // Cancelled or rescheduled since
+        }
+        if (entry.deadline_ms <= now_ms) {
+            deadlines_.erase(it);
+            expired.push_back(entry.key);
+            continue;
+        }
+        entries[kept++] = entry;  // Due on a later revolution
+    }
+    entries.resize(kept);
+}
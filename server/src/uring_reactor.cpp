@@ -0,0 +1,574 @@
+#include "uring_reactor.h"
+#include "client_connection.h"
+#include "logger.h"
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <linux/io_uring.h>
+
+namespace {
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ring_fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+// Completion tags: operation in the low byte, then the fd, then the connection's generation
+enum TagOp : uint64_t {
+    OP_ACCEPT = 1,
+    OP_WAKE = 2,
+    OP_RECV = 3,
+    OP_POLLOUT = 4,
+    OP_CANCEL = 5,
+    OP_TICK = 6,
+    OP_QUIESCE = 7
+};
+
+uint64_t makeTag(TagOp op, int fd = 0, uint32_t generation = 0) {
+    return static_cast<uint64_t>(op)
+         | (static_cast<uint64_t>(static_cast<uint32_t>(fd) & 0xFFFFFF) << 8)
+         | (static_cast<uint64_t>(generation) << 32);
+}
+
+bool probeKernel() {
+    // Multishot recv with provided buffers arrived in 6.0
+    struct utsname info;
+    int major = 0;
+    int minor = 0;
+    if (uname(&info) != 0 || sscanf(info.release, "%d.%d", &major, &minor) != 2 ||
+        major < 6) {
+        return false;
+    }
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ring_fd = ioUringSetup(8, &params);
+    if (ring_fd < 0) {
+        return false;  // ENOSYS, or blocked by seccomp (e.g. default container profiles)
+    }
+
+    const unsigned OPS = 256;
+    std::vector<char> storage(sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    bool supported = ioUringRegister(ring_fd, IORING_REGISTER_PROBE, probe, OPS) == 0 &&
+                     (params.features & IORING_FEAT_NODROP);
+
+    const int needed[] = { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_POLL_ADD,
+                           IORING_OP_ASYNC_CANCEL, IORING_OP_READ, IORING_OP_TIMEOUT };
+    for (int op : needed) {
+        if (!supported || op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            supported = false;
+        }
+    }
+
+    close(ring_fd);
+    return supported;
+}
+}
+
+UringReactor::UringReactor(int listen_fd, int cpu)
+    : Reactor(listen_fd, cpu)
+    , ring_fd_(-1)
+    , sq_map_(nullptr)
+    , sq_map_size_(0)
+    , sqes_(nullptr)
+    , sqes_size_(0)
+    , sq_head_(nullptr)
+    , sq_tail_(nullptr)
+    , sq_array_(nullptr)
+    , sq_mask_(0)
+    , sq_entries_(0)
+    , pending_(0)
+    , cq_map_(nullptr)
+    , cq_map_size_(0)
+    , cqes_(nullptr)
+    , cq_head_(nullptr)
+    , cq_tail_(nullptr)
+    , cq_mask_(0)
+    , buf_ring_(nullptr)
+    , buf_ring_size_(0)
+    , buf_tail_(0)
+    , buf_ring_registered_(false)
+    , wake_value_(0)
+    , next_generation_(0)
+    , quiescing_(false)
+{
+    memset(&tick_timeout_, 0, sizeof(tick_timeout_));
+}
+
+UringReactor::~UringReactor() {
+    // The loop thread runs our run(); it must be gone before our members are
+    stop();
+    teardown();
+}
+
+bool UringReactor::isSupported() {
+    static const bool supported = probeKernel();
+    return supported;
+}
+
+bool UringReactor::setup() {
+    quiescing_ = false;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = CQ_ENTRIES;  // Multishot requests post many completions per submission
+
+    ring_fd_ = ioUringSetup(RING_ENTRIES, &params);
+    if (ring_fd_ < 0) {
+        LOG_ERROR("URING", "io_uring_setup failed: " << strerror(errno));
+        return false;
+    }
+
+    sq_map_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_map_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+    }
+
+    sq_map_ = mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_map_ == MAP_FAILED) {
+        sq_map_ = nullptr;
+        LOG_ERROR("URING", "Failed to map submission ring: " << strerror(errno));
+        teardown();
+        return false;
+    }
+
+    if (single_mmap) {
+        cq_map_ = sq_map_;
+    } else {
+        cq_map_ = mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_map_ == MAP_FAILED) {
+            cq_map_ = nullptr;
+            LOG_ERROR("URING", "Failed to map completion ring: " << strerror(errno));
+            teardown();
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        LOG_ERROR("URING", "Failed to map submission entries: " << strerror(errno));
+        teardown();
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_map_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+
+    char* cq = static_cast<char*>(cq_map_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Provided buffer ring: the kernel picks a free buffer for each recv completion
+    buf_ring_size_ = BUFFER_COUNT * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        LOG_ERROR("URING", "Failed to allocate buffer ring: " << strerror(errno));
+        teardown();
+        return false;
+    }
+    buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = BUFFER_COUNT;
+    reg.bgid = BUFFER_GROUP;
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+        LOG_ERROR("URING", "Failed to register buffer ring: " << strerror(errno));
+        teardown();
+        return false;
+    }
+    buf_ring_registered_ = true;
+
+    buffers_.assign(static_cast<size_t>(BUFFER_COUNT) * BUFFER_BYTES, 0);
+    for (unsigned i = 0; i < BUFFER_COUNT; i++) {
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+
+    armWake();
+    armAccept();
+    armTick();
+    if (submit(0) < 0) {
+        LOG_ERROR("URING", "Initial submit failed: " << strerror(errno));
+        teardown();
+        return false;
+    }
+    return true;
+}
+
+void UringReactor::teardown() {
+    if (buf_ring_) {
+        munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = nullptr;
+        buf_ring_registered_ = false;
+    }
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (cq_map_ && cq_map_ != sq_map_) {
+        munmap(cq_map_, cq_map_size_);
+    }
+    cq_map_ = nullptr;
+    if (sq_map_) {
+        munmap(sq_map_, sq_map_size_);
+        sq_map_ = nullptr;
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);  // Cancels whatever is still in flight
+        ring_fd_ = -1;
+    }
+    generations_.clear();
+}
+
+io_uring_sqe* UringReactor::nextSqe() {
+    unsigned tail = *sq_tail_;
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        submit(0);  // Ring full: hand what we have to the kernel first
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            return nullptr;
+        }
+    }
+
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    pending_++;
+    return sqe;
+}
+
+int UringReactor::submit(unsigned wait_for) {
+    unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int submitted = ioUringEnter(ring_fd_, pending_, wait_for, flags);
+    if (submitted > 0) {
+        pending_ -= std::min(pending_, static_cast<unsigned>(submitted));
+    }
+    return submitted;
+}
+
+void UringReactor::armAccept() {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_WARN("URING", "Submission ring full, accept not armed");
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = makeTag(OP_ACCEPT);
+}
+
+void UringReactor::armWake() {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+    sqe->len = sizeof(wake_value_);
+    sqe->user_data = makeTag(OP_WAKE);
+}
+
+void UringReactor::armTick() {
+    // Nothing else wakes the loop on a quiet ring, and idle deadlines still need checking
+    if (idle_ms_ == 0) {
+        return;
+    }
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        return;
+    }
+    tick_timeout_.tv_sec = 0;
+    tick_timeout_.tv_nsec = static_cast<long long>(IDLE_TICK_MS) * 1000000;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&tick_timeout_);
+    sqe->len = 1;
+    sqe->user_data = makeTag(OP_TICK);
+}
+
+void UringReactor::armRecv(int client_fd, uint32_t generation) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_WARN("URING", "Submission ring full, recv not armed for fd=" << client_fd);
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = client_fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = makeTag(OP_RECV, client_fd, generation);
+}
+
+void UringReactor::armPollOut(int client_fd, uint32_t generation) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_WARN("URING", "Submission ring full, POLLOUT not armed for fd=" << client_fd);
+        return;
+    }
+    // Multishot polls are edge-triggered: one completion each time a full socket gets room
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = client_fd;
+    sqe->poll32_events = POLLOUT | EPOLLET;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = makeTag(OP_POLLOUT, client_fd, generation);
+}
+
+void UringReactor::recycleBuffer(uint16_t buffer_id) {
+    // Only addr/len/bid: the resv field of the first slot doubles as the ring tail.
+    // Slots start at the ring base; the header's flex-array wrapper puts bufs at
+    // offset 8 when compiled as C++, so it can't be indexed directly.
+    io_uring_buf* slots = reinterpret_cast<io_uring_buf*>(buf_ring_);
+    io_uring_buf* buf = &slots[buf_tail_ & (BUFFER_COUNT - 1)];
+    buf->addr = reinterpret_cast<uint64_t>(&buffers_[static_cast<size_t>(buffer_id) * BUFFER_BYTES]);
+    buf->len = BUFFER_BYTES;
+    buf->bid = buffer_id;
+    buf_tail_++;
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+void UringReactor::unwatch(int client_fd) {
+    auto it = generations_.find(client_fd);
+    if (it == generations_.end()) {
+        return;
+    }
+    uint32_t generation = it->second;
+    generations_.erase(it);
+
+    // Cancel by tag rather than by fd, so a reused fd number can never be hit
+    const TagOp ops[] = { OP_RECV, OP_POLLOUT };
+    for (TagOp op : ops) {
+        io_uring_sqe* sqe = nextSqe();
+        if (!sqe) {
+            continue;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = makeTag(op, client_fd, generation);
+        sqe->user_data = makeTag(OP_CANCEL);
+    }
+}
+
+ClientConnection* UringReactor::findClient(int client_fd, uint32_t generation) {
+    auto it = generations_.find(client_fd);
+    if (it == generations_.end() || it->second != generation) {
+        return nullptr;  // Completion for a connection that has since closed
+    }
+    auto conn = connections_.find(client_fd);
+    return conn != connections_.end() ? conn->second.get() : nullptr;
+}
+
+void UringReactor::acceptClient(int client_fd) {
+    struct sockaddr_in client_addr;
+    socklen_t addr_len = sizeof(client_addr);
+    memset(&client_addr, 0, sizeof(client_addr));
+    getpeername(client_fd, (struct sockaddr*)&client_addr, &addr_len);
+
+    std::shared_ptr<ClientConnection> client;
+    if (accept_callback_) {
+        client = accept_callback_(client_fd, client_addr);
+    }
+    if (!client) {
+        close(client_fd);
+        return;
+    }
+
+    watch(client);
+    accepted_count_++;
+}
+
+bool UringReactor::watch(const std::shared_ptr<ClientConnection>& client) {
+    int client_fd = client->getSocketFd();
+    uint32_t generation = ++next_generation_;
+    generations_[client_fd] = generation;
+    connections_[client_fd] = client;
+    connection_count_ = connections_.size();
+
+    // Accepted while quiescing: left unarmed so its bytes stay in the socket
+    if (!quiescing_) {
+        armRecv(client_fd, generation);
+        armPollOut(client_fd, generation);
+    }
+    watchIdle(client.get());
+    return true;
+}
+
+void UringReactor::handleCompletion(const io_uring_cqe& cqe) {
+    TagOp op = static_cast<TagOp>(cqe.user_data & 0xFF);
+    int fd = static_cast<int>((cqe.user_data >> 8) & 0xFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32);
+    bool more = cqe.flags & IORING_CQE_F_MORE;
+
+    switch (op) {
+        case OP_WAKE:
+            if (running_) {
+                armWake();
+            }
+            break;
+
+        case OP_TICK:
+            if (running_) {
+                armTick();  // run() checks idle deadlines after every batch of completions
+            }
+            break;
+
+        case OP_ACCEPT:
+            if (cqe.res >= 0) {
+                acceptClient(cqe.res);
+            } else if (cqe.res != -ECANCELED) {
+                LOG_ERROR("URING", "Accept failed: " << strerror(-cqe.res));
+            }
+            if (!more && running_) {
+                armAccept();
+            }
+            break;
+
+        case OP_RECV: {
+            ClientConnection* client = findClient(fd, generation);
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                if (client && cqe.res > 0) {
+                    client->appendReceived(&buffers_[static_cast<size_t>(buffer_id) * BUFFER_BYTES], cqe.res);
+                }
+                recycleBuffer(buffer_id);
+            }
+            if (!client) {
+                break;
+            }
+
+            // Dispatch every complete frame, including ones that arrived just before a close
+            dispatchMessages(client);
+
+            // -ENOBUFS only means the buffer ring ran dry; the data waits in the socket.
+            // Cancelled by quiesce(): the socket stays open for whoever serves it next.
+            bool open = cqe.res > 0 || cqe.res == -ENOBUFS || (cqe.res == -ECANCELED && quiescing_);
+            if (!open) {
+                if (cqe.res < 0 && cqe.res != -ECONNRESET && cqe.res != -ECANCELED) {
+                    LOG_WARN("URING", "Receive failed: " << strerror(-cqe.res));
+                }
+                client->disconnect();
+            }
+            if (!open || !client->isConnected()) {
+                closeClient(client);
+            } else if (!more && !quiescing_) {
+                armRecv(fd, generation);
+            }
+            break;
+        }
+
+        case OP_POLLOUT: {
+            ClientConnection* client = findClient(fd, generation);
+            if (!client) {
+                break;
+            }
+            // Socket writable again: push out whatever senders left queued
+            client->flushOutbound();
+            if (!client->isConnected()) {
+                closeClient(client);
+            } else if (!more && cqe.res >= 0) {
+                armPollOut(fd, generation);
+            }
+            break;
+        }
+
+        default:
+            break;  // Cancellation results
+    }
+}
+
+void UringReactor::run() {
+    pinToCpu();
+
+    LOG_INFO("REACTOR", "io_uring loop started (listen fd=" << listen_fd_
+            << ", cpu=" << cpu_ << ")");
+
+    while (running_) {
+        // One syscall submits everything queued and waits for at least one completion
+        if (submit(1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG_ERROR("URING", "io_uring_enter failed: " << strerror(errno));
+            break;
+        }
+
+        unsigned head = *cq_head_;
+        while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) && running_) {
+            io_uring_cqe cqe = cqes_[head & cq_mask_];
+            __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+            handleCompletion(cqe);
+        }
+
+        checkIdle();
+    }
+
+    quiesce();
+    LOG_INFO("REACTOR", "io_uring loop stopped");
+}
+
+void UringReactor::quiesce() {
+    // Multishot receives keep taking bytes off sockets until cancelled, and the
+    // sockets may outlive this reactor (hot restart). Cancel every request and
+    // handle what completes meanwhile, so no received byte is left unprocessed.
+    quiescing_ = true;
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    sqe->user_data = makeTag(OP_QUIESCE);
+
+    // One more pass after the cancel completes picks up terminations it deferred
+    bool cancelled = false;
+    bool drained = false;
+    while (!drained) {
+        drained = cancelled;
+        if (submit(cancelled ? 0 : 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG_ERROR("URING", "io_uring_enter failed while stopping: " << strerror(errno));
+            return;
+        }
+
+        unsigned head = *cq_head_;
+        while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            io_uring_cqe cqe = cqes_[head & cq_mask_];
+            __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+            if ((cqe.user_data & 0xFF) == OP_QUIESCE) {
+                cancelled = true;
+            } else {
+                handleCompletion(cqe);
+            }
+        }
+    }
+}
@@ -0,0 +1,253 @@
+#include "worker_pool.h"
+#include "logger.h"
+#include <exception>
+
+namespace {
+// Pool and index of the worker running on this thread; null/-1 outside any pool.
+// Another pool's worker (e.g. AsyncRuntime's blocking threads) posts from outside.
+thread_local const WorkerPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+
+// A queue that never fully drains drops its consumed front once it is half the vector
+template <typename T>
+void compactFront(std::vector<T>& items, size_t& head) {
+    if (head >= 64 && head * 2 >= items.size()) {
+        items.erase(items.begin(), items.begin() + head);
+        head = 0;
+    }
+}
+
+template <typename T>
+void updateMax(std::atomic<T>& target, T value) {
+    T seen = target.load();
+    while (value > seen && !target.compare_exchange_weak(seen, value)) {
+    }
+}
+}
+
+Strand::~Strand() {
+    // Only reached with tasks left if the pool was destroyed before running them
+    for (size_t i = head_; i < tasks_.size(); i++) {
+        tasks_[i].fn->release();
+    }
+}
+
+size_t Strand::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size() - head_;
+}
+
+WorkerPool::WorkerPool(size_t thread_count)
+    : thread_count_(thread_count)
+    , running_(false)
+    , next_queue_(0)
+    , ready_strands_(0)
+    , queue_depth_(0)
+    , max_queue_depth_(0)
+    , tasks_run_(0)
+    , steals_(0)
+    , total_wait_us_(0)
+    , max_wait_us_(0)
+{
+    if (thread_count_ == 0) {
+        thread_count_ = std::thread::hardware_concurrency();
+        if (thread_count_ == 0) {
+            thread_count_ = 1;
+        }
+    }
+
+    for (size_t i = 0; i < thread_count_; i++) {
+        queues_.emplace_back(new RunQueue());
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+bool WorkerPool::start() {
+    if (running_.exchange(true)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < thread_count_; i++) {
+        threads_.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+
+    LOG_INFO("WORKERS", thread_count_ << " worker thread(s) started");
+    return true;
+}
+
+void WorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    idle_cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+
+    LOG_INFO("WORKERS", "Worker threads stopped (" << tasks_run_ << " tasks run)");
+}
+
+void WorkerPool::postTask(const std::shared_ptr<Strand>& strand, PooledTask* task) {
+    if (!running_ || !strand) {
+        runTask(task);
+        return;
+    }
+
+    bool needs_schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex_);
+        Strand::Task entry;
+        entry.fn = task;
+        entry.enqueued = std::chrono::steady_clock::now();
+        strand->tasks_.push_back(entry);
+
+        if (!strand->scheduled_) {
+            strand->scheduled_ = true;
+            needs_schedule = true;
+        }
+    }
+
+    updateMax(max_queue_depth_, ++queue_depth_);
+
+    if (needs_schedule) {
+        schedule(strand);
+    }
+}
+
+void WorkerPool::schedule(std::shared_ptr<Strand> strand) {
+    // Workers keep rescheduled strands local; outside posts are spread round-robin
+    size_t index = current_pool == this ? static_cast<size_t>(current_worker)
+                                        : next_queue_++ % thread_count_;
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->strands.push_back(std::move(strand));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        ready_strands_++;
+    }
+    idle_cv_.notify_one();
+}
+
+std::shared_ptr<Strand> WorkerPool::takeStrand(size_t index) {
+    // Own queue first (FIFO), then steal from the back of the others
+    for (size_t offset = 0; offset < thread_count_; offset++) {
+        RunQueue& queue = *queues_[(index + offset) % thread_count_];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head == queue.strands.size()) {
+            continue;
+        }
+
+        std::shared_ptr<Strand> strand;
+        if (offset == 0) {
+            strand = std::move(queue.strands[queue.head++]);
+        } else {
+            strand = std::move(queue.strands.back());
+            queue.strands.pop_back();
+            steals_++;
+        }
+        if (queue.head == queue.strands.size()) {
+            queue.strands.clear();
+            queue.head = 0;
+        } else {
+            compactFront(queue.strands, queue.head);
+        }
+        ready_strands_--;
+        return strand;
+    }
+    return nullptr;
+}
+
+void WorkerPool::workerLoop(size_t index) {
+    current_pool = this;
+    current_worker = static_cast<int>(index);
+
+    while (true) {
+        std::shared_ptr<Strand> strand = takeStrand(index);
+        if (strand) {
+            runStrand(strand);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_cv_.wait(lock, [this]() { return !running_ || ready_strands_ > 0; });
+        if (!running_ && ready_strands_ == 0) {
+            break;  // Stopped and fully drained
+        }
+    }
+
+    current_pool = nullptr;
+    current_worker = -1;
+}
+
+void WorkerPool::runStrand(const std::shared_ptr<Strand>& strand) {
+    for (size_t ran = 0; ; ran++) {
+        Strand::Task task;
+        {
+            std::lock_guard<std::mutex> lock(strand->mutex_);
+            if (strand->head_ == strand->tasks_.size()) {
+                strand->tasks_.clear();
+                strand->head_ = 0;
+                strand->scheduled_ = false;
+                return;
+            }
+            if (ran == STRAND_BATCH) {
+                break;  // Still scheduled; requeue below so other strands get a turn
+            }
+            task = strand->tasks_[strand->head_++];
+            if (strand->head_ == strand->tasks_.size()) {
+                // Reuse the slots now, so a post while this task runs does not grow the vector
+                strand->tasks_.clear();
+                strand->head_ = 0;
+            } else {
+                compactFront(strand->tasks_, strand->head_);
+            }
+        }
+        queue_depth_--;
+
+        uint64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task.enqueued).count();
+        total_wait_us_ += wait_us;
+        updateMax(max_wait_us_, wait_us);
+
+        runTask(task.fn);
+        tasks_run_++;
+    }
+
+    schedule(strand);
+}
+
+void WorkerPool::runTask(PooledTask* task) {
+    try {
+        task->run();
+    } catch (const std::exception& e) {
+        LOG_ERROR("WORKERS", "Task threw: " << e.what());
+    } catch (...) {
+        LOG_ERROR("WORKERS", "Task threw an unknown exception");
+    }
+    task->release();
+}
+
+WorkerPool::Stats WorkerPool::getStats() const {
+    Stats stats;
+    stats.threads = thread_count_;
+    stats.queue_depth = queue_depth_;
+    stats.max_queue_depth = max_queue_depth_;
+    stats.tasks_run = tasks_run_;
+    stats.steals = steals_;
+    stats.avg_wait_us = stats.tasks_run > 0 ? static_cast<double>(total_wait_us_) / stats.tasks_run : 0.0;
+    stats.max_wait_us = max_wait_us_;
+    return stats;
+}
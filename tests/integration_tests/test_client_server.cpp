@@ -2,6 +2,7 @@
 #include <thread>
 #include <chrono>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
@@ -14,7 +15,8 @@
  *
  * REQUIREMENTS:
  * - Server must be running on localhost (port defined in config.h)
- * - Run server: ./bin/battleship_server
+ * - Run server: ./bin/battleship_server (from the repository root, so the
+ *   Unix socket test finds UNIX_SOCKET_PATH)
  *
  * These tests connect to the actual server and test real network communication
  */
@@ -55,6 +57,28 @@ public:
         return true;
     }
 
+    // Same protocol over the server's Unix socket
+    bool connectLocal(const char* path) {
+        socket_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket_fd_ < 0) {
+            return false;
+        }
+
+        struct sockaddr_un server_addr;
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sun_family = AF_UNIX;
+        strncpy(server_addr.sun_path, path, sizeof(server_addr.sun_path) - 1);
+
+        if (::connect(socket_fd_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            close(socket_fd_);
+            socket_fd_ = -1;
+            return false;
+        }
+
+        connected_ = true;
+        return true;
+    }
+
     void disconnect() {
         if (socket_fd_ >= 0) {
             close(socket_fd_);
@@ -313,6 +337,28 @@ TEST_F(IntegrationTest, PingPong_Concurrent) {
         << "Not all concurrent clients received PONG";
 }
 
+TEST_F(IntegrationTest, PingPong_OverUnixSocket) {
+    ASSERT_TRUE(client->connectLocal(UNIX_SOCKET_PATH))
+        << "Failed to connect to " << UNIX_SOCKET_PATH;
+
+    for (int i = 0; i < 10; i++) {
+        MessageHeader ping_header;
+        ping_header.type = PING;
+        ping_header.length = 0;
+        ping_header.timestamp = time(nullptr);
+        memset(ping_header.session_token, 0, sizeof(ping_header.session_token));
+
+        ASSERT_TRUE(client->sendMessage(ping_header, ""))
+            << "Failed to send PING #" << i;
+
+        MessageHeader pong_header;
+        std::string payload;
+        ASSERT_TRUE(client->receiveMessage(pong_header, payload))
+            << "Failed to receive PONG #" << i;
+        EXPECT_EQ(pong_header.type, PONG);
+    }
+}
+
 // ============== STRESS TESTS ==============
 
 TEST_F(IntegrationTest, StressTest_RapidPingPong) {
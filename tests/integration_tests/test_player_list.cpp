@@ -12,6 +12,7 @@
 #include "protocol.h"
 #include "messages/authentication_messages.h"
 #include "messages/matchmaking_messages.h"
+#include "player_list.h"
 #include "message_serialization.h"
 #include "password_hash.h"
 #include "config.h"
@@ -26,6 +27,7 @@ using namespace MessageSerialization;
  * - PLAYER_LIST_REQUEST returns online players
  * - Multiple clients can see each other
  * - Logout removes player from list
+ * - Pages of the list can be walked with a cursor
  * - Player status updates are broadcasted
  */
 
@@ -184,8 +186,10 @@ protected:
         return resp.success;
     }
 
-    bool requestPlayerList(int sock, PlayerListResponse& response) {
+    bool requestPlayerList(int sock, PlayerListPage& response, uint32_t cursor = 0, uint16_t limit = 0) {
         PlayerListRequest req;
+        req.cursor = cursor;
+        req.limit = limit;
 
         MessageHeader header;
         header.type = static_cast<uint8_t>(MessageType::PLAYER_LIST_REQUEST);
@@ -203,11 +207,7 @@ protected:
             return false;
         }
 
-        if (!deserialize(response_payload, response)) {
-            return false;
-        }
-
-        return true;
+        return response.decode(response_payload);
     }
 
     std::string server_host;
@@ -250,13 +250,13 @@ TEST_F(PlayerListIntegrationTest, RequestPlayerListReturnsPlayers) {
     ASSERT_TRUE(loginUser(sock, username, password, session_token));
 
     // Request player list
-    PlayerListResponse response;
+    PlayerListPage response;
     ASSERT_TRUE(requestPlayerList(sock, response));
 
     // Should have at least 1 player (ourselves)
-    EXPECT_GT(response.count, 0);
+    EXPECT_GT(response.players.size(), 0u);
 
-    std::cout << "✅ Player list returned " << response.count << " players" << std::endl;
+    std::cout << "✅ Player list returned " << response.players.size() << " players" << std::endl;
 }
 
 // Test: Multiple clients see each other
@@ -291,18 +291,18 @@ TEST_F(PlayerListIntegrationTest, MultipleClientsSeeEachOther) {
 
     // Each client requests player list
     for (int i = 0; i < num_clients; i++) {
-        PlayerListResponse response;
+        PlayerListPage response;
         ASSERT_TRUE(requestPlayerList(socks[i], response));
 
         // Should see all players (including themselves)
-        EXPECT_GE(response.count, num_clients);
+        EXPECT_GE(response.players.size(), static_cast<size_t>(num_clients));
 
-        std::cout << "Client " << i << " sees " << response.count << " players" << std::endl;
+        std::cout << "Client " << i << " sees " << response.players.size() << " players" << std::endl;
 
         // Verify all our test players are in the list
         for (const std::string& expected_user : usernames) {
             bool found = false;
-            for (uint32_t j = 0; j < response.count; j++) {
+            for (size_t j = 0; j < response.players.size(); j++) {
                 if (std::string(response.players[j].username) == expected_user) {
                     found = true;
                     EXPECT_EQ(response.players[j].status, STATUS_AVAILABLE);
@@ -342,9 +342,9 @@ TEST_F(PlayerListIntegrationTest, LogoutRemovesPlayer) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
     // Client 2 checks player list (should see both)
-    PlayerListResponse response1;
+    PlayerListPage response1;
     ASSERT_TRUE(requestPlayerList(sock2, response1));
-    uint32_t count_before = response1.count;
+    size_t count_before = response1.players.size();
 
     std::cout << "Before logout: " << count_before << " players" << std::endl;
 
@@ -372,14 +372,14 @@ TEST_F(PlayerListIntegrationTest, LogoutRemovesPlayer) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
     // Client 2 checks player list again (should not see client 1)
-    PlayerListResponse response2;
+    PlayerListPage response2;
     ASSERT_TRUE(requestPlayerList(sock2, response2));
 
-    std::cout << "After logout: " << response2.count << " players" << std::endl;
+    std::cout << "After logout: " << response2.players.size() << " players" << std::endl;
 
     // Verify client 1 is not in the list
     bool found_client1 = false;
-    for (uint32_t i = 0; i < response2.count; i++) {
+    for (size_t i = 0; i < response2.players.size(); i++) {
         if (std::string(response2.players[i].username) == username1) {
             found_client1 = true;
             break;
@@ -405,12 +405,12 @@ TEST_F(PlayerListIntegrationTest, PlayerListContainsCorrectInfo) {
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
     // Request player list
-    PlayerListResponse response;
+    PlayerListPage response;
     ASSERT_TRUE(requestPlayerList(sock, response));
 
     // Find our player in the list
     bool found = false;
-    for (uint32_t i = 0; i < response.count; i++) {
+    for (size_t i = 0; i < response.players.size(); i++) {
         if (std::string(response.players[i].username) == username) {
             found = true;
             EXPECT_STREQ(response.players[i].display_name, display_name.c_str());
@@ -424,6 +424,58 @@ TEST_F(PlayerListIntegrationTest, PlayerListContainsCorrectInfo) {
     std::cout << "✅ Player list contains correct info" << std::endl;
 }
 
+// Test: Walking the list page by page visits every player once, in user_id order
+TEST_F(PlayerListIntegrationTest, CursorWalksAllPages) {
+    const int num_clients = 3;
+    std::vector<int> socks;
+    std::vector<std::string> usernames;
+    std::string ts = std::to_string(time(nullptr));
+
+    for (int i = 0; i < num_clients; i++) {
+        int sock = connectToServer();
+        ASSERT_GT(sock, 0);
+        socks.push_back(sock);
+
+        std::string username = "test_page_" + ts + "_" + std::to_string(i);
+        ASSERT_TRUE(registerUser(sock, username, "password123", "Page Player " + std::to_string(i)));
+        std::string token;
+        ASSERT_TRUE(loginUser(sock, username, "password123", token));
+        usernames.push_back(username);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Two players a page
+    std::vector<PlayerInfo_Message> seen;
+    uint32_t cursor = 0;
+    int pages = 0;
+    do {
+        PlayerListPage page;
+        ASSERT_TRUE(requestPlayerList(socks[0], page, cursor, 2));
+        EXPECT_LE(page.players.size(), 2u);
+        EXPECT_GE(page.total, static_cast<uint32_t>(num_clients));
+        EXPECT_LE(page.encode().size(), PlayerListPage::HEADER_SIZE + 2 * sizeof(PlayerInfo_Message));
+        seen.insert(seen.end(), page.players.begin(), page.players.end());
+        cursor = page.next_cursor;
+        ASSERT_LT(++pages, 1000) << "Cursor does not advance";
+    } while (cursor != 0);
+
+    for (size_t i = 1; i < seen.size(); i++) {
+        EXPECT_LT(seen[i - 1].user_id, seen[i].user_id);
+    }
+    for (const std::string& expected_user : usernames) {
+        int found = 0;
+        for (const auto& player : seen) {
+            if (std::string(player.username) == expected_user) {
+                found++;
+            }
+        }
+        EXPECT_EQ(found, 1) << "Player " << expected_user << " should be listed once";
+    }
+
+    std::cout << "✅ " << seen.size() << " players over " << pages << " pages" << std::endl;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+
+#include "protocol.h"
+#include "messages/authentication_messages.h"
+#include "messages/matchmaking_messages.h"
+#include "player_list.h"
+#include "message_serialization.h"
+#include "config.h"
+
+using namespace MessageSerialization;
+
+/**
+ * Integration Tests for Hot Restart
+ *
+ * Starts the server binary itself, logs clients in, then starts a second
+ * binary with --takeover (and a third after that). The clients keep their
+ * TCP connections throughout and must find their sessions intact. A
+ * successor that fails to start must leave the old process serving them.
+ *
+ * Run from the repository root after `make server`; SERVER_BIN overrides the
+ * binary. Uses its own port and handoff socket, so no server needs to be up.
+ */
+
+static const int TAKEOVER_PORT = 9995;
+static const char* TAKEOVER_SOCKET = "/tmp/battleship_takeover_test.sock";
+
+class TakeoverIntegrationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        srand(time(nullptr) + getpid());
+        server_bin = std::getenv("SERVER_BIN") ? std::getenv("SERVER_BIN") : "./bin/battleship_server";
+        ASSERT_EQ(access(server_bin.c_str(), X_OK), 0) << server_bin << " not found; run make server";
+    }
+
+    void TearDown() override {
+        for (int fd : client_fds) {
+            close(fd);
+        }
+        for (pid_t pid : servers) {
+            kill(pid, SIGTERM);
+        }
+        for (pid_t pid : servers) {
+            waitpid(pid, nullptr, 0);
+        }
+        unlink(TAKEOVER_SOCKET);
+    }
+
+    // max_fds > 0 caps the process's descriptors (RLIMIT_NOFILE)
+    pid_t launchServer(bool takeover, const std::string& log_path, rlim_t max_fds = 0) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int log_fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (log_fd >= 0) {
+                dup2(log_fd, STDOUT_FILENO);
+                dup2(log_fd, STDERR_FILENO);
+            }
+            if (max_fds > 0) {
+                struct rlimit limit = {max_fds, max_fds};
+                setrlimit(RLIMIT_NOFILE, &limit);
+            }
+            setenv("HANDOFF_SOCKET", TAKEOVER_SOCKET, 1);
+            std::string port = std::to_string(TAKEOVER_PORT);
+            if (takeover) {
+                execl(server_bin.c_str(), server_bin.c_str(), port.c_str(), "--takeover", (char*)nullptr);
+            } else {
+                execl(server_bin.c_str(), server_bin.c_str(), port.c_str(), (char*)nullptr);
+            }
+            _exit(127);
+        }
+        servers.push_back(pid);
+        return pid;
+    }
+
+    // Exit code once pid has exited (it is reaped and forgotten), -1 while it runs
+    int waitForStatus(pid_t pid, int timeout_ms) {
+        for (int waited = 0; waited < timeout_ms; waited += 10) {
+            int status = 0;
+            if (waitpid(pid, &status, WNOHANG) == pid) {
+                servers.erase(std::find(servers.begin(), servers.end(), pid));
+                return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return -1;
+    }
+
+    // True once pid has exited cleanly
+    bool waitForExit(pid_t pid, int timeout_ms) {
+        return waitForStatus(pid, timeout_ms) == 0;
+    }
+
+    static std::string readFile(const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    bool waitForHandoffSocket(int timeout_ms) {
+        for (int waited = 0; waited < timeout_ms; waited += 10) {
+            if (access(TAKEOVER_SOCKET, F_OK) == 0) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    int connectToServer() {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) {
+            return -1;
+        }
+
+        struct timeval tv = {5, 0};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        struct sockaddr_in server_addr;
+        memset(&server_addr, 0, sizeof(server_addr));
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(TAKEOVER_PORT);
+        inet_pton(AF_INET, SERVER_HOST, &server_addr.sin_addr);
+
+        if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            close(sock);
+            return -1;
+        }
+
+        client_fds.push_back(sock);
+        return sock;
+    }
+
+    bool sendMessage(int sock, MessageType type, const std::string& payload) {
+        MessageHeader header = createHeader(type, payload.size());
+        if (send(sock, &header, sizeof(MessageHeader), 0) != sizeof(MessageHeader)) {
+            return false;
+        }
+        return payload.empty() || send(sock, payload.data(), payload.size(), 0) == (ssize_t)payload.size();
+    }
+
+    // Receive a message of the expected type, skipping broadcasts and heartbeats
+    bool receiveExpected(int sock, MessageType expected_type, std::string& payload) {
+        for (int attempt = 0; attempt < 50; attempt++) {
+            MessageHeader header;
+            if (recv(sock, &header, sizeof(MessageHeader), MSG_WAITALL) != sizeof(MessageHeader)) {
+                return false;
+            }
+            payload.assign(header.length, '\0');
+            if (header.length > 0 &&
+                recv(sock, &payload[0], header.length, MSG_WAITALL) != (ssize_t)header.length) {
+                return false;
+            }
+            if (header.type == static_cast<uint8_t>(expected_type)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool registerAndLogin(int sock, const std::string& username) {
+        RegisterRequest reg;
+        safeStrCopy(reg.username, username, sizeof(reg.username));
+        safeStrCopy(reg.password, "password123", sizeof(reg.password));
+        safeStrCopy(reg.display_name, username, sizeof(reg.display_name));
+
+        std::string payload;
+        RegisterResponse reg_resp;
+        if (!sendMessage(sock, AUTH_REGISTER, serialize(reg)) ||
+            !receiveExpected(sock, AUTH_RESPONSE, payload) ||
+            !deserialize(payload, reg_resp) || !reg_resp.success) {
+            return false;
+        }
+
+        LoginRequest login;
+        safeStrCopy(login.username, username, sizeof(login.username));
+        safeStrCopy(login.password, "password123", sizeof(login.password));
+
+        LoginResponse login_resp;
+        return sendMessage(sock, AUTH_LOGIN, serialize(login)) &&
+               receiveExpected(sock, AUTH_RESPONSE, payload) &&
+               deserialize(payload, login_resp) && login_resp.success;
+    }
+
+    bool pingPong(int sock) {
+        std::string payload;
+        return sendMessage(sock, PING, "") && receiveExpected(sock, PONG, payload);
+    }
+
+    // Names in the server's online list
+    std::vector<std::string> onlinePlayers(int sock) {
+        std::vector<std::string> names;
+        std::string payload;
+        PlayerListPage page;
+        if (sendMessage(sock, PLAYER_LIST_REQUEST, serialize(PlayerListRequest())) &&
+            receiveExpected(sock, PLAYER_LIST, payload) && page.decode(payload)) {
+            for (const auto& player : page.players) {
+                names.push_back(player.username);
+            }
+        }
+        return names;
+    }
+
+    static bool contains(const std::vector<std::string>& names, const std::string& name) {
+        return std::find(names.begin(), names.end(), name) != names.end();
+    }
+
+    std::string server_bin;
+    std::vector<pid_t> servers;
+    std::vector<int> client_fds;
+};
+
+TEST_F(TakeoverIntegrationTest, ClientsSurviveTwoRestarts) {
+    unlink(TAKEOVER_SOCKET);
+    launchServer(false, "/tmp/battleship_takeover_1.log");
+    ASSERT_TRUE(waitForHandoffSocket(5000)) << "first server did not start";
+
+    int alice = connectToServer();
+    int bob = connectToServer();
+    ASSERT_GT(alice, 0);
+    ASSERT_GT(bob, 0);
+
+    std::string suffix = std::to_string(time(nullptr)) + "_" + std::to_string(rand() % 10000);
+    std::string alice_name = "ho_a_" + suffix;
+    std::string bob_name = "ho_b_" + suffix;
+    ASSERT_TRUE(registerAndLogin(alice, alice_name));
+    ASSERT_TRUE(registerAndLogin(bob, bob_name));
+    ASSERT_TRUE(contains(onlinePlayers(alice), bob_name));
+
+    // Two upgrades in a row: each new binary takes over from the previous one
+    for (int generation = 2; generation <= 3; generation++) {
+        pid_t previous = servers.back();
+        launchServer(true, "/tmp/battleship_takeover_" + std::to_string(generation) + ".log");
+        ASSERT_TRUE(waitForExit(previous, 15000)) << "server " << generation - 1 << " did not hand off";
+        ASSERT_TRUE(waitForHandoffSocket(5000)) << "server " << generation << " is not accepting takeovers";
+
+        // Same sockets, now served by the new process, with sessions intact
+        EXPECT_TRUE(pingPong(alice));
+        EXPECT_TRUE(pingPong(bob));
+        std::vector<std::string> online = onlinePlayers(bob);
+        EXPECT_TRUE(contains(online, alice_name));
+        EXPECT_TRUE(contains(online, bob_name));
+
+        // New connections land on the new process too
+        int carol = connectToServer();
+        ASSERT_GT(carol, 0);
+        EXPECT_TRUE(pingPong(carol));
+    }
+}
+
+TEST_F(TakeoverIntegrationTest, OldServerKeepsServingWhenSuccessorFails) {
+    unlink(TAKEOVER_SOCKET);
+    pid_t server = launchServer(false, "/tmp/battleship_takeover_failed.log");
+    ASSERT_TRUE(waitForHandoffSocket(5000)) << "server did not start";
+
+    int alice = connectToServer();
+    ASSERT_GT(alice, 0);
+    std::string alice_name = "ho_f_" + std::to_string(time(nullptr)) + "_" + std::to_string(rand() % 10000);
+    ASSERT_TRUE(registerAndLogin(alice, alice_name));
+
+    // A successor with just enough descriptors to receive the handoff fails in
+    // start(), with the sockets in hand. Raise its limit until it gets that far;
+    // each attempt that fails earlier must leave the old server serving too.
+    std::string successor_log = "/tmp/battleship_takeover_failing.log";
+    bool failed_in_start = false;
+    for (rlim_t max_fds = 4; max_fds <= 256 && !failed_in_start; max_fds++) {
+        ASSERT_TRUE(waitForHandoffSocket(15000)) << "server stopped accepting takeovers";
+        pid_t successor = launchServer(true, successor_log, max_fds);
+        ASSERT_NE(waitForStatus(successor, 15000), 0) << "successor took over with " << max_fds << " fds";
+        failed_in_start = readFile(successor_log).find("Took over") != std::string::npos;
+        ASSERT_TRUE(pingPong(alice)) << "old server stopped serving after a takeover with " << max_fds << " fds";
+    }
+    ASSERT_TRUE(failed_in_start);
+
+    // Still the same process, with the same session, the listener and a new handoff socket
+    EXPECT_FALSE(waitForExit(server, 500)) << "server exited without a successor";
+    EXPECT_TRUE(pingPong(alice));
+    EXPECT_TRUE(contains(onlinePlayers(alice), alice_name));
+
+    int bob = connectToServer();
+    ASSERT_GT(bob, 0);
+    EXPECT_TRUE(pingPong(bob));
+    EXPECT_TRUE(waitForHandoffSocket(5000));
+
+    // A real successor can still take over afterwards
+    launchServer(true, "/tmp/battleship_takeover_after_failed.log");
+    ASSERT_TRUE(waitForExit(server, 15000)) << "server did not hand off";
+    EXPECT_TRUE(pingPong(alice));
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
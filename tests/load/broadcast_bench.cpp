@@ -0,0 +1,155 @@
+/**
+ * Broadcast Benchmark: allocations per broadcast
+ *
+ * Fans a PLAYER_STATUS_UPDATE out to N connections over socket pairs and
+ * counts heap allocations per broadcast. "per-client" serializes the frame
+ * for every recipient, as broadcasts did before frames were shared; "shared"
+ * builds one MessageBuffer and queues it to everyone, as Server::broadcast
+ * does now. The first grows with N, the second should stay constant.
+ *
+ * Run with:
+ *   ./bin/broadcast_bench [--rounds 2000]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "protocol.h"
+#include "messages/matchmaking_messages.h"
+#include "message_serialization.h"
+#include "client_connection.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// Every heap allocation in the process goes through here
+static atomic<uint64_t> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+struct Recipient {
+    shared_ptr<ClientConnection> connection;
+    int peer_fd;
+};
+
+static vector<Recipient> makeRecipients(int count) {
+    vector<Recipient> recipients;
+    recipients.reserve(count);
+    for (int i = 0; i < count; i++) {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets) != 0) {
+            perror("socketpair");
+            exit(1);
+        }
+        Recipient recipient;
+        recipient.connection = make_shared<ClientConnection>(sockets[0]);
+        recipient.peer_fd = sockets[1];
+        recipients.push_back(recipient);
+    }
+    return recipients;
+}
+
+// Empties the peers so the next round writes straight through
+static void drainPeers(const vector<Recipient>& recipients) {
+    char buffer[4096];
+    for (const auto& recipient : recipients) {
+        while (recv(recipient.peer_fd, buffer, sizeof(buffer), 0) > 0) {
+        }
+    }
+}
+
+static void broadcastRound(vector<Recipient>& recipients, bool shared,
+                           const MessageHeader& header, const string& payload) {
+    // The server handles messages inside a batch; broadcasts happen there too
+    ClientConnection::SendBatch batch;
+    if (shared) {
+        SharedMessage message = MessageBuffer::create(header, payload);
+        for (auto& recipient : recipients) {
+            recipient.connection->sendMessage(message);
+        }
+    } else {
+        for (auto& recipient : recipients) {
+            recipient.connection->sendMessage(header, payload);
+        }
+    }
+}
+
+static void runCase(const char* name, bool shared, int clients, int rounds) {
+    vector<Recipient> recipients = makeRecipients(clients);
+
+    PlayerStatusUpdate update;
+    update.user_id = 42;
+    update.status = STATUS_IN_GAME;
+    strncpy(update.display_name, "Bench Player", sizeof(update.display_name) - 1);
+    update.elo_rating = 1200;
+    string payload = MessageSerialization::serialize(update);
+
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = PLAYER_STATUS_UPDATE;
+    header.length = payload.size();
+
+    // Warm up queue and batch capacity, then measure
+    for (int i = 0; i < 10; i++) {
+        broadcastRound(recipients, shared, header, payload);
+        drainPeers(recipients);
+    }
+
+    uint64_t counted = 0;
+    double secs = 0;
+    for (int i = 0; i < rounds; i++) {
+        uint64_t before = allocations;
+        auto start = Clock::now();
+        broadcastRound(recipients, shared, header, payload);
+        secs += chrono::duration<double>(Clock::now() - start).count();
+        counted += allocations - before;
+        drainPeers(recipients);
+    }
+
+    for (auto& recipient : recipients) {
+        close(recipient.peer_fd);
+    }
+
+    cout << "[BENCH] " << left << setw(11) << name << right << setw(5) << clients << " clients  "
+         << fixed << setprecision(2) << setw(8) << (double)counted / rounds << " allocs/broadcast  "
+         << setprecision(0) << setw(8) << (rounds * clients / secs) << " frames/s" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = 2000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "--rounds") rounds = atoi(argv[i + 1]);
+    }
+
+    cout << "[BENCH] " << rounds << " PLAYER_STATUS_UPDATE broadcasts per case" << endl;
+    const int sizes[] = {10, 100, 1000};
+    for (int clients : sizes) {
+        runCase("per-client", false, clients, rounds);
+        runCase("shared", true, clients, rounds);
+    }
+    return 0;
+}
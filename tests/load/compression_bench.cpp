@@ -0,0 +1,241 @@
+/**
+ * Compression Benchmark: CPU cost against bytes saved
+ *
+ * Compresses the real message payloads a server sends (the fixed structs
+ * in common/include/messages/, filled as the handlers fill them, plus the
+ * variable-length PLAYER_LIST pages and a lobby BATCH frame) with
+ * PayloadCompression and reports, per message:
+ *
+ *   raw and compressed size, microseconds to compress and to decompress,
+ *   and bytes saved per microsecond of CPU (both ends together).
+ *
+ * Messages below COMPRESSION_THRESHOLD are marked; the server sends those
+ * uncompressed whatever the connection agreed. "-" means compression does
+ * not make the payload smaller, so it goes out as it is.
+ *
+ * Run with:
+ *   ./bin/compression_bench [--rounds 20000]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include "protocol.h"
+#include "config.h"
+#include "payload_compression.h"
+#include "player_list.h"
+#include "batch_entry.h"
+#include "messages/authentication_messages.h"
+#include "messages/matchmaking_messages.h"
+#include "messages/gameplay_messages.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct Case {
+    string name;
+    string payload;
+};
+
+template <typename T>
+static Case message(const char* name, const T& data) {
+    Case result;
+    result.name = name;
+    result.payload.assign(reinterpret_cast<const char*>(&data), sizeof(T));
+    return result;
+}
+
+static PlayerInfo_Message player(uint32_t id) {
+    PlayerInfo_Message info;
+    info.user_id = id;
+    info.elo_rating = 900 + static_cast<int32_t>(id * 37 % 600);
+    info.status = id % 3 == 0 ? STATUS_IN_GAME : STATUS_AVAILABLE;
+    snprintf(info.username, sizeof(info.username), "player%u", id);
+    snprintf(info.display_name, sizeof(info.display_name), "Player %u", id);
+    return info;
+}
+
+// A page of up to players entries, cut at MAX_MESSAGE_SIZE as the handler does
+static Case playerPage(const char* name, uint32_t players) {
+    PlayerListPage page;
+    page.total = 5000;
+    size_t size = PlayerListPage::HEADER_SIZE;
+    for (uint32_t id = 1; id <= players; id++) {
+        PlayerInfo_Message info = player(id);
+        if (size + PlayerListPage::entrySize(info) > MAX_MESSAGE_SIZE) {
+            break;
+        }
+        size += PlayerListPage::entrySize(info);
+        page.players.push_back(info);
+        page.next_cursor = id;
+    }
+    Case result;
+    result.name = name;
+    result.payload = page.encode();
+    return result;
+}
+
+// What a lobby client gets in one step while others log in and out
+static Case lobbyBatch(uint32_t updates) {
+    Case result;
+    result.name = "BATCH (status updates)";
+    for (uint32_t id = 1; id <= updates; id++) {
+        PlayerStatusUpdate update;
+        update.user_id = id;
+        update.status = id % 2 ? STATUS_AVAILABLE : STATUS_OFFLINE;
+        update.elo_rating = 1000 + static_cast<int32_t>(id);
+        snprintf(update.display_name, sizeof(update.display_name), "Player %u", id);
+
+        char header[BatchEntry::HEADER_SIZE];
+        BatchEntry::encodeHeader(header, PLAYER_STATUS_UPDATE, sizeof(update));
+        result.payload.append(header, sizeof(header));
+        result.payload.append(reinterpret_cast<const char*>(&update), sizeof(update));
+    }
+    return result;
+}
+
+static vector<Case> realMessages() {
+    vector<Case> cases;
+
+    RegisterResponse registered;
+    registered.success = true;
+    registered.user_id = 4242;
+    cases.push_back(message("REGISTER_RESPONSE", registered));
+
+    LoginResponse login;
+    login.success = true;
+    login.user_id = 4242;
+    strncpy(login.session_token, "3f2a9c4e8b1d7f6a0e5c2b9d4a8f1e3c7b6d0a9f2e4c8b1d5a7f3e9c0b2d6a4f", sizeof(login.session_token) - 1);
+    strncpy(login.display_name, "Captain Nemo", sizeof(login.display_name) - 1);
+    cases.push_back(message("LOGIN_RESPONSE", login));
+
+    SessionValidateResponse session;
+    session.valid = true;
+    session.user_id = 4242;
+    strncpy(session.username, "nemo", sizeof(session.username) - 1);
+    strncpy(session.display_name, "Captain Nemo", sizeof(session.display_name) - 1);
+    cases.push_back(message("SESSION_VALIDATE_RESPONSE", session));
+
+    PlayerStatusUpdate status;
+    status.user_id = 4242;
+    status.status = STATUS_AVAILABLE;
+    strncpy(status.display_name, "Captain Nemo", sizeof(status.display_name) - 1);
+    cases.push_back(message("PLAYER_STATUS_UPDATE", status));
+
+    ChallengeReceived challenge;
+    challenge.challenge_id = 17;
+    challenge.challenger_id = 4242;
+    strncpy(challenge.challenger_name, "Captain Nemo", sizeof(challenge.challenger_name) - 1);
+    challenge.expires_at = 1700000000;
+    cases.push_back(message("CHALLENGE_RECEIVED", challenge));
+
+    MatchStartMessage start;
+    start.match_id = 99;
+    start.opponent_id = 4242;
+    strncpy(start.opponent_name, "Captain Nemo", sizeof(start.opponent_name) - 1);
+    cases.push_back(message("MATCH_START", start));
+
+    ShipPlacementAck placement;
+    placement.match_id = 99;
+    placement.valid = true;
+    cases.push_back(message("SHIP_PLACEMENT (ack)", placement));
+
+    MoveResultMessage move;
+    move.match_id = 99;
+    move.shooter_id = 4242;
+    move.target.row = 3;
+    move.target.col = 7;
+    move.result = SHOT_HIT;
+    cases.push_back(message("MOVE_RESULT", move));
+
+    TurnUpdateMessage turn;
+    turn.match_id = 99;
+    turn.current_player_id = 4242;
+    turn.turn_number = 12;
+    cases.push_back(message("TURN_UPDATE", turn));
+
+    MatchEndMessage end;
+    end.match_id = 99;
+    end.result = RESULT_WIN;
+    end.winner_id = 4242;
+    end.elo_change = 16;
+    end.new_elo = 1016;
+    end.total_moves = 57;
+    end.duration = 840;
+    strncpy(end.reason_text, "All ships sunk", sizeof(end.reason_text) - 1);
+    cases.push_back(message("MATCH_END", end));
+
+    ChatMessage chat;
+    chat.match_id = 99;
+    strncpy(chat.message, "Good game! That last shot was lucky.", sizeof(chat.message) - 1);
+    cases.push_back(message("CHAT_MESSAGE", chat));
+
+    cases.push_back(playerPage("PLAYER_LIST (50 players)", 50));
+    cases.push_back(playerPage("PLAYER_LIST (full page)", 1000));
+    cases.push_back(lobbyBatch(20));
+    return cases;
+}
+
+static double microsPer(Clock::time_point start, int rounds) {
+    return chrono::duration<double, micro>(Clock::now() - start).count() / rounds;
+}
+
+static void runCase(const Case& test, int rounds) {
+    const string& raw = test.payload;
+    cout << "[BENCH] " << left << setw(27) << test.name << right << setw(6) << raw.size();
+
+    string packed;
+    if (!PayloadCompression::compress(raw.data(), raw.size(), packed)) {
+        cout << setw(8) << "-" << endl;
+        return;
+    }
+
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; i++) {
+        PayloadCompression::compress(raw.data(), raw.size(), packed);
+    }
+    double compress_us = microsPer(start, rounds);
+
+    string restored;
+    start = Clock::now();
+    for (int i = 0; i < rounds; i++) {
+        PayloadCompression::decompress(packed.data(), packed.size(), MAX_MESSAGE_SIZE, restored);
+    }
+    double decompress_us = microsPer(start, rounds);
+    if (restored != raw) {
+        cout << "  round trip FAILED" << endl;
+        exit(1);
+    }
+
+    double saved = static_cast<double>(raw.size() - packed.size());
+    cout << setw(8) << packed.size()
+         << fixed << setprecision(0) << setw(6) << (100.0 * saved / raw.size()) << "%"
+         << setprecision(2) << setw(10) << compress_us << setw(10) << decompress_us
+         << setprecision(1) << setw(12) << saved / (compress_us + decompress_us)
+         << (raw.size() < COMPRESSION_THRESHOLD ? "  (below threshold)" : "") << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = 20000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "--rounds") rounds = atoi(argv[i + 1]);
+    }
+
+    if (!PayloadCompression::supported()) {
+        cout << "[BENCH] Built without zlib; nothing to measure" << endl;
+        return 0;
+    }
+
+    cout << "[BENCH] " << rounds << " rounds per message, threshold " << COMPRESSION_THRESHOLD << " bytes" << endl;
+    cout << "[BENCH] " << left << setw(27) << "message" << right << setw(6) << "raw"
+         << setw(8) << "packed" << setw(7) << "saved" << setw(10) << "comp us"
+         << setw(10) << "decomp us" << setw(12) << "bytes/us" << endl;
+    for (const Case& test : realMessages()) {
+        runCase(test, rounds);
+    }
+    return 0;
+}
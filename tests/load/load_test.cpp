@@ -0,0 +1,205 @@
+/**
+ * Load Test: Connection accept rate and message throughput
+ *
+ * Opens many TCP connections to a running server, then pipelines PING
+ * frames on every connection and counts the PONG replies. Used to compare
+ * server configurations (e.g. IO_REACTORS=1 vs 2 vs 4, IO_BACKEND=epoll vs io_uring).
+ * With --unix the same load goes over the server's Unix socket instead, which
+ * separates protocol cost from the TCP stack.
+ *
+ * Run with:
+ *   Terminal 1: IO_REACTORS=2 ./bin/battleship_server 9998
+ *   Terminal 2: ./bin/load_test --port 9998 --connections 1000 --threads 4
+ *           or: ./bin/load_test --unix data/battleship.sock --connections 1000
+ *
+ * Or use ./run_load_test.sh to sweep reactor counts and backends automatically.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "protocol.h"
+#include "config.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct LoadOptions {
+    string host = SERVER_HOST;
+    int port = SERVER_PORT;
+    string unix_path;     // Set: connect to this Unix socket instead of host:port
+    int connections = 500;
+    int threads = 4;
+    int rounds = 200;     // Pipelined batches per connection
+    int pipeline = 8;     // PINGs in flight per connection per batch
+};
+
+static int connectOnce(const LoadOptions& opts) {
+    bool local = !opts.unix_path.empty();
+    int fd = socket(local ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    struct timeval tv;
+    tv.tv_sec = 10;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    int result;
+    if (local) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, opts.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        result = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    } else {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(opts.port);
+        inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr);
+        result = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    }
+
+    if (result < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool readFully(int fd, char* buffer, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = recv(fd, buffer + total, size - total, 0);
+        if (n <= 0) return false;
+        total += n;
+    }
+    return true;
+}
+
+static void parseArgs(int argc, char* argv[], LoadOptions& opts) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string key = argv[i];
+        const char* value = argv[i + 1];
+        if (key == "--host") opts.host = value;
+        else if (key == "--port") opts.port = atoi(value);
+        else if (key == "--unix") opts.unix_path = value;
+        else if (key == "--connections") opts.connections = atoi(value);
+        else if (key == "--threads") opts.threads = atoi(value);
+        else if (key == "--rounds") opts.rounds = atoi(value);
+        else if (key == "--pipeline") opts.pipeline = atoi(value);
+        else cerr << "Unknown option: " << key << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions opts;
+    parseArgs(argc, argv, opts);
+
+    // Many sockets per process: raise the fd limit as far as allowed
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    if (!opts.unix_path.empty()) {
+        cout << "[LOAD] Target: Unix socket " << opts.unix_path << endl;
+    }
+    cout << "[LOAD] " << opts.connections << " connections, " << opts.threads << " threads, "
+         << opts.rounds << " rounds x " << opts.pipeline << " pipelined PINGs" << endl;
+
+    vector<vector<int>> sockets(opts.threads);
+    atomic<int> failed_connects(0);
+
+    // ===== Phase 1: connection storm =====
+    auto connect_start = Clock::now();
+    {
+        vector<thread> workers;
+        for (int t = 0; t < opts.threads; t++) {
+            workers.emplace_back([&, t]() {
+                for (int i = t; i < opts.connections; i += opts.threads) {
+                    int fd = connectOnce(opts);
+                    if (fd < 0) {
+                        failed_connects++;
+                    } else {
+                        sockets[t].push_back(fd);
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    double connect_secs = chrono::duration<double>(Clock::now() - connect_start).count();
+    int connected = opts.connections - failed_connects;
+
+    // ===== Phase 2: pipelined PING/PONG =====
+    MessageHeader ping;
+    memset(&ping, 0, sizeof(ping));
+    ping.type = PING;
+    ping.length = 0;
+
+    string batch;
+    for (int i = 0; i < opts.pipeline; i++) {
+        batch.append(reinterpret_cast<const char*>(&ping), sizeof(ping));
+    }
+
+    atomic<uint64_t> messages(0);
+    atomic<int> errors(0);
+
+    auto message_start = Clock::now();
+    {
+        vector<thread> workers;
+        for (int t = 0; t < opts.threads; t++) {
+            workers.emplace_back([&, t]() {
+                vector<char> replies(sizeof(MessageHeader) * opts.pipeline);
+                for (int round = 0; round < opts.rounds; round++) {
+                    for (int fd : sockets[t]) {
+                        if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != (ssize_t)batch.size()) {
+                            errors++;
+                        }
+                    }
+                    for (int fd : sockets[t]) {
+                        if (readFully(fd, replies.data(), replies.size())) {
+                            messages += opts.pipeline;
+                        } else {
+                            errors++;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    double message_secs = chrono::duration<double>(Clock::now() - message_start).count();
+
+    for (auto& list : sockets) {
+        for (int fd : list) close(fd);
+    }
+
+    cout << fixed << setprecision(0);
+    cout << "[LOAD] Connected:   " << connected << "/" << opts.connections
+         << " in " << setprecision(3) << connect_secs << "s  ("
+         << setprecision(0) << (connected / connect_secs) << " accepts/s)" << endl;
+    cout << "[LOAD] Round trips: " << messages << " in " << setprecision(3) << message_secs << "s  ("
+         << setprecision(0) << (messages / message_secs) << " msgs/s)" << endl;
+    if (errors > 0) {
+        cout << "[LOAD] Errors:      " << errors << endl;
+    }
+
+    return (failed_connects == 0 && errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/**
+ * Send Benchmark: syscalls per move
+ *
+ * Replays the server side of a move (MOVE_RESULT + TURN_UPDATE to both
+ * players) over socket pairs and reports send syscalls per move and moves
+ * per second, with and without a ClientConnection::SendBatch around each
+ * move. Before header and payload were gathered into one call, every
+ * message cost two send() calls: 8 per move.
+ *
+ * Run with:
+ *   ./bin/send_bench [--moves 100000]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "protocol.h"
+#include "messages/gameplay_messages.h"
+#include "client_connection.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct Player {
+    shared_ptr<ClientConnection> connection;
+    int peer_fd;
+};
+
+static Player makePlayer() {
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        perror("socketpair");
+        exit(1);
+    }
+    Player player;
+    player.connection = make_shared<ClientConnection>(sockets[0]);
+    player.peer_fd = sockets[1];
+    return player;
+}
+
+// Reads and discards everything the server side writes
+static void drain(int fd, atomic<bool>& done) {
+    char buffer[65536];
+    while (!done) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+    }
+}
+
+static void sendMove(Player& shooter, Player& target, uint32_t turn) {
+    MoveResultMessage result;
+    result.match_id = 1;
+    result.shooter_id = 1;
+    result.result = SHOT_MISS;
+
+    MessageHeader result_header;
+    memset(&result_header, 0, sizeof(result_header));
+    result_header.type = MOVE_RESULT;
+    result_header.length = sizeof(result);
+    string result_payload(reinterpret_cast<const char*>(&result), sizeof(result));
+
+    TurnUpdateMessage update;
+    update.match_id = 1;
+    update.current_player_id = 2;
+    update.turn_number = turn;
+
+    MessageHeader update_header;
+    memset(&update_header, 0, sizeof(update_header));
+    update_header.type = TURN_UPDATE;
+    update_header.length = sizeof(update);
+    string update_payload(reinterpret_cast<const char*>(&update), sizeof(update));
+
+    shooter.connection->sendMessage(result_header, result_payload);
+    target.connection->sendMessage(result_header, result_payload);
+    shooter.connection->sendMessage(update_header, update_payload);
+    target.connection->sendMessage(update_header, update_payload);
+}
+
+static void runCase(const char* name, bool batched, int moves) {
+    Player p1 = makePlayer();
+    Player p2 = makePlayer();
+
+    atomic<bool> done(false);
+    thread reader1(drain, p1.peer_fd, ref(done));
+    thread reader2(drain, p2.peer_fd, ref(done));
+
+    auto start = Clock::now();
+    for (int i = 0; i < moves; i++) {
+        if (batched) {
+            ClientConnection::SendBatch batch;
+            sendMove(p1, p2, i);
+        } else {
+            sendMove(p1, p2, i);
+        }
+    }
+    double secs = chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t calls = p1.connection->getSendCalls() + p2.connection->getSendCalls();
+
+    done = true;
+    shutdown(p1.peer_fd, SHUT_RDWR);
+    shutdown(p2.peer_fd, SHUT_RDWR);
+    reader1.join();
+    reader2.join();
+    close(p1.peer_fd);
+    close(p2.peer_fd);
+
+    cout << "[BENCH] " << left << setw(10) << name << right
+         << fixed << setprecision(2) << setw(6) << (double)calls / moves << " syscalls/move  "
+         << setprecision(0) << setw(9) << (moves / secs) << " moves/s" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int moves = 100000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "--moves") moves = atoi(argv[i + 1]);
+    }
+
+    cout << "[BENCH] " << moves << " moves (MOVE_RESULT + TURN_UPDATE to both players)" << endl;
+    cout << "[BENCH] separate header/payload send(): 8.00 syscalls/move" << endl;
+    runCase("writev", false, moves);
+    runCase("batched", true, moves);
+    return 0;
+}
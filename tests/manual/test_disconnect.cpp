@@ -98,7 +98,7 @@ void test_client_1() {
     // Request player list
     cout << "[Client 1] Requesting player list..." << endl;
     bool list_done = false;
-    client.requestPlayerList([&](bool success, const vector<PlayerInfo_Message>& players) {
+    client.requestPlayerList([&](bool success, const vector<PlayerInfo_Message>& players, uint32_t) {
         if (success) {
             cout << "[Client 1] ✅ Player list (" << players.size() << " players):" << endl;
             for (const auto& p : players) {
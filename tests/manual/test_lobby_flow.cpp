@@ -100,7 +100,7 @@ void test_client(int client_num, const string& username) {
     cout << "[Client " << client_num << "] Requesting player list..." << endl;
     bool player_list_done = false;
     uint32_t other_user_id = 0;
-    client.requestPlayerList([&](bool success, const vector<PlayerInfo_Message>& players) {
+    client.requestPlayerList([&](bool success, const vector<PlayerInfo_Message>& players, uint32_t) {
         if (success) {
             cout << "[Client " << client_num << "] ✅ Player list received (" << players.size() << " players):" << endl;
             for (const auto& player : players) {
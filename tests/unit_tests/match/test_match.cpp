@@ -305,6 +305,49 @@ TEST_F(MatchStateTest, CompleteGameFlow) {
     EXPECT_EQ(match.move_history.size(), total_moves);
 }
 
+// ============== SNAPSHOT TESTS ==============
+
+TEST_F(MatchStateTest, Serialize_RoundTripMidGame) {
+    setupShips();
+    match.match_id = "42";
+    match.current_turn_player_id = match.player1_id;
+    match.startMatch();
+    match.processMove(match.player1_id, {5, 5});  // Hit
+    match.processMove(match.player1_id, {9, 9});  // Miss, turn passes
+
+    MatchState restored;
+    ASSERT_TRUE(restored.deserialize(match.serialize()));
+
+    EXPECT_EQ(restored.match_id, "42");
+    EXPECT_EQ(restored.player1_name, "Player1");
+    EXPECT_EQ(restored.current_turn_player_id, match.player2_id);
+    EXPECT_EQ(restored.turn_number, match.turn_number);
+    EXPECT_EQ(restored.turn_start_time, match.turn_start_time);
+    EXPECT_TRUE(restored.is_active);
+    ASSERT_EQ(restored.move_history.size(), 2u);
+    EXPECT_EQ(restored.move_history[0].result, SHOT_HIT);
+    EXPECT_EQ(restored.player2_board.getCell(5, 5), CELL_HIT);
+    EXPECT_EQ(restored.player2_board.getCell(9, 9), CELL_MISS);
+    EXPECT_EQ(restored.player1_board.getCell(0, 0), CELL_SHIP);
+
+    // The restored match plays on from the same turn
+    int remaining = restored.player1_board.getShipsRemaining();
+    EXPECT_EQ(restored.processMove(match.player2_id, {0, 0}), SHOT_HIT);
+    EXPECT_EQ(restored.processMove(match.player2_id, {0, 1}), SHOT_SUNK);
+    EXPECT_EQ(restored.player1_board.getShipsRemaining(), remaining - 1);
+}
+
+TEST_F(MatchStateTest, Deserialize_RejectsTruncatedData) {
+    setupShips();
+    std::string data = match.serialize();
+
+    MatchState restored;
+    restored.match_id = "untouched";
+    EXPECT_FALSE(restored.deserialize(data.substr(0, data.size() - 1)));
+    EXPECT_FALSE(restored.deserialize(""));
+    EXPECT_EQ(restored.match_id, "untouched");
+}
+
 // Main function
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
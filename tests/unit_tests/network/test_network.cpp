@@ -1,12 +1,16 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstring>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include "protocol.h"
 #include "client_connection.h"
+#include "config.h"
 
 // Helper: Create a simple client socket
 int createClientSocket(int port) {
@@ -59,6 +63,16 @@ TEST(ProtocolTest, MessageTypeToString) {
     EXPECT_FALSE(login_str.empty());
 }
 
+TEST(ProtocolTest, MessagePriorityClasses) {
+    EXPECT_EQ(getMessagePriority(MOVE_RESULT), PRIORITY_GAMEPLAY);
+    EXPECT_EQ(getMessagePriority(TURN_UPDATE), PRIORITY_GAMEPLAY);
+    EXPECT_EQ(getMessagePriority(MATCH_START), PRIORITY_GAMEPLAY);
+    EXPECT_EQ(getMessagePriority(CHALLENGE_RECEIVED), PRIORITY_MATCHMAKING);
+    EXPECT_EQ(getMessagePriority(AUTH_RESPONSE), PRIORITY_MATCHMAKING);
+    EXPECT_EQ(getMessagePriority(PLAYER_STATUS_UPDATE), PRIORITY_PRESENCE);
+    EXPECT_EQ(getMessagePriority(CHAT_MESSAGE), PRIORITY_PRESENCE);
+}
+
 // ============== CLIENT CONNECTION TESTS ==============
 
 class ClientConnectionTest : public ::testing::Test {
@@ -214,6 +228,425 @@ TEST_F(ClientConnectionTest, Disconnect) {
     EXPECT_FALSE(sent);
 }
 
+TEST_F(ClientConnectionTest, ReadAvailable_FramesPartialAndPipelinedMessages) {
+    ASSERT_NE(connection, nullptr);
+    ASSERT_TRUE(connection->setNonBlocking());
+
+    MessageHeader first;
+    memset(&first, 0, sizeof(first));
+    first.type = MOVE;
+    first.length = 3;
+
+    MessageHeader second;
+    memset(&second, 0, sizeof(second));
+    second.type = PING;
+    second.length = 0;
+
+    std::string wire(reinterpret_cast<const char*>(&first), sizeof(first));
+    wire += "abc";
+    wire.append(reinterpret_cast<const char*>(&second), sizeof(second));
+
+    MessageHeader header;
+    PayloadView payload;
+
+    // Only part of the first header: nothing to frame yet
+    ASSERT_EQ(write(test_fd, wire.data(), 10), 10);
+    EXPECT_TRUE(connection->readAvailable());
+    EXPECT_FALSE(connection->nextMessage(header, payload));
+
+    // Rest of both messages arrives in one burst
+    ssize_t rest = wire.size() - 10;
+    ASSERT_EQ(write(test_fd, wire.data() + 10, rest), rest);
+    EXPECT_TRUE(connection->readAvailable());
+
+    ASSERT_TRUE(connection->nextMessage(header, payload));
+    EXPECT_EQ(header.type, MOVE);
+    EXPECT_EQ(payload.str(), "abc");
+
+    ASSERT_TRUE(connection->nextMessage(header, payload));
+    EXPECT_EQ(header.type, PING);
+    EXPECT_TRUE(payload.empty());
+
+    EXPECT_FALSE(connection->nextMessage(header, payload));
+    EXPECT_EQ(connection->getBytesReceived(), wire.size());
+}
+
+TEST_F(ClientConnectionTest, NextMessage_ViewSurvivesLaterReads) {
+    ASSERT_NE(connection, nullptr);
+    ASSERT_TRUE(connection->setNonBlocking());
+
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = CHAT_MESSAGE;
+    header.length = 1000;
+
+    // Enough frames to wrap the read buffer several times over
+    const int FRAMES = 40;
+    std::vector<PayloadView> views;
+    for (int i = 0; i < FRAMES; i++) {
+        std::string frame(reinterpret_cast<const char*>(&header), sizeof(header));
+        frame.append(1000, static_cast<char>('a' + i % 26));
+        ASSERT_EQ(write(test_fd, frame.data(), frame.size()), static_cast<ssize_t>(frame.size()));
+
+        ASSERT_TRUE(connection->readAvailable());
+        MessageHeader recv_header;
+        PayloadView payload;
+        while (connection->nextMessage(recv_header, payload)) {
+            views.push_back(payload);  // Held, as a queued worker task would
+        }
+    }
+
+    ASSERT_EQ(views.size(), static_cast<size_t>(FRAMES));
+    for (int i = 0; i < FRAMES; i++) {
+        EXPECT_EQ(views[i].str(), std::string(1000, static_cast<char>('a' + i % 26))) << "frame " << i;
+    }
+}
+
+TEST_F(ClientConnectionTest, ReadAvailable_PeerClosed) {
+    ASSERT_NE(connection, nullptr);
+    ASSERT_TRUE(connection->setNonBlocking());
+
+    close(test_fd);
+    test_fd = -1;
+
+    EXPECT_FALSE(connection->readAvailable());
+    EXPECT_FALSE(connection->isConnected());
+}
+
+TEST_F(ClientConnectionTest, SendMessage_HeaderAndPayloadInOneCall) {
+    ASSERT_NE(connection, nullptr);
+
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = MOVE_RESULT;
+    header.length = 5;
+
+    EXPECT_TRUE(connection->sendMessage(header, "hello"));
+    EXPECT_EQ(connection->getSendCalls(), 1u);
+    EXPECT_EQ(connection->getBytesSent(), sizeof(MessageHeader) + 5);
+}
+
+TEST(SendBatchTest, CoalescesFramesPerConnection) {
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    auto connection = std::make_shared<ClientConnection>(sockets[0]);
+
+    MessageHeader first;
+    memset(&first, 0, sizeof(first));
+    first.type = MOVE_RESULT;
+    first.length = 3;
+
+    MessageHeader second;
+    memset(&second, 0, sizeof(second));
+    second.type = TURN_UPDATE;
+    second.length = 0;
+
+    {
+        ClientConnection::SendBatch batch;
+        EXPECT_TRUE(connection->sendMessage(first, "abc"));
+        {
+            ClientConnection::SendBatch nested;  // Joins the outer batch
+            EXPECT_TRUE(connection->sendMessage(second, ""));
+        }
+        EXPECT_EQ(connection->getSendCalls(), 0u);
+    }
+    EXPECT_EQ(connection->getSendCalls(), 1u);
+
+    // Both frames arrive, in order
+    std::string expected(reinterpret_cast<const char*>(&first), sizeof(first));
+    expected += "abc";
+    expected.append(reinterpret_cast<const char*>(&second), sizeof(second));
+
+    std::vector<char> received(expected.size());
+    ASSERT_EQ(recv(sockets[1], received.data(), received.size(), MSG_WAITALL),
+              static_cast<ssize_t>(expected.size()));
+    EXPECT_EQ(std::string(received.begin(), received.end()), expected);
+
+    close(sockets[1]);
+}
+
+TEST(SendBatchTest, DirectSendFlushesQueuedFramesFirst) {
+    int sockets[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    auto connection = std::make_shared<ClientConnection>(sockets[0]);
+
+    MessageHeader queued;
+    memset(&queued, 0, sizeof(queued));
+    queued.type = MOVE_RESULT;
+
+    MessageHeader direct;
+    memset(&direct, 0, sizeof(direct));
+    direct.type = PONG;
+
+    ClientConnection::SendBatch* batch = new ClientConnection::SendBatch();
+    EXPECT_TRUE(connection->sendMessage(queued, ""));
+
+    // Another thread (no batch) sends directly; the queued frame must go first
+    std::thread other([&]() { EXPECT_TRUE(connection->sendMessage(direct, "")); });
+    other.join();
+    delete batch;
+
+    MessageHeader received[2];
+    ASSERT_EQ(recv(sockets[1], received, sizeof(received), MSG_WAITALL),
+              static_cast<ssize_t>(sizeof(received)));
+    EXPECT_EQ(received[0].type, MOVE_RESULT);
+    EXPECT_EQ(received[1].type, PONG);
+    EXPECT_EQ(connection->getSendCalls(), 1u);
+
+    close(sockets[1]);
+}
+
+TEST(SendBatchTest, SharedMessageFansOutWithoutCopies) {
+    const int RECIPIENTS = 3;
+    int sockets[RECIPIENTS][2];
+    std::vector<std::shared_ptr<ClientConnection>> connections;
+    for (int i = 0; i < RECIPIENTS; i++) {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets[i]), 0);
+        connections.push_back(std::make_shared<ClientConnection>(sockets[i][0]));
+    }
+
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = PLAYER_STATUS_UPDATE;
+    header.length = 4;
+    SharedMessage message = MessageBuffer::create(header, "ping", 4);
+    EXPECT_EQ(message->type(), PLAYER_STATUS_UPDATE);
+    EXPECT_EQ(message->size(), sizeof(MessageHeader) + 4);
+
+    {
+        ClientConnection::SendBatch batch;
+        for (auto& connection : connections) {
+            EXPECT_TRUE(connection->sendMessage(message));
+        }
+        // Every queue references the one buffer
+        EXPECT_EQ(message.use_count(), 1 + RECIPIENTS);
+    }
+    EXPECT_EQ(message.use_count(), 1);  // Written and released
+
+    std::string expected(message->data(), message->size());
+    for (int i = 0; i < RECIPIENTS; i++) {
+        std::vector<char> received(expected.size());
+        ASSERT_EQ(recv(sockets[i][1], received.data(), received.size(), MSG_WAITALL),
+                  static_cast<ssize_t>(expected.size()));
+        EXPECT_EQ(std::string(received.begin(), received.end()), expected);
+        close(sockets[i][1]);
+    }
+}
+
+// ============== OUTBOUND QUEUE TESTS ==============
+
+class OutboundQueueTest : public ClientConnectionTest {
+protected:
+    void SetUp() override {
+        ClientConnectionTest::SetUp();
+        ASSERT_NE(connection, nullptr);
+        ASSERT_TRUE(connection->setNonBlocking());
+        memset(&frame_header, 0, sizeof(frame_header));
+        frame_header.type = MOVE_RESULT;
+        frame_header.length = 4000;
+        payload.assign(4000, 'x');
+    }
+
+    void TearDown() override {
+        ClientConnection::setOutboundLimit(OUTBOUND_QUEUE_LIMIT, ClientConnection::OVERFLOW_DROP_LOBBY);
+        ClientConnectionTest::TearDown();
+    }
+
+    // Send until the socket buffer is full and frames start queuing
+    size_t fillSocket() {
+        size_t frames = 0;
+        while (connection->getQueuedBytes() == 0 && frames < 10000) {
+            EXPECT_TRUE(connection->sendMessage(frame_header, payload));
+            frames++;
+        }
+        return frames;
+    }
+
+    // Reads until the queue has drained and the socket is empty; returns frame types in arrival order
+    std::vector<std::pair<uint8_t, std::string>> drainFrames() {
+        std::string stream;
+        std::vector<char> buffer(65536);
+        while (true) {
+            ssize_t n = recv(test_fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (n > 0) {
+                stream.append(buffer.data(), n);
+            } else if (connection->getQueuedBytes() == 0) {
+                break;
+            }
+            connection->flushOutbound();
+        }
+
+        std::vector<std::pair<uint8_t, std::string>> frames;
+        size_t pos = 0;
+        while (pos + sizeof(MessageHeader) <= stream.size()) {
+            MessageHeader header;
+            memcpy(&header, stream.data() + pos, sizeof(header));
+            pos += sizeof(header);
+            frames.emplace_back(header.type, stream.substr(pos, header.length));
+            pos += header.length;
+        }
+        EXPECT_EQ(pos, stream.size());
+        return frames;
+    }
+
+    void sendPresence(uint32_t user_id, uint8_t status) {
+        MessageHeader header;
+        memset(&header, 0, sizeof(header));
+        header.type = PLAYER_STATUS_UPDATE;
+        header.length = 8;
+        std::string body(8, '\0');
+        memcpy(&body[0], &user_id, sizeof(user_id));
+        body[4] = static_cast<char>(status);
+        EXPECT_TRUE(connection->sendMessage(header, body));
+    }
+
+    MessageHeader frame_header;
+    std::string payload;
+};
+
+TEST_F(OutboundQueueTest, QueuesWhenSocketFullThenDrains) {
+    ClientConnection::setOutboundLimit(8 * 1024 * 1024, ClientConnection::OVERFLOW_DROP_LOBBY);
+
+    size_t frames = fillSocket();
+    for (int i = 0; i < 20; i++) {
+        EXPECT_TRUE(connection->sendMessage(frame_header, payload));  // Returns at once: queued
+        frames++;
+    }
+    EXPECT_GT(connection->getQueuedBytes(), 0u);
+    EXPECT_GT(ClientConnection::getOutboundStats().queued_bytes, 0u);
+
+    // Reader catches up; the I/O layer drains the rest
+    size_t expected = frames * (sizeof(MessageHeader) + payload.size());
+    size_t received = 0;
+    std::vector<char> buffer(65536);
+    while (received < expected) {
+        ssize_t n = recv(test_fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (n > 0) {
+            received += n;
+        }
+        connection->flushOutbound();
+    }
+
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(connection->getQueuedBytes(), 0u);
+    EXPECT_TRUE(connection->isConnected());
+}
+
+TEST_F(OutboundQueueTest, OverflowDropsLobbyUpdatesThenEvicts) {
+    const size_t LIMIT = 64 * 1024;
+    ClientConnection::setOutboundLimit(LIMIT, ClientConnection::OVERFLOW_DROP_LOBBY);
+    ClientConnection::OutboundStats before = ClientConnection::getOutboundStats();
+
+    fillSocket();
+
+    // Lobby updates queue until the limit, then new ones are dropped
+    MessageHeader lobby;
+    memset(&lobby, 0, sizeof(lobby));
+    lobby.type = PLAYER_STATUS_UPDATE;
+    lobby.length = 1000;
+    std::string lobby_payload(1000, 'p');
+    for (int i = 0; i < 100; i++) {
+        memcpy(&lobby_payload[0], &i, sizeof(i));  // Distinct users, so nothing coalesces
+        EXPECT_TRUE(connection->sendMessage(lobby, lobby_payload));
+    }
+    EXPECT_LE(connection->getQueuedBytes(), LIMIT);
+    uint64_t dropped = connection->getFramesDropped();
+    EXPECT_GT(dropped, 0u);
+    EXPECT_TRUE(connection->isConnected());
+
+    // Gameplay frames push queued lobby updates out
+    EXPECT_TRUE(connection->sendMessage(frame_header, payload));
+    EXPECT_GT(connection->getFramesDropped(), dropped);
+    EXPECT_TRUE(connection->isConnected());
+
+    // Once only gameplay is left, the slow client is evicted
+    bool sent = true;
+    for (int i = 0; i < 100 && sent; i++) {
+        sent = connection->sendMessage(frame_header, payload);
+    }
+    EXPECT_FALSE(sent);
+    EXPECT_FALSE(connection->isConnected());
+
+    ClientConnection::OutboundStats after = ClientConnection::getOutboundStats();
+    EXPECT_EQ(after.evictions, before.evictions + 1);
+    EXPECT_EQ(after.frames_dropped, before.frames_dropped + connection->getFramesDropped());
+}
+
+TEST_F(OutboundQueueTest, GameplayOvertakesQueuedPresence) {
+    ClientConnection::setOutboundLimit(8 * 1024 * 1024, ClientConnection::OVERFLOW_DROP_LOBBY);
+
+    fillSocket();
+    for (uint32_t user = 1; user <= 20; user++) {
+        sendPresence(user, STATUS_ONLINE);
+    }
+
+    MessageHeader turn;
+    memset(&turn, 0, sizeof(turn));
+    turn.type = TURN_UPDATE;
+    EXPECT_TRUE(connection->sendMessage(turn, ""));
+
+    auto frames = drainFrames();
+    size_t turn_at = frames.size();
+    size_t first_presence = frames.size();
+    size_t presence = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].first == TURN_UPDATE) turn_at = i;
+        if (frames[i].first == PLAYER_STATUS_UPDATE) {
+            first_presence = std::min(first_presence, i);
+            presence++;
+        }
+    }
+    EXPECT_EQ(presence, 20u);
+    ASSERT_LT(turn_at, frames.size());
+    EXPECT_LT(turn_at, first_presence);  // Sent last, delivered ahead of the lobby backlog
+}
+
+TEST_F(OutboundQueueTest, PresenceUpdatesCoalescePerUser) {
+    ClientConnection::setOutboundLimit(8 * 1024 * 1024, ClientConnection::OVERFLOW_DROP_LOBBY);
+    uint64_t before = ClientConnection::getOutboundStats().frames_coalesced;
+
+    fillSocket();
+    sendPresence(7, STATUS_ONLINE);
+    sendPresence(8, STATUS_ONLINE);
+    sendPresence(7, STATUS_AVAILABLE);
+    sendPresence(7, STATUS_IN_GAME);
+
+    EXPECT_EQ(connection->getFramesCoalesced(), 2u);
+    EXPECT_EQ(ClientConnection::getOutboundStats().frames_coalesced, before + 2);
+
+    // One frame per user, in first-queued order, carrying the latest status
+    std::vector<std::string> presence;
+    for (auto& frame : drainFrames()) {
+        if (frame.first == PLAYER_STATUS_UPDATE) presence.push_back(frame.second);
+    }
+    ASSERT_EQ(presence.size(), 2u);
+    uint32_t first_user;
+    memcpy(&first_user, presence[0].data(), sizeof(first_user));
+    EXPECT_EQ(first_user, 7u);
+    EXPECT_EQ(presence[0][4], static_cast<char>(STATUS_IN_GAME));
+}
+
+TEST_F(OutboundQueueTest, DisconnectPolicyEvictsOnFirstOverflow) {
+    ClientConnection::setOutboundLimit(16 * 1024, ClientConnection::OVERFLOW_DISCONNECT);
+
+    fillSocket();
+
+    MessageHeader lobby;
+    memset(&lobby, 0, sizeof(lobby));
+    lobby.type = PLAYER_STATUS_UPDATE;
+    lobby.length = 1000;
+    std::string lobby_payload(1000, 'p');
+
+    bool sent = true;
+    for (int i = 0; i < 100 && sent; i++) {
+        memcpy(&lobby_payload[0], &i, sizeof(i));
+        sent = connection->sendMessage(lobby, lobby_payload);
+    }
+    EXPECT_FALSE(sent);
+    EXPECT_FALSE(connection->isConnected());
+    EXPECT_EQ(connection->getFramesDropped(), 0u);
+}
+
 // ============== INTEGRATION TESTS ==============
 // These tests require the server to be running
 
@@ -0,0 +1,133 @@
+/**
+ * Unit tests for the message schema
+ * Tests the generated payload rules, type to struct mapping and handler dispatch
+ */
+
+#include <gtest/gtest.h>
+#include "message_schema.h"
+#include "message_serialization.h"
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+using namespace MessageSerialization;
+
+// The tables are usable at compile time
+static_assert(MessageSchema::CLIENT_RULES[MOVE].size == sizeof(MoveMessage), "MOVE rule");
+static_assert(MessageSchema::SERVER_RULES[SHIP_PLACEMENT].size == sizeof(ShipPlacementAck), "SHIP_PLACEMENT rule");
+static_assert(std::is_same<MessageSchema::ClientPayload<SHIP_PLACEMENT>::type, ShipPlacementMessage>::value,
+              "client SHIP_PLACEMENT");
+static_assert(std::is_same<MessageSchema::ServerPayload<SHIP_PLACEMENT>::type, ShipPlacementAck>::value,
+              "server SHIP_PLACEMENT");
+
+template <typename T>
+static std::string bytesOf(const T& message) {
+    return std::string(reinterpret_cast<const char*>(&message), sizeof(message));
+}
+
+// ==================== Size Tests ====================
+
+TEST(MessageSchema, ExpectedSizesComeFromTheStructs) {
+    EXPECT_EQ(getExpectedPayloadSize(AUTH_LOGIN), sizeof(LoginRequest));
+    EXPECT_EQ(getExpectedPayloadSize(MOVE), sizeof(MoveMessage));
+    EXPECT_EQ(getExpectedPayloadSize(CHALLENGE_RESPONSE), sizeof(ChallengeResponse));
+    EXPECT_EQ(getExpectedPayloadSize(CHALLENGE_RESPONSE, FROM_SERVER), sizeof(ChallengeResult));
+    EXPECT_EQ(getExpectedPayloadSize(TURN_UPDATE, FROM_SERVER), sizeof(TurnUpdateMessage));
+    EXPECT_EQ(getExpectedPayloadSize(PING), 0u);
+    EXPECT_EQ(getExpectedPayloadSize(PLAYER_LIST, FROM_SERVER), 0u);
+}
+
+TEST(MessageSchema, FixedPayloadsMustMatchExactly) {
+    EXPECT_TRUE(validatePayloadSize(MOVE, sizeof(MoveMessage)));
+    EXPECT_FALSE(validatePayloadSize(MOVE, sizeof(MoveMessage) - 1));
+    EXPECT_FALSE(validatePayloadSize(MOVE, sizeof(MoveMessage) + 1));
+    EXPECT_FALSE(validatePayloadSize(MOVE, 0));
+
+    EXPECT_TRUE(validatePayloadSize(PING, 0));
+    EXPECT_FALSE(validatePayloadSize(PING, 1));
+
+    // Older clients ask for the player list with no payload
+    EXPECT_TRUE(validatePayloadSize(PLAYER_LIST_REQUEST, 0));
+    EXPECT_TRUE(validatePayloadSize(PLAYER_LIST_REQUEST, sizeof(PlayerListRequest)));
+    EXPECT_FALSE(validatePayloadSize(PLAYER_LIST_REQUEST, 1));
+
+    EXPECT_TRUE(validatePayloadSize(BATCH, MAX_MESSAGE_SIZE, FROM_SERVER));
+    EXPECT_FALSE(validatePayloadSize(BATCH, MAX_MESSAGE_SIZE + 1, FROM_SERVER));
+}
+
+TEST(MessageSchema, DirectionsAreSeparate) {
+    // Server-only and client-only types are not accepted the other way
+    EXPECT_FALSE(validatePayloadSize(MOVE_RESULT, sizeof(MoveResultMessage)));
+    EXPECT_TRUE(validatePayloadSize(MOVE_RESULT, sizeof(MoveResultMessage), FROM_SERVER));
+    EXPECT_FALSE(validatePayloadSize(MOVE, sizeof(MoveMessage), FROM_SERVER));
+    EXPECT_FALSE(validatePayloadSize(BATCH, 0));
+
+    // Unlisted types are never valid
+    EXPECT_FALSE(validatePayloadSize(CHAT_MESSAGE, sizeof(ChatMessage)));
+    EXPECT_FALSE(validatePayloadSize(static_cast<MessageType>(250), 0));
+}
+
+// ==================== Handler Tests ====================
+
+TEST(MessageSchema, EachClientMessageHasOneHandler) {
+    for (MessageType type : MessageSchema::CLIENT_TYPES) {
+        int handlers = MessageSchema::handlesAuth(type) + MessageSchema::handlesPlayer(type) +
+                       MessageSchema::handlesChallenge(type) + MessageSchema::handlesGameplay(type);
+        bool system = type == PING || type == PONG || type == CAPABILITIES;
+        EXPECT_EQ(handlers, system ? 0 : 1) << "type " << static_cast<int>(type);
+    }
+    EXPECT_FALSE(MessageSchema::handlesGameplay(MOVE_RESULT));
+}
+
+// Records which struct a dispatch produced
+struct Seen {
+    int moves = 0;
+    int resigns = 0;
+    MoveMessage move;
+
+    void operator()(const MoveMessage& message) { moves++; move = message; }
+    void operator()(const ResignMessage&) { resigns++; }
+    template <typename T> void operator()(const T&) {}
+};
+
+TEST(MessageSchema, DispatchDecodesTheSchemaStruct) {
+    MoveMessage move;
+    move.match_id = 77;
+    move.target.row = 4;
+    move.target.col = 9;
+    std::string payload = bytesOf(move);
+
+    Seen seen;
+    EXPECT_TRUE(MessageSchema::dispatchGameplay(MOVE, payload, [&seen](const auto& message) { seen(message); }));
+    EXPECT_EQ(seen.moves, 1);
+    EXPECT_EQ(seen.move.match_id, 77u);
+    EXPECT_EQ(seen.move.target.row, 4);
+    EXPECT_EQ(seen.move.target.col, 9);
+
+    ResignMessage resign;
+    EXPECT_TRUE(MessageSchema::dispatchGameplay(RESIGN, bytesOf(resign), [&seen](const auto& message) { seen(message); }));
+    EXPECT_EQ(seen.resigns, 1);
+}
+
+TEST(MessageSchema, DispatchRejectsWrongSizesAndOtherGroups) {
+    Seen seen;
+    auto record = [&seen](const auto& message) { seen(message); };
+    std::string payload = bytesOf(MoveMessage());
+
+    EXPECT_FALSE(MessageSchema::dispatchGameplay(MOVE, payload.substr(1), record));
+    EXPECT_FALSE(MessageSchema::dispatchGameplay(MOVE, payload + "x", record));
+    EXPECT_FALSE(MessageSchema::dispatchGameplay(AUTH_LOGIN, bytesOf(LoginRequest()), record));
+    EXPECT_EQ(seen.moves, 0);
+
+    // An optional payload decodes to the default struct when absent
+    bool called = false;
+    EXPECT_TRUE(MessageSchema::dispatchPlayer(PLAYER_LIST_REQUEST, std::string(), [&called](const PlayerListRequest& request) {
+        called = request.cursor == 0 && request.limit == 0;
+    }));
+    EXPECT_TRUE(called);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
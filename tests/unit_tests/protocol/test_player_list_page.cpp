@@ -0,0 +1,125 @@
+/**
+ * Unit tests for the variable-length PLAYER_LIST encoding
+ * Tests encode/decode of PlayerListPage and its size limits
+ */
+
+#include <gtest/gtest.h>
+#include "player_list.h"
+#include "message_serialization.h"
+#include <cstring>
+#include <string>
+
+using namespace MessageSerialization;
+
+static PlayerInfo_Message makePlayer(uint32_t user_id, const std::string& username,
+                                     const std::string& display_name) {
+    PlayerInfo_Message player;
+    player.user_id = user_id;
+    safeStrCopy(player.username, username, sizeof(player.username));
+    safeStrCopy(player.display_name, display_name, sizeof(player.display_name));
+    player.elo_rating = 1000 + user_id;
+    player.status = STATUS_AVAILABLE;
+    return player;
+}
+
+// ==================== Encoding Tests ====================
+
+TEST(PlayerListPage, EncodeDecodeRoundTrip) {
+    PlayerListPage original;
+    original.total = 250;
+    original.next_cursor = 12;
+    original.players.push_back(makePlayer(3, "alice", "Alice"));
+    original.players.push_back(makePlayer(12, "bob", "Bob the Builder"));
+    original.players[1].status = STATUS_IN_GAME;
+
+    std::string encoded = original.encode();
+
+    PlayerListPage decoded;
+    ASSERT_TRUE(decoded.decode(encoded));
+    EXPECT_EQ(decoded.total, 250u);
+    EXPECT_EQ(decoded.next_cursor, 12u);
+    ASSERT_EQ(decoded.players.size(), 2u);
+    EXPECT_EQ(decoded.players[0].user_id, 3u);
+    EXPECT_STREQ(decoded.players[0].username, "alice");
+    EXPECT_STREQ(decoded.players[0].display_name, "Alice");
+    EXPECT_EQ(decoded.players[0].elo_rating, 1003);
+    EXPECT_EQ(decoded.players[1].status, STATUS_IN_GAME);
+    EXPECT_STREQ(decoded.players[1].display_name, "Bob the Builder");
+}
+
+TEST(PlayerListPage, EmptyPage) {
+    PlayerListPage original;
+    std::string encoded = original.encode();
+    EXPECT_EQ(encoded.size(), PlayerListPage::HEADER_SIZE);
+
+    PlayerListPage decoded;
+    decoded.players.push_back(makePlayer(1, "stale", "Stale"));
+    ASSERT_TRUE(decoded.decode(encoded));
+    EXPECT_TRUE(decoded.players.empty());
+    EXPECT_EQ(decoded.next_cursor, 0u);
+}
+
+TEST(PlayerListPage, SizeFollowsNames) {
+    PlayerInfo_Message player = makePlayer(1, "ann", "Ann");
+    EXPECT_EQ(PlayerListPage::entrySize(player), PlayerListPage::MIN_ENTRY_SIZE + 6);
+
+    PlayerListPage page;
+    for (uint32_t i = 1; i <= 3; i++) {
+        page.players.push_back(player);
+    }
+    EXPECT_EQ(page.encode().size(), PlayerListPage::HEADER_SIZE + 3 * PlayerListPage::entrySize(player));
+    EXPECT_LT(page.encode().size(), 3 * sizeof(PlayerInfo_Message));
+}
+
+TEST(PlayerListPage, FullLengthNames) {
+    PlayerListPage original;
+    original.players.push_back(makePlayer(1, std::string(40, 'u'), std::string(80, 'd')));
+
+    PlayerListPage decoded;
+    ASSERT_TRUE(decoded.decode(original.encode()));
+    EXPECT_EQ(std::string(decoded.players[0].username), std::string(31, 'u'));
+    EXPECT_EQ(std::string(decoded.players[0].display_name), std::string(63, 'd'));
+}
+
+// ==================== Malformed Input Tests ====================
+
+TEST(PlayerListPage, RejectsTruncatedPage) {
+    PlayerListPage original;
+    original.players.push_back(makePlayer(1, "alice", "Alice"));
+    original.players.push_back(makePlayer(2, "bob", "Bob"));
+    std::string encoded = original.encode();
+
+    PlayerListPage decoded;
+    for (size_t size = 0; size < encoded.size(); size++) {
+        EXPECT_FALSE(decoded.decode(encoded.data(), size)) << "prefix of " << size;
+    }
+    EXPECT_FALSE(decoded.decode(encoded + "x"));
+}
+
+TEST(PlayerListPage, RejectsOverlongNames) {
+    PlayerListPage original;
+    original.players.push_back(makePlayer(1, "alice", "Alice"));
+    std::string encoded = original.encode();
+
+    // Username length byte follows user_id, elo_rating and status
+    std::string bad = encoded;
+    bad[PlayerListPage::HEADER_SIZE + 9] = 32;
+    bad.append(27, 'x');
+    PlayerListPage decoded;
+    EXPECT_FALSE(decoded.decode(bad));
+}
+
+TEST(PlayerListPage, RejectsImpossibleCount) {
+    PlayerListPage original;
+    std::string encoded = original.encode();
+    uint16_t count = 0xFFFF;
+    memcpy(&encoded[8], &count, sizeof(count));
+
+    PlayerListPage decoded;
+    EXPECT_FALSE(decoded.decode(encoded));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
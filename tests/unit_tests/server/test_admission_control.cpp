@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include "admission_control.h"
+
+static uint32_t ip(const char* text) {
+    return inet_addr(text);
+}
+
+// ============== LIMIT TESTS ==============
+
+TEST(AdmissionControlTest, EnforcesConnectionCap) {
+    AdmissionControl admission(3, 0, 1000);
+
+    EXPECT_EQ(admission.admit(ip("10.0.0.1")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("10.0.0.2")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("10.0.0.3")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("10.0.0.4")), AdmissionControl::REJECT_FULL);
+
+    // A released slot is available again
+    admission.release(ip("10.0.0.2"));
+    EXPECT_EQ(admission.admit(ip("10.0.0.4")), AdmissionControl::ADMIT);
+
+    AdmissionControl::Stats stats = admission.getStats();
+    EXPECT_EQ(stats.active, 3u);
+    EXPECT_EQ(stats.admitted, 4u);
+    EXPECT_EQ(stats.rejected_full, 1u);
+    EXPECT_EQ(stats.rejected_address, 0u);
+}
+
+TEST(AdmissionControlTest, EnforcesPerAddressLimit) {
+    AdmissionControl admission(0, 2, 1000);
+
+    EXPECT_EQ(admission.admit(ip("192.168.1.5")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("192.168.1.5")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("192.168.1.5")), AdmissionControl::REJECT_ADDRESS);
+
+    // Other addresses are unaffected
+    EXPECT_EQ(admission.admit(ip("192.168.1.6")), AdmissionControl::ADMIT);
+
+    admission.release(ip("192.168.1.5"));
+    EXPECT_EQ(admission.admit(ip("192.168.1.5")), AdmissionControl::ADMIT);
+
+    EXPECT_EQ(admission.getStats().rejected_address, 1u);
+    EXPECT_EQ(admission.getStats().active, 3u);
+}
+
+TEST(AdmissionControlTest, LocalPeersOnlyCountTowardTheCap) {
+    AdmissionControl admission(4, 1, 1000);
+
+    // Everything on the Unix socket shares one address; it is not one client
+    EXPECT_EQ(admission.admit(AdmissionControl::LOCAL_ADDRESS), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(AdmissionControl::LOCAL_ADDRESS), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(AdmissionControl::LOCAL_ADDRESS), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("10.0.0.1")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(AdmissionControl::LOCAL_ADDRESS), AdmissionControl::REJECT_FULL);
+
+    admission.release(AdmissionControl::LOCAL_ADDRESS);
+    EXPECT_EQ(admission.getStats().active, 3u);
+}
+
+TEST(AdmissionControlTest, ZeroMeansUnlimited) {
+    AdmissionControl admission(0, 0, 1000);
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQ(admission.admit(ip("127.0.0.1")), AdmissionControl::ADMIT);
+    }
+    EXPECT_EQ(admission.getStats().active, 10000u);
+}
+
+TEST(AdmissionControlTest, ReleaseOfUnknownAddressIsIgnored) {
+    AdmissionControl admission(1, 0, 1000);
+    admission.release(ip("10.9.9.9"));
+    EXPECT_EQ(admission.getStats().active, 0u);
+
+    EXPECT_EQ(admission.admit(ip("10.0.0.1")), AdmissionControl::ADMIT);
+    EXPECT_EQ(admission.admit(ip("10.0.0.1")), AdmissionControl::REJECT_FULL);
+}
+
+TEST(AdmissionControlTest, SlotsBalanceUnderConcurrency) {
+    AdmissionControl admission(50, 0, 1000);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&admission, t]() {
+            uint32_t address = htonl(0x0A000000 + t);
+            for (int i = 0; i < 5000; i++) {
+                if (admission.admit(address) == AdmissionControl::ADMIT) {
+                    admission.release(address);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    AdmissionControl::Stats stats = admission.getStats();
+    EXPECT_EQ(stats.active, 0u);
+    EXPECT_EQ(stats.admitted + stats.rejected_full, 20000u);
+}
+
+// ============== RETRY HINT TESTS ==============
+
+TEST(AdmissionControlTest, RetryHintsAreJitteredWithinRange) {
+    AdmissionControl admission(1, 0, 1000);
+
+    std::set<uint32_t> distinct;
+    for (int i = 0; i < 200; i++) {
+        uint32_t retry = admission.retryAfterMs();
+        ASSERT_GE(retry, 1000u);
+        ASSERT_LE(retry, 2000u);
+        distinct.insert(retry);
+    }
+
+    // Refused clients must not all come back at the same moment
+    EXPECT_GT(distinct.size(), 100u);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
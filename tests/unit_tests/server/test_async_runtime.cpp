@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "async_runtime.h"
+#include "worker_pool.h"
+#include "client_connection.h"
+
+// Connection on one end of a socket pair, with its own strand as the server gives it
+static std::shared_ptr<ClientConnection> makeConnection() {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        return nullptr;
+    }
+    close(pair[1]);
+    auto conn = std::make_shared<ClientConnection>(pair[0]);
+    conn->setStrand(std::make_shared<Strand>());
+    return conn;
+}
+
+// Delivers a message the way the server does: on the connection's strand, through dispatch()
+template <typename Task>
+static void deliver(WorkerPool& pool, AsyncRuntime& runtime,
+                    const std::shared_ptr<ClientConnection>& conn, Task task) {
+    pool.post(conn->getStrand(), [&runtime, conn, task]() {
+        runtime.dispatch(conn, task);
+    });
+}
+
+static bool waitFor(const std::function<bool()>& done, int timeout_ms = 2000) {
+    for (int waited = 0; waited < timeout_ms; waited++) {
+        if (done()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return done();
+}
+
+static int64_t elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+// ============== CONTINUATION TESTS ==============
+
+TEST(AsyncRuntimeTest, ContinuationGetsResultOffTheBlockingThread) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 1));
+    auto conn = makeConnection();
+
+    std::thread::id work_thread;
+    std::thread::id then_thread;
+    std::atomic<int> result(0);
+    deliver(pool, runtime, conn, [&]() {
+        runtime.query(conn, [&work_thread]() {
+            work_thread = std::this_thread::get_id();
+            return 42;
+        }, [&](int value) {
+            then_thread = std::this_thread::get_id();
+            result = value;
+        });
+    });
+
+    ASSERT_TRUE(waitFor([&result]() { return result == 42; }));
+    runtime.stop();
+    pool.stop();
+    EXPECT_NE(work_thread, then_thread);
+}
+
+TEST(AsyncRuntimeTest, SlowStepsDoNotHoldWorkers) {
+    WorkerPool pool(1);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 4));
+
+    // Four clients each wait 100 ms on a single worker thread
+    std::atomic<int> finished(0);
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<ClientConnection>> conns;
+    for (int i = 0; i < 4; i++) {
+        auto conn = makeConnection();
+        conns.push_back(conn);
+        deliver(pool, runtime, conn, [&runtime, &finished, conn]() {
+            runtime.run(conn, []() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return true;
+            }, [&finished](bool) { finished++; });
+        });
+    }
+
+    // Meanwhile the worker is free for someone else
+    std::atomic<bool> other_ran(false);
+    pool.post(std::make_shared<Strand>(), [&other_ran]() { other_ran = true; });
+    ASSERT_TRUE(waitFor([&other_ran]() { return other_ran.load(); }));
+    EXPECT_LT(elapsedMs(started), 50);
+
+    ASSERT_TRUE(waitFor([&finished]() { return finished == 4; }));
+    EXPECT_LT(elapsedMs(started), 300);
+    runtime.stop();
+    pool.stop();
+}
+
+TEST(AsyncRuntimeTest, ChainedStepsRunInSequence) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 2));
+    auto conn = makeConnection();
+
+    std::atomic<int> total(0);
+    deliver(pool, runtime, conn, [&runtime, &total, conn]() {
+        runtime.query(conn, []() { return 1; }, [&runtime, &total, conn](int first) {
+            runtime.query(conn, [first]() { return first + 2; }, [&total](int second) {
+                total = second;
+            });
+        });
+    });
+
+    ASSERT_TRUE(waitFor([&total]() { return total == 3; }));
+    runtime.stop();
+    pool.stop();
+}
+
+TEST(AsyncRuntimeTest, QueryWithoutConnectionOutlivesTheClient) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 1));
+    auto conn = makeConnection();
+
+    std::atomic<int> result(0);
+    deliver(pool, runtime, conn, [&runtime, &result]() {
+        runtime.query([]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return 42;
+        }, [&result](int value) { result = value; });
+    });
+    deliver(pool, runtime, conn, [conn]() { conn->disconnect(); });
+
+    ASSERT_TRUE(waitFor([&result]() { return result == 42; }));
+    EXPECT_FALSE(conn->isSuspended());
+    runtime.stop();
+    pool.stop();
+}
+
+// ============== SUSPENSION TESTS ==============
+
+TEST(AsyncRuntimeTest, LaterMessagesWaitForTheStepAndKeepOrder) {
+    WorkerPool pool(4);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 1));
+    auto conn = makeConnection();
+
+    std::vector<std::string> seen;
+    std::mutex seen_mutex;
+    auto record = [&seen, &seen_mutex](const std::string& event) {
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        seen.push_back(event);
+    };
+
+    deliver(pool, runtime, conn, [&runtime, &record, conn]() {
+        record("1");
+        runtime.query(conn, []() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return 0;
+        }, [&record](int) { record("1 done"); });
+    });
+    for (int i = 2; i <= 4; i++) {
+        deliver(pool, runtime, conn, [&record, i]() { record(std::to_string(i)); });
+    }
+
+    ASSERT_TRUE(waitFor([&seen, &seen_mutex]() {
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        return seen.size() == 5;
+    }));
+    runtime.stop();
+    pool.stop();
+    EXPECT_EQ(seen, std::vector<std::string>({"1", "1 done", "2", "3", "4"}));
+}
+
+TEST(AsyncRuntimeTest, DropsContinuationsForDisconnectedClients) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 1));
+    auto conn = makeConnection();
+
+    std::atomic<bool> work_done(false);
+    std::atomic<bool> continued(false);
+    std::atomic<bool> deferred_ran(false);
+    deliver(pool, runtime, conn, [&, conn]() {
+        runtime.query(conn, [&work_done]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            work_done = true;
+            return 0;
+        }, [&continued](int) { continued = true; });
+    });
+    deliver(pool, runtime, conn, [&deferred_ran]() { deferred_ran = true; });
+    conn->disconnect();
+
+    ASSERT_TRUE(waitFor([&work_done]() { return work_done.load(); }));
+    runtime.stop();
+    pool.stop();
+    EXPECT_FALSE(continued);
+    EXPECT_FALSE(deferred_ran);
+    EXPECT_FALSE(conn->isSuspended());
+}
+
+// ============== TIMER TESTS ==============
+
+TEST(AsyncRuntimeTest, AfterResumesOnceTheDelayHasPassed) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 1));
+    auto conn = makeConnection();
+
+    std::atomic<int64_t> waited(-1);
+    auto started = std::chrono::steady_clock::now();
+    deliver(pool, runtime, conn, [&, conn]() {
+        runtime.after(conn, 60, [&waited, started]() { waited = elapsedMs(started); });
+    });
+
+    ASSERT_TRUE(waitFor([&waited]() { return waited >= 0; }));
+    EXPECT_GE(waited, 60);
+    runtime.stop();
+    pool.stop();
+}
+
+TEST(AsyncRuntimeTest, StopFiresPendingTimers) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+    AsyncRuntime runtime;
+    ASSERT_TRUE(runtime.start(&pool, 1));
+    auto conn = makeConnection();
+
+    std::atomic<bool> fired(false);
+    std::atomic<bool> scheduled(false);
+    deliver(pool, runtime, conn, [&, conn]() {
+        runtime.after(conn, 60000, [&fired]() { fired = true; });
+        scheduled = true;
+    });
+    ASSERT_TRUE(waitFor([&scheduled]() { return scheduled.load(); }));
+
+    auto started = std::chrono::steady_clock::now();
+    runtime.stop();
+    pool.stop();
+    EXPECT_TRUE(fired);
+    EXPECT_LT(elapsedMs(started), 1000);
+}
+
+// ============== INLINE TESTS ==============
+
+TEST(AsyncRuntimeTest, RunsInlineUntilStarted) {
+    AsyncRuntime runtime;
+    auto conn = makeConnection();
+
+    int result = 0;
+    bool timer_fired = false;
+    runtime.query(conn, []() { return 7; }, [&result](int value) { result = value; });
+    runtime.after(conn, 60000, [&timer_fired]() { timer_fired = true; });
+
+    EXPECT_EQ(result, 7);
+    EXPECT_TRUE(timer_fired);
+    EXPECT_FALSE(conn->isSuspended());
+    EXPECT_FALSE(runtime.isRunning());
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
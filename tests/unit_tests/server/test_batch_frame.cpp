@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "batch_entry.h"
+#include "compact_header.h"
+#include "message_buffer.h"
+#include "client_connection.h"
+#include "messages/gameplay_messages.h"
+#include "messages/matchmaking_messages.h"
+
+struct Received {
+    uint8_t type;
+    std::string payload;
+};
+
+// Splits a BATCH payload into its messages; empty if malformed
+static std::vector<Received> unpack(const std::string& payload) {
+    std::vector<Received> messages;
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        BatchEntry entry;
+        size_t used = entry.decode(payload.data() + offset, payload.size() - offset);
+        if (used == 0) {
+            return std::vector<Received>();
+        }
+        messages.push_back(Received{entry.type, std::string(entry.payload, entry.length)});
+        offset += used;
+    }
+    return messages;
+}
+
+static PlayerStatusUpdate statusUpdate(uint32_t user_id, PlayerStatus status) {
+    PlayerStatusUpdate update;
+    update.user_id = user_id;
+    update.status = status;
+    return update;
+}
+
+// Connection on one end of a socket pair; peer is the client's end
+class BatchFrameTest : public ::testing::Test {
+protected:
+    std::shared_ptr<ClientConnection> connect(ClientConnection::WireVersion version, int& peer) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+            return nullptr;
+        }
+        auto conn = std::make_shared<ClientConnection>(pair[0]);
+        conn->setNonBlocking();
+        conn->setWireVersion(version);
+        peer = pair[1];
+        peers.push_back(peer);
+        return conn;
+    }
+
+    void TearDown() override {
+        for (int peer : peers) {
+            close(peer);
+        }
+    }
+
+    // Frames the client has been sent, as v2 frames
+    static std::vector<Received> receiveFrames(int peer) {
+        std::string bytes;
+        char chunk[16384];
+        ssize_t received;
+        while ((received = recv(peer, chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) {
+            bytes.append(chunk, received);
+        }
+
+        std::vector<Received> frames;
+        size_t offset = 0;
+        while (offset < bytes.size()) {
+            CompactHeader header;
+            int used = header.decode(bytes.data() + offset, bytes.size() - offset);
+            if (used <= 0 || offset + used + header.length > bytes.size()) {
+                ADD_FAILURE() << "Bad frame at " << offset;
+                break;
+            }
+            frames.push_back(Received{header.type, bytes.substr(offset + used, header.length)});
+            offset += used + header.length;
+        }
+        return frames;
+    }
+
+    std::vector<int> peers;
+};
+
+// ============== ENCODING TESTS ==============
+
+TEST(BatchEntryTest, EntriesRoundTrip) {
+    MoveResultMessage result;
+    result.match_id = 9;
+    TurnUpdateMessage turn;
+    turn.turn_number = 4;
+    SharedMessage batch = MessageBuffer::batch({MessageBuffer::create(MOVE_RESULT, result),
+                                                MessageBuffer::create(TURN_UPDATE, turn)});
+
+    EXPECT_EQ(batch->type(), BATCH);
+    EXPECT_EQ(batch->payloadSize(), 2 * BatchEntry::HEADER_SIZE + sizeof(result) + sizeof(turn));
+
+    std::vector<Received> messages = unpack(std::string(batch->payload(), batch->payloadSize()));
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].type, MOVE_RESULT);
+    EXPECT_EQ(messages[0].payload, std::string(reinterpret_cast<char*>(&result), sizeof(result)));
+    EXPECT_EQ(messages[1].type, TURN_UPDATE);
+    EXPECT_EQ(messages[1].payload, std::string(reinterpret_cast<char*>(&turn), sizeof(turn)));
+}
+
+TEST(BatchEntryTest, TruncatedEntryIsRejected) {
+    char bytes[BatchEntry::HEADER_SIZE + 4];
+    BatchEntry::encodeHeader(bytes, MOVE, 4);
+    memset(bytes + BatchEntry::HEADER_SIZE, 'm', 4);
+
+    BatchEntry entry;
+    EXPECT_EQ(entry.decode(bytes, sizeof(bytes)), sizeof(bytes));
+    EXPECT_EQ(entry.length, 4);
+    for (size_t size = 0; size < sizeof(bytes); size++) {
+        EXPECT_EQ(entry.decode(bytes, size), 0u) << "prefix of " << size;
+    }
+}
+
+// ============== CONNECTION TESTS ==============
+
+TEST_F(BatchFrameTest, V2ClientGetsOneFramePerBatch) {
+    int peer;
+    auto conn = connect(ClientConnection::WIRE_V2, peer);
+    {
+        ClientConnection::SendBatch batch;
+        EXPECT_TRUE(conn->sendMessage(MessageBuffer::create(MOVE_RESULT, MoveResultMessage())));
+        EXPECT_TRUE(conn->sendMessage(MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage())));
+        EXPECT_TRUE(receiveFrames(peer).empty());  // Nothing goes out before the batch ends
+    }
+
+    std::vector<Received> frames = receiveFrames(peer);
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].type, BATCH);
+    std::vector<Received> messages = unpack(frames[0].payload);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].type, MOVE_RESULT);
+    EXPECT_EQ(messages[1].type, TURN_UPDATE);
+    EXPECT_EQ(conn->getSendCalls(), 1u);
+}
+
+TEST_F(BatchFrameTest, SingleMessageIsNotWrapped) {
+    int peer;
+    auto conn = connect(ClientConnection::WIRE_V2, peer);
+    {
+        ClientConnection::SendBatch batch;
+        conn->sendMessage(MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage()));
+    }
+
+    std::vector<Received> frames = receiveFrames(peer);
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].type, TURN_UPDATE);
+    EXPECT_EQ(frames[0].payload.size(), sizeof(TurnUpdateMessage));
+}
+
+TEST_F(BatchFrameTest, V1ClientGetsSeparateFrames) {
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    peers.push_back(pair[1]);
+    auto conn = std::make_shared<ClientConnection>(pair[0]);
+    conn->setWireVersion(ClientConnection::WIRE_V1);
+    {
+        ClientConnection::SendBatch batch;
+        conn->sendMessage(MessageBuffer::create(MOVE_RESULT, MoveResultMessage()));
+        conn->sendMessage(MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage()));
+    }
+
+    char bytes[1024];
+    ssize_t received = recv(pair[1], bytes, sizeof(bytes), MSG_DONTWAIT);
+    ASSERT_EQ(received, static_cast<ssize_t>(2 * sizeof(MessageHeader) + sizeof(MoveResultMessage) +
+                                             sizeof(TurnUpdateMessage)));
+    EXPECT_EQ(static_cast<uint8_t>(bytes[0]), MOVE_RESULT);
+    EXPECT_EQ(static_cast<uint8_t>(bytes[sizeof(MessageHeader) + sizeof(MoveResultMessage)]), TURN_UPDATE);
+}
+
+TEST_F(BatchFrameTest, LargeBatchesAreSplit) {
+    int peer;
+    auto conn = connect(ClientConnection::WIRE_V2, peer);
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = CHAT_MESSAGE;
+    header.length = 1500;
+    std::string text(1500, 'c');
+    {
+        ClientConnection::SendBatch batch;
+        for (int i = 0; i < 3; i++) {
+            conn->sendMessage(MessageBuffer::create(header, text));
+        }
+    }
+
+    std::vector<Received> frames = receiveFrames(peer);
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0].type, BATCH);
+    EXPECT_LE(frames[0].payload.size(), static_cast<size_t>(MAX_MESSAGE_SIZE));
+    EXPECT_EQ(unpack(frames[0].payload).size(), 2u);
+    EXPECT_EQ(frames[1].type, CHAT_MESSAGE);
+}
+
+TEST_F(BatchFrameTest, EachClientIsFlushedOnce) {
+    int peer;
+    int other_peer;
+    auto conn = connect(ClientConnection::WIRE_V2, peer);
+    auto other = connect(ClientConnection::WIRE_V2, other_peer);
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = CHAT_MESSAGE;
+    header.length = 1500;
+    std::string text(1500, 'c');
+    {
+        ClientConnection::SendBatch batch;
+        // A queued frame, then held ones that overflow into a second BATCH
+        conn->sendMessage(MessageBuffer::fromFrames(std::string(sizeof(MessageHeader), '\0')));
+        for (int i = 0; i < 4; i++) {
+            conn->sendMessage(MessageBuffer::create(header, text));
+        }
+        other->sendMessage(MessageBuffer::create(header, text));
+        other->sendMessage(MessageBuffer::create(header, text));
+        EXPECT_EQ(batch.pending(), 2u);
+    }
+
+    // The next batch starts empty and takes the client again
+    ClientConnection::SendBatch batch;
+    conn->sendMessage(MessageBuffer::create(header, text));
+    EXPECT_EQ(batch.pending(), 1u);
+}
+
+TEST_F(BatchFrameTest, RawFramesKeepTheirPlace) {
+    int peer;
+    auto conn = connect(ClientConnection::WIRE_V2, peer);
+    char raw[CompactHeader::MAX_SIZE];
+    CompactHeader notification;
+    notification.type = NOTIFICATION;
+    size_t raw_size = notification.encode(raw);
+
+    // All of one priority class, so the queue keeps them in the order sent
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = CHALLENGE_RESPONSE;
+    {
+        ClientConnection::SendBatch batch;
+        conn->sendMessage(MessageBuffer::create(header, ""));
+        conn->sendMessage(MessageBuffer::fromFrames(std::string(raw, raw_size)));
+        header.type = CHALLENGE_RECEIVED;
+        conn->sendMessage(MessageBuffer::create(header, ""));
+    }
+
+    std::vector<Received> frames = receiveFrames(peer);
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[0].type, CHALLENGE_RESPONSE);
+    EXPECT_EQ(frames[1].type, NOTIFICATION);
+    EXPECT_EQ(frames[2].type, CHALLENGE_RECEIVED);
+}
+
+TEST_F(BatchFrameTest, HeldPresenceUpdatesAreCoalesced) {
+    int peer;
+    auto conn = connect(ClientConnection::WIRE_V2, peer);
+    {
+        ClientConnection::SendBatch batch;
+        conn->sendMessage(MessageBuffer::create(PLAYER_STATUS_UPDATE, statusUpdate(1, STATUS_IN_GAME)));
+        conn->sendMessage(MessageBuffer::create(MATCH_END, MatchEndMessage()));
+        conn->sendMessage(MessageBuffer::create(PLAYER_STATUS_UPDATE, statusUpdate(1, STATUS_AVAILABLE)));
+        conn->sendMessage(MessageBuffer::create(PLAYER_STATUS_UPDATE, statusUpdate(2, STATUS_AVAILABLE)));
+    }
+
+    std::vector<Received> frames = receiveFrames(peer);
+    ASSERT_EQ(frames.size(), 1u);
+    std::vector<Received> messages = unpack(frames[0].payload);
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0].type, PLAYER_STATUS_UPDATE);
+    PlayerStatusUpdate first;
+    memcpy(&first, messages[0].payload.data(), sizeof(first));
+    EXPECT_EQ(first.status, STATUS_AVAILABLE);
+    EXPECT_EQ(messages[1].type, MATCH_END);
+    EXPECT_EQ(conn->getFramesCoalesced(), 1u);
+}
+
+TEST_F(BatchFrameTest, SameMessagesShareOneFrame) {
+    // A lobby of clients receiving the same two broadcasts
+    std::vector<int> lobby_peers(3);
+    std::vector<std::shared_ptr<ClientConnection>> lobby;
+    for (int& peer : lobby_peers) {
+        lobby.push_back(connect(ClientConnection::WIRE_V2, peer));
+    }
+    SharedMessage first = MessageBuffer::create(PLAYER_STATUS_UPDATE, statusUpdate(1, STATUS_AVAILABLE));
+    SharedMessage second = MessageBuffer::create(PLAYER_STATUS_UPDATE, statusUpdate(2, STATUS_AVAILABLE));
+    {
+        ClientConnection::SendBatch batch;
+        for (auto& conn : lobby) {
+            conn->sendMessage(first);
+        }
+        for (auto& conn : lobby) {
+            conn->sendMessage(second);
+        }
+    }
+
+    std::string expected;
+    for (int peer : lobby_peers) {
+        std::vector<Received> frames = receiveFrames(peer);
+        ASSERT_EQ(frames.size(), 1u);
+        EXPECT_EQ(frames[0].type, BATCH);
+        EXPECT_EQ(unpack(frames[0].payload).size(), 2u);
+        if (expected.empty()) {
+            expected = frames[0].payload;
+        }
+        EXPECT_EQ(frames[0].payload, expected);
+    }
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "buffer_pool.h"
+#include "message_buffer.h"
+#include "worker_pool.h"
+#include "reactor.h"
+#include "client_connection.h"
+#include "messages/gameplay_messages.h"
+
+// ============== ALLOCATION COUNTING ==============
+
+// The replacements below pair malloc with free themselves
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+// Every heap allocation in the process while counting is on, from any thread
+static std::atomic<bool> counting(false);
+static std::atomic<uint64_t> allocations(0);
+
+void* operator new(size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    void* block = malloc(size > 0 ? size : 1);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
+
+// ============== POOL TESTS ==============
+
+TEST(BufferPoolTest, RoundsUpToSizeClasses) {
+    EXPECT_EQ(BufferPool::blockSize(1), BufferPool::MIN_BLOCK);
+    EXPECT_EQ(BufferPool::blockSize(64), 64u);
+    EXPECT_EQ(BufferPool::blockSize(65), 128u);
+    EXPECT_EQ(BufferPool::blockSize(sizeof(MessageHeader) + MAX_MESSAGE_SIZE), 8192u);
+    EXPECT_EQ(BufferPool::blockSize(BufferPool::MAX_BLOCK), BufferPool::MAX_BLOCK);
+}
+
+TEST(BufferPoolTest, ReusesFreedBlocks) {
+    void* first = BufferPool::allocate(100);
+    BufferPool::deallocate(first, 100);
+    void* second = BufferPool::allocate(120);  // Same class
+    EXPECT_EQ(first, second);
+    BufferPool::deallocate(second, 120);
+}
+
+TEST(BufferPoolTest, OversizeRequestsGoToTheHeap) {
+    BufferPool::Stats before = BufferPool::getStats();
+    void* block = BufferPool::allocate(BufferPool::MAX_BLOCK + 1);
+    memset(block, 0xAB, BufferPool::MAX_BLOCK + 1);
+    BufferPool::deallocate(block, BufferPool::MAX_BLOCK + 1);
+
+    BufferPool::Stats after = BufferPool::getStats();
+    EXPECT_EQ(after.oversize, before.oversize + 1);
+    EXPECT_EQ(after.blocks_in_use, before.blocks_in_use);
+}
+
+TEST(BufferPoolTest, BlocksBalanceAcrossThreads) {
+    uint64_t baseline = BufferPool::getStats().blocks_in_use;
+
+    // Allocated on one thread, freed on another, as frames are
+    std::vector<std::vector<void*>> handed(4);
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < handed.size(); t++) {
+        producers.emplace_back([&handed, t]() {
+            for (int i = 0; i < 1000; i++) {
+                size_t size = 32 + (i * 37) % 6000;
+                void* block = BufferPool::allocate(size);
+                memset(block, static_cast<int>(t), size);
+                handed[t].push_back(block);
+            }
+        });
+    }
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    EXPECT_EQ(BufferPool::getStats().blocks_in_use, baseline + 4000);
+
+    std::vector<std::thread> consumers;
+    for (size_t t = 0; t < handed.size(); t++) {
+        consumers.emplace_back([&handed, t]() {
+            for (int i = 0; i < 1000; i++) {
+                BufferPool::deallocate(handed[t][i], 32 + (i * 37) % 6000);
+            }
+        });
+    }
+    for (auto& thread : consumers) {
+        thread.join();
+    }
+    EXPECT_EQ(BufferPool::getStats().blocks_in_use, baseline);
+}
+
+// ============== MESSAGE BUFFER TESTS ==============
+
+TEST(MessageBufferTest, TypedCreateWritesHeaderAndStruct) {
+    TurnUpdateMessage update;
+    update.match_id = 42;
+    update.current_player_id = 7;
+    update.turn_number = 3;
+
+    SharedMessage frame = MessageBuffer::create(TURN_UPDATE, update);
+    ASSERT_EQ(frame->size(), sizeof(MessageHeader) + sizeof(update));
+    EXPECT_EQ(frame->type(), static_cast<uint8_t>(TURN_UPDATE));
+
+    MessageHeader header;
+    memcpy(&header, frame->data(), sizeof(header));
+    EXPECT_EQ(header.length, sizeof(update));
+    EXPECT_EQ(header.session_token[0], '\0');
+    EXPECT_EQ(memcmp(frame->data() + sizeof(header), &update, sizeof(update)), 0);
+}
+
+TEST(MessageBufferTest, FramesReturnTheirBlocks) {
+    uint64_t baseline = BufferPool::getStats().blocks_in_use;
+    {
+        SharedMessage frame = MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage());
+        SharedMessage copy = frame;
+        EXPECT_GT(BufferPool::getStats().blocks_in_use, baseline);
+    }
+    EXPECT_EQ(BufferPool::getStats().blocks_in_use, baseline);
+}
+
+// ============== HOT PATH TEST ==============
+
+static bool readFrame(int fd, MessageHeader& header, char* payload, size_t capacity) {
+    size_t total = 0;
+    char* bytes = reinterpret_cast<char*>(&header);
+    while (total < sizeof(header)) {
+        ssize_t n = recv(fd, bytes + total, sizeof(header) - total, 0);
+        if (n <= 0) return false;
+        total += n;
+    }
+    if (header.length > capacity) return false;
+    total = 0;
+    while (total < header.length) {
+        ssize_t n = recv(fd, payload + total, header.length - total, 0);
+        if (n <= 0) return false;
+        total += n;
+    }
+    return true;
+}
+
+// A MOVE goes through the same steps as in the server: read off the socket by
+// the reactor, posted to the connection's strand, answered with MOVE_RESULT and
+// TURN_UPDATE built in pooled frames, written back in one batch. Once the pools
+// are warm none of that touches the heap. (The server's session lookup and
+// move persistence go to SQLite and are not part of this path.)
+TEST(BufferPoolHotPathTest, SteadyStateMovePathDoesNotAllocate) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ASSERT_EQ(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listen_fd, 4), 0);
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL, 0) | O_NONBLOCK);
+    int client_fd = pair[1];
+
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+
+    auto conn = std::make_shared<ClientConnection>(pair[0]);
+    conn->setStrand(std::make_shared<Strand>());
+
+    Reactor reactor(listen_fd);
+    reactor.setMessageCallback([&pool](ClientConnection* client, const MessageHeader& header,
+                                       const PayloadView& payload) {
+        std::shared_ptr<ClientConnection> owner = client->shared_from_this();
+        pool.post(owner->getStrand(), [owner, header, payload]() {
+            ClientConnection::SendBatch batch;
+            MoveMessage move;
+            if (payload.size() != sizeof(move)) {
+                return;
+            }
+            memcpy(&move, payload.data(), sizeof(move));
+
+            MoveResultMessage result;
+            result.match_id = move.match_id;
+            result.target = move.target;
+            result.result = SHOT_MISS;
+            owner->sendMessage(MessageBuffer::create(MOVE_RESULT, result));
+
+            TurnUpdateMessage turn;
+            turn.match_id = move.match_id;
+            turn.turn_number = static_cast<uint32_t>(header.timestamp);
+            owner->sendMessage(MessageBuffer::create(TURN_UPDATE, turn));
+        });
+    });
+    reactor.adopt(conn);
+    ASSERT_TRUE(reactor.start());
+
+    char frame[sizeof(MessageHeader) + sizeof(MoveMessage)];
+    char reply[256];
+    auto playMove = [&](uint32_t turn) -> bool {
+        MessageHeader header;
+        memset(&header, 0, sizeof(header));
+        header.type = MOVE;
+        header.length = sizeof(MoveMessage);
+        header.timestamp = turn;
+        MoveMessage move;
+        move.match_id = 5;
+        move.target.row = turn % 10;
+        move.target.col = (turn / 10) % 10;
+        memcpy(frame, &header, sizeof(header));
+        memcpy(frame + sizeof(header), &move, sizeof(move));
+        if (send(client_fd, frame, sizeof(frame), 0) != static_cast<ssize_t>(sizeof(frame))) {
+            return false;
+        }
+
+        MessageHeader first, second;
+        if (!readFrame(client_fd, first, reply, sizeof(reply)) || first.type != MOVE_RESULT) {
+            return false;
+        }
+        if (!readFrame(client_fd, second, reply, sizeof(reply)) || second.type != TURN_UPDATE) {
+            return false;
+        }
+        TurnUpdateMessage turn_update;
+        memcpy(&turn_update, reply, sizeof(turn_update));
+        return turn_update.turn_number == turn;
+    };
+
+    // Warm up: pools, strand and queue capacities, read block rotation
+    for (uint32_t turn = 0; turn < 500; turn++) {
+        ASSERT_TRUE(playMove(turn));
+    }
+
+    allocations = 0;
+    counting = true;
+    bool all_ok = true;
+    for (uint32_t turn = 500; turn < 5500 && all_ok; turn++) {
+        all_ok = playMove(turn);
+    }
+    counting = false;
+
+    EXPECT_TRUE(all_ok);
+    EXPECT_EQ(allocations.load(), 0u);
+
+    reactor.stop();
+    pool.stop();
+    close(client_fd);
+    close(listen_fd);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
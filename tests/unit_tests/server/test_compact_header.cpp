@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "compact_header.h"
+#include "message_buffer.h"
+#include "client_connection.h"
+#include "messages/gameplay_messages.h"
+
+static CompactHeader header(uint8_t type, uint32_t length) {
+    CompactHeader result;
+    result.type = type;
+    result.length = length;
+    return result;
+}
+
+static std::string encode(const CompactHeader& compact) {
+    char bytes[CompactHeader::MAX_SIZE];
+    return std::string(bytes, compact.encode(bytes));
+}
+
+// Connection on one end of a socket pair; peer is the client's end
+class CompactConnectionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        int pair[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        conn = std::make_shared<ClientConnection>(pair[0]);
+        ASSERT_TRUE(conn->setNonBlocking());
+        peer = pair[1];
+    }
+
+    void TearDown() override {
+        close(peer);
+    }
+
+    void clientSends(const std::string& bytes) {
+        ASSERT_EQ(write(peer, bytes.data(), bytes.size()), static_cast<ssize_t>(bytes.size()));
+        ASSERT_TRUE(conn->readAvailable());
+    }
+
+    std::string clientReceives() {
+        char bytes[1024];
+        ssize_t received = recv(peer, bytes, sizeof(bytes), MSG_DONTWAIT);
+        return received > 0 ? std::string(bytes, received) : std::string();
+    }
+
+    std::shared_ptr<ClientConnection> conn;
+    int peer;
+};
+
+// ============== ENCODING TESTS ==============
+
+TEST(CompactHeaderTest, RoundTripsLengthsAndSequences) {
+    const uint32_t lengths[] = {0, 1, 127, 128, 300, 4096, 16383, 16384, 0xFFFFFFFFu};
+    for (uint32_t length : lengths) {
+        CompactHeader sent = header(MOVE, length);
+        sent.flags = CompactHeader::FLAG_SEQUENCE;
+        sent.sequence = length ^ 0x5A5A5A5Au;
+        std::string bytes = encode(sent);
+
+        CompactHeader received;
+        EXPECT_EQ(received.decode(bytes.data(), bytes.size()), static_cast<int>(bytes.size()));
+        EXPECT_EQ(received.type, MOVE);
+        EXPECT_EQ(received.length, length);
+        EXPECT_EQ(received.sequence, sent.sequence);
+    }
+}
+
+TEST(CompactHeaderTest, SmallPayloadsTakeFourBytes) {
+    EXPECT_EQ(encode(header(MOVE, 0)).size(), 4u);
+    EXPECT_EQ(encode(header(MOVE, sizeof(MoveMessage))).size(), 4u);
+    EXPECT_EQ(encode(header(MOVE, 4096)).size(), 5u);
+    EXPECT_LT(encode(header(MOVE, 0xFFFFFFFFu)).size(), sizeof(MessageHeader));
+
+    MessageHeader v1 = header(MOVE, 4096).toMessageHeader();
+    EXPECT_EQ(v1.type, MOVE);
+    EXPECT_EQ(v1.length, 4096u);
+    EXPECT_EQ(v1.session_token[0], '\0');
+}
+
+TEST(CompactHeaderTest, WaitsForTheRestOfAHeader) {
+    CompactHeader sent = header(PLAYER_LIST, 70000);
+    sent.flags = CompactHeader::FLAG_SEQUENCE;
+    sent.sequence = 1u << 20;
+    std::string bytes = encode(sent);
+
+    for (size_t size = 0; size < bytes.size(); size++) {
+        CompactHeader received;
+        EXPECT_EQ(received.decode(bytes.data(), size), 0) << "prefix of " << size;
+    }
+}
+
+TEST(CompactHeaderTest, RejectsMalformedHeaders) {
+    CompactHeader received;
+    const char v1_frame[] = {static_cast<char>(MOVE), 8, 0, 0, 0};
+    EXPECT_EQ(received.decode(v1_frame, sizeof(v1_frame)), -1);
+
+    const char unknown_flag[] = {static_cast<char>(0xB2), static_cast<char>(MOVE), 0x40, 8};
+    EXPECT_EQ(received.decode(unknown_flag, sizeof(unknown_flag)), -1);
+
+    const char too_long[] = {static_cast<char>(0xB2), static_cast<char>(MOVE), 0,
+                             static_cast<char>(0xFF), static_cast<char>(0xFF), static_cast<char>(0xFF),
+                             static_cast<char>(0xFF), 0x1F};
+    EXPECT_EQ(received.decode(too_long, sizeof(too_long)), -1);
+
+    EXPECT_FALSE(CompactHeader::isCompactFrame(v1_frame, sizeof(v1_frame)));
+    EXPECT_TRUE(CompactHeader::isCompactFrame(unknown_flag, sizeof(unknown_flag)));
+}
+
+// ============== SHARED FRAME TESTS ==============
+
+TEST(CompactHeaderTest, CompactFrameIsEncodedOnceAndShared) {
+    TurnUpdateMessage turn;
+    turn.match_id = 42;
+    SharedMessage full = MessageBuffer::create(TURN_UPDATE, turn);
+
+    SharedMessage compact = MessageBuffer::compact(full);
+    EXPECT_EQ(MessageBuffer::compact(full), compact);
+    EXPECT_EQ(compact->type(), TURN_UPDATE);
+    EXPECT_EQ(compact->size(), 4 + sizeof(turn));
+    ASSERT_EQ(compact->payloadSize(), sizeof(turn));
+    EXPECT_EQ(memcmp(compact->payload(), full->payload(), sizeof(turn)), 0);
+
+    // Already framed bytes are passed through as they are
+    SharedMessage raw = MessageBuffer::fromFrames(std::string(full->data(), full->size()));
+    EXPECT_EQ(MessageBuffer::compact(raw), raw);
+}
+
+// ============== CONNECTION TESTS ==============
+
+TEST_F(CompactConnectionTest, V2ClientGetsV2Replies) {
+    MoveMessage move;
+    move.match_id = 7;
+    move.target.row = 3;
+    clientSends(encode(header(MOVE, sizeof(move))) + std::string(reinterpret_cast<char*>(&move), sizeof(move)));
+
+    MessageHeader received;
+    PayloadView payload;
+    ASSERT_TRUE(conn->nextMessage(received, payload));
+    EXPECT_EQ(received.type, MOVE);
+    ASSERT_EQ(payload.size(), sizeof(move));
+    EXPECT_EQ(memcmp(payload.data(), &move, sizeof(move)), 0);
+    EXPECT_EQ(conn->getWireVersion(), ClientConnection::WIRE_V2);
+
+    TurnUpdateMessage turn;
+    ASSERT_TRUE(conn->sendMessage(MessageBuffer::create(TURN_UPDATE, turn)));
+    std::string reply = clientReceives();
+    CompactHeader reply_header;
+    ASSERT_EQ(reply_header.decode(reply.data(), reply.size()), 4);
+    EXPECT_EQ(reply_header.type, TURN_UPDATE);
+    EXPECT_EQ(reply.size(), 4 + sizeof(turn));
+}
+
+TEST_F(CompactConnectionTest, V1ClientGetsV1Replies) {
+    MessageHeader ping;
+    memset(&ping, 0, sizeof(ping));
+    ping.type = PING;
+    clientSends(std::string(reinterpret_cast<char*>(&ping), sizeof(ping)));
+
+    MessageHeader received;
+    PayloadView payload;
+    ASSERT_TRUE(conn->nextMessage(received, payload));
+    EXPECT_EQ(received.type, PING);
+    EXPECT_EQ(conn->getWireVersion(), ClientConnection::WIRE_V1);
+
+    MessageHeader pong = ping;
+    pong.type = PONG;
+    ASSERT_TRUE(conn->sendMessage(pong, ""));
+    std::string reply = clientReceives();
+    ASSERT_EQ(reply.size(), sizeof(MessageHeader));
+    EXPECT_EQ(static_cast<uint8_t>(reply[0]), PONG);
+}
+
+TEST_F(CompactConnectionTest, FramesSplitAcrossReadsAreReassembled) {
+    std::string frame = encode(header(CHAT_MESSAGE, 200)) + std::string(200, 'c');
+    clientSends(frame.substr(0, 2));
+
+    MessageHeader received;
+    PayloadView payload;
+    EXPECT_FALSE(conn->nextMessage(received, payload));
+    clientSends(frame.substr(2, 100));
+    EXPECT_FALSE(conn->nextMessage(received, payload));
+    clientSends(frame.substr(102));
+    ASSERT_TRUE(conn->nextMessage(received, payload));
+    EXPECT_EQ(received.type, CHAT_MESSAGE);
+    EXPECT_EQ(payload.size(), 200u);
+    EXPECT_TRUE(conn->isConnected());
+}
+
+TEST_F(CompactConnectionTest, MalformedHeaderDisconnects) {
+    const char bad[] = {static_cast<char>(0xB2), static_cast<char>(MOVE), 0x40, 0};
+    clientSends(std::string(bad, sizeof(bad)));
+
+    MessageHeader received;
+    PayloadView payload;
+    EXPECT_FALSE(conn->nextMessage(received, payload));
+    EXPECT_FALSE(conn->isConnected());
+}
+
+TEST_F(CompactConnectionTest, SessionIsBoundAtLogin) {
+    clientSends(encode(header(PING, 0)));
+    MessageHeader received;
+    PayloadView payload;
+    ASSERT_TRUE(conn->nextMessage(received, payload));
+
+    conn->bindSession(received);
+    EXPECT_EQ(received.session_token[0], '\0');
+
+    conn->setAuthenticated(5, "session-token-5");
+    conn->bindSession(received);
+    EXPECT_STREQ(received.session_token, "session-token-5");
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "connection_table.h"
+#include "client_connection.h"
+
+// Connection on one end of a socket pair; the other end is closed right away
+static std::shared_ptr<ClientConnection> makeConnection() {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        return nullptr;
+    }
+    close(pair[1]);
+    return std::make_shared<ClientConnection>(pair[0]);
+}
+
+// ============== BASIC OPERATIONS ==============
+
+TEST(ConnectionTableTest, FindsInsertedConnectionsByFd) {
+    ConnectionTable table(1024);
+    auto first = makeConnection();
+    auto second = makeConnection();
+
+    EXPECT_NE(table.insert(first), 0u);
+    EXPECT_NE(table.insert(second), 0u);
+    EXPECT_EQ(table.size(), 2u);
+
+    ClientConnection* found = nullptr;
+    EXPECT_TRUE(table.with(second->getSocketFd(), [&found](ClientConnection& client, uint32_t) {
+        found = &client;
+    }));
+    EXPECT_EQ(found, second.get());
+    EXPECT_FALSE(table.with(1000, [](ClientConnection&, uint32_t) {}));
+    EXPECT_FALSE(table.with(-1, [](ClientConnection&, uint32_t) {}));
+}
+
+TEST(ConnectionTableTest, RemoveReturnsTheConnection) {
+    ConnectionTable table(1024);
+    auto client = makeConnection();
+    int fd = client->getSocketFd();
+    table.insert(client);
+
+    std::shared_ptr<ClientConnection> removed = table.remove(fd);
+    EXPECT_EQ(removed, client);
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_FALSE(table.with(fd, [](ClientConnection&, uint32_t) {}));
+    EXPECT_EQ(table.remove(fd), nullptr);
+}
+
+TEST(ConnectionTableTest, StaleGenerationDoesNotRemoveNewerConnection) {
+    ConnectionTable table(1024);
+    auto client = makeConnection();
+    int fd = client->getSocketFd();
+    uint32_t old_generation = table.insert(client);
+    table.remove(fd, old_generation);
+
+    // Same fd, new connection (as after the number is reused)
+    auto newer = std::make_shared<ClientConnection>(fd);
+    client->release();
+    uint32_t new_generation = table.insert(newer);
+    EXPECT_NE(new_generation, old_generation);
+
+    EXPECT_EQ(table.remove(fd, old_generation), nullptr);
+    EXPECT_EQ(table.size(), 1u);
+
+    uint32_t seen = 0;
+    table.with(fd, [&seen](ClientConnection&, uint32_t generation) { seen = generation; });
+    EXPECT_EQ(seen, new_generation);
+    EXPECT_EQ(table.remove(fd, new_generation), newer);
+}
+
+TEST(ConnectionTableTest, RejectsFdsOutOfRangeAndTakenSlots) {
+    ConnectionTable table(4);  // Rounded up to one chunk
+    auto probe = makeConnection();
+    int high_fd = fcntl(probe->getSocketFd(), F_DUPFD, static_cast<int>(table.capacity()));
+    ASSERT_GE(high_fd, 0);
+    auto beyond = std::make_shared<ClientConnection>(high_fd);
+    EXPECT_EQ(table.insert(beyond), 0u);
+    EXPECT_EQ(table.insert(nullptr), 0u);
+
+    auto client = makeConnection();
+
+    ConnectionTable roomy(1024);
+    EXPECT_NE(roomy.insert(client), 0u);
+    EXPECT_EQ(roomy.insert(client), 0u);
+}
+
+TEST(ConnectionTableTest, ForEachVisitsEveryLiveConnection) {
+    ConnectionTable table(4096);
+    std::vector<std::shared_ptr<ClientConnection>> clients;
+    for (int i = 0; i < 20; i++) {
+        clients.push_back(makeConnection());
+        table.insert(clients.back());
+    }
+    table.remove(clients[3]->getSocketFd());
+    table.remove(clients[11]->getSocketFd());
+
+    int last_fd = -1;
+    bool ordered = true;
+    size_t visited = table.forEach([&last_fd, &ordered](ClientConnection& client) {
+        ordered = ordered && client.getSocketFd() > last_fd;
+        last_fd = client.getSocketFd();
+    });
+    EXPECT_EQ(visited, 18u);
+    EXPECT_TRUE(ordered);
+
+    EXPECT_EQ(table.removeAll().size(), 18u);
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_EQ(table.forEach([](ClientConnection&) {}), 0u);
+}
+
+// ============== CONCURRENCY ==============
+
+TEST(ConnectionTableTest, RemoveWaitsForReaders) {
+    ConnectionTable table(1024);
+    auto client = makeConnection();
+    int fd = client->getSocketFd();
+    table.insert(client);
+    client.reset();  // The table holds the only reference
+
+    std::atomic<bool> reading(false);
+    std::atomic<bool> reader_done(false);
+    std::thread reader([&]() {
+        table.with(fd, [&](ClientConnection& found, uint32_t) {
+            reading = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            EXPECT_EQ(found.getSocketFd(), fd);
+            reader_done = true;
+        });
+    });
+
+    while (!reading) {
+        std::this_thread::yield();
+    }
+    std::shared_ptr<ClientConnection> removed = table.remove(fd);
+    EXPECT_TRUE(reader_done);
+    EXPECT_NE(removed, nullptr);
+    reader.join();
+}
+
+TEST(ConnectionTableTest, ReadersRaceWithInsertAndRemove) {
+    ConnectionTable table(4096);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> lookups(0);
+
+    // A few stay for the whole test so readers always find something
+    std::vector<std::shared_ptr<ClientConnection>> resident;
+    for (int i = 0; i < 8; i++) {
+        resident.push_back(makeConnection());
+        table.insert(resident.back());
+    }
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                table.forEach([&lookups](ClientConnection& client) {
+                    if (client.getSocketFd() >= 0) {
+                        lookups++;
+                    }
+                });
+                for (int fd = 0; fd < 64; fd++) {
+                    table.with(fd, [&lookups](ClientConnection& client, uint32_t) {
+                        if (client.isConnected()) {
+                            lookups++;
+                        }
+                    });
+                }
+            }
+        });
+    }
+
+    // Churn: every removed connection is destroyed as soon as remove() returns
+    for (int round = 0; round < 2000; round++) {
+        auto client = makeConnection();
+        int fd = client->getSocketFd();
+        uint32_t generation = table.insert(client);
+        client.reset();
+        ASSERT_NE(table.remove(fd, generation), nullptr);
+    }
+    stop = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    EXPECT_EQ(table.size(), resident.size());
+    EXPECT_GT(lookups.load(), 0u);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
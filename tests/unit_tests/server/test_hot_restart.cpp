@@ -0,0 +1,286 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "hot_restart.h"
+#include "reactor.h"
+#include "client_connection.h"
+#include "message_buffer.h"
+
+class HotRestartTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, channel), 0);
+    }
+
+    void TearDown() override {
+        close(channel[0]);
+        close(channel[1]);
+        for (int fd : opened) {
+            close(fd);
+        }
+    }
+
+    // Sends on a thread: a large handoff fills the channel before the receiver reads
+    bool roundTrip(const HandoffState& sent, HandoffState& received) {
+        bool send_ok = false;
+        std::thread sender([&]() { send_ok = HotRestart::send(channel[0], sent); });
+        bool receive_ok = HotRestart::receive(channel[1], received);
+        sender.join();
+        for (int fd : received.listen_fds) {
+            opened.push_back(fd);
+        }
+        for (const HandoffClient& client : received.clients) {
+            opened.push_back(client.fd);
+        }
+        return send_ok && receive_ok;
+    }
+
+    int channel[2];
+    std::vector<int> opened;
+};
+
+// ============== CHANNEL TESTS ==============
+
+TEST_F(HotRestartTest, PassesDescriptorsAcrossChunks) {
+    // More descriptors than fit in one SCM_RIGHTS message
+    const size_t COUNT = HotRestart::MAX_FDS_PER_CHUNK + 50;
+
+    HandoffState sent;
+    int listener = eventfd(0, EFD_CLOEXEC);
+    opened.push_back(listener);
+    sent.listen_fds.push_back(listener);
+    for (size_t i = 0; i < COUNT; i++) {
+        HandoffClient client;
+        client.fd = eventfd(0, EFD_CLOEXEC);
+        ASSERT_GE(client.fd, 0);
+        opened.push_back(client.fd);
+        client.sender_fd = -1;
+        client.peer_address = static_cast<uint32_t>(i);
+        client.user_id = static_cast<uint32_t>(1000 + i);
+        client.authenticated = i % 2 == 0;
+        client.session_token = "token-" + std::to_string(i);
+        client.wire_version = static_cast<uint8_t>(i % 3);
+        client.capabilities = static_cast<uint32_t>(i % 2);
+        sent.clients.push_back(client);
+    }
+
+    HandoffState received;
+    ASSERT_TRUE(roundTrip(sent, received));
+    ASSERT_EQ(received.listen_fds.size(), 1u);
+    ASSERT_EQ(received.clients.size(), COUNT);
+
+    for (size_t i = 0; i < COUNT; i++) {
+        const HandoffClient& original = sent.clients[i];
+        const HandoffClient& client = received.clients[i];
+        EXPECT_EQ(client.sender_fd, original.fd);
+        EXPECT_NE(client.fd, original.fd);
+        EXPECT_EQ(client.user_id, original.user_id);
+        EXPECT_EQ(client.authenticated, original.authenticated);
+        EXPECT_EQ(client.session_token, original.session_token);
+        EXPECT_EQ(client.wire_version, original.wire_version);
+        EXPECT_EQ(client.capabilities, original.capabilities);
+
+        // Same open file under a new number: a write on one is read on the other
+        uint64_t value = i + 1;
+        ASSERT_EQ(write(original.fd, &value, sizeof(value)), static_cast<ssize_t>(sizeof(value)));
+        uint64_t seen = 0;
+        ASSERT_EQ(read(client.fd, &seen, sizeof(seen)), static_cast<ssize_t>(sizeof(seen)));
+        EXPECT_EQ(seen, value);
+    }
+}
+
+TEST_F(HotRestartTest, CarriesLargeSnapshots) {
+    HandoffState sent;
+    HandoffClient client;
+    client.fd = eventfd(0, EFD_CLOEXEC);
+    opened.push_back(client.fd);
+    client.sender_fd = -1;
+    client.peer_address = 0;
+    client.user_id = 7;
+    client.authenticated = true;
+    client.wire_version = 2;
+    client.capabilities = CAP_ZLIB;
+    client.inbound = std::string("\x00\x01partial", 9);
+    client.outbound.assign(3 * HotRestart::MAX_BYTES_PER_CHUNK + 17, 'o');
+    sent.clients.push_back(client);
+    sent.players = "players";
+    for (int i = 0; i < 20000; i++) {
+        sent.matches += static_cast<char>(i % 251);
+    }
+
+    HandoffState received;
+    ASSERT_TRUE(roundTrip(sent, received));
+    ASSERT_EQ(received.clients.size(), 1u);
+    EXPECT_EQ(received.clients[0].inbound, client.inbound);
+    EXPECT_EQ(received.clients[0].outbound, client.outbound);
+    EXPECT_EQ(received.players, sent.players);
+    EXPECT_EQ(received.matches, sent.matches);
+}
+
+TEST_F(HotRestartTest, RejectsStreamThatEndsEarly) {
+    HandoffState sent;
+    sent.players.assign(2 * HotRestart::MAX_BYTES_PER_CHUNK, 'p');
+
+    // Only the header and the first chunk arrive before the sender goes away
+    std::thread sender([&]() {
+        HotRestart::send(channel[0], sent);
+    });
+    std::string chunk;
+    std::vector<int> fds;
+    ASSERT_TRUE(HotRestart::receiveChunk(channel[1], chunk, fds));
+    std::string first_header = chunk;
+    ASSERT_TRUE(HotRestart::receiveChunk(channel[1], chunk, fds));
+    std::string first_body = chunk;
+    sender.join();
+
+    int replay[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, replay), 0);
+    ASSERT_TRUE(HotRestart::sendChunk(replay[0], first_header.data(), first_header.size(), nullptr, 0));
+    ASSERT_TRUE(HotRestart::sendChunk(replay[0], first_body.data(), first_body.size(), nullptr, 0));
+    close(replay[0]);
+
+    HandoffState received;
+    EXPECT_FALSE(HotRestart::receive(replay[1], received));
+    close(replay[1]);
+}
+
+TEST_F(HotRestartTest, ReadyHandshake) {
+    EXPECT_FALSE(HotRestart::waitReady(channel[0], 50));
+    ASSERT_TRUE(HotRestart::sendReady(channel[1]));
+    EXPECT_TRUE(HotRestart::waitReady(channel[0], 1000));
+
+    ASSERT_TRUE(HotRestart::sendGo(channel[0]));
+    EXPECT_TRUE(HotRestart::waitGo(channel[1]));
+}
+
+TEST_F(HotRestartTest, NoGoWhenTheOldProcessKeepsServing) {
+    ASSERT_TRUE(HotRestart::sendReady(channel[1]));
+    close(channel[0]);
+    channel[0] = -1;
+    EXPECT_FALSE(HotRestart::waitGo(channel[1]));
+}
+
+// ============== CONNECTION CARRY-OVER TESTS ==============
+
+static SharedMessage numberedFrame(uint32_t number, size_t payload_size) {
+    MessageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.type = static_cast<uint8_t>(MOVE_RESULT);
+    header.length = payload_size;
+    header.timestamp = number;
+    std::string payload(payload_size, static_cast<char>('a' + number % 26));
+    return MessageBuffer::create(header, payload);
+}
+
+TEST(HotRestartConnectionTest, UnsentOutputContinuesOnTheNewConnection) {
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair), 0);
+    int small = 4096;
+    setsockopt(pair[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+
+    // The peer is not reading, so most of this stays queued (some of it mid-frame)
+    const uint32_t FRAMES = 40;
+    auto old_conn = std::make_shared<ClientConnection>(pair[0]);
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        ASSERT_TRUE(old_conn->sendMessage(numberedFrame(i, 1000)));
+    }
+    ASSERT_GT(old_conn->getQueuedBytes(), 0u);
+
+    std::string carried = old_conn->takeOutbound();
+    EXPECT_EQ(old_conn->getQueuedBytes(), 0u);
+    int new_fd = dup(pair[0]);
+    old_conn->release();  // Must not shut the socket down
+
+    auto new_conn = std::make_shared<ClientConnection>(new_fd);
+    new_conn->restoreOutbound(carried);
+    new_conn->sendMessage(numberedFrame(FRAMES, 10));
+
+    // The peer sees every frame once, in order, with nothing torn
+    int flags = fcntl(pair[1], F_GETFL, 0);
+    fcntl(pair[1], F_SETFL, flags & ~O_NONBLOCK);
+    for (uint32_t i = 0; i <= FRAMES; i++) {
+        MessageHeader header;
+        while (recv(pair[1], &header, sizeof(header), MSG_DONTWAIT | MSG_PEEK) < static_cast<ssize_t>(sizeof(header))) {
+            new_conn->flushOutbound();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(recv(pair[1], &header, sizeof(header), MSG_WAITALL), static_cast<ssize_t>(sizeof(header)));
+        ASSERT_EQ(header.timestamp, i);
+        std::string payload(header.length, '\0');
+        size_t got = 0;
+        while (got < payload.size()) {
+            new_conn->flushOutbound();
+            ssize_t n = recv(pair[1], &payload[got], payload.size() - got, MSG_DONTWAIT);
+            if (n > 0) {
+                got += n;
+            }
+        }
+        EXPECT_EQ(payload, std::string(header.length, static_cast<char>('a' + i % 26)));
+    }
+    EXPECT_EQ(new_conn->getQueuedBytes(), 0u);
+    close(pair[1]);
+}
+
+TEST(HotRestartConnectionTest, AdoptedConnectionFinishesAPartialFrame) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ASSERT_EQ(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listen_fd, 4), 0);
+
+    int pair[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, pair), 0);
+
+    // The old process had read the first half of a PING frame
+    MessageHeader ping;
+    memset(&ping, 0, sizeof(ping));
+    ping.type = static_cast<uint8_t>(PING);
+    ping.timestamp = 99;
+    const char* bytes = reinterpret_cast<const char*>(&ping);
+    size_t half = sizeof(ping) / 2;
+
+    auto conn = std::make_shared<ClientConnection>(pair[0]);
+    conn->appendReceived(bytes, half);
+
+    std::atomic<int> received{0};
+    std::atomic<uint64_t> timestamp{0};
+    Reactor reactor(listen_fd);
+    reactor.setMessageCallback([&](ClientConnection*, const MessageHeader& header, const PayloadView&) {
+        timestamp = header.timestamp;
+        received++;
+    });
+    reactor.adopt(conn);
+    ASSERT_TRUE(reactor.start());
+    EXPECT_EQ(reactor.getConnectionCount(), 1u);
+    EXPECT_EQ(reactor.getAcceptedCount(), 0u);
+
+    // The rest arrives on the socket the new process now watches
+    ASSERT_EQ(send(pair[1], bytes + half, sizeof(ping) - half, 0), static_cast<ssize_t>(sizeof(ping) - half));
+    for (int i = 0; i < 1000 && received == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(received, 1);
+    EXPECT_EQ(timestamp, 99u);
+
+    reactor.stop();
+    close(pair[1]);
+    close(listen_fd);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <regex>
+#include <chrono>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "logger.h"
+
+// Collects everything written to the logger's stdout/stderr replacements
+class CapturedOutput {
+public:
+    CapturedOutput() {
+        EXPECT_EQ(pipe(out_pipe_), 0);
+        EXPECT_EQ(pipe(err_pipe_), 0);
+        out_reader_ = std::thread(&CapturedOutput::drain, out_pipe_[0], &out_);
+        err_reader_ = std::thread(&CapturedOutput::drain, err_pipe_[0], &err_);
+        Logger::setOutput(out_pipe_[1], err_pipe_[1]);
+    }
+
+    ~CapturedOutput() {
+        finish();
+    }
+
+    // Stops the logger and waits for everything it wrote
+    void finish() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        Logger::stop();
+        Logger::setOutput(STDOUT_FILENO, STDERR_FILENO);
+        close(out_pipe_[1]);
+        close(err_pipe_[1]);
+        out_reader_.join();
+        err_reader_.join();
+        close(out_pipe_[0]);
+        close(err_pipe_[0]);
+    }
+
+    std::vector<std::string> outLines() const { return split(out_); }
+    std::vector<std::string> errLines() const { return split(err_); }
+
+private:
+    static void drain(int fd, std::string* into) {
+        char buffer[4096];
+        ssize_t got;
+        while ((got = read(fd, buffer, sizeof(buffer))) > 0) {
+            into->append(buffer, got);
+        }
+    }
+
+    static std::vector<std::string> split(const std::string& text) {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    int out_pipe_[2];
+    int err_pipe_[2];
+    std::string out_;
+    std::string err_;
+    std::thread out_reader_;
+    std::thread err_reader_;
+    bool finished_ = false;
+};
+
+// Text after "LEVEL [TAG] "
+static std::string messageOf(const std::string& line) {
+    size_t tag_end = line.find("] ");
+    return tag_end == std::string::npos ? std::string() : line.substr(tag_end + 2);
+}
+
+class LoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Logger::setLevel(LOG_LEVEL_INFO);
+    }
+};
+
+// ============== LEVELS ==============
+
+TEST_F(LoggerTest, ParsesLevelNames) {
+    LogLevel level = LOG_LEVEL_INFO;
+    EXPECT_TRUE(Logger::parseLevel("debug", level));
+    EXPECT_EQ(level, LOG_LEVEL_DEBUG);
+    EXPECT_TRUE(Logger::parseLevel("WARNING", level));
+    EXPECT_EQ(level, LOG_LEVEL_WARN);
+    EXPECT_TRUE(Logger::parseLevel("Error", level));
+    EXPECT_EQ(level, LOG_LEVEL_ERROR);
+    EXPECT_TRUE(Logger::parseLevel("OFF", level));
+    EXPECT_EQ(level, LOG_LEVEL_OFF);
+
+    EXPECT_FALSE(Logger::parseLevel("loud", level));
+    EXPECT_FALSE(Logger::parseLevel(nullptr, level));
+    EXPECT_EQ(level, LOG_LEVEL_OFF);  // Untouched on failure
+}
+
+TEST_F(LoggerTest, DropsLinesBelowTheLevelAndSplitsStreams) {
+    CapturedOutput output;
+    Logger::start();
+
+    Logger::setLevel(LOG_LEVEL_WARN);
+    int evaluated = 0;
+    LOG_INFO("TEST", "hidden " << ++evaluated);
+    LOG_WARN("TEST", "warned");
+    LOG_ERROR("TEST", "failed");
+    EXPECT_EQ(evaluated, 0);  // Arguments of a filtered line are never evaluated
+
+    Logger::setLevel(LOG_LEVEL_INFO);
+    LOG_INFO("TEST", "shown");
+    output.finish();
+
+    std::vector<std::string> out = output.outLines();
+    std::vector<std::string> err = output.errLines();
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(messageOf(out[0]), "shown");
+    ASSERT_EQ(err.size(), 2u);
+    EXPECT_EQ(messageOf(err[0]), "warned");
+    EXPECT_EQ(messageOf(err[1]), "failed");
+}
+
+TEST_F(LoggerTest, DebugLinesAreCompiledOutOfReleaseBuilds) {
+    CapturedOutput output;
+    Logger::start();
+    Logger::setLevel(LOG_LEVEL_DEBUG);
+
+    int evaluated = 0;
+    LOG_DEBUG("TEST", "debug " << ++evaluated);
+    output.finish();
+
+#if defined(DEBUG) || defined(LOG_DEBUG_ENABLED)
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(output.outLines().size(), 1u);
+#else
+    EXPECT_EQ(evaluated, 0);
+    EXPECT_TRUE(output.outLines().empty());
+#endif
+}
+
+// ============== FORMAT ==============
+
+TEST_F(LoggerTest, FormatsTimestampLevelTagAndValues) {
+    CapturedOutput output;
+    Logger::start();
+
+    std::atomic<uint64_t> counter(9);
+    LOG_INFO("TEST", "n=" << 42 << " neg=" << -7 << " big=" << 18446744073709551615ULL
+             << " c=" << 'x' << " b=" << true << " d=" << 2.5
+             << " s=" << std::string("str") << " a=" << counter);
+    output.finish();
+
+    std::vector<std::string> out = output.outLines();
+    ASSERT_EQ(out.size(), 1u);
+    std::regex format("\\d{4}-\\d{2}-\\d{2} \\d{2}:\\d{2}:\\d{2}\\.\\d{6} INFO  \\[TEST\\] .*");
+    EXPECT_TRUE(std::regex_match(out[0], format)) << out[0];
+    EXPECT_EQ(messageOf(out[0]),
+              "n=42 neg=-7 big=18446744073709551615 c=x b=true d=2.5 s=str a=9");
+}
+
+TEST_F(LoggerTest, TruncatesLongLines) {
+    CapturedOutput output;
+    Logger::start();
+
+    LOG_INFO("TEST", std::string(1000, 'a') << "tail");
+    output.finish();
+
+    std::vector<std::string> out = output.outLines();
+    ASSERT_EQ(out.size(), 1u);
+    std::string message = messageOf(out[0]);
+    EXPECT_EQ(message.size(), Logger::LINE_BYTES);
+    EXPECT_EQ(message.substr(message.size() - 3), "...");
+}
+
+TEST_F(LoggerTest, WritesDirectlyWhenNotStarted) {
+    CapturedOutput output;
+
+    LOG_INFO("TEST", "before start");
+    output.finish();
+
+    std::vector<std::string> out = output.outLines();
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(messageOf(out[0]), "before start");
+}
+
+// ============== CONCURRENCY ==============
+
+TEST_F(LoggerTest, ConcurrentLinesArriveWholeAndInOrderPerThread) {
+    const int THREADS = 8;
+    const int LINES = 5000;
+
+    CapturedOutput output;
+    Logger::start();
+    Logger::Stats before = Logger::getStats();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < LINES; i++) {
+                LOG_INFO("TEST", "thread " << t << " line " << i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    output.finish();
+    Logger::Stats after = Logger::getStats();
+
+    // Every line is either written or counted as dropped, never mangled
+    std::vector<int> next(THREADS, 0);
+    size_t received = 0;
+    std::regex format("thread (\\d+) line (\\d+)");
+    for (const std::string& line : output.outLines()) {
+        std::smatch match;
+        std::string message = messageOf(line);
+        ASSERT_TRUE(std::regex_match(message, match, format)) << line;
+        int t = std::stoi(match[1]);
+        int i = std::stoi(match[2]);
+        EXPECT_GE(i, next[t]) << line;
+        next[t] = i + 1;
+        received++;
+    }
+    uint64_t dropped = after.dropped - before.dropped;
+    EXPECT_EQ(received + dropped, static_cast<size_t>(THREADS * LINES));
+    EXPECT_EQ(after.lines - before.lines, received);
+
+    // A drop leaves a note on stderr
+    if (dropped > 0) {
+        ASSERT_FALSE(output.errLines().empty());
+        EXPECT_NE(output.errLines()[0].find("dropped"), std::string::npos);
+    }
+}
+
+// ============== COST ==============
+
+TEST_F(LoggerTest, LoggingCostsLittleOnTheCallingThread) {
+    int null_fd = open("/dev/null", O_WRONLY);
+    ASSERT_GE(null_fd, 0);
+    Logger::setOutput(null_fd, null_fd);
+    Logger::start();
+
+    // Batches small enough for the ring, so this times the logging side only
+    const int BATCHES = 50;
+    const int BATCH = 2000;
+    std::chrono::nanoseconds logging(0);
+    for (int batch = 0; batch < BATCHES; batch++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BATCH; i++) {
+            LOG_INFO("TEST", "Received from fd=" << 17 << " type=" << i << " length=" << 64);
+        }
+        logging += std::chrono::steady_clock::now() - start;
+        Logger::flush();
+    }
+    Logger::stop();
+    Logger::setOutput(STDOUT_FILENO, STDERR_FILENO);
+    close(null_fd);
+
+    double per_line = static_cast<double>(logging.count()) / (BATCHES * BATCH);
+    std::cout << "[ INFO     ] " << per_line << " ns per logged line" << std::endl;
+    EXPECT_LT(per_line, 5000.0);  // Loose; sanitizer and loaded machines included
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
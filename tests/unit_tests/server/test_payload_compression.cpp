@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "payload_compression.h"
+#include "compact_header.h"
+#include "message_buffer.h"
+#include "client_connection.h"
+#include "messages/gameplay_messages.h"
+#include "messages/matchmaking_messages.h"
+
+static ChatMessage chat(const char* text) {
+    ChatMessage message;
+    message.match_id = 9;
+    strncpy(message.message, text, sizeof(message.message) - 1);
+    return message;
+}
+
+static std::string bytesOf(const ChatMessage& message) {
+    return std::string(reinterpret_cast<const char*>(&message), sizeof(message));
+}
+
+// Frame as a v2 client reads it: header, and the payload as sent
+struct Frame {
+    CompactHeader header;
+    std::string payload;
+};
+
+static bool parse(const std::string& bytes, Frame& frame) {
+    int used = frame.header.decode(bytes.data(), bytes.size());
+    if (used <= 0 || bytes.size() != used + frame.header.length) {
+        return false;
+    }
+    frame.payload = bytes.substr(used);
+    return true;
+}
+
+// v2 connection on one end of a socket pair; peer is the client's end
+class CompressedConnectionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!PayloadCompression::supported()) {
+            GTEST_SKIP() << "built without zlib";
+        }
+        int pair[2];
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        conn = std::make_shared<ClientConnection>(pair[0]);
+        ASSERT_TRUE(conn->setNonBlocking());
+        conn->setWireVersion(ClientConnection::WIRE_V2);
+        peer = pair[1];
+    }
+
+    void TearDown() override {
+        if (peer >= 0) {
+            close(peer);
+        }
+    }
+
+    void clientSends(const std::string& bytes) {
+        ASSERT_EQ(write(peer, bytes.data(), bytes.size()), static_cast<ssize_t>(bytes.size()));
+        ASSERT_TRUE(conn->readAvailable());
+    }
+
+    std::string clientReceives() {
+        char bytes[8192];
+        ssize_t received = recv(peer, bytes, sizeof(bytes), MSG_DONTWAIT);
+        return received > 0 ? std::string(bytes, received) : std::string();
+    }
+
+    std::shared_ptr<ClientConnection> conn;
+    int peer = -1;
+};
+
+// ============== CODEC TESTS ==============
+
+TEST(PayloadCompressionTest, RoundTripsMessageStructs) {
+    if (!PayloadCompression::supported()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    std::string raw = bytesOf(chat("gg"));
+    std::string packed;
+    ASSERT_TRUE(PayloadCompression::compress(raw.data(), raw.size(), packed));
+    EXPECT_LT(packed.size(), raw.size() / 2);
+
+    std::string restored;
+    ASSERT_TRUE(PayloadCompression::decompress(packed.data(), packed.size(), MAX_MESSAGE_SIZE, restored));
+    EXPECT_EQ(restored, raw);
+}
+
+TEST(PayloadCompressionTest, DeclinesPayloadsItCannotShrink) {
+    if (!PayloadCompression::supported()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    std::string noise(512, '\0');
+    uint32_t state = 12345;
+    for (char& byte : noise) {
+        state = state * 1103515245u + 12345u;
+        byte = static_cast<char>(state >> 24);
+    }
+    std::string packed;
+    EXPECT_FALSE(PayloadCompression::compress(noise.data(), noise.size(), packed));
+}
+
+TEST(PayloadCompressionTest, RejectsMalformedInput) {
+    if (!PayloadCompression::supported()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    std::string raw = bytesOf(chat("hello"));
+    std::string packed;
+    ASSERT_TRUE(PayloadCompression::compress(raw.data(), raw.size(), packed));
+
+    std::string out;
+    EXPECT_FALSE(PayloadCompression::decompress(packed.data(), 3, MAX_MESSAGE_SIZE, out));
+    EXPECT_FALSE(PayloadCompression::decompress(packed.data(), packed.size() - 1, MAX_MESSAGE_SIZE, out));
+    EXPECT_FALSE(PayloadCompression::decompress(packed.data(), packed.size(), raw.size() - 1, out));
+
+    // A length prefix that does not match the stream
+    std::string wrong_length = packed;
+    uint32_t claimed = static_cast<uint32_t>(raw.size() + 1);
+    memcpy(&wrong_length[0], &claimed, sizeof(claimed));
+    EXPECT_FALSE(PayloadCompression::decompress(wrong_length.data(), wrong_length.size(), MAX_MESSAGE_SIZE, out));
+
+    std::string garbage = packed.substr(0, PayloadCompression::PREFIX_SIZE) + std::string(40, 'x');
+    EXPECT_FALSE(PayloadCompression::decompress(garbage.data(), garbage.size(), MAX_MESSAGE_SIZE, out));
+}
+
+// ============== SHARED FRAME TESTS ==============
+
+TEST(PayloadCompressionTest, CompressedFrameIsBuiltOnceAboveTheThreshold) {
+    if (!PayloadCompression::supported()) {
+        GTEST_SKIP() << "built without zlib";
+    }
+    SharedMessage full = MessageBuffer::create(CHAT_MESSAGE, chat("well played"));
+    SharedMessage compressed = MessageBuffer::compressed(full);
+    EXPECT_EQ(MessageBuffer::compressed(full), compressed);
+    EXPECT_EQ(compressed->type(), CHAT_MESSAGE);
+
+    Frame frame;
+    ASSERT_TRUE(parse(std::string(compressed->data(), compressed->size()), frame));
+    EXPECT_TRUE(frame.header.flags & CompactHeader::FLAG_COMPRESSED);
+    std::string restored;
+    ASSERT_TRUE(PayloadCompression::decompress(frame.payload.data(), frame.payload.size(), MAX_MESSAGE_SIZE, restored));
+    EXPECT_EQ(restored, std::string(full->payload(), full->payloadSize()));
+
+    // Small messages and raw frames are not worth it
+    SharedMessage small = MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage());
+    EXPECT_EQ(MessageBuffer::compressed(small), MessageBuffer::compact(small));
+    SharedMessage raw = MessageBuffer::fromFrames(std::string(full->data(), full->size()));
+    EXPECT_EQ(MessageBuffer::compressed(raw), raw);
+}
+
+// ============== CONNECTION TESTS ==============
+
+TEST_F(CompressedConnectionTest, SendsPlainFramesUntilAgreed) {
+    ASSERT_TRUE(conn->sendMessage(MessageBuffer::create(CHAT_MESSAGE, chat("hi"))));
+    Frame frame;
+    ASSERT_TRUE(parse(clientReceives(), frame));
+    EXPECT_FALSE(frame.header.flags & CompactHeader::FLAG_COMPRESSED);
+    EXPECT_EQ(frame.payload.size(), sizeof(ChatMessage));
+}
+
+TEST_F(CompressedConnectionTest, SendsLargeMessagesCompressedOnceAgreed) {
+    conn->setCapabilities(CAP_ZLIB);
+    ChatMessage message = chat("nice shot");
+    ASSERT_TRUE(conn->sendMessage(MessageBuffer::create(CHAT_MESSAGE, message)));
+
+    Frame frame;
+    ASSERT_TRUE(parse(clientReceives(), frame));
+    EXPECT_EQ(frame.header.type, CHAT_MESSAGE);
+    EXPECT_TRUE(frame.header.flags & CompactHeader::FLAG_COMPRESSED);
+    std::string restored;
+    ASSERT_TRUE(PayloadCompression::decompress(frame.payload.data(), frame.payload.size(), MAX_MESSAGE_SIZE, restored));
+    EXPECT_EQ(restored, bytesOf(message));
+
+    // Below the threshold the frame is plain v2
+    ASSERT_TRUE(conn->sendMessage(MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage())));
+    ASSERT_TRUE(parse(clientReceives(), frame));
+    EXPECT_FALSE(frame.header.flags & CompactHeader::FLAG_COMPRESSED);
+}
+
+TEST_F(CompressedConnectionTest, BatchFramesAreCompressedAsAWhole) {
+    conn->setCapabilities(CAP_ZLIB);
+    {
+        ClientConnection::SendBatch batch;
+        for (uint32_t user_id = 1; user_id <= 10; user_id++) {
+            PlayerStatusUpdate update;
+            update.user_id = user_id;
+            update.status = STATUS_AVAILABLE;
+            ASSERT_TRUE(conn->sendMessage(MessageBuffer::create(PLAYER_STATUS_UPDATE, update)));
+        }
+    }
+
+    Frame frame;
+    ASSERT_TRUE(parse(clientReceives(), frame));
+    EXPECT_EQ(frame.header.type, BATCH);
+    EXPECT_TRUE(frame.header.flags & CompactHeader::FLAG_COMPRESSED);
+    std::string restored;
+    ASSERT_TRUE(PayloadCompression::decompress(frame.payload.data(), frame.payload.size(), MAX_MESSAGE_SIZE, restored));
+    EXPECT_EQ(restored.size(), 10 * (BatchEntry::HEADER_SIZE + sizeof(PlayerStatusUpdate)));
+}
+
+TEST_F(CompressedConnectionTest, ReceivesCompressedFramesOnceAgreed) {
+    conn->setCapabilities(CAP_ZLIB);
+    std::string raw = bytesOf(chat("rematch?"));
+    std::string packed;
+    ASSERT_TRUE(PayloadCompression::compress(raw.data(), raw.size(), packed));
+
+    CompactHeader header;
+    header.type = CHAT_MESSAGE;
+    header.flags = CompactHeader::FLAG_COMPRESSED;
+    header.length = static_cast<uint32_t>(packed.size());
+    char encoded[CompactHeader::MAX_SIZE];
+    clientSends(std::string(encoded, header.encode(encoded)) + packed);
+
+    MessageHeader received;
+    PayloadView payload;
+    ASSERT_TRUE(conn->nextMessage(received, payload));
+    EXPECT_EQ(received.type, CHAT_MESSAGE);
+    EXPECT_EQ(received.length, raw.size());
+    ASSERT_EQ(payload.size(), raw.size());
+    EXPECT_EQ(std::string(payload.data(), payload.size()), raw);
+    EXPECT_TRUE(conn->isConnected());
+}
+
+TEST_F(CompressedConnectionTest, CompressedFrameWithoutAgreementDisconnects) {
+    std::string raw = bytesOf(chat("sneaky"));
+    std::string packed;
+    ASSERT_TRUE(PayloadCompression::compress(raw.data(), raw.size(), packed));
+
+    CompactHeader header;
+    header.type = CHAT_MESSAGE;
+    header.flags = CompactHeader::FLAG_COMPRESSED;
+    header.length = static_cast<uint32_t>(packed.size());
+    char encoded[CompactHeader::MAX_SIZE];
+    clientSends(std::string(encoded, header.encode(encoded)) + packed);
+
+    MessageHeader received;
+    PayloadView payload;
+    EXPECT_FALSE(conn->nextMessage(received, payload));
+    EXPECT_FALSE(conn->isConnected());
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
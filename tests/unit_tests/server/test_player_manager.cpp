@@ -4,6 +4,8 @@
 #include "client_connection.h"
 #include <thread>
 #include <chrono>
+#include <unistd.h>
+#include "messages/gameplay_messages.h"
 
 /**
  * Unit Tests for PlayerManager
@@ -111,6 +113,27 @@ TEST_F(PlayerManagerTest, GetOnlinePlayers) {
     EXPECT_TRUE(found1 && found2 && found3);
 }
 
+// Test: Get online players a page at a time, in user_id order
+TEST_F(PlayerManagerTest, GetOnlinePlayersPage) {
+    player_manager->addPlayer(nullptr, 7, "user7", "Player Seven", 1000);
+    player_manager->addPlayer(nullptr, 2, "user2", "Player Two", 1200);
+    player_manager->addPlayer(nullptr, 5, "user5", "Player Five", 800);
+
+    uint32_t total = 0;
+    auto first = player_manager->getOnlinePlayers(0, 2, total);
+    EXPECT_EQ(total, 3u);
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_EQ(first[0].user_id, 2u);
+    EXPECT_EQ(first[1].user_id, 5u);
+
+    auto rest = player_manager->getOnlinePlayers(first.back().user_id, 2, total);
+    ASSERT_EQ(rest.size(), 1u);
+    EXPECT_EQ(rest[0].user_id, 7u);
+    EXPECT_STREQ(rest[0].display_name, "Player Seven");
+
+    EXPECT_TRUE(player_manager->getOnlinePlayers(7, 2, total).empty());
+}
+
 // Test: Get available players (filter by status)
 TEST_F(PlayerManagerTest, GetAvailablePlayers) {
     player_manager->addPlayer(nullptr, 1, "user1", "Player One", 1000);
@@ -230,16 +253,41 @@ TEST_F(PlayerManagerTest, ConcurrentStatusUpdates) {
     EXPECT_EQ(available.size(), num_players);
 }
 
-// Test: Get client connection
-TEST_F(PlayerManagerTest, GetClientConnection) {
-    ClientConnection* fake_client = reinterpret_cast<ClientConnection*>(0x1234);
-    player_manager->addPlayer(fake_client, 1, "user1", "Player One", 1000);
+// Test: Get connection handle
+TEST_F(PlayerManagerTest, GetConnectionHandle) {
+    auto client = std::make_shared<ClientConnection>(dup(STDIN_FILENO));
+    client->setHandle(ConnectionHandle(client->getSocketFd(), 7));
+    player_manager->addPlayer(client.get(), 1, "user1", "Player One", 1000);
+
+    ConnectionHandle retrieved = player_manager->getConnectionHandle(1);
+    EXPECT_EQ(retrieved, client->getHandle());
+
+    EXPECT_FALSE(player_manager->getConnectionHandle(999).valid());
+    EXPECT_FALSE(player_manager->sendToPlayer(999, MessageBuffer::create(TURN_UPDATE, TurnUpdateMessage())));
+}
+
+// Test: The old connection of a player who reconnected does not take the new one down
+TEST_F(PlayerManagerTest, ReconnectKeepsNewRoute) {
+    ConnectionHandle old_connection(40, 3);
+    ConnectionHandle new_connection(41, 9);
+
+    auto first = std::make_shared<ClientConnection>(dup(STDIN_FILENO));
+    auto second = std::make_shared<ClientConnection>(dup(STDIN_FILENO));
+    first->setHandle(old_connection);
+    second->setHandle(new_connection);
 
-    ClientConnection* retrieved = player_manager->getClientConnection(1);
-    EXPECT_EQ(retrieved, fake_client);
+    player_manager->addPlayer(first.get(), 1, "user1", "Player One", 1000);
+    player_manager->addPlayer(second.get(), 1, "user1", "Player One", 1000);
+    EXPECT_EQ(player_manager->getConnectionHandle(1), new_connection);
 
-    ClientConnection* non_existent = player_manager->getClientConnection(999);
-    EXPECT_EQ(non_existent, nullptr);
+    // Old connection closes after the reconnect
+    player_manager->removePlayer(1, old_connection);
+    EXPECT_TRUE(player_manager->isPlayerOnline(1));
+    EXPECT_EQ(player_manager->getConnectionHandle(1), new_connection);
+
+    player_manager->removePlayer(1, new_connection);
+    EXPECT_FALSE(player_manager->isPlayerOnline(1));
+    EXPECT_FALSE(player_manager->getConnectionHandle(1).valid());
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "rate_limiter.h"
+#include "protocol.h"
+#include "config.h"
+
+static RateLimiter::Budget budget(uint32_t per_second, uint32_t burst) {
+    RateLimiter::Budget result;
+    result.per_second = per_second;
+    result.burst = burst;
+    return result;
+}
+
+// How many of count messages sent at now_ms get through
+static int allowed(RateLimiter& limiter, RateLimiter::Buckets& buckets, uint8_t type,
+                   int count, uint32_t now_ms) {
+    int passed = 0;
+    for (int i = 0; i < count; i++) {
+        if (limiter.allow(buckets, type, now_ms)) {
+            passed++;
+        }
+    }
+    return passed;
+}
+
+// ============== BUCKET TESTS ==============
+
+TEST(RateLimiterTest, AllowsBurstThenRefillsAtRate) {
+    RateLimiter limiter;
+    limiter.setBudget(MOVE, budget(10, 5));
+    RateLimiter::Buckets buckets;
+
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 8, 1000), 5);
+
+    // 10 a second is one per 100 ms
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 3, 1050), 0);
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 3, 1100), 1);
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 3, 1350), 2);   // 2.5 accrued
+
+    // A long pause refills only up to the burst
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 10, 60000), 5);
+}
+
+TEST(RateLimiterTest, UnlimitedTypesAndOtherConnectionsAreUnaffected) {
+    RateLimiter limiter;
+    limiter.setBudget(PLAYER_LIST_REQUEST, budget(1, 2));
+    RateLimiter::Buckets spammer;
+    RateLimiter::Buckets other;
+
+    EXPECT_EQ(allowed(limiter, spammer, PLAYER_LIST_REQUEST, 10, 5000), 2);
+    EXPECT_EQ(allowed(limiter, spammer, PING, 1000, 5000), 1000);
+    EXPECT_EQ(allowed(limiter, spammer, MOVE, 1000, 5000), 1000);
+    EXPECT_EQ(allowed(limiter, other, PLAYER_LIST_REQUEST, 10, 5000), 2);
+}
+
+TEST(RateLimiterTest, ConnectionBudgetCoversAllTypes) {
+    RateLimiter limiter;
+    limiter.setConnectionBudget(budget(100, 10));
+    limiter.setBudget(MOVE, budget(100, 3));
+    RateLimiter::Buckets buckets;
+
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 5, 0), 3);
+    EXPECT_EQ(allowed(limiter, buckets, PING, 20, 0), 5);  // 5 connection tokens spent on MOVE above
+}
+
+TEST(RateLimiterTest, CountsDropsByType) {
+    RateLimiter limiter;
+    limiter.setBudget(CHALLENGE_SEND, budget(1, 1));
+    limiter.setBudget(MOVE, budget(1, 2));
+    RateLimiter::Buckets buckets;
+
+    allowed(limiter, buckets, CHALLENGE_SEND, 4, 0);
+    allowed(limiter, buckets, MOVE, 4, 0);
+
+    RateLimiter::Stats stats = limiter.getStats();
+    EXPECT_EQ(stats.dropped_by_type[CHALLENGE_SEND], 3u);
+    EXPECT_EQ(stats.dropped_by_type[MOVE], 2u);
+    EXPECT_EQ(stats.dropped, 5u);
+}
+
+TEST(RateLimiterTest, ClockWrapDoesNotStallBuckets) {
+    RateLimiter limiter;
+    limiter.setBudget(MOVE, budget(10, 2));
+    RateLimiter::Buckets buckets;
+
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 3, 0xFFFFFF00u), 2);
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 3, 0x00000100u), 2);  // 512 ms later
+}
+
+// ============== CONFIGURATION TESTS ==============
+
+TEST(RateLimiterTest, ConfiguresFromSpec) {
+    RateLimiter limiter;
+    EXPECT_TRUE(limiter.configure("MOVE=10/20, PLAYER_LIST_REQUEST=2/5,52=1/1,*=100/200"));
+
+    EXPECT_EQ(limiter.getBudget(MOVE).per_second, 10u);
+    EXPECT_EQ(limiter.getBudget(MOVE).burst, 20u);
+    EXPECT_EQ(limiter.getBudget(PLAYER_LIST_REQUEST).burst, 5u);
+    EXPECT_EQ(limiter.getBudget(STATS_REQUEST).per_second, 1u);
+    EXPECT_EQ(limiter.getBudget(PING).per_second, 0u);
+
+    // Later specs override and remove entries
+    EXPECT_TRUE(limiter.configure("MOVE=0,STATS_REQUEST=3/4"));
+    EXPECT_EQ(limiter.getBudget(MOVE).per_second, 0u);
+    EXPECT_EQ(limiter.getBudget(STATS_REQUEST).per_second, 3u);
+
+    RateLimiter::Buckets buckets;
+    EXPECT_EQ(allowed(limiter, buckets, MOVE, 300, 0), 200);  // Only the connection budget left
+
+    EXPECT_TRUE(limiter.configure(DEFAULT_RATE_LIMITS));
+}
+
+TEST(RateLimiterTest, RejectsMalformedSpecs) {
+    RateLimiter limiter;
+    EXPECT_FALSE(limiter.configure("MOVE"));
+    EXPECT_FALSE(limiter.configure("MOVE=10"));
+    EXPECT_FALSE(limiter.configure("MOVE=10/0"));
+    EXPECT_FALSE(limiter.configure("MOVE=ten/5"));
+    EXPECT_FALSE(limiter.configure("NOT_A_TYPE=1/1"));
+    EXPECT_FALSE(limiter.configure("300=1/1"));
+
+    // Entries before the bad one still apply
+    EXPECT_FALSE(limiter.configure("RESIGN=1/2,bogus"));
+    EXPECT_EQ(limiter.getBudget(RESIGN).burst, 2u);
+}
+
+TEST(RateLimiterTest, LimitsAtMostFifteenTypes) {
+    RateLimiter limiter;
+    for (uint8_t type = 200; type < 200 + RateLimiter::MAX_LIMITED_TYPES; type++) {
+        EXPECT_TRUE(limiter.setBudget(type, budget(1, 1)));
+    }
+    EXPECT_FALSE(limiter.setBudget(MOVE, budget(1, 1)));
+    EXPECT_TRUE(limiter.setBudget(200, budget(5, 5)));  // Existing ones can change
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
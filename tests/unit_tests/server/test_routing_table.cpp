@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "routing_table.h"
+
+// ============== BASIC OPERATIONS ==============
+
+TEST(RoutingTableTest, FindsRoutesBySetUser) {
+    RoutingTable routes;
+    routes.set(1, ConnectionHandle(10, 1));
+    routes.set(2, ConnectionHandle(11, 4));
+
+    EXPECT_EQ(routes.find(1), ConnectionHandle(10, 1));
+    EXPECT_EQ(routes.find(2), ConnectionHandle(11, 4));
+    EXPECT_FALSE(routes.find(3).valid());
+    EXPECT_FALSE(routes.find(0).valid());
+    EXPECT_EQ(routes.size(), 2u);
+}
+
+TEST(RoutingTableTest, SetReplacesTheRoute) {
+    RoutingTable routes;
+    routes.set(5, ConnectionHandle(10, 1));
+    routes.set(5, ConnectionHandle(12, 2));
+
+    EXPECT_EQ(routes.find(5), ConnectionHandle(12, 2));
+    EXPECT_EQ(routes.size(), 1u);
+}
+
+TEST(RoutingTableTest, EraseWithHandleOnlyRemovesThatConnection) {
+    RoutingTable routes;
+    routes.set(5, ConnectionHandle(12, 2));
+
+    EXPECT_FALSE(routes.erase(5, ConnectionHandle(10, 1)));  // Older connection
+    EXPECT_EQ(routes.find(5), ConnectionHandle(12, 2));
+
+    EXPECT_TRUE(routes.erase(5, ConnectionHandle(12, 2)));
+    EXPECT_FALSE(routes.find(5).valid());
+    EXPECT_FALSE(routes.erase(5));
+    EXPECT_EQ(routes.size(), 0u);
+}
+
+TEST(RoutingTableTest, GrowsAndSurvivesChurn) {
+    RoutingTable routes(16);
+    for (uint32_t user = 1; user <= 1000; user++) {
+        routes.set(user, ConnectionHandle(static_cast<int>(user), user * 3));
+    }
+    EXPECT_EQ(routes.size(), 1000u);
+
+    // Removed entries are reused or cleaned up, so lookups keep terminating
+    for (uint32_t user = 1; user <= 1000; user += 2) {
+        routes.erase(user);
+    }
+    for (uint32_t user = 1001; user <= 5000; user++) {
+        routes.set(user, ConnectionHandle(static_cast<int>(user), user * 3));
+        routes.erase(user);
+    }
+
+    EXPECT_EQ(routes.size(), 500u);
+    for (uint32_t user = 1; user <= 1000; user++) {
+        ConnectionHandle handle = routes.find(user);
+        if (user % 2 == 1) {
+            EXPECT_FALSE(handle.valid()) << user;
+        } else {
+            EXPECT_EQ(handle, ConnectionHandle(static_cast<int>(user), user * 3)) << user;
+        }
+    }
+
+    routes.clear();
+    EXPECT_EQ(routes.size(), 0u);
+    EXPECT_FALSE(routes.find(2).valid());
+}
+
+// ============== CONCURRENCY ==============
+
+TEST(RoutingTableTest, ReadersNeverSeeTornHandles) {
+    RoutingTable routes(16);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> torn(0);
+    std::atomic<uint64_t> found(0);
+
+    // Every handle written has generation == fd * 2, so a mixed read shows up
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                for (uint32_t user = 1; user <= 64; user++) {
+                    ConnectionHandle handle = routes.find(user);
+                    if (handle.valid()) {
+                        found++;
+                        if (handle.generation != static_cast<uint32_t>(handle.fd) * 2) {
+                            torn++;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // Until the readers have had a good look, however quickly this side runs
+    for (int round = 1; round <= 20000 || found < 10000; round++) {
+        uint32_t user = 1 + round % 64;
+        routes.set(user, ConnectionHandle(round, static_cast<uint32_t>(round) * 2));
+        if (round % 7 == 0) {
+            routes.erase(user);
+        }
+        if (round % 5000 == 0) {
+            routes.clear();  // Swaps the array under the readers
+        }
+    }
+    stop = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    EXPECT_EQ(torn.load(), 0u);
+    EXPECT_GT(found.load(), 0u);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "timer_wheel.h"
+#include "reactor.h"
+#include "client_connection.h"
+
+// ============== TIMER WHEEL TESTS ==============
+
+TEST(TimerWheelTest, ExpiresOnlyPastDeadlines) {
+    TimerWheel wheel(10, 8);
+    wheel.schedule(1, 1000);
+    wheel.schedule(2, 1050);
+    wheel.schedule(3, 1200);
+
+    std::vector<int> expired;
+    wheel.advance(999, expired);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(1050, expired);
+    std::sort(expired.begin(), expired.end());
+    EXPECT_EQ(expired, std::vector<int>({1, 2}));
+    EXPECT_EQ(wheel.size(), 1u);
+
+    expired.clear();
+    wheel.advance(1200, expired);
+    EXPECT_EQ(expired, std::vector<int>({3}));
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, RescheduleAndCancelDropOldEntries) {
+    TimerWheel wheel(10, 8);
+    std::vector<int> expired;
+    wheel.advance(0, expired);
+
+    wheel.schedule(1, 50);
+    wheel.schedule(1, 150);  // Moved: must not fire at 50
+    wheel.schedule(2, 50);
+    wheel.cancel(2);
+    EXPECT_FALSE(wheel.contains(2));
+
+    wheel.advance(100, expired);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(150, expired);
+    EXPECT_EQ(expired, std::vector<int>({1}));
+}
+
+TEST(TimerWheelTest, DeadlinesBeyondOneRevolutionWait) {
+    // 8 slots x 10 ms: a 500 ms deadline shares a slot with earlier ticks
+    TimerWheel wheel(10, 8);
+    std::vector<int> expired;
+    wheel.advance(0, expired);
+    wheel.schedule(7, 500);
+
+    for (uint64_t now = 10; now < 500; now += 10) {
+        wheel.advance(now, expired);
+        ASSERT_TRUE(expired.empty()) << "fired early at " << now;
+    }
+    wheel.advance(500, expired);
+    EXPECT_EQ(expired, std::vector<int>({7}));
+}
+
+TEST(TimerWheelTest, LongGapBetweenAdvancesStillExpires) {
+    TimerWheel wheel(10, 8);
+    std::vector<int> expired;
+    wheel.advance(0, expired);
+    wheel.schedule(1, 30);
+    wheel.schedule(2, 5000);
+
+    wheel.advance(4000, expired);  // Skips many revolutions at once
+    EXPECT_EQ(expired, std::vector<int>({1}));
+    EXPECT_TRUE(wheel.contains(2));
+}
+
+TEST(TimerWheelTest, PastDeadlineFiresOnNextAdvance) {
+    TimerWheel wheel(10, 8);
+    std::vector<int> expired;
+    wheel.advance(1000, expired);
+
+    wheel.schedule(4, 500);
+    wheel.advance(1000, expired);  // Same tick: slot not visited yet
+    wheel.advance(1010, expired);
+    EXPECT_EQ(expired, std::vector<int>({4}));
+}
+
+// ============== REACTOR IDLE TESTS ==============
+
+class ReactorIdleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(listen_fd, 0);
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = 0;
+        ASSERT_EQ(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+        ASSERT_EQ(listen(listen_fd, 16), 0);
+
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd, (struct sockaddr*)&addr, &len);
+        port = ntohs(addr.sin_port);
+
+        reactor.reset(new Reactor(listen_fd));
+        reactor->setAcceptCallback([](int client_fd, const sockaddr_in&) {
+            return std::make_shared<ClientConnection>(client_fd);
+        });
+        reactor->setCloseCallback([this](int) { closed++; });
+    }
+
+    void TearDown() override {
+        reactor.reset();
+        if (client_fd >= 0) {
+            close(client_fd);
+        }
+        close(listen_fd);
+    }
+
+    void connectClient() {
+        client_fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = htons(port);
+        ASSERT_EQ(connect(client_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+
+        // Short receive timeout so a missing heartbeat fails instead of hanging
+        struct timeval timeout = {2, 0};
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    void sendFrame(MessageType type) {
+        MessageHeader header;
+        memset(&header, 0, sizeof(header));
+        header.type = static_cast<uint8_t>(type);
+        ASSERT_EQ(send(client_fd, &header, sizeof(header), 0), static_cast<ssize_t>(sizeof(header)));
+    }
+
+    int listen_fd = -1;
+    int client_fd = -1;
+    int port = 0;
+    std::unique_ptr<Reactor> reactor;
+    std::atomic<int> closed{0};
+};
+
+TEST_F(ReactorIdleTest, SilentClientGetsPingThenIsClosed) {
+    reactor->setIdleTimeout(200, 200);
+    ASSERT_TRUE(reactor->start());
+    connectClient();
+
+    MessageHeader header;
+    ASSERT_EQ(recv(client_fd, &header, sizeof(header), MSG_WAITALL), static_cast<ssize_t>(sizeof(header)));
+    EXPECT_EQ(header.type, static_cast<uint8_t>(PING));
+
+    // No reply: the reactor closes the connection after the grace period
+    char byte;
+    EXPECT_EQ(recv(client_fd, &byte, 1, 0), 0);
+    for (int i = 0; i < 100 && closed == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));  // EOF can beat the close callback
+    }
+    EXPECT_EQ(closed, 1);
+
+    Reactor::IdleStats stats = reactor->getIdleStats();
+    EXPECT_EQ(stats.heartbeats_sent, 1u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_GE(stats.silence_max_ms, 400u);
+    EXPECT_EQ(stats.silence_total_ms, stats.silence_max_ms);
+    EXPECT_EQ(reactor->getConnectionCount(), 0u);
+}
+
+TEST_F(ReactorIdleTest, RepliesKeepConnectionOpen) {
+    reactor->setIdleTimeout(200, 200);
+    ASSERT_TRUE(reactor->start());
+    connectClient();
+
+    // Answer every heartbeat for a while
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1200);
+    int pings = 0;
+    while (std::chrono::steady_clock::now() < until) {
+        MessageHeader header;
+        ssize_t got = recv(client_fd, &header, sizeof(header), MSG_WAITALL);
+        ASSERT_EQ(got, static_cast<ssize_t>(sizeof(header)));
+        ASSERT_EQ(header.type, static_cast<uint8_t>(PING));
+        pings++;
+        sendFrame(PONG);
+    }
+
+    EXPECT_GE(pings, 2);
+    EXPECT_EQ(closed, 0);
+    EXPECT_EQ(reactor->getIdleStats().evictions, 0u);
+    EXPECT_EQ(reactor->getConnectionCount(), 1u);
+}
+
+TEST_F(ReactorIdleTest, DisabledByDefault) {
+    ASSERT_TRUE(reactor->start());
+    connectClient();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(reactor->getIdleStats().heartbeats_sent, 0u);
+    EXPECT_EQ(reactor->getConnectionCount(), 1u);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
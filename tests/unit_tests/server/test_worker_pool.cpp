@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "worker_pool.h"
+
+// ============== STRAND ORDERING TESTS ==============
+
+TEST(WorkerPoolTest, RunsTasksOnStrandInOrder) {
+    WorkerPool pool(4);
+    ASSERT_TRUE(pool.start());
+
+    auto strand = std::make_shared<Strand>();
+    std::vector<int> seen;
+    std::mutex seen_mutex;
+
+    const int TASKS = 1000;
+    for (int i = 0; i < TASKS; i++) {
+        pool.post(strand, [&, i]() {
+            std::lock_guard<std::mutex> lock(seen_mutex);
+            seen.push_back(i);
+        });
+    }
+    pool.stop();  // Drains queued work
+
+    ASSERT_EQ(seen.size(), static_cast<size_t>(TASKS));
+    for (int i = 0; i < TASKS; i++) {
+        EXPECT_EQ(seen[i], i);
+    }
+}
+
+TEST(WorkerPoolTest, StrandNeverRunsTwoTasksAtOnce) {
+    WorkerPool pool(4);
+    ASSERT_TRUE(pool.start());
+
+    auto strand = std::make_shared<Strand>();
+    std::atomic<int> active(0);
+    std::atomic<int> overlaps(0);
+
+    for (int i = 0; i < 200; i++) {
+        pool.post(strand, [&]() {
+            if (active.fetch_add(1) != 0) {
+                overlaps++;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            active--;
+        });
+    }
+    pool.stop();
+
+    EXPECT_EQ(overlaps, 0);
+}
+
+TEST(WorkerPoolTest, DifferentStrandsRunInParallel) {
+    WorkerPool pool(2);
+    ASSERT_TRUE(pool.start());
+
+    // Two strands each wait for the other; only completes if both run at once
+    auto first = std::make_shared<Strand>();
+    auto second = std::make_shared<Strand>();
+    std::atomic<int> arrived(0);
+    std::atomic<bool> both_seen(false);
+
+    auto rendezvous = [&]() {
+        arrived++;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (arrived < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        if (arrived == 2) {
+            both_seen = true;
+        }
+    };
+
+    pool.post(first, rendezvous);
+    pool.post(second, rendezvous);
+    pool.stop();
+
+    EXPECT_TRUE(both_seen);
+}
+
+TEST(WorkerPoolTest, TasksPostedFromTasksStayOrdered) {
+    WorkerPool pool(3);
+    ASSERT_TRUE(pool.start());
+
+    auto strand = std::make_shared<Strand>();
+    std::vector<int> seen;
+    std::mutex seen_mutex;
+
+    pool.post(strand, [&]() {
+        for (int i = 1; i <= 50; i++) {
+            pool.post(strand, [&, i]() {
+                std::lock_guard<std::mutex> lock(seen_mutex);
+                seen.push_back(i);
+            });
+        }
+    });
+
+    // Give the nested posts time to land before draining
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pool.stop();
+
+    ASSERT_EQ(seen.size(), 50u);
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(seen[i], i + 1);
+    }
+}
+
+// ============== LIFECYCLE TESTS ==============
+
+TEST(WorkerPoolTest, PostWithoutStartRunsInline) {
+    WorkerPool pool(2);
+    auto strand = std::make_shared<Strand>();
+
+    bool ran = false;
+    pool.post(strand, [&]() { ran = true; });
+
+    EXPECT_TRUE(ran);
+}
+
+TEST(WorkerPoolTest, ThrowingTaskDoesNotKillWorker) {
+    WorkerPool pool(1);
+    ASSERT_TRUE(pool.start());
+
+    auto strand = std::make_shared<Strand>();
+    std::atomic<bool> ran_after(false);
+
+    pool.post(strand, []() { throw std::runtime_error("handler failed"); });
+    pool.post(strand, [&]() { ran_after = true; });
+    pool.stop();
+
+    EXPECT_TRUE(ran_after);
+}
+
+TEST(WorkerPoolTest, DefaultThreadCountIsAtLeastOne) {
+    WorkerPool pool(0);
+    EXPECT_GE(pool.getThreadCount(), 1u);
+}
+
+// ============== STATISTICS TESTS ==============
+
+TEST(WorkerPoolTest, StatsTrackQueueDepthAndWaits) {
+    WorkerPool pool(1);
+    ASSERT_TRUE(pool.start());
+
+    auto blocker = std::make_shared<Strand>();
+    auto other = std::make_shared<Strand>();
+    std::atomic<bool> release(false);
+
+    // Occupy the only worker so later posts have to queue
+    pool.post(blocker, [&]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    for (int i = 0; i < 10; i++) {
+        pool.post(other, []() {});
+    }
+
+    WorkerPool::Stats queued = pool.getStats();
+    EXPECT_EQ(queued.queue_depth, 10u);
+    EXPECT_GE(queued.max_queue_depth, 10u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+    pool.stop();
+
+    WorkerPool::Stats done = pool.getStats();
+    EXPECT_EQ(done.threads, 1u);
+    EXPECT_EQ(done.queue_depth, 0u);
+    EXPECT_EQ(done.tasks_run, 11u);
+    EXPECT_GE(done.max_wait_us, 20000u);
+    EXPECT_GT(done.avg_wait_us, 0.0);
+}
+
+TEST(WorkerPoolTest, IdleWorkersStealQueuedStrands) {
+    WorkerPool pool(4);
+    ASSERT_TRUE(pool.start());
+
+    // Worker-side posts land on the posting worker's own queue; while it is
+    // busy, the other workers have to steal them.
+    auto origin = std::make_shared<Strand>();
+    std::vector<std::shared_ptr<Strand>> strands;
+    for (int i = 0; i < 32; i++) {
+        strands.push_back(std::make_shared<Strand>());
+    }
+    std::atomic<int> finished(0);
+
+    pool.post(origin, [&]() {
+        for (auto& strand : strands) {
+            pool.post(strand, [&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                finished++;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pool.stop();
+
+    EXPECT_EQ(finished, 32);
+    EXPECT_GT(pool.getStats().steals, 0u);
+}
+
+// Main function
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}